@@ -1,5 +1,6 @@
 #include "./app.h"
 
+#include "../core/string/string_atom.h"
 #include "../vulkan/initializer/shader/graphics_pipeline_builder/graphics_pipeline_builder.h"
 #include "./app_builder/app_builder.h"
 
@@ -38,6 +39,11 @@ static bool init_shaders(App* app) {
 }
 
 void app_init(App* app) {
+    if (!string_atom_table_init()) {
+        log_error("Unable to initialize string atom table");
+        return;
+    }
+
     if (!path_get_basepath(app->basepath)) {
         log_error("Unable to get basepath");
         return;
@@ -76,6 +82,9 @@ int app_start(App* app) {
 
     bool is_running = true;
     while (is_running) {
+        // Input is polled after the wait so the frame uses the latest state
+        is_running = renderer_pace_frame(&app->renderer);
+
         SDL_Event event;
         bool resized = false;
         while (SDL_PollEvent(&event)) {
@@ -110,9 +119,13 @@ int app_start(App* app) {
 void app_destroy(App* app) {
     pipeline_repository_destroy(&app->pipeline_repository);
     rendering_context_destroy(&app->rendering_context);
+    memory_uploader_destroy(&app->memory_uploader);
+    memory_defragmenter_destroy(&app->memory_defragmenter);
     command_context_destroy(&app->command_context);
     memory_context_destroy(&app->memory_context);
     context_destroy(&app->context);
     app_window_destroy(&app->window);
+    job_system_destroy(&app->job_system);
+    string_atom_table_destroy();
     app_clear(app);
 }
@@ -4,21 +4,27 @@
 #include <stdbool.h>
 
 #include "../core/fs/path.h"
+#include "../core/jobs/job_system.h"
 #include "../renderer/renderer.h"
 #include "../vulkan/core/command/command_context.h"
 #include "../vulkan/core/context/context.h"
+#include "../vulkan/core/memory/defragmenter/memory_defragmenter.h"
 #include "../vulkan/core/memory/memory_context.h"
+#include "../vulkan/core/memory/uploader/memory_uploader.h"
 #include "../vulkan/core/rendering/rendering_context.h"
 #include "../vulkan/core/shader/pipeline_repository.h"
 #include "./window/app_window.h"
 
 typedef struct App {
     char basepath[PATH_MAX_SIZE];
+    JobSystem job_system;
     AppWindow window;
     Context context;
     PipelineRepository pipeline_repository;
     CommandContext command_context;
     MemoryContext memory_context;
+    MemoryUploader memory_uploader;
+    MemoryDefragmenter memory_defragmenter;
     RenderingContext rendering_context;
     Renderer renderer;
     bool is_init;
@@ -26,11 +32,14 @@ typedef struct App {
 
 static inline void app_clear(App* app) {
     string_copy("", app->basepath, PATH_MAX_SIZE);
+    job_system_clear(&app->job_system);
     app_window_clear(&app->window);
     context_clear(&app->context);
     pipeline_repository_clear(&app->pipeline_repository);
     command_context_clear(&app->command_context);
     memory_context_clear(&app->memory_context);
+    memory_uploader_clear(&app->memory_uploader);
+    memory_defragmenter_clear(&app->memory_defragmenter);
     rendering_context_clear(&app->rendering_context);
     renderer_clear(&app->renderer);
     app->is_init = false;
@@ -14,6 +14,12 @@ static int app_builder_rendering_context_config_set_value(AppBuilder* builder, c
         return 1;
     }
 
+    if (string_equals(name, "recording_thread_count")) {
+        INI_PARSER_ASSERT_INT("rendering_context", name, value, false, 1);
+        builder->rendering_context_config.recording_thread_count = string_to_int(value, uint32_t);
+        return 1;
+    }
+
     if (string_equals(name, "clear_color")) {
         builder->rendering_context_config.clear_color = color_from_hex_string(value);
         return 1;
@@ -24,12 +30,94 @@ static int app_builder_rendering_context_config_set_value(AppBuilder* builder, c
         return 1;
     }
 
+    if (string_equals(name, "timeline_semaphore_enabled")) {
+        builder->rendering_context_config.timeline_semaphore_enabled = string_equals(value, "1");
+        return 1;
+    }
+
     if (string_equals(name, "render_timeout_ms")) {
         INI_PARSER_ASSERT_INT("rendering_context", name, value, false, 1);
         builder->rendering_context_config.render_timeout_ms = string_to_int(value, uint64_t);
         return 1;
     }
 
+    if (string_equals(name, "present_mode")) {
+        builder->rendering_context_config.present_mode = present_mode_from_string(value);
+        return 1;
+    }
+
+    if (string_equals(name, "just_in_time_wait_enabled")) {
+        builder->rendering_context_config.just_in_time_wait_enabled = string_equals(value, "1");
+        return 1;
+    }
+
+    if (string_equals(name, "just_in_time_margin_us")) {
+        INI_PARSER_ASSERT_INT("rendering_context", name, value, false, 1);
+        builder->rendering_context_config.just_in_time_margin_us = string_to_int(value, uint64_t);
+        return 1;
+    }
+
+    if (string_equals(name, "latency_log_interval_frames")) {
+        INI_PARSER_ASSERT_INT("rendering_context", name, value, false, 1);
+        builder->latency_log_interval = string_to_int(value, uint32_t);
+        return 1;
+    }
+
+    return 1;
+}
+
+static int app_builder_memory_uploader_config_set_value(AppBuilder* builder, const char* name, const char* value) {
+    if (string_equals(name, "staging_size_MB")) {
+        INI_PARSER_ASSERT_INT("memory_uploader", name, value, false, 1);
+        builder->upload_staging_size_MB = string_to_int(value, uint32_t);
+        return 1;
+    }
+
+    return 1;
+}
+
+static int app_builder_memory_defragmenter_config_set_value(
+    AppBuilder* builder, const char* name, const char* value) {
+    if (string_equals(name, "interval_frames")) {
+        INI_PARSER_ASSERT_INT("memory_defragmenter", name, value, false, 1);
+        builder->defragmentation_interval = string_to_int(value, uint32_t);
+        return 1;
+    }
+
+    if (string_equals(name, "max_bytes_per_step_MB")) {
+        INI_PARSER_ASSERT_INT("memory_defragmenter", name, value, false, 1);
+        builder->defragmenter_info.max_bytes_per_step = string_to_int(value, VkDeviceSize) * 1024 * 1024;
+        return 1;
+    }
+
+    if (string_equals(name, "max_moves_per_step")) {
+        INI_PARSER_ASSERT_INT("memory_defragmenter", name, value, false, 1);
+        builder->defragmenter_info.max_moves_per_step = string_to_int(value, uint32_t);
+        return 1;
+    }
+
+    if (string_equals(name, "max_bytes_MB")) {
+        INI_PARSER_ASSERT_INT("memory_defragmenter", name, value, false, 1);
+        builder->defragmentation_limits.max_bytes = string_to_int(value, VkDeviceSize) * 1024 * 1024;
+        return 1;
+    }
+
+    if (string_equals(name, "max_moves")) {
+        INI_PARSER_ASSERT_INT("memory_defragmenter", name, value, false, 1);
+        builder->defragmentation_limits.max_moves = string_to_int(value, uint32_t);
+        return 1;
+    }
+
+    return 1;
+}
+
+static int app_builder_jobs_config_set_value(AppBuilder* builder, const char* name, const char* value) {
+    if (string_equals(name, "worker_count")) {
+        INI_PARSER_ASSERT_INT("jobs", name, value, false, 1);
+        builder->job_system_config.worker_count = string_to_int(value, uint32_t);
+        return 1;
+    }
+
     return 1;
 }
 
@@ -52,6 +140,18 @@ static int app_builder_parser_handler(
         return memory_context_builder_set_config_value(&builder->memory_context_builder, name, value);
     }
 
+    if (string_equals(section, "memory_uploader")) {
+        return app_builder_memory_uploader_config_set_value(builder, name, value);
+    }
+
+    if (string_equals(section, "memory_defragmenter")) {
+        return app_builder_memory_defragmenter_config_set_value(builder, name, value);
+    }
+
+    if (string_equals(section, "jobs")) {
+        return app_builder_jobs_config_set_value(builder, name, value);
+    }
+
     context_builder_set_config_value(&builder->context_builder, section, name, value);
     return 1;
 }
@@ -61,6 +161,11 @@ bool app_builder_build(AppBuilder* builder, const char* config_file, App* app) {
 
     ini_parse(config_file, app_builder_parser_handler, builder);
 
+    if (!job_system_init(&app->job_system, &builder->job_system_config)) {
+        log_error("Unable to initialize the job system");
+        return false;
+    }
+
     app_window_builder_build(&builder->window_builder, &app->window);
     if (!app->window.is_init) {
         log_error("Unable to create the window");
@@ -83,7 +188,32 @@ bool app_builder_build(AppBuilder* builder, const char* config_file, App* app) {
         memory_context_builder_build(&builder->memory_context_builder, &app->memory_context);
     ASSERT_SUCCESS_LOG(memory_ctx_status, MemoryContextError, memory_context_error_to_string, false);
 
-    renderer_init(&app->renderer, &app->rendering_context);
+    // Has to run before static buffers are created, it decides which queue families share them
+    MemoryUploaderInfo uploader_info = {
+        .memory_context = &app->memory_context,
+        .command_context = &app->command_context,
+        .queue = app->rendering_context.swapchain.queue,
+        .staging_size = (VkDeviceSize)builder->upload_staging_size_MB * 1024 * 1024,
+    };
+    memory_ctx_status = memory_uploader_init(&app->memory_uploader, &uploader_info);
+    ASSERT_SUCCESS_LOG(memory_ctx_status, MemoryContextError, memory_context_error_to_string, false);
+
+    builder->defragmenter_info.memory_context = &app->memory_context;
+    builder->defragmenter_info.command_context = &app->command_context;
+    builder->defragmenter_info.queue = app->rendering_context.swapchain.queue;
+    memory_ctx_status = memory_defragmenter_init(&app->memory_defragmenter, &builder->defragmenter_info);
+    ASSERT_SUCCESS_LOG(memory_ctx_status, MemoryContextError, memory_context_error_to_string, false);
+
+    RendererInfo renderer_info = {
+        .context = &app->rendering_context,
+        .memory_context = &app->memory_context,
+        .memory_uploader = &app->memory_uploader,
+        .memory_defragmenter = &app->memory_defragmenter,
+        .defragmentation_interval = builder->defragmentation_interval,
+        .defragmentation_limits = builder->defragmentation_limits,
+        .latency_log_interval = builder->latency_log_interval,
+    };
+    renderer_init(&app->renderer, &renderer_info);
 
     return true;
 }
@@ -2,7 +2,9 @@
 #define APP_BUILDER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
+#include "../../core/jobs/job_system.h"
 #include "../../renderer/core/rendering_context_config.h"
 #include "../../vulkan/initializer/context_builder/context_builder.h"
 #include "../../vulkan/initializer/memory_context_builder/memory_context_builder.h"
@@ -14,6 +16,12 @@ typedef struct AppBuilder {
     ContextBuilder context_builder;
     MemoryContextBuilder memory_context_builder;
     RenderingContextConfig rendering_context_config;
+    JobSystemConfig job_system_config;
+    uint32_t upload_staging_size_MB;
+    MemoryDefragmenterInfo defragmenter_info;
+    uint32_t defragmentation_interval;
+    VulkanMemoryDefragmentationLimits defragmentation_limits;
+    uint32_t latency_log_interval;
 } AppBuilder;
 
 static inline void app_builder_clear(AppBuilder* builder) {
@@ -21,6 +29,18 @@ static inline void app_builder_clear(AppBuilder* builder) {
     context_builder_clear(&builder->context_builder);
     memory_context_builder_clear(&builder->memory_context_builder);
     builder->rendering_context_config = rendering_context_config_default();
+    builder->job_system_config = job_system_config_default();
+    builder->upload_staging_size_MB = 16;
+    builder->defragmenter_info = (MemoryDefragmenterInfo){
+        .max_bytes_per_step = 8 * 1024 * 1024,
+        .max_moves_per_step = 16,
+    };
+    builder->defragmentation_interval = 0;
+    builder->defragmentation_limits = (VulkanMemoryDefragmentationLimits){
+        .max_bytes = 64 * 1024 * 1024,
+        .max_moves = 256,
+    };
+    builder->latency_log_interval = 0;
 }
 
 bool app_builder_build(AppBuilder* builder, const char* config_file, App* app);
@@ -0,0 +1,222 @@
+#include "./hash_string_group_map.h"
+
+#include "../utils/macro.h"
+#include "./hash_string_group_match.h"
+
+#define HASH_STRING_GROUP_MAP_VALUES_ALIGNMENT 16
+
+static inline uint8_t hash_string_group_tag(uint32_t hash) { return (uint8_t)(hash >> 25); }
+
+static inline size_t hash_string_group_map_max_load(size_t capacity) { return capacity - (capacity >> 3); }
+
+static inline size_t hash_string_group_map_capacity_for(size_t size) {
+    size_t capacity = HASH_STRING_GROUP_SIZE;
+    while (hash_string_group_map_max_load(capacity) < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+static inline bool hash_string_group_map_key_equals(const char* stored_key, const char* key) {
+    size_t i;
+    for (i = 0; i < HASH_KEY_MAX_SIZE && stored_key[i] == key[i] && key[i] != '\0'; ++i)
+        ;
+    return i >= HASH_KEY_MAX_SIZE || stored_key[i] == key[i];
+}
+
+static inline void hash_string_group_map_key_copy(const char* key, char* stored_key) {
+    for (size_t i = 0; i < HASH_KEY_MAX_SIZE; ++i) {
+        stored_key[i] = key[i];
+        if (key[i] == '\0') {
+            break;
+        }
+    }
+}
+
+static inline void hash_string_group_map_set_slot(
+    HashStringGroupMapTable* table, size_t slot, uint32_t hash, const char* key) {
+    table->ctrl[slot] = hash_string_group_tag(hash);
+    table->hashes[slot] = hash;
+    hash_string_group_map_key_copy(key, table->keys[slot]);
+}
+
+// Groups are probed triangularly, which visits every group of a power of two table
+static size_t hash_string_group_map_find_free_slot(const HashStringGroupMapTable* table, uint32_t hash) {
+    const size_t group_mask = table->cap / HASH_STRING_GROUP_SIZE - 1;
+    size_t group = hash & group_mask;
+    for (size_t step = 1;; ++step) {
+        const size_t group_start = group * HASH_STRING_GROUP_SIZE;
+        HashStringGroupMask free_mask = hash_string_group_match_free(&table->ctrl[group_start]);
+        if (free_mask != 0) {
+            return group_start + hash_string_group_mask_first(free_mask);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+static bool hash_string_group_map_rehash(HashStringGroupMapTable* table, size_t value_size, size_t capacity) {
+    const size_t hashes_offset = capacity;
+    const size_t keys_offset = hashes_offset + capacity * sizeof(uint32_t);
+    const size_t values_offset =
+        ALIGN(keys_offset + capacity * HASH_KEY_MAX_SIZE, HASH_STRING_GROUP_MAP_VALUES_ALIGNMENT);
+    byte* data = mem_alloc(values_offset + capacity * value_size);
+    if (data == NULL) {
+        return false;
+    }
+
+    HashStringGroupMapTable new_table = {
+        .ctrl = data,
+        .hashes = (uint32_t*)(data + hashes_offset),
+        .keys = (char(*)[HASH_KEY_MAX_SIZE])(data + keys_offset),
+        .values = data + values_offset,
+        .cap = capacity,
+        .size = table->size,
+        .tombstones = 0,
+    };
+    mem_set(new_table.ctrl, HASH_STRING_GROUP_CTRL_EMPTY, capacity);
+
+    for (size_t i = 0; i < table->cap; ++i) {
+        if (table->ctrl[i] & HASH_STRING_GROUP_CTRL_EMPTY) {
+            continue;
+        }
+        const uint32_t hash = table->hashes[i];
+        const size_t slot = hash_string_group_map_find_free_slot(&new_table, hash);
+        hash_string_group_map_set_slot(&new_table, slot, hash, table->keys[i]);
+        mem_copy(table->values + i * value_size, new_table.values + slot * value_size, value_size);
+    }
+
+    mem_free(table->ctrl);
+    *table = new_table;
+
+    return true;
+}
+
+static ssize_t hash_string_group_map_find_slot(const HashStringGroupMapTable* table, const char* key, uint32_t hash) {
+    if (table->size == 0) {
+        return -1;
+    }
+
+    const uint8_t tag = hash_string_group_tag(hash);
+    const size_t group_count = table->cap / HASH_STRING_GROUP_SIZE;
+    const size_t group_mask = group_count - 1;
+    size_t group = hash & group_mask;
+    for (size_t step = 1; step <= group_count; ++step) {
+        const size_t group_start = group * HASH_STRING_GROUP_SIZE;
+        const uint8_t* ctrl = &table->ctrl[group_start];
+        for (HashStringGroupMask mask = hash_string_group_match(ctrl, tag); mask != 0;
+             mask = hash_string_group_mask_next(mask)) {
+            // The cached hash is only read when rehashing, a tag match goes straight to the key
+            const size_t slot = group_start + hash_string_group_mask_first(mask);
+            if (hash_string_group_map_key_equals(table->keys[slot], key)) {
+                return slot;
+            }
+        }
+        if (hash_string_group_match(ctrl, HASH_STRING_GROUP_CTRL_EMPTY) != 0) {
+            return -1;
+        }
+        group = (group + step) & group_mask;
+    }
+
+    return -1;
+}
+
+void hash_string_group_map_table_clear(HashStringGroupMapTable* table) {
+    table->ctrl = NULL;
+    table->hashes = NULL;
+    table->keys = NULL;
+    table->values = NULL;
+    table->cap = 0;
+    table->size = 0;
+    table->tombstones = 0;
+}
+
+bool hash_string_group_map_table_reserve(HashStringGroupMapTable* table, size_t value_size, size_t min_size) {
+    if (hash_string_group_map_max_load(table->cap) >= min_size) {
+        return true;
+    }
+    return hash_string_group_map_rehash(table, value_size, hash_string_group_map_capacity_for(min_size));
+}
+
+ssize_t hash_string_group_map_table_find(const HashStringGroupMapTable* table, const char* key) {
+    return hash_string_group_map_find_slot(table, key, hash_string(key));
+}
+
+void* hash_string_group_map_table_insert(
+    HashStringGroupMapTable* table, size_t value_size, const char* key, bool grow) {
+    const uint32_t hash = hash_string(key);
+    ssize_t found_slot = hash_string_group_map_find_slot(table, key, hash);
+    if (found_slot != -1) {
+        return table->values + found_slot * value_size;
+    }
+
+    if (table->size + table->tombstones + 1 > hash_string_group_map_max_load(table->cap)) {
+        size_t capacity = table->cap;
+        if (table->size + 1 > hash_string_group_map_max_load(capacity)) {
+            if (!grow) {
+                return NULL;
+            }
+            capacity = hash_string_group_map_capacity_for(table->size + 1);
+        } else if (grow && table->size + 1 > hash_string_group_map_max_load(capacity) / 2) {
+            capacity <<= 1;
+        }
+        if (!hash_string_group_map_rehash(table, value_size, capacity)) {
+            return NULL;
+        }
+    }
+
+    const size_t slot = hash_string_group_map_find_free_slot(table, hash);
+    if (table->ctrl[slot] == HASH_STRING_GROUP_CTRL_DELETED) {
+        --table->tombstones;
+    }
+    hash_string_group_map_set_slot(table, slot, hash, key);
+    ++table->size;
+
+    return table->values + slot * value_size;
+}
+
+bool hash_string_group_map_table_delete(HashStringGroupMapTable* table, const char* key) {
+    ssize_t slot = hash_string_group_map_table_find(table, key);
+    if (slot == -1) {
+        return false;
+    }
+
+    // Lookups already stop at a group with an empty slot, so no probe sequence runs through this one
+    const size_t group_start = slot & ~(size_t)(HASH_STRING_GROUP_SIZE - 1);
+    if (hash_string_group_match(&table->ctrl[group_start], HASH_STRING_GROUP_CTRL_EMPTY) != 0) {
+        table->ctrl[slot] = HASH_STRING_GROUP_CTRL_EMPTY;
+    } else {
+        table->ctrl[slot] = HASH_STRING_GROUP_CTRL_DELETED;
+        ++table->tombstones;
+    }
+    --table->size;
+
+    return true;
+}
+
+size_t hash_string_group_map_table_next(const HashStringGroupMapTable* table, size_t slot) {
+    while (slot < table->cap && (table->ctrl[slot] & HASH_STRING_GROUP_CTRL_EMPTY)) {
+        ++slot;
+    }
+    return slot;
+}
+
+size_t hash_string_group_map_table_skip(const HashStringGroupMapTable* table, size_t count) {
+    size_t slot = hash_string_group_map_table_next(table, 0);
+    for (size_t i = 0; i < count && slot < table->cap; ++i) {
+        slot = hash_string_group_map_table_next(table, slot + 1);
+    }
+    return slot;
+}
+
+void hash_string_group_map_table_clear_values(HashStringGroupMapTable* table) {
+    if (table->cap != 0) {
+        mem_set(table->ctrl, HASH_STRING_GROUP_CTRL_EMPTY, table->cap);
+    }
+    table->size = 0;
+    table->tombstones = 0;
+}
+
+void hash_string_group_map_table_destroy(HashStringGroupMapTable* table) {
+    mem_free(table->ctrl);
+    hash_string_group_map_table_clear(table);
+}
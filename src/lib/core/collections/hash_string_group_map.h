@@ -0,0 +1,146 @@
+#ifndef HASH_STRING_GROUP_MAP_H
+#define HASH_STRING_GROUP_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "../memory/memory.h"
+#include "./hash_string_map.h"
+
+#define HASH_STRING_GROUP_SIZE 16
+
+// Control bytes with the high bit set are free, live slots store 7 bits of the key hash as a tag
+#define HASH_STRING_GROUP_CTRL_EMPTY ((uint8_t)0x80)
+#define HASH_STRING_GROUP_CTRL_DELETED ((uint8_t)0xFE)
+
+// Same layout as HashStringMapTable plus one control byte per slot, a whole group of control bytes is matched at once
+typedef struct HashStringGroupMapTable {
+    uint8_t* ctrl;
+    uint32_t* hashes;
+    char (*keys)[HASH_KEY_MAX_SIZE];
+    byte* values;
+    // Power of two, multiple of HASH_STRING_GROUP_SIZE
+    size_t cap;
+    size_t size;
+    size_t tombstones;
+} HashStringGroupMapTable;
+
+#define HASH_STRING_GROUP_MAP(type)                                                                                    \
+    {                                                                                                                  \
+        HashStringGroupMapTable table;                                                                                 \
+        type _value_type[0];                                                                                           \
+    }
+
+void hash_string_group_map_table_clear(HashStringGroupMapTable* table);
+bool hash_string_group_map_table_reserve(HashStringGroupMapTable* table, size_t value_size, size_t min_size);
+ssize_t hash_string_group_map_table_find(const HashStringGroupMapTable* table, const char* key);
+void* hash_string_group_map_table_insert(
+    HashStringGroupMapTable* table, size_t value_size, const char* key, bool grow);
+bool hash_string_group_map_table_delete(HashStringGroupMapTable* table, const char* key);
+size_t hash_string_group_map_table_skip(const HashStringGroupMapTable* table, size_t count);
+size_t hash_string_group_map_table_next(const HashStringGroupMapTable* table, size_t slot);
+void hash_string_group_map_table_clear_values(HashStringGroupMapTable* table);
+void hash_string_group_map_table_destroy(HashStringGroupMapTable* table);
+
+#define hash_string_group_map_value_size_(phm) sizeof(*(phm)->_value_type)
+
+#define hash_string_group_map_value_at_(phm, slot)                                                                     \
+    (((__typeof__(&(phm)->_value_type[0]))(phm)->table.values)[slot])
+
+#define hash_string_group_map_init(phm) hash_string_group_map_table_clear(&(phm)->table)
+
+#define hash_string_group_map_destroy(phm) hash_string_group_map_table_destroy(&(phm)->table)
+
+#define hash_string_group_map_clear(phm) (hash_string_group_map_destroy(phm), hash_string_group_map_init(phm))
+
+#define hash_string_group_map_get_capacity(phm) ((phm)->table.cap)
+
+#define hash_string_group_map_get_size(phm) ((phm)->table.size)
+
+#define hash_string_group_map_clear_values(phm) hash_string_group_map_table_clear_values(&(phm)->table)
+
+#define hash_string_group_map_reserve(phm, min_size)                                                                   \
+    hash_string_group_map_table_reserve(&(phm)->table, hash_string_group_map_value_size_(phm), min_size)
+
+#define hash_string_group_map_add_internal_(phm, map_key, elem, grow)                                                  \
+    ({                                                                                                                 \
+        __typeof__(&(phm)->_value_type[0]) _add_value_ref = hash_string_group_map_table_insert(                        \
+            &(phm)->table, hash_string_group_map_value_size_(phm), map_key, grow);                                     \
+        if (_add_value_ref != NULL) {                                                                                  \
+            *_add_value_ref = (elem);                                                                                  \
+        }                                                                                                              \
+        _add_value_ref != NULL;                                                                                        \
+    })
+
+#define hash_string_group_map_add(phm, map_key, elem) hash_string_group_map_add_internal_(phm, map_key, elem, true)
+
+#define hash_string_group_map_add_nogrow(phm, map_key, elem)                                                           \
+    hash_string_group_map_add_internal_(phm, map_key, elem, false)
+
+#define hash_string_group_map_has(phm, map_key) (hash_string_group_map_table_find(&(phm)->table, map_key) != -1)
+
+#define hash_string_group_map_get(phm, map_key, pval)                                                                  \
+    ({                                                                                                                 \
+        ssize_t _read_slot = hash_string_group_map_table_find(&(phm)->table, map_key);                                 \
+        if (_read_slot != -1) {                                                                                        \
+            *(pval) = hash_string_group_map_value_at_(phm, _read_slot);                                                \
+        }                                                                                                              \
+        _read_slot != -1;                                                                                              \
+    })
+
+#define hash_string_group_map_get_reference(phm, map_key)                                                              \
+    ({                                                                                                                 \
+        ssize_t _read_slot = hash_string_group_map_table_find(&(phm)->table, map_key);                                 \
+        _read_slot != -1 ? &hash_string_group_map_value_at_(phm, _read_slot) : NULL;                                   \
+    })
+
+#define hash_string_group_map_delete(phm, map_key) hash_string_group_map_table_delete(&(phm)->table, map_key)
+
+#define hash_string_group_map_keys_range(phm, key_buff, start_idx, buff_size)                                          \
+    ({                                                                                                                 \
+        size_t _keys_processed = 0;                                                                                    \
+        for (size_t _key_slot = hash_string_group_map_table_skip(&(phm)->table, start_idx);                            \
+             _key_slot < hash_string_group_map_get_capacity(phm) && _keys_processed < (buff_size);                     \
+             _key_slot = hash_string_group_map_table_next(&(phm)->table, _key_slot + 1)) {                            \
+            mem_copy((phm)->table.keys[_key_slot], (key_buff)[_keys_processed], HASH_KEY_MAX_SIZE);                    \
+            ++_keys_processed;                                                                                         \
+        }                                                                                                              \
+        _keys_processed;                                                                                               \
+    })
+
+#define hash_string_group_map_keys(phm, pkeys)                                                                         \
+    hash_string_group_map_keys_range(phm, pkeys, 0, hash_string_group_map_get_size(phm))
+
+#define hash_string_group_map_values_range(phm, val_buff, start_idx, buff_size)                                        \
+    ({                                                                                                                 \
+        size_t _vals_processed = 0;                                                                                    \
+        for (size_t _val_slot = hash_string_group_map_table_skip(&(phm)->table, start_idx);                            \
+             _val_slot < hash_string_group_map_get_capacity(phm) && _vals_processed < (buff_size);                     \
+             _val_slot = hash_string_group_map_table_next(&(phm)->table, _val_slot + 1)) {                             \
+            (val_buff)[_vals_processed] = hash_string_group_map_value_at_(phm, _val_slot);                             \
+            ++_vals_processed;                                                                                         \
+        }                                                                                                              \
+        _vals_processed;                                                                                               \
+    })
+
+#define hash_string_group_map_values(phm, pvals)                                                                       \
+    hash_string_group_map_values_range(phm, pvals, 0, hash_string_group_map_get_size(phm))
+
+#define hash_string_group_map_values_reference_range(phm, pval_buff, start_idx, buff_size)                             \
+    ({                                                                                                                 \
+        size_t _pvals_processed = 0;                                                                                   \
+        for (size_t _pval_slot = hash_string_group_map_table_skip(&(phm)->table, start_idx);                           \
+             _pval_slot < hash_string_group_map_get_capacity(phm) && _pvals_processed < (buff_size);                   \
+             _pval_slot = hash_string_group_map_table_next(&(phm)->table, _pval_slot + 1)) {                           \
+            (pval_buff)[_pvals_processed] = &hash_string_group_map_value_at_(phm, _pval_slot);                         \
+            ++_pvals_processed;                                                                                        \
+        }                                                                                                              \
+        _pvals_processed;                                                                                              \
+    })
+
+#define hash_string_group_map_values_reference(phm, pvals)                                                             \
+    hash_string_group_map_values_reference_range(phm, pvals, 0, hash_string_group_map_get_size(phm))
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef HASH_STRING_GROUP_MATCH_H
+#define HASH_STRING_GROUP_MATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./hash_string_group_map.h"
+
+// Defining HASH_STRING_GROUP_MAP_SCALAR picks the scalar matches on every target
+#if defined(__SSE2__) && !defined(HASH_STRING_GROUP_MAP_SCALAR)
+#define HASH_STRING_GROUP_MATCH_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && !defined(HASH_STRING_GROUP_MAP_SCALAR)
+#define HASH_STRING_GROUP_MATCH_NEON
+#include <arm_neon.h>
+#endif
+
+// Group matches return a bit mask with HASH_STRING_GROUP_MASK_STRIDE bits per slot, only the highest one may be set
+#if defined(HASH_STRING_GROUP_MATCH_NEON)
+#define HASH_STRING_GROUP_MASK_STRIDE 4
+#else
+#define HASH_STRING_GROUP_MASK_STRIDE 1
+#endif
+
+typedef uint64_t HashStringGroupMask;
+
+// The scalar matches are always built, they are the reference the vector matches are tested against
+static inline HashStringGroupMask hash_string_group_match_scalar(const uint8_t* ctrl, uint8_t value) {
+    HashStringGroupMask mask = 0;
+    for (size_t i = 0; i < HASH_STRING_GROUP_SIZE; ++i) {
+        mask |= (HashStringGroupMask)(ctrl[i] == value) << i;
+    }
+    return mask;
+}
+
+static inline HashStringGroupMask hash_string_group_match_free_scalar(const uint8_t* ctrl) {
+    HashStringGroupMask mask = 0;
+    for (size_t i = 0; i < HASH_STRING_GROUP_SIZE; ++i) {
+        mask |= (HashStringGroupMask)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+}
+
+#if defined(HASH_STRING_GROUP_MATCH_SSE2)
+
+static inline __m128i hash_string_group_load(const uint8_t* ctrl) { return _mm_loadu_si128((const __m128i*)ctrl); }
+
+static inline HashStringGroupMask hash_string_group_match(const uint8_t* ctrl, uint8_t value) {
+    __m128i matches = _mm_cmpeq_epi8(hash_string_group_load(ctrl), _mm_set1_epi8((char)value));
+    return (uint16_t)_mm_movemask_epi8(matches);
+}
+
+static inline HashStringGroupMask hash_string_group_match_free(const uint8_t* ctrl) {
+    return (uint16_t)_mm_movemask_epi8(hash_string_group_load(ctrl));
+}
+
+#elif defined(HASH_STRING_GROUP_MATCH_NEON)
+
+// Narrows every byte of the comparison result to 4 bits, NEON has no movemask
+static inline HashStringGroupMask hash_string_group_to_mask(uint8x16_t matches) {
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(matches), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ull;
+}
+
+static inline HashStringGroupMask hash_string_group_match(const uint8_t* ctrl, uint8_t value) {
+    return hash_string_group_to_mask(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(value)));
+}
+
+static inline HashStringGroupMask hash_string_group_match_free(const uint8_t* ctrl) {
+    return hash_string_group_to_mask(vcltzq_s8(vreinterpretq_s8_u8(vld1q_u8(ctrl))));
+}
+
+#else
+
+static inline HashStringGroupMask hash_string_group_match(const uint8_t* ctrl, uint8_t value) {
+    return hash_string_group_match_scalar(ctrl, value);
+}
+
+static inline HashStringGroupMask hash_string_group_match_free(const uint8_t* ctrl) {
+    return hash_string_group_match_free_scalar(ctrl);
+}
+
+#endif
+
+static inline size_t hash_string_group_mask_first(HashStringGroupMask mask) {
+    return __builtin_ctzll(mask) / HASH_STRING_GROUP_MASK_STRIDE;
+}
+
+static inline HashStringGroupMask hash_string_group_mask_next(HashStringGroupMask mask) { return mask & (mask - 1); }
+
+#endif
@@ -0,0 +1,281 @@
+#include "./hash_string_map.h"
+
+#include "../utils/macro.h"
+
+#define HASH_STRING_MAP_VALUES_ALIGNMENT 16
+
+static inline size_t hash_string_map_max_load(size_t capacity) { return capacity - (capacity >> 2); }
+
+static inline size_t hash_string_map_capacity_for(size_t size) {
+    size_t capacity = HASH_STRING_MAP_MIN_CAPACITY;
+    while (hash_string_map_max_load(capacity) < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+static inline bool hash_string_map_key_equals(const char* stored_key, const char* key) {
+    size_t i;
+    for (i = 0; i < HASH_KEY_MAX_SIZE && stored_key[i] == key[i] && key[i] != '\0'; ++i)
+        ;
+    return i >= HASH_KEY_MAX_SIZE || stored_key[i] == key[i];
+}
+
+static inline void hash_string_map_key_set(char* stored_key, const char* key) {
+    for (size_t i = 0; i < HASH_KEY_MAX_SIZE; ++i) {
+        stored_key[i] = key[i];
+        if (key[i] == '\0') {
+            break;
+        }
+    }
+}
+
+static inline void hash_string_map_slots_clear(HashStringMapSlots* slots) {
+    slots->hashes = NULL;
+    slots->keys = NULL;
+    slots->values = NULL;
+    slots->cap = 0;
+}
+
+static bool hash_string_map_slots_init(HashStringMapSlots* slots, size_t value_size, size_t capacity) {
+    const size_t hashes_bytes = capacity * sizeof(uint32_t);
+    const size_t keys_bytes = capacity * HASH_KEY_MAX_SIZE;
+    const size_t values_offset = ALIGN(hashes_bytes + keys_bytes, HASH_STRING_MAP_VALUES_ALIGNMENT);
+    byte* data = mem_alloc(values_offset + capacity * value_size);
+    if (data == NULL) {
+        return false;
+    }
+
+    slots->hashes = (uint32_t*)data;
+    slots->keys = (char(*)[HASH_KEY_MAX_SIZE])(data + hashes_bytes);
+    slots->values = data + values_offset;
+    slots->cap = capacity;
+    mem_set(slots->hashes, HASH_STRING_MAP_SLOT_EMPTY, hashes_bytes);
+
+    return true;
+}
+
+static void hash_string_map_slots_destroy(HashStringMapSlots* slots) {
+    mem_free(slots->hashes);
+    hash_string_map_slots_clear(slots);
+}
+
+// Triangular probing visits every slot of a power of two table
+static size_t hash_string_map_slots_find_free(const HashStringMapSlots* slots, uint32_t hash) {
+    const size_t mask = slots->cap - 1;
+    size_t slot = hash & mask;
+    for (size_t step = 1; slots->hashes[slot] >= HASH_STRING_MAP_SLOT_LIVE; ++step) {
+        slot = (slot + step) & mask;
+    }
+    return slot;
+}
+
+static ssize_t hash_string_map_slots_find(const HashStringMapSlots* slots, const char* key, uint32_t hash) {
+    const size_t mask = slots->cap - 1;
+    size_t slot = hash & mask;
+    for (size_t step = 1; step <= slots->cap; ++step) {
+        const uint32_t stored_hash = slots->hashes[slot];
+        if (stored_hash == HASH_STRING_MAP_SLOT_EMPTY) {
+            return -1;
+        }
+        if (stored_hash == hash && hash_string_map_key_equals(slots->keys[slot], key)) {
+            return slot;
+        }
+        slot = (slot + step) & mask;
+    }
+    return -1;
+}
+
+// Entries move with their cached hashes, the new slots never hold the same key so no key is compared. Deletes
+// during the migration leave tombstones in the new slots, a moved entry may reuse one
+static void hash_string_map_migrate_slot(HashStringMapTable* table, size_t old_slot, size_t value_size) {
+    HashStringMapSlots* dst = &table->slots;
+    HashStringMapSlots* src = &table->old_slots;
+    const uint32_t hash = src->hashes[old_slot];
+    const size_t slot = hash_string_map_slots_find_free(dst, hash);
+    if (dst->hashes[slot] == HASH_STRING_MAP_SLOT_DELETED) {
+        --table->tombstones;
+    }
+    dst->hashes[slot] = hash;
+    hash_string_map_key_set(dst->keys[slot], src->keys[old_slot]);
+    mem_copy(src->values + old_slot * value_size, dst->values + slot * value_size, value_size);
+    src->hashes[old_slot] = HASH_STRING_MAP_SLOT_DELETED;
+}
+
+static void hash_string_map_release_old_slots(HashStringMapTable* table) {
+    hash_string_map_slots_destroy(&table->old_slots);
+    table->old_size = 0;
+    table->migrate_index = 0;
+}
+
+static void hash_string_map_migrate(HashStringMapTable* table, size_t value_size, size_t slot_count) {
+    HashStringMapSlots* old_slots = &table->old_slots;
+    for (; slot_count > 0 && table->old_size > 0 && table->migrate_index < old_slots->cap; --slot_count) {
+        const size_t slot = table->migrate_index++;
+        if (old_slots->hashes[slot] >= HASH_STRING_MAP_SLOT_LIVE) {
+            hash_string_map_migrate_slot(table, slot, value_size);
+            --table->old_size;
+        }
+    }
+    if (old_slots->cap != 0 && table->old_size == 0) {
+        hash_string_map_release_old_slots(table);
+    }
+}
+
+// The current slots become the old ones and their entries move over a step at a time, or all at once when
+// incremental is false. An earlier migration is finished first so there are never more than two tables
+static bool hash_string_map_grow(HashStringMapTable* table, size_t value_size, size_t capacity, bool incremental) {
+    hash_string_map_migrate(table, value_size, SIZE_MAX);
+
+    HashStringMapSlots slots;
+    if (!hash_string_map_slots_init(&slots, value_size, capacity)) {
+        return false;
+    }
+
+    if (table->size == 0) {
+        hash_string_map_slots_destroy(&table->slots);
+    } else {
+        table->old_slots = table->slots;
+        table->old_size = table->size;
+        table->migrate_index = 0;
+    }
+    table->slots = slots;
+    table->tombstones = 0;
+
+    if (!incremental) {
+        hash_string_map_migrate(table, value_size, SIZE_MAX);
+    }
+
+    return true;
+}
+
+static ssize_t hash_string_map_find_slot(const HashStringMapTable* table, const char* key, uint32_t hash) {
+    if (table->size == 0) {
+        return -1;
+    }
+
+    ssize_t slot = hash_string_map_slots_find(&table->slots, key, hash);
+    if (slot == -1 && table->old_size != 0) {
+        slot = hash_string_map_slots_find(&table->old_slots, key, hash);
+        if (slot != -1) {
+            slot += table->slots.cap;
+        }
+    }
+    return slot;
+}
+
+void hash_string_map_table_clear(HashStringMapTable* table) {
+    hash_string_map_slots_clear(&table->slots);
+    hash_string_map_slots_clear(&table->old_slots);
+    table->size = 0;
+    table->old_size = 0;
+    table->tombstones = 0;
+    table->migrate_index = 0;
+}
+
+bool hash_string_map_table_reserve(HashStringMapTable* table, size_t value_size, size_t min_size) {
+    if (hash_string_map_max_load(table->slots.cap) >= min_size) {
+        return true;
+    }
+    return hash_string_map_grow(table, value_size, hash_string_map_capacity_for(min_size), false);
+}
+
+ssize_t hash_string_map_table_find(const HashStringMapTable* table, const char* key) {
+    return hash_string_map_find_slot(table, key, hash_string_map_hash_key_(key));
+}
+
+void* hash_string_map_table_insert(HashStringMapTable* table, size_t value_size, const char* key, bool grow) {
+    if (table->old_size != 0) {
+        hash_string_map_migrate(table, value_size, HASH_STRING_MAP_MIGRATE_STEP);
+    }
+
+    const uint32_t hash = hash_string_map_hash_key_(key);
+    ssize_t found_slot = hash_string_map_find_slot(table, key, hash);
+    if (found_slot != -1) {
+        return hash_string_map_table_value(table, value_size, found_slot);
+    }
+
+    // Tombstones count towards the load so that misses keep ending at an empty slot. A new table of the same
+    // capacity drops them, unless the live entries alone would soon fill it again. Entries still in the old table
+    // count as well since they all end up in the current one
+    const size_t max_load = hash_string_map_max_load(table->slots.cap);
+    if (table->size + table->tombstones + 1 > max_load) {
+        size_t capacity = table->slots.cap;
+        if (table->size + 1 > max_load) {
+            if (!grow) {
+                return NULL;
+            }
+            capacity = hash_string_map_capacity_for(table->size + 1);
+        } else if (grow && table->size + 1 > max_load / 2) {
+            capacity <<= 1;
+        }
+        if (!hash_string_map_grow(table, value_size, capacity, true)) {
+            return NULL;
+        }
+    }
+
+    HashStringMapSlots* slots = &table->slots;
+    const size_t slot = hash_string_map_slots_find_free(slots, hash);
+    if (slots->hashes[slot] == HASH_STRING_MAP_SLOT_DELETED) {
+        --table->tombstones;
+    }
+    slots->hashes[slot] = hash;
+    hash_string_map_key_set(slots->keys[slot], key);
+    ++table->size;
+
+    return slots->values + slot * value_size;
+}
+
+bool hash_string_map_table_delete(HashStringMapTable* table, const char* key) {
+    ssize_t slot = hash_string_map_table_find(table, key);
+    if (slot == -1) {
+        return false;
+    }
+
+    --table->size;
+    if ((size_t)slot < table->slots.cap) {
+        table->slots.hashes[slot] = HASH_STRING_MAP_SLOT_DELETED;
+        ++table->tombstones;
+        return true;
+    }
+
+    // Deleting does not know the value size so it cannot migrate, the old table only goes away once it is empty
+    table->old_slots.hashes[slot - table->slots.cap] = HASH_STRING_MAP_SLOT_DELETED;
+    if (--table->old_size == 0) {
+        hash_string_map_release_old_slots(table);
+    }
+
+    return true;
+}
+
+size_t hash_string_map_table_next(const HashStringMapTable* table, size_t slot) {
+    const size_t slot_count = hash_string_map_table_slot_count(table);
+    while (slot < slot_count && !hash_string_map_slot_is_live_(table, slot)) {
+        ++slot;
+    }
+    return slot;
+}
+
+size_t hash_string_map_table_skip(const HashStringMapTable* table, size_t count) {
+    const size_t slot_count = hash_string_map_table_slot_count(table);
+    size_t slot = hash_string_map_table_next(table, 0);
+    for (size_t i = 0; i < count && slot < slot_count; ++i) {
+        slot = hash_string_map_table_next(table, slot + 1);
+    }
+    return slot;
+}
+
+void hash_string_map_table_clear_values(HashStringMapTable* table) {
+    hash_string_map_release_old_slots(table);
+    if (table->slots.cap != 0) {
+        mem_set(table->slots.hashes, HASH_STRING_MAP_SLOT_EMPTY, table->slots.cap * sizeof(uint32_t));
+    }
+    table->size = 0;
+    table->tombstones = 0;
+}
+
+void hash_string_map_table_destroy(HashStringMapTable* table) {
+    hash_string_map_slots_destroy(&table->slots);
+    hash_string_map_slots_destroy(&table->old_slots);
+    hash_string_map_table_clear(table);
+}
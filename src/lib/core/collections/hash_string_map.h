@@ -3,268 +3,171 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
 
 #include "../memory/memory.h"
-#include "./vector.h"
 
 #define HASH_KEY_MAX_SIZE 64
-#define HASH_KEY_AVAILABLE "_AVAIL"
+
+#define HASH_STRING_MAP_MIN_CAPACITY 16
+
+// Control values below HASH_STRING_MAP_SLOT_LIVE mark free slots, live slots store the cached key hash
+#define HASH_STRING_MAP_SLOT_EMPTY 0
+#define HASH_STRING_MAP_SLOT_DELETED 1
+#define HASH_STRING_MAP_SLOT_LIVE 2
+
+// Old slots moved by each insert while the map migrates to a grown table
+#define HASH_STRING_MAP_MIGRATE_STEP 8
+
+// Hashes, keys and values live in separate arrays of a single allocation
+typedef struct HashStringMapSlots {
+    uint32_t* hashes;
+    char (*keys)[HASH_KEY_MAX_SIZE];
+    byte* values;
+    // Power of two
+    size_t cap;
+} HashStringMapSlots;
+
+// Type independent part of the map. While old_slots is allocated an entry lives in either of the two tables, slot
+// indices past slots.cap refer to old_slots
+typedef struct HashStringMapTable {
+    HashStringMapSlots slots;
+    HashStringMapSlots old_slots;
+    size_t size;
+    size_t old_size;
+    size_t tombstones;
+    size_t migrate_index;
+} HashStringMapTable;
 
 #define HASH_STRING_MAP(type)                                                                                          \
     {                                                                                                                  \
-        struct VECTOR(struct {                                                                                         \
-            char key[HASH_KEY_MAX_SIZE];                                                                               \
-            type value;                                                                                                \
-        }) nodes;                                                                                                      \
-        size_t cap;                                                                                                    \
-        size_t size;                                                                                                   \
-        struct VECTOR(struct {                                                                                         \
-            char key[HASH_KEY_MAX_SIZE];                                                                               \
-            type value;                                                                                                \
-        }) _old_nodes;                                                                                                 \
+        HashStringMapTable table;                                                                                      \
+        type _value_type[0];                                                                                           \
     }
 
-// djb2
-static inline unsigned long hash_string_1(const char* key) {
-    unsigned long hash = 5381;
-
-    int c;
-    size_t i = 0;
-    while ((c = *key++) && (i < HASH_KEY_MAX_SIZE)) {
-        hash = ((hash << 5) + hash) + c;
+// FNV-1a over at most HASH_KEY_MAX_SIZE characters
+static inline uint32_t hash_string(const char* key) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < HASH_KEY_MAX_SIZE && key[i] != '\0'; ++i) {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
     }
-
     return hash;
 }
 
-// sdbm
-static inline unsigned long hash_string_2(const char* key) {
-    unsigned long hash = 0;
-
-    int c;
-    size_t i = 0;
-    while ((c = *key++) && (i < HASH_KEY_MAX_SIZE)) {
-        hash = c + (hash << 6) + (hash << 16) - hash;
-    }
-
-    return hash;
+static inline uint32_t hash_string_map_hash_key_(const char* key) {
+    uint32_t hash = hash_string(key);
+    return hash < HASH_STRING_MAP_SLOT_LIVE ? hash + HASH_STRING_MAP_SLOT_LIVE : hash;
 }
 
-static inline void hash_string_key_clear_(char* key) { mem_set(key, '\0', HASH_KEY_MAX_SIZE); }
-
-static inline void hash_string_key_set_(char* key, const char* key_value) {
-    hash_string_key_clear_(key);
+static inline size_t hash_string_map_table_slot_count(const HashStringMapTable* table) {
+    return table->slots.cap + table->old_slots.cap;
+}
 
-    for (size_t i = 0; i < HASH_KEY_MAX_SIZE; ++i) {
-        key[i] = key_value[i];
-        if (key_value[i] == '\0') {
-            break;
-        }
+static inline const HashStringMapSlots* hash_string_map_table_slots_of_(
+    const HashStringMapTable* table, size_t* slot) {
+    if (*slot < table->slots.cap) {
+        return &table->slots;
     }
+    *slot -= table->slots.cap;
+    return &table->old_slots;
 }
 
-static inline bool hash_string_key_equal_(const char* key1, const char* key2) {
-    size_t i;
-    for (i = 0; i < HASH_KEY_MAX_SIZE && key1[i] == key2[i] && key1[i] != '\0' && key2[i] != '\0'; ++i)
-        ;
-    return i >= HASH_KEY_MAX_SIZE || key1[i] == key2[i];
+static inline bool hash_string_map_slot_is_live_(const HashStringMapTable* table, size_t slot) {
+    const HashStringMapSlots* slots = hash_string_map_table_slots_of_(table, &slot);
+    return slots->hashes[slot] >= HASH_STRING_MAP_SLOT_LIVE;
 }
 
-static inline bool hash_string_key_is_empty_(const char key[HASH_KEY_MAX_SIZE]) {
-    return hash_string_key_equal_(key, "");
+static inline const char* hash_string_map_table_key(const HashStringMapTable* table, size_t slot) {
+    const HashStringMapSlots* slots = hash_string_map_table_slots_of_(table, &slot);
+    return slots->keys[slot];
 }
 
-static inline bool hash_string_key_is_avail_(const char key[HASH_KEY_MAX_SIZE]) {
-    return hash_string_key_equal_(key, HASH_KEY_AVAILABLE);
+static inline void* hash_string_map_table_value(const HashStringMapTable* table, size_t value_size, size_t slot) {
+    const HashStringMapSlots* slots = hash_string_map_table_slots_of_(table, &slot);
+    return slots->values + slot * value_size;
 }
 
-static inline size_t hash_string_map_enforce_size_t_(size_t value) { return value; }
+void hash_string_map_table_clear(HashStringMapTable* table);
+bool hash_string_map_table_reserve(HashStringMapTable* table, size_t value_size, size_t min_size);
+// Returns the slot of the key or -1
+ssize_t hash_string_map_table_find(const HashStringMapTable* table, const char* key);
+// Returns the value slot of the key, inserting the key when it is missing, or NULL when the table could not grow.
+// Growing is incremental, value pointers stay valid only until the next insert or delete
+void* hash_string_map_table_insert(HashStringMapTable* table, size_t value_size, const char* key, bool grow);
+bool hash_string_map_table_delete(HashStringMapTable* table, const char* key);
+// Skips the given number of live slots and returns the slot after them, or the slot count when there are none
+size_t hash_string_map_table_skip(const HashStringMapTable* table, size_t count);
+size_t hash_string_map_table_next(const HashStringMapTable* table, size_t slot);
+void hash_string_map_table_clear_values(HashStringMapTable* table);
+void hash_string_map_table_destroy(HashStringMapTable* table);
 
-#define hash_string_map_init(phm)                                                                                      \
-    (void)({                                                                                                           \
-        vector_init(&(phm)->nodes);                                                                                    \
-        vector_init(&(phm)->_old_nodes);                                                                               \
-        (phm)->cap = 0;                                                                                                \
-        (phm)->size = 0;                                                                                               \
-    })
+#define hash_string_map_value_size_(phm) sizeof(*(phm)->_value_type)
 
-#define hash_string_map_destroy(phm) vector_destroy(&(phm)->nodes)
+#define hash_string_map_value_at_(phm, slot)                                                                           \
+    (*(__typeof__(&(phm)->_value_type[0]))hash_string_map_table_value(                                                 \
+        &(phm)->table, hash_string_map_value_size_(phm), slot))
 
-#define hash_string_map_clear(phm) vector_clear(&(phm)->nodes)
+#define hash_string_map_init(phm) hash_string_map_table_clear(&(phm)->table)
 
-#define hash_string_map_get_capacity(phm) ((phm)->cap)
+#define hash_string_map_destroy(phm) hash_string_map_table_destroy(&(phm)->table)
 
-#define hash_string_map_get_size(phm) ((phm)->size)
+#define hash_string_map_clear(phm) (hash_string_map_destroy(phm), hash_string_map_init(phm))
 
-#define hash_string_map_clear_values(phm)                                                                              \
-    (void)({                                                                                                           \
-        (phm)->size = 0;                                                                                               \
-        for (size_t _idx = 0; _idx < hash_string_map_get_capacity(phm); ++_idx) {                                      \
-            hash_string_key_clear_((phm)->nodes.data[_idx].key);                                                       \
-        }                                                                                                              \
-    })
+#define hash_string_map_get_capacity(phm) ((phm)->table.slots.cap)
 
-static inline size_t hash_string_map_growsize_(size_t value) {
-    // integer multiplication by 2
-    return value << 1;
-}
-
-static inline bool hash_string_map_cap_above_threshold_(size_t size, size_t capacity) {
-    return (3 * size) > (capacity << 1);
-}
+#define hash_string_map_get_size(phm) ((phm)->table.size)
 
-#define hash_string_map_set_item_idx_(phm, idx, map_key, map_value)                                                    \
-    (void)({                                                                                                           \
-        hash_string_key_set_((phm)->nodes.data[idx].key, map_key);                                                     \
-        (phm)->nodes.data[idx].value = map_value;                                                                      \
-    })
-
-#define hash_string_map_copy_to_old_data_(phm)                                                                         \
-    ({                                                                                                                 \
-        vector_init(&(phm)->_old_nodes);                                                                               \
-        bool _old_data_status = vector_reserve(&(phm)->_old_nodes, (phm)->nodes.cap);                                  \
-        for (size_t _i = 0; _i < (phm)->nodes.cap && _old_data_status; ++_i) {                                         \
-            hash_string_key_set_((phm)->_old_nodes.data[_i].key, (phm)->nodes.data[_i].key);                           \
-            (phm)->_old_nodes.data[_i].value = (phm)->nodes.data[_i].value;                                            \
-        }                                                                                                              \
-        _old_data_status;                                                                                              \
-    })
+#define hash_string_map_clear_values(phm) hash_string_map_table_clear_values(&(phm)->table)
 
-#define hash_string_map_find_internal_(phm, map_key, pidx)                                                             \
-    ({                                                                                                                 \
-        size_t _n = hash_string_map_get_capacity(phm);                                                                 \
-        size_t _find_idx = hash_string_1((map_key)) % _n;                                                              \
-        size_t _hash_counter = 1;                                                                                      \
-        ssize_t _find_element_idx = -1;                                                                                \
-        bool _node_found = false;                                                                                      \
-        while (true) {                                                                                                 \
-            if (hash_string_key_is_empty_((phm)->nodes.data[_find_idx].key)) {                                         \
-                if (_find_element_idx == -1) {                                                                         \
-                    _find_element_idx = _find_idx;                                                                     \
-                }                                                                                                      \
-                _node_found = false;                                                                                   \
-                break;                                                                                                 \
-            }                                                                                                          \
-            if (hash_string_key_is_avail_((phm)->nodes.data[_find_idx].key)) {                                         \
-                if (_find_element_idx == -1) {                                                                         \
-                    _find_element_idx = _find_idx;                                                                     \
-                }                                                                                                      \
-            } else {                                                                                                   \
-                if (hash_string_key_equal_((phm)->nodes.data[_find_idx].key, map_key)) {                               \
-                    _find_element_idx = _find_idx;                                                                     \
-                    _node_found = true;                                                                                \
-                    break;                                                                                             \
-                }                                                                                                      \
-            }                                                                                                          \
-            _find_idx = (_find_idx + _hash_counter * hash_string_2(map_key)) % _n;                                     \
-            ++_hash_counter;                                                                                           \
-        }                                                                                                              \
-        *(pidx) = _find_element_idx;                                                                                   \
-        _node_found;                                                                                                   \
-    })
+// Makes room for min_size entries, unlike growth on add it migrates every entry right away
+#define hash_string_map_reserve(phm, min_size)                                                                         \
+    hash_string_map_table_reserve(&(phm)->table, hash_string_map_value_size_(phm), min_size)
 
-#define hash_string_map_add_nogrow(phm, map_key, map_val)                                                              \
+#define hash_string_map_add_internal_(phm, map_key, elem, grow)                                                        \
     ({                                                                                                                 \
-        ssize_t _add_ng_idx = -1;                                                                                      \
-        bool _node_found = hash_string_map_find_internal_(phm, map_key, &_add_ng_idx);                                 \
-        if (_node_found) {                                                                                             \
-            (phm)->nodes.data[_add_ng_idx].value = map_val;                                                            \
-        } else {                                                                                                       \
-            hash_string_map_set_item_idx_(phm, _add_ng_idx, map_key, map_val);                                         \
-            ++(phm)->size;                                                                                             \
+        __typeof__(&(phm)->_value_type[0]) _add_value_ref =                                                            \
+            hash_string_map_table_insert(&(phm)->table, hash_string_map_value_size_(phm), map_key, grow);              \
+        if (_add_value_ref != NULL) {                                                                                  \
+            *_add_value_ref = (elem);                                                                                  \
         }                                                                                                              \
-        true;                                                                                                          \
+        _add_value_ref != NULL;                                                                                        \
     })
 
-#define hash_string_rehash_(phm)                                                                                       \
-    (void)({                                                                                                           \
-        hash_string_map_clear_values(phm);                                                                             \
-        for (size_t _i = 0; _i < (phm)->_old_nodes.cap; ++_i) {                                                        \
-            if (!hash_string_key_is_empty_((phm)->_old_nodes.data[_i].key) &&                                          \
-                !hash_string_key_is_avail_((phm)->_old_nodes.data[_i].key)) {                                          \
-                hash_string_map_add_nogrow(phm, (phm)->_old_nodes.data[_i].key, (phm)->_old_nodes.data[_i].value);     \
-            }                                                                                                          \
-        }                                                                                                              \
-    })
+#define hash_string_map_add(phm, map_key, elem) hash_string_map_add_internal_(phm, map_key, elem, true)
 
-#define hash_string_map_reserve(phm, min_cap)                                                                          \
-    ({                                                                                                                 \
-        bool _res_status = true;                                                                                       \
-        size_t _min_cap = hash_string_map_enforce_size_t_(min_cap);                                                    \
-        if (hash_string_map_get_capacity(phm) < _min_cap) {                                                            \
-            _res_status = hash_string_map_copy_to_old_data_(phm) && vector_reserve(&(phm)->nodes, _min_cap);           \
-            (phm)->cap = (phm)->nodes.cap;                                                                             \
-            hash_string_rehash_(phm);                                                                                  \
-            vector_clear(&(phm)->_old_nodes);                                                                          \
-        }                                                                                                              \
-        _res_status && (phm)->cap >= _min_cap;                                                                         \
-    })
+#define hash_string_map_add_nogrow(phm, map_key, elem) hash_string_map_add_internal_(phm, map_key, elem, false)
 
-#define hash_string_map_has(phm, map_key)                                                                              \
-    ({                                                                                                                 \
-        ssize_t _has_dummy_idx = -1;                                                                                   \
-        hash_string_map_find_internal_(phm, map_key, &_has_dummy_idx);                                                 \
-    })
+#define hash_string_map_has(phm, map_key) (hash_string_map_table_find(&(phm)->table, map_key) != -1)
 
 #define hash_string_map_get(phm, map_key, pval)                                                                        \
     ({                                                                                                                 \
-        ssize_t _read_idx_found = -1;                                                                                  \
-        bool _read_node_found = hash_string_map_find_internal_(phm, map_key, &_read_idx_found);                        \
-        if (_read_node_found) {                                                                                        \
-            *(pval) = (phm)->nodes.data[_read_idx_found].value;                                                        \
+        ssize_t _read_slot = hash_string_map_table_find(&(phm)->table, map_key);                                       \
+        if (_read_slot != -1) {                                                                                        \
+            *(pval) = hash_string_map_value_at_(phm, _read_slot);                                                      \
         }                                                                                                              \
-        _read_node_found;                                                                                              \
+        _read_slot != -1;                                                                                              \
     })
 
 #define hash_string_map_get_reference(phm, map_key)                                                                    \
     ({                                                                                                                 \
-        ssize_t _read_idx_found = -1;                                                                                  \
-        bool _read_node_found = hash_string_map_find_internal_(phm, map_key, &_read_idx_found);                        \
-        void* _map_value_ref = NULL;                                                                                   \
-        if (_read_node_found) {                                                                                        \
-            _map_value_ref = &((phm)->nodes.data[_read_idx_found].value);                                              \
-        }                                                                                                              \
-        _map_value_ref;                                                                                                \
+        ssize_t _read_slot = hash_string_map_table_find(&(phm)->table, map_key);                                       \
+        _read_slot != -1 ? &hash_string_map_value_at_(phm, _read_slot) : NULL;                                         \
     })
 
-#define hash_string_map_add(phm, map_key, elem)                                                                        \
-    ({                                                                                                                 \
-        ssize_t _add_idx = -1;                                                                                         \
-        bool _add_status = true;                                                                                       \
-        bool _add_node_found = hash_string_map_find_internal_(phm, map_key, &_add_idx);                                \
-        if (_add_node_found) {                                                                                         \
-            (phm)->nodes.data[_add_idx].value = elem;                                                                  \
-        } else {                                                                                                       \
-            hash_string_map_set_item_idx_(phm, _add_idx, map_key, elem);                                               \
-            ++(phm)->size;                                                                                             \
-            if (hash_string_map_cap_above_threshold_((phm)->size, (phm)->cap)) {                                       \
-                _add_status = hash_string_map_reserve(phm, hash_string_map_growsize_((phm)->cap));                     \
-            }                                                                                                          \
-        }                                                                                                              \
-        _add_status;                                                                                                   \
-    })
-
-#define hash_string_map_delete(phm, map_key)                                                                           \
-    ({                                                                                                                 \
-        ssize_t _delete_idx = -1;                                                                                      \
-        bool _delete_node_found = hash_string_map_find_internal_(phm, map_key, &_delete_idx);                          \
-        if (_delete_node_found) {                                                                                      \
-            hash_string_key_set_((phm)->nodes.data[_delete_idx].key, HASH_KEY_AVAILABLE);                              \
-            --(phm)->size;                                                                                             \
-        }                                                                                                              \
-        _delete_node_found;                                                                                            \
-    })
+#define hash_string_map_delete(phm, map_key) hash_string_map_table_delete(&(phm)->table, map_key)
 
+// The range variants skip the first start_idx entries so a map can be walked in fixed size chunks
 #define hash_string_map_keys_range(phm, key_buff, start_idx, buff_size)                                                \
     ({                                                                                                                 \
         size_t _keys_processed = 0;                                                                                    \
-        for (size_t _key_it_idx = (start_idx);                                                                         \
-             _key_it_idx < hash_string_map_get_capacity(phm) && _keys_processed < (buff_size); ++_key_it_idx) {        \
-            if (!hash_string_key_is_empty_((phm)->nodes.data[_key_it_idx].key) &&                                      \
-                !hash_string_key_is_avail_((phm)->nodes.data[_key_it_idx].key)) {                                      \
-                hash_string_key_set_((key_buff)[_key_it_idx], (phm)->nodes[_key_it_idx].key);                          \
-                ++_keys_processed;                                                                                     \
-            }                                                                                                          \
+        for (size_t _key_slot = hash_string_map_table_skip(&(phm)->table, start_idx);                                  \
+             _key_slot < hash_string_map_table_slot_count(&(phm)->table) && _keys_processed < (buff_size);             \
+             _key_slot = hash_string_map_table_next(&(phm)->table, _key_slot + 1)) {                                   \
+            const char* _key = hash_string_map_table_key(&(phm)->table, _key_slot);                                    \
+            mem_copy(_key, (key_buff)[_keys_processed], HASH_KEY_MAX_SIZE);                                            \
+            ++_keys_processed;                                                                                         \
         }                                                                                                              \
         _keys_processed;                                                                                               \
     })
@@ -274,13 +177,11 @@ static inline bool hash_string_map_cap_above_threshold_(size_t size, size_t capa
 #define hash_string_map_values_range(phm, val_buff, start_idx, buff_size)                                              \
     ({                                                                                                                 \
         size_t _vals_processed = 0;                                                                                    \
-        for (size_t _val_it_idx = (start_idx);                                                                         \
-             _val_it_idx < hash_string_map_get_capacity(phm) && _vals_processed < (buff_size); ++_val_it_idx) {        \
-            if (!hash_string_key_is_empty_((phm)->nodes.data[_val_it_idx].key) &&                                      \
-                !hash_string_key_is_avail_((phm)->nodes.data[_val_it_idx].key)) {                                      \
-                (val_buff)[_vals_processed] = (phm)->nodes.data[_val_it_idx].value;                                    \
-                ++_vals_processed;                                                                                     \
-            }                                                                                                          \
+        for (size_t _val_slot = hash_string_map_table_skip(&(phm)->table, start_idx);                                  \
+             _val_slot < hash_string_map_table_slot_count(&(phm)->table) && _vals_processed < (buff_size);             \
+             _val_slot = hash_string_map_table_next(&(phm)->table, _val_slot + 1)) {                                   \
+            (val_buff)[_vals_processed] = hash_string_map_value_at_(phm, _val_slot);                                   \
+            ++_vals_processed;                                                                                         \
         }                                                                                                              \
         _vals_processed;                                                                                               \
     })
@@ -290,13 +191,11 @@ static inline bool hash_string_map_cap_above_threshold_(size_t size, size_t capa
 #define hash_string_map_values_reference_range(phm, pval_buff, start_idx, buff_size)                                   \
     ({                                                                                                                 \
         size_t _pvals_processed = 0;                                                                                   \
-        for (size_t _pval_idx = (start_idx);                                                                           \
-             _pval_idx < hash_string_map_get_capacity(phm) && _pvals_processed < (buff_size); ++_pval_idx) {           \
-            if (!hash_string_key_is_empty_((phm)->nodes.data[_pval_idx].key) &&                                        \
-                !hash_string_key_is_avail_((phm)->nodes.data[_pval_idx].key)) {                                        \
-                (pval_buff)[_pvals_processed] = &(phm)->nodes.data[_pval_idx].value;                                   \
-                ++_pvals_processed;                                                                                    \
-            }                                                                                                          \
+        for (size_t _pval_slot = hash_string_map_table_skip(&(phm)->table, start_idx);                                 \
+             _pval_slot < hash_string_map_table_slot_count(&(phm)->table) && _pvals_processed < (buff_size);           \
+             _pval_slot = hash_string_map_table_next(&(phm)->table, _pval_slot + 1)) {                                 \
+            (pval_buff)[_pvals_processed] = &hash_string_map_value_at_(phm, _pval_slot);                               \
+            ++_pvals_processed;                                                                                        \
         }                                                                                                              \
         _pvals_processed;                                                                                              \
     })
@@ -36,8 +36,12 @@ static inline size_t vector_enforce_size_t_(size_t value) { return value; }
 
 #define VECTOR_FAILFLAG_ (~(((size_t)-1) >> 1))
 
+static inline void vector_zero_tail_(void* data, size_t size, size_t cap, size_t elem_size) {
+    mem_set((char*)data + size * elem_size, 0, (cap - size) * elem_size);
+}
+
 static inline void* vector_reallocdata_(
-    void* ptr, size_t count, size_t size, size_t* restrict pcap, size_t* restrict psize) {
+    void* ptr, size_t count, size_t size, size_t* restrict pcap, size_t* restrict psize, bool zero_fill) {
     void* n = mem_realloc(ptr, count * size);
     if (!n) {
         *pcap |= VECTOR_FAILFLAG_;
@@ -45,10 +49,9 @@ static inline void* vector_reallocdata_(
     }
     *pcap = count;
     *psize = vector_min_(*psize, count);
-    char* cn = (char*)n;
-    const size_t byte_offset = *psize * size;
-    size_t extra_empty_part_byte_length = (*pcap - *psize) * size;
-    mem_set(cn + byte_offset, 0, extra_empty_part_byte_length);
+    if (zero_fill) {
+        vector_zero_tail_(n, *psize, *pcap, size);
+    }
     return n;
 }
 
@@ -60,12 +63,12 @@ static inline bool vector_test_and_reset_failflag_(size_t* pcap) {
     return false;
 }
 
-#define vector_realloc_(pv, new_cap)                                                                                   \
-    ((pv)->data = vector_reallocdata_((pv)->data, new_cap, sizeof(*(pv)->data), &(pv)->cap, &(pv)->size),              \
+#define vector_realloc_(pv, new_cap, zero_fill)                                                                        \
+    ((pv)->data = vector_reallocdata_((pv)->data, new_cap, sizeof(*(pv)->data), &(pv)->cap, &(pv)->size, zero_fill),   \
         !vector_test_and_reset_failflag_(&(pv)->cap))
 
 #define vector_resize_(pv, new_cap)                                                                                    \
-    ((pv)->cap == (new_cap) || ((new_cap) > 0 ? vector_realloc_(pv, new_cap) : (vector_clear(pv), true)))
+    ((pv)->cap == (new_cap) || ((new_cap) > 0 ? vector_realloc_(pv, new_cap, true) : (vector_clear(pv), true)))
 
 static inline size_t vector_growsize_(size_t value) {
     // integer multiplication by 1.5
@@ -74,36 +77,57 @@ static inline size_t vector_growsize_(size_t value) {
 
 #define vector_max_cap_(pv) (SIZE_MAX / 2 / sizeof(*(pv)->data))
 
-#define vector_reserve(pv, min_cap) vector_reserve_internal_(pv, vector_max_(min_cap, VECTOR_MINCAP_))
+// Grown capacity past the size is zero filled, the nofill variant leaves it uninitialized for callers that write
+// every element they add
+#define vector_reserve(pv, min_cap) vector_reserve_internal_(pv, vector_max_(min_cap, VECTOR_MINCAP_), true)
 
-#define vector_reserve_internal_(pv, min_cap)                                                                          \
+#define vector_reserve_nofill(pv, min_cap) vector_reserve_internal_(pv, vector_max_(min_cap, VECTOR_MINCAP_), false)
+
+#define vector_reserve_internal_(pv, min_cap, zero_fill)                                                               \
     ((min_cap) <= (pv)->cap ||                                                                                         \
         ((min_cap) <= vector_max_cap_(pv) &&                                                                           \
-            vector_realloc_(pv, vector_between_(vector_growsize_((pv)->cap), min_cap, vector_max_cap_(pv)))))
+            vector_realloc_(                                                                                           \
+                pv, vector_between_(vector_growsize_((pv)->cap), min_cap, vector_max_cap_(pv)), zero_fill)))
 
 #define vector_shrink_to_fit(pv) (void)vector_resize_(pv, (pv)->size)
 
+// Shrinks to half the capacity once a quarter or less is used, so alternating removes and pushes around one size
+// never reallocate on every call
 #define vector_autoshrink(pv)                                                                                          \
-    (void)((pv)->cap <= VECTOR_MINCAP_ || (pv)->cap < vector_growsize_((pv)->size + 5) ||                              \
-           vector_resize_(pv, vector_max_((pv)->size + 5, VECTOR_MINCAP_)))
+    (void)((pv)->cap <= VECTOR_MINCAP_ || (pv)->size > (pv)->cap / 4 ||                                                \
+           vector_resize_(pv, vector_max_((pv)->cap / 2, VECTOR_MINCAP_)))
 
 #define vector_check_same_ptr_type_(a, b) (void)((a) == (b))
 
-#define vector_push(pv, item) (vector_reserve(pv, (pv)->size + 1) && ((pv)->data[(pv)->size++] = (item), true))
+#define vector_push(pv, item)                                                                                          \
+    (vector_reserve_nofill(pv, (pv)->size + 1) && ((pv)->data[(pv)->size++] = (item), true))
 
 #define vector_push_all(pv, items, count) vector_push_all_internal_(pv, items, vector_enforce_size_t_(count))
 
 #define vector_push_all_internal_(pv, items, count)                                                                    \
     (vector_check_same_ptr_type_((pv)->data, items),                                                                   \
-        vector_reserve(pv, (pv)->size + (count)) &&                                                                    \
-            (mem_copy(&(pv)->data[(pv)->size], items, (count) * sizeof(*(pv)->data)), (pv)->size += (count), true))
+        vector_reserve_nofill(pv, (pv)->size + (count)) &&                                                             \
+            (mem_copy(items, &(pv)->data[(pv)->size], (count) * sizeof(*(pv)->data)), (pv)->size += (count), true))
+
+// Adds count copies of the item with a single reservation
+#define vector_push_n(pv, item, count) vector_push_n_internal_(pv, item, vector_enforce_size_t_(count))
+
+#define vector_push_n_internal_(pv, item, count)                                                                       \
+    (vector_reserve_nofill(pv, (pv)->size + (count)) && ({                                                             \
+        for (size_t vector_push_n_idx_ = 0; vector_push_n_idx_ < (count); ++vector_push_n_idx_) {                      \
+            (pv)->data[(pv)->size++] = (item);                                                                         \
+        }                                                                                                              \
+        true;                                                                                                          \
+    }))
+
+#define vector_append(pv, psrc) vector_push_all(pv, (psrc)->data, (psrc)->size)
 
 #define vector_insert_hole(pv, index, count)                                                                           \
     vector_insert_hole_internal_(pv, vector_enforce_size_t_(index), vector_enforce_size_t_(count))
 
 #define vector_insert_hole_internal_(pv, index, count)                                                                 \
     (vector_reserve(pv, (pv)->size + (count)) &&                                                                       \
-        ((index) == (pv)->size || (mem_move(&(pv)->data[(index) + (count)], &(pv)->data[index],                        \
+        ((index) == (pv)->size || (mem_move(&(pv)->data[index], &(pv)->data[(index) + (count)],                        \
                                        ((pv)->size - (index)) * sizeof(*(pv)->data)),                                  \
                                       true)) &&                                                                        \
         ((pv)->size += (count), true))
@@ -113,7 +137,7 @@ static inline size_t vector_growsize_(size_t value) {
 #define vector_insert_all(pv, index, items, count)                                                                     \
     (vector_check_same_ptr_type_((pv)->data, items),                                                                   \
         vector_insert_hole(pv, index, count) &&                                                                        \
-            (mem_copy(&(pv)->data[index], items, (count) * sizeof(*(pv)->data)), true))
+            (mem_copy(items, &(pv)->data[index], (count) * sizeof(*(pv)->data)), true))
 
 static inline void vector_reverse_array_(char* array, size_t len) {
     for (size_t i = 0; i < len / 2; ++i) {
@@ -160,7 +184,7 @@ static inline void vector_move_(char* array, size_t index, size_t count, size_t
 #define vector_remove_slice_noshrink_internal_(pv, index, count)                                                       \
     do {                                                                                                               \
         if ((index) + (count) < (pv)->size)                                                                            \
-            mem_move(&(pv)->data[index], &(pv)->data[(index) + (count)],                                               \
+            mem_move(&(pv)->data[(index) + (count)], &(pv)->data[index],                                               \
                 ((pv)->size - (index) - (count)) * sizeof(*(pv)->data));                                               \
         (pv)->size -= (count);                                                                                         \
     } while (0)
@@ -199,4 +223,103 @@ static inline void vector_move_(char* array, size_t index, size_t count, size_t
     for (size_t vector_idx_##item = 0;                                                                                 \
          vector_idx_##item < (pv)->size && ((item) = (pv)->data[vector_idx_##item], true); ++vector_idx_##item)
 
+// Keeps the first N elements inside the struct and only goes to the heap once they overflow. Data points into the
+// struct while inline so a small vector must not be copied or moved by value. Macros that do not allocate, such as
+// vector_foreach, vector_index_of, vector_swap_remove, vector_remove_noshrink and vector_empty_noshrink, work on
+// small vectors as well
+#define SMALL_VECTOR(type, n)                                                                                          \
+    {                                                                                                                  \
+        size_t cap;                                                                                                    \
+        size_t size;                                                                                                   \
+        type* data;                                                                                                    \
+        type inline_data[n];                                                                                           \
+    }
+
+#define small_vector_inline_cap_(pv) (sizeof((pv)->inline_data) / sizeof(*(pv)->inline_data))
+
+#define small_vector_init(pv)                                                                                          \
+    (void)((pv)->cap = small_vector_inline_cap_(pv), (pv)->size = 0, (pv)->data = (pv)->inline_data)
+
+#define small_vector_is_inline(pv) ((pv)->data == (pv)->inline_data)
+
+#define small_vector_destroy(pv) (small_vector_is_inline(pv) ? (void)0 : mem_free((pv)->data))
+
+#define small_vector_clear(pv) (small_vector_destroy(pv), small_vector_init(pv))
+
+// Moves between the inline buffer and the heap, a capacity that fits inline always goes back to the inline buffer
+static inline void* small_vector_reallocdata_(void* ptr, void* inline_data, size_t inline_cap, size_t count,
+    size_t size, size_t* restrict pcap, size_t* restrict psize, bool zero_fill) {
+    const size_t kept_size = vector_min_(*psize, count);
+    void* n;
+    if (count <= inline_cap) {
+        if (ptr != inline_data) {
+            mem_copy(ptr, inline_data, kept_size * size);
+            mem_free(ptr);
+        }
+        n = inline_data;
+        count = inline_cap;
+    } else if (ptr == inline_data) {
+        n = mem_alloc(count * size);
+        if (n != NULL) {
+            mem_copy(inline_data, n, kept_size * size);
+        }
+    } else {
+        n = mem_realloc(ptr, count * size);
+    }
+    if (!n) {
+        *pcap |= VECTOR_FAILFLAG_;
+        return ptr;
+    }
+
+    *pcap = count;
+    *psize = kept_size;
+    if (zero_fill) {
+        vector_zero_tail_(n, *psize, *pcap, size);
+    }
+    return n;
+}
+
+#define small_vector_realloc_(pv, new_cap, zero_fill)                                                                  \
+    ((pv)->data = small_vector_reallocdata_((pv)->data, (pv)->inline_data, small_vector_inline_cap_(pv), new_cap,      \
+         sizeof(*(pv)->data), &(pv)->cap, &(pv)->size, zero_fill),                                                     \
+        !vector_test_and_reset_failflag_(&(pv)->cap))
+
+#define small_vector_reserve_internal_(pv, min_cap, zero_fill)                                                         \
+    ((min_cap) <= (pv)->cap ||                                                                                         \
+        ((min_cap) <= vector_max_cap_(pv) &&                                                                           \
+            small_vector_realloc_(                                                                                     \
+                pv, vector_between_(vector_growsize_((pv)->cap), min_cap, vector_max_cap_(pv)), zero_fill)))
+
+#define small_vector_reserve(pv, min_cap) small_vector_reserve_internal_(pv, vector_enforce_size_t_(min_cap), true)
+
+#define small_vector_reserve_nofill(pv, min_cap)                                                                       \
+    small_vector_reserve_internal_(pv, vector_enforce_size_t_(min_cap), false)
+
+#define small_vector_shrink_to_fit(pv)                                                                                 \
+    (void)((pv)->cap == vector_max_((pv)->size, small_vector_inline_cap_(pv)) ||                                       \
+           small_vector_realloc_(pv, (pv)->size, true))
+
+#define small_vector_push(pv, item)                                                                                    \
+    (small_vector_reserve_nofill(pv, (pv)->size + 1) && ((pv)->data[(pv)->size++] = (item), true))
+
+#define small_vector_push_all(pv, items, count)                                                                        \
+    small_vector_push_all_internal_(pv, items, vector_enforce_size_t_(count))
+
+#define small_vector_push_all_internal_(pv, items, count)                                                              \
+    (vector_check_same_ptr_type_((pv)->data, items),                                                                   \
+        small_vector_reserve_nofill(pv, (pv)->size + (count)) &&                                                       \
+            (mem_copy(items, &(pv)->data[(pv)->size], (count) * sizeof(*(pv)->data)), (pv)->size += (count), true))
+
+#define small_vector_push_n(pv, item, count) small_vector_push_n_internal_(pv, item, vector_enforce_size_t_(count))
+
+#define small_vector_push_n_internal_(pv, item, count)                                                                 \
+    (small_vector_reserve_nofill(pv, (pv)->size + (count)) && ({                                                       \
+        for (size_t vector_push_n_idx_ = 0; vector_push_n_idx_ < (count); ++vector_push_n_idx_) {                      \
+            (pv)->data[(pv)->size++] = (item);                                                                         \
+        }                                                                                                              \
+        true;                                                                                                          \
+    }))
+
+#define small_vector_append(pv, psrc) small_vector_push_all(pv, (psrc)->data, (psrc)->size)
+
 #endif
@@ -7,6 +7,10 @@
 
 ssize_t file_get_byte_size(const char* filename) {
     SDL_RWops* rw = SDL_RWFromFile(filename, "rb");
+    if (rw == NULL) {
+        log_error("Unable to open the file: %s %s", filename, SDL_GetError());
+        return -1;
+    }
     Sint64 res_size = rw->size(rw);
     if (res_size <= 0) {
         log_error("Unable to retrieve byte size of the file: %s %s", filename, SDL_GetError());
@@ -18,6 +22,10 @@ ssize_t file_get_byte_size(const char* filename) {
 
 ssize_t file_read_binary(const char* filename, char* data) {
     SDL_RWops* rw = SDL_RWFromFile(filename, "rb");
+    if (rw == NULL) {
+        log_error("Unable to open the file: %s %s", filename, SDL_GetError());
+        return -1;
+    }
     Sint64 file_size = rw->size(rw);
     if (file_size <= 0) {
         log_error("Unable to read file: %s %s", filename, SDL_GetError());
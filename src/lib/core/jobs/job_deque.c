@@ -0,0 +1,73 @@
+#include "./job_deque.h"
+
+#define JOB_DEQUE_MASK (JOB_DEQUE_CAPACITY - 1)
+
+void job_deque_clear(JobDeque* deque) {
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    for (size_t i = 0; i < JOB_DEQUE_CAPACITY; ++i) {
+        atomic_init(&deque->jobs[i], NULL);
+    }
+}
+
+bool job_deque_push(JobDeque* deque, struct Job* job) {
+    const int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    const int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) {
+        return false;
+    }
+
+    atomic_store_explicit(&deque->jobs[bottom & JOB_DEQUE_MASK], job, memory_order_relaxed);
+    // Publishes the job contents together with the new bottom
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+
+    return true;
+}
+
+struct Job* job_deque_pop(JobDeque* deque) {
+    const int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    // Orders the bottom store before the top load, thieves do the opposite
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    struct Job* job = atomic_load_explicit(&deque->jobs[bottom & JOB_DEQUE_MASK], memory_order_relaxed);
+    if (top == bottom) {
+        // Last job, thieves race for it through top
+        if (!atomic_compare_exchange_strong_explicit(
+                &deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            job = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+
+    return job;
+}
+
+struct Job* job_deque_steal(JobDeque* deque) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    const int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    struct Job* job = atomic_load_explicit(&deque->jobs[top & JOB_DEQUE_MASK], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(
+            &deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+
+    return job;
+}
+
+bool job_deque_is_empty(const JobDeque* deque) {
+    const int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    const int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    return top >= bottom;
+}
@@ -0,0 +1,32 @@
+#ifndef JOB_DEQUE_H
+#define JOB_DEQUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Power of two
+#define JOB_DEQUE_CAPACITY 1024
+#define JOB_CACHE_LINE_SIZE 64
+
+struct Job;
+
+// Chase-Lev work stealing deque over a fixed ring. The owning worker pushes and pops at the bottom, any other thread
+// steals from the top. Memory orders follow Le et al., Correct and Efficient Work-Stealing for Weak Memory Models
+typedef struct JobDeque {
+    _Alignas(JOB_CACHE_LINE_SIZE) _Atomic(int64_t) top;
+    _Alignas(JOB_CACHE_LINE_SIZE) _Atomic(int64_t) bottom;
+    _Alignas(JOB_CACHE_LINE_SIZE) _Atomic(struct Job*) jobs[JOB_DEQUE_CAPACITY];
+} JobDeque;
+
+void job_deque_clear(JobDeque* deque);
+// Owner only, returns false when the deque is full
+bool job_deque_push(JobDeque* deque, struct Job* job);
+// Owner only
+struct Job* job_deque_pop(JobDeque* deque);
+// Returns NULL when the deque is empty or another thread took the job first
+struct Job* job_deque_steal(JobDeque* deque);
+bool job_deque_is_empty(const JobDeque* deque);
+
+#endif
@@ -0,0 +1,321 @@
+#include "./job_system.h"
+
+#include "../logger/logger.h"
+#include "../memory/memory.h"
+#include "../threads/thread.h"
+#include "../utils/macro.h"
+#include "./job_deque.h"
+
+#define JOB_SYSTEM_JOB_POOL_SIZE JOB_DEQUE_CAPACITY
+// Failed rounds of job search before an idle worker goes to sleep
+#define JOB_SYSTEM_IDLE_SPIN_COUNT 64
+
+typedef struct Job {
+    JobFunction function;
+    JobRangeFunction range_function;
+    void* data;
+    size_t start;
+    size_t end;
+    JobCounter* counter;
+    // Set from allocation until a worker takes the job out of a deque
+    _Atomic(bool) is_queued;
+} Job;
+
+// Jobs are allocated from the pool of the worker that queues them, a slot still in use means the pool is full
+typedef struct JobWorker {
+    JobDeque deque;
+    Job jobs[JOB_SYSTEM_JOB_POOL_SIZE];
+    uint32_t next_job;
+    uint32_t index;
+    uint32_t random_state;
+    JobSystem* system;
+    Thread thread;
+} JobWorker;
+
+static inline JobWorker* job_system_get_current_worker(const JobSystem* system) {
+    return thread_local_get(&system->current_worker);
+}
+
+// Xorshift, only spreads the steal attempts
+static inline uint32_t job_worker_random(JobWorker* worker) {
+    uint32_t x = worker->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->random_state = x;
+    return x;
+}
+
+static Job* job_worker_allocate_job(JobWorker* worker) {
+    Job* job = &worker->jobs[worker->next_job & (JOB_SYSTEM_JOB_POOL_SIZE - 1)];
+    if (atomic_load_explicit(&job->is_queued, memory_order_acquire)) {
+        return NULL;
+    }
+    ++worker->next_job;
+    atomic_store_explicit(&job->is_queued, true, memory_order_relaxed);
+    return job;
+}
+
+static void job_execute(Job* job) {
+    Job local_job = {
+        .function = job->function,
+        .range_function = job->range_function,
+        .data = job->data,
+        .start = job->start,
+        .end = job->end,
+        .counter = job->counter,
+    };
+    atomic_store_explicit(&job->is_queued, false, memory_order_release);
+
+    if (local_job.range_function != NULL) {
+        local_job.range_function(local_job.data, local_job.start, local_job.end);
+    } else {
+        local_job.function(local_job.data);
+    }
+
+    if (local_job.counter != NULL) {
+        atomic_fetch_sub_explicit(&local_job.counter->value, 1, memory_order_release);
+    }
+}
+
+static Job* job_system_find_job(JobSystem* system, JobWorker* worker) {
+    Job* job = job_deque_pop(&worker->deque);
+    if (job != NULL || system->worker_count == 1) {
+        return job;
+    }
+
+    const uint32_t first_victim = job_worker_random(worker) % system->worker_count;
+    for (uint32_t i = 0; i < system->worker_count; ++i) {
+        JobWorker* victim = &system->workers[(first_victim + i) % system->worker_count];
+        if (victim == worker) {
+            continue;
+        }
+        job = job_deque_steal(&victim->deque);
+        if (job != NULL) {
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+static bool job_system_has_queued_jobs(const JobSystem* system) {
+    for (uint32_t i = 0; i < system->worker_count; ++i) {
+        if (!job_deque_is_empty(&system->workers[i].deque)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void job_system_wake_workers(JobSystem* system, size_t job_count) {
+    // Pairs with the fence of a worker going to sleep, either it sees the new jobs or this sees it sleeping
+    atomic_thread_fence(memory_order_seq_cst);
+    const uint32_t sleeping_count = atomic_load_explicit(&system->sleeping_count, memory_order_relaxed);
+    for (size_t i = 0; i < MIN(job_count, sleeping_count); ++i) {
+        semaphore_post(&system->wake_semaphore);
+    }
+}
+
+static int job_system_worker_main(void* data) {
+    JobWorker* worker = data;
+    JobSystem* system = worker->system;
+    thread_local_set(&system->current_worker, worker);
+
+    uint32_t idle_count = 0;
+    while (atomic_load_explicit(&system->is_running, memory_order_acquire)) {
+        Job* job = job_system_find_job(system, worker);
+        if (job != NULL) {
+            job_execute(job);
+            idle_count = 0;
+            continue;
+        }
+
+        if (++idle_count < JOB_SYSTEM_IDLE_SPIN_COUNT) {
+            thread_pause();
+            continue;
+        }
+
+        atomic_fetch_add_explicit(&system->sleeping_count, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!job_system_has_queued_jobs(system) && atomic_load_explicit(&system->is_running, memory_order_acquire)) {
+            semaphore_wait(&system->wake_semaphore);
+        }
+        atomic_fetch_sub_explicit(&system->sleeping_count, 1, memory_order_relaxed);
+        idle_count = 0;
+    }
+
+    return 0;
+}
+
+bool job_system_init(JobSystem* system, const JobSystemConfig* config) {
+    job_system_clear(system);
+
+    uint32_t worker_count = config->worker_count != 0 ? config->worker_count : thread_get_cpu_count();
+    worker_count = MIN(worker_count, JOB_SYSTEM_MAX_WORKERS);
+
+    if (!thread_local_init(&system->current_worker) || !semaphore_init(&system->wake_semaphore, 0)) {
+        job_system_destroy(system);
+        return false;
+    }
+
+    system->workers = mem_alloc_aligned(sizeof(JobWorker) * worker_count, _Alignof(JobWorker));
+    if (system->workers == NULL) {
+        log_error("Unable to allocate job workers");
+        job_system_destroy(system);
+        return false;
+    }
+    system->worker_count = worker_count;
+
+    for (uint32_t i = 0; i < worker_count; ++i) {
+        JobWorker* worker = &system->workers[i];
+        job_deque_clear(&worker->deque);
+        for (size_t j = 0; j < JOB_SYSTEM_JOB_POOL_SIZE; ++j) {
+            atomic_init(&worker->jobs[j].is_queued, false);
+        }
+        worker->next_job = 0;
+        worker->index = i;
+        worker->random_state = 0x9E3779B9u * (i + 1);
+        worker->system = system;
+        thread_clear(&worker->thread);
+    }
+
+    thread_local_set(&system->current_worker, &system->workers[0]);
+    atomic_store(&system->is_running, true);
+
+    for (uint32_t i = 1; i < worker_count; ++i) {
+        JobWorker* worker = &system->workers[i];
+        if (!thread_init(&worker->thread, "job_worker", job_system_worker_main, worker)) {
+            job_system_destroy(system);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool job_system_run(JobSystem* system, const JobDecl* jobs, size_t count, JobCounter* counter) {
+    JobWorker* worker = job_system_get_current_worker(system);
+    if (worker == NULL) {
+        log_error("Jobs can only be started from job system workers");
+        return false;
+    }
+    if (count > UINT32_MAX) {
+        log_error("Unable to start %zu jobs, a job counter holds at most %u", count, UINT32_MAX);
+        return false;
+    }
+
+    if (counter != NULL) {
+        atomic_fetch_add_explicit(&counter->value, count, memory_order_relaxed);
+    }
+
+    size_t queued_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Job* job = job_worker_allocate_job(worker);
+        Job inline_job;
+        if (job == NULL) {
+            job = &inline_job;
+        }
+
+        job->function = jobs[i].function;
+        job->range_function = NULL;
+        job->data = jobs[i].data;
+        job->start = 0;
+        job->end = 0;
+        job->counter = counter;
+
+        if (job == &inline_job || !job_deque_push(&worker->deque, job)) {
+            job_execute(job);
+        } else {
+            ++queued_count;
+        }
+    }
+
+    job_system_wake_workers(system, queued_count);
+
+    return true;
+}
+
+void job_system_wait(JobSystem* system, JobCounter* counter) {
+    JobWorker* worker = job_system_get_current_worker(system);
+    while (!job_counter_is_done(counter)) {
+        Job* job = worker != NULL ? job_system_find_job(system, worker) : NULL;
+        if (job != NULL) {
+            job_execute(job);
+        } else {
+            thread_pause();
+        }
+    }
+}
+
+bool job_system_parallel_for(
+    JobSystem* system, size_t count, size_t batch_size, JobRangeFunction function, void* data) {
+    JobWorker* worker = job_system_get_current_worker(system);
+    if (worker == NULL) {
+        log_error("Jobs can only be started from job system workers");
+        return false;
+    }
+
+    batch_size = MAX(batch_size, 1);
+    const size_t batch_count = count / batch_size + (count % batch_size != 0 ? 1 : 0);
+    if (batch_count > UINT32_MAX) {
+        log_error("Unable to start %zu batches, a job counter holds at most %u", batch_count, UINT32_MAX);
+        return false;
+    }
+
+    JobCounter counter;
+    job_counter_clear(&counter);
+    atomic_store_explicit(&counter.value, batch_count, memory_order_relaxed);
+
+    size_t queued_count = 0;
+    for (size_t start = 0; start < count; start += batch_size) {
+        Job* job = job_worker_allocate_job(worker);
+        Job inline_job;
+        if (job == NULL) {
+            job = &inline_job;
+        }
+
+        job->function = NULL;
+        job->range_function = function;
+        job->data = data;
+        job->start = start;
+        job->end = MIN(start + batch_size, count);
+        job->counter = &counter;
+
+        if (job == &inline_job || !job_deque_push(&worker->deque, job)) {
+            job_execute(job);
+        } else {
+            ++queued_count;
+        }
+    }
+
+    job_system_wake_workers(system, queued_count);
+    job_system_wait(system, &counter);
+
+    return true;
+}
+
+int32_t job_system_get_worker_index(const JobSystem* system) {
+    if (!thread_local_is_init(&system->current_worker)) {
+        return -1;
+    }
+    const JobWorker* worker = job_system_get_current_worker(system);
+    return worker != NULL ? (int32_t)worker->index : -1;
+}
+
+void job_system_destroy(JobSystem* system) {
+    if (system->workers != NULL) {
+        atomic_store(&system->is_running, false);
+        for (uint32_t i = 1; i < system->worker_count; ++i) {
+            semaphore_post(&system->wake_semaphore);
+        }
+        for (uint32_t i = 1; i < system->worker_count; ++i) {
+            thread_join(&system->workers[i].thread);
+        }
+        thread_local_set(&system->current_worker, NULL);
+        mem_free_aligned(system->workers);
+    }
+
+    semaphore_destroy(&system->wake_semaphore);
+    job_system_clear(system);
+}
@@ -0,0 +1,83 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../threads/semaphore.h"
+#include "../threads/thread_local.h"
+
+#define JOB_SYSTEM_MAX_WORKERS 32
+
+typedef void (*JobFunction)(void* data);
+typedef void (*JobRangeFunction)(void* data, size_t start, size_t end);
+
+// Number of unfinished jobs started with the counter. A job that waits for another counter helps run queued jobs in
+// the meantime, that is how dependencies between jobs are expressed
+typedef struct JobCounter {
+    _Atomic(uint32_t) value;
+} JobCounter;
+
+static inline void job_counter_clear(JobCounter* counter) { atomic_init(&counter->value, 0); }
+
+static inline bool job_counter_is_done(JobCounter* counter) {
+    return atomic_load_explicit(&counter->value, memory_order_acquire) == 0;
+}
+
+typedef struct JobDecl {
+    JobFunction function;
+    void* data;
+} JobDecl;
+
+typedef struct JobSystemConfig {
+    // Includes the thread calling job_system_init, 0 uses one worker per CPU. The default of 1 starts no threads, jobs
+    // then run on the calling thread while it waits for them
+    uint32_t worker_count;
+} JobSystemConfig;
+
+struct JobWorker;
+
+typedef struct JobSystem {
+    struct JobWorker* workers;
+    uint32_t worker_count;
+    ThreadLocal current_worker;
+    Semaphore wake_semaphore;
+    _Atomic(uint32_t) sleeping_count;
+    _Atomic(bool) is_running;
+} JobSystem;
+
+static inline JobSystemConfig job_system_config_default() {
+    return (JobSystemConfig){
+        .worker_count = 1,
+    };
+}
+
+static inline void job_system_clear(JobSystem* system) {
+    system->workers = NULL;
+    system->worker_count = 0;
+    thread_local_clear(&system->current_worker);
+    semaphore_clear(&system->wake_semaphore);
+    atomic_init(&system->sleeping_count, 0);
+    atomic_init(&system->is_running, false);
+}
+
+static inline bool job_system_is_init(const JobSystem* system) { return system->workers != NULL; }
+
+// The calling thread becomes worker 0, it runs jobs only while it waits for a counter
+bool job_system_init(JobSystem* system, const JobSystemConfig* config);
+// Jobs can only be queued from worker threads, at most UINT32_MAX at once. The counter may be NULL, otherwise it is
+// increased by the job count and every finished job decreases it. Jobs that do not fit the worker queue run right away
+// on the calling thread
+bool job_system_run(JobSystem* system, const JobDecl* jobs, size_t count, JobCounter* counter);
+// Runs queued jobs until the counter reaches zero
+void job_system_wait(JobSystem* system, JobCounter* counter);
+// Splits [0, count) into at most UINT32_MAX batches of batch_size and returns once all of them are done
+bool job_system_parallel_for(
+    JobSystem* system, size_t count, size_t batch_size, JobRangeFunction function, void* data);
+// Index in [0, worker_count) of the calling thread or -1 when it is not a worker
+int32_t job_system_get_worker_index(const JobSystem* system);
+void job_system_destroy(JobSystem* system);
+
+#endif
@@ -8,6 +8,25 @@ void* mem_realloc(void* mem, size_t size) { return SDL_realloc(mem, size); }
 
 void mem_free(void* data) { SDL_free(data); }
 
+// The pointer returned by SDL_malloc is kept right before the aligned block
+void* mem_alloc_aligned(size_t size, size_t alignment) {
+    alignment = alignment < sizeof(void*) ? sizeof(void*) : alignment;
+    void* mem = SDL_malloc(size + alignment - 1 + sizeof(void*));
+    if (mem == NULL) {
+        return NULL;
+    }
+
+    void** data = (void**)ALIGN_MEM((byte*)mem + sizeof(void*), alignment);
+    data[-1] = mem;
+    return data;
+}
+
+void mem_free_aligned(void* data) {
+    if (data != NULL) {
+        SDL_free(((void**)data)[-1]);
+    }
+}
+
 void mem_copy(const void* src, void* dst, size_t length) { SDL_memcpy(dst, src, length); }
 
 void* mem_move(const void* src, void* dst, size_t length) { return SDL_memmove(dst, src, length); }
@@ -67,6 +67,9 @@ static inline size_t count_bits_uint32_t(uint32_t n) {
 void* mem_alloc(size_t size);
 void* mem_realloc(void* mem, size_t size);
 void mem_free(void* data);
+// Alignment is a power of two, memory from mem_alloc_aligned is only released with mem_free_aligned
+void* mem_alloc_aligned(size_t size, size_t alignment);
+void mem_free_aligned(void* data);
 void mem_copy(const void* src, void* dst, size_t length);
 void* mem_move(const void* src, void* dst, size_t length);
 int mem_cmp(const void* m1, const void* m2, size_t length);
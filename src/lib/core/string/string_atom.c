@@ -0,0 +1,274 @@
+#include "./string_atom.h"
+
+#include <stdatomic.h>
+
+#include "../logger/logger.h"
+#include "../memory/memory.h"
+#include "../threads/mutex.h"
+#include "../utils/macro.h"
+
+#define STRING_ATOM_INDEX_MIN_SIZE 256
+#define STRING_ATOM_ARENA_BLOCK_SIZE KB_TO_BYTES(16)
+
+typedef struct StringAtomEntry {
+    const char* string;
+    uint32_t hash;
+    uint32_t length;
+} StringAtomEntry;
+
+// Open addressing index of atoms, readers never lock so a grown index is published as a whole and the old one is
+// only freed with the table
+typedef struct StringAtomIndex {
+    struct StringAtomIndex* retired_next;
+    size_t mask;
+    _Atomic(StringAtom) slots[];
+} StringAtomIndex;
+
+typedef struct StringAtomArenaBlock {
+    struct StringAtomArenaBlock* next;
+    size_t size;
+    size_t used;
+    char data[];
+} StringAtomArenaBlock;
+
+typedef struct StringAtomTable {
+    Mutex lock;
+    _Atomic(StringAtomIndex*) index;
+    StringAtomIndex* retired_indices;
+    // Entries never move, a chunk is allocated before the first atom pointing into it is published
+    StringAtomEntry* chunks[STRING_ATOM_MAX_CHUNKS];
+    // Stored after the entry of the new atom is written, readers only look up atoms below it
+    _Atomic(uint32_t) count;
+    StringAtomArenaBlock* arena;
+} StringAtomTable;
+
+static StringAtomTable string_atom_table;
+
+// FNV-1a
+static uint32_t string_atom_hash(const char* str, size_t* length) {
+    uint32_t hash = 2166136261u;
+    size_t i;
+    for (i = 0; str[i] != '\0'; ++i) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    *length = i;
+    return hash;
+}
+
+static inline const StringAtomEntry* string_atom_get_entry(StringAtom atom) {
+    return &string_atom_table.chunks[atom / STRING_ATOM_CHUNK_SIZE][atom % STRING_ATOM_CHUNK_SIZE];
+}
+
+static StringAtomIndex* string_atom_index_create(size_t size) {
+    StringAtomIndex* index = mem_alloc(sizeof(StringAtomIndex) + size * sizeof(StringAtom));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->retired_next = NULL;
+    index->mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        atomic_init(&index->slots[i], STRING_ATOM_NONE);
+    }
+    return index;
+}
+
+static void string_atom_index_insert(StringAtomIndex* index, uint32_t hash, StringAtom atom) {
+    size_t i = hash & index->mask;
+    while (atomic_load_explicit(&index->slots[i], memory_order_relaxed) != STRING_ATOM_NONE) {
+        i = (i + 1) & index->mask;
+    }
+    atomic_store_explicit(&index->slots[i], atom, memory_order_release);
+}
+
+static StringAtom string_atom_index_find(const StringAtomIndex* index, const char* str, uint32_t hash, size_t length) {
+    for (size_t i = hash & index->mask;; i = (i + 1) & index->mask) {
+        StringAtom atom = atomic_load_explicit(&index->slots[i], memory_order_acquire);
+        if (atom == STRING_ATOM_NONE) {
+            return STRING_ATOM_NONE;
+        }
+        const StringAtomEntry* entry = string_atom_get_entry(atom);
+        if (entry->hash == hash && entry->length == length && mem_cmp(entry->string, str, length) == 0) {
+            return atom;
+        }
+    }
+}
+
+static bool string_atom_index_grow(StringAtomTable* table) {
+    StringAtomIndex* index = atomic_load_explicit(&table->index, memory_order_relaxed);
+    StringAtomIndex* grown_index = string_atom_index_create((index->mask + 1) << 1);
+    if (grown_index == NULL) {
+        return false;
+    }
+    const uint32_t count = atomic_load_explicit(&table->count, memory_order_relaxed);
+    for (StringAtom atom = 1; atom < count; ++atom) {
+        string_atom_index_insert(grown_index, string_atom_get_entry(atom)->hash, atom);
+    }
+
+    index->retired_next = table->retired_indices;
+    table->retired_indices = index;
+    atomic_store_explicit(&table->index, grown_index, memory_order_release);
+
+    return true;
+}
+
+static const char* string_atom_arena_copy(StringAtomTable* table, const char* str, size_t length) {
+    StringAtomArenaBlock* block = table->arena;
+    if (block == NULL || block->size - block->used < length + 1) {
+        size_t block_size = MAX(length + 1, STRING_ATOM_ARENA_BLOCK_SIZE);
+        block = mem_alloc(sizeof(StringAtomArenaBlock) + block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->size = block_size;
+        block->used = 0;
+        // A block made for one long string goes behind the current one so its free space stays usable
+        if (table->arena != NULL && block_size > STRING_ATOM_ARENA_BLOCK_SIZE) {
+            block->next = table->arena->next;
+            table->arena->next = block;
+        } else {
+            block->next = table->arena;
+            table->arena = block;
+        }
+    }
+
+    char* copy = &block->data[block->used];
+    mem_copy(str, copy, length);
+    copy[length] = '\0';
+    block->used += length + 1;
+
+    return copy;
+}
+
+static StringAtom string_atom_add(StringAtomTable* table, const char* str, uint32_t hash, size_t length) {
+    const StringAtom atom = atomic_load_explicit(&table->count, memory_order_relaxed);
+    if (atom > STRING_ATOM_MAX_COUNT) {
+        log_error("String atom table is full");
+        return STRING_ATOM_NONE;
+    }
+
+    StringAtomIndex* index = atomic_load_explicit(&table->index, memory_order_relaxed);
+    if (2 * atom > index->mask && !string_atom_index_grow(table)) {
+        log_error("Unable to grow string atom index");
+        return STRING_ATOM_NONE;
+    }
+
+    StringAtomEntry** chunk = &table->chunks[atom / STRING_ATOM_CHUNK_SIZE];
+    if (*chunk == NULL) {
+        *chunk = mem_alloc(STRING_ATOM_CHUNK_SIZE * sizeof(StringAtomEntry));
+        if (*chunk == NULL) {
+            log_error("Unable to allocate string atom entries");
+            return STRING_ATOM_NONE;
+        }
+    }
+
+    const char* copy = string_atom_arena_copy(table, str, length);
+    if (copy == NULL) {
+        log_error("Unable to allocate string atom storage");
+        return STRING_ATOM_NONE;
+    }
+
+    (*chunk)[atom % STRING_ATOM_CHUNK_SIZE] = (StringAtomEntry){
+        .string = copy,
+        .hash = hash,
+        .length = (uint32_t)length,
+    };
+    atomic_store_explicit(&table->count, atom + 1, memory_order_release);
+    string_atom_index_insert(atomic_load_explicit(&table->index, memory_order_relaxed), hash, atom);
+
+    return atom;
+}
+
+bool string_atom_table_init(void) {
+    StringAtomTable* table = &string_atom_table;
+    mutex_clear(&table->lock);
+    table->retired_indices = NULL;
+    for (size_t i = 0; i < STRING_ATOM_MAX_CHUNKS; ++i) {
+        table->chunks[i] = NULL;
+    }
+    // Atom 0 is STRING_ATOM_NONE
+    atomic_init(&table->count, 1);
+    table->arena = NULL;
+
+    StringAtomIndex* index = string_atom_index_create(STRING_ATOM_INDEX_MIN_SIZE);
+    if (index == NULL || !mutex_init(&table->lock)) {
+        log_error("Unable to initialize string atom table");
+        mem_free(index);
+        atomic_init(&table->index, NULL);
+        return false;
+    }
+    atomic_init(&table->index, index);
+
+    return true;
+}
+
+void string_atom_table_destroy(void) {
+    StringAtomTable* table = &string_atom_table;
+    mutex_destroy(&table->lock);
+
+    mem_free(atomic_load_explicit(&table->index, memory_order_relaxed));
+    atomic_store_explicit(&table->index, NULL, memory_order_relaxed);
+    while (table->retired_indices != NULL) {
+        StringAtomIndex* next = table->retired_indices->retired_next;
+        mem_free(table->retired_indices);
+        table->retired_indices = next;
+    }
+
+    for (size_t i = 0; i < STRING_ATOM_MAX_CHUNKS; ++i) {
+        mem_free(table->chunks[i]);
+        table->chunks[i] = NULL;
+    }
+    atomic_store_explicit(&table->count, 1, memory_order_relaxed);
+
+    while (table->arena != NULL) {
+        StringAtomArenaBlock* next = table->arena->next;
+        mem_free(table->arena);
+        table->arena = next;
+    }
+}
+
+StringAtom string_atom_intern(const char* str) {
+    StringAtomTable* table = &string_atom_table;
+    if (str == NULL || str[0] == '\0') {
+        return STRING_ATOM_NONE;
+    }
+    if (!mutex_is_init(&table->lock)) {
+        log_error("String atom table is not initialized");
+        return STRING_ATOM_NONE;
+    }
+
+    size_t length;
+    uint32_t hash = string_atom_hash(str, &length);
+    if (length > UINT32_MAX) {
+        return STRING_ATOM_NONE;
+    }
+
+    mutex_lock(&table->lock);
+    StringAtom atom =
+        string_atom_index_find(atomic_load_explicit(&table->index, memory_order_relaxed), str, hash, length);
+    if (atom == STRING_ATOM_NONE) {
+        atom = string_atom_add(table, str, hash, length);
+    }
+    mutex_unlock(&table->lock);
+
+    return atom;
+}
+
+StringAtom string_atom_find(const char* str) {
+    const StringAtomIndex* index = atomic_load_explicit(&string_atom_table.index, memory_order_acquire);
+    if (str == NULL || str[0] == '\0' || index == NULL) {
+        return STRING_ATOM_NONE;
+    }
+
+    size_t length;
+    uint32_t hash = string_atom_hash(str, &length);
+    return string_atom_index_find(index, str, hash, length);
+}
+
+const char* string_atom_get(StringAtom atom) {
+    // Atoms past the count were never handed out, their chunk may not even be allocated
+    if (atom == STRING_ATOM_NONE || atom >= atomic_load_explicit(&string_atom_table.count, memory_order_acquire)) {
+        return "";
+    }
+    return string_atom_get_entry(atom)->string;
+}
@@ -0,0 +1,30 @@
+#ifndef STRING_ATOM_H
+#define STRING_ATOM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Atoms are stable ids of interned strings, registries compare and hash them instead of the names
+typedef uint32_t StringAtom;
+
+#define STRING_ATOM_NONE 0
+
+#define STRING_ATOM_CHUNK_SIZE 1024
+#define STRING_ATOM_MAX_CHUNKS 1024
+#define STRING_ATOM_MAX_COUNT (STRING_ATOM_CHUNK_SIZE * STRING_ATOM_MAX_CHUNKS - 1)
+
+static inline bool string_atom_is_valid(StringAtom atom) { return atom != STRING_ATOM_NONE; }
+
+// The table is global, it has to be initialized before any name is registered and outlives every registry
+bool string_atom_table_init(void);
+void string_atom_table_destroy(void);
+
+// Registers the string if needed, the empty string and failures return STRING_ATOM_NONE
+StringAtom string_atom_intern(const char* str);
+// Lookup without registering, safe to call concurrently with string_atom_intern
+StringAtom string_atom_find(const char* str);
+// The returned string lives as long as the table
+const char* string_atom_get(StringAtom atom);
+
+#endif
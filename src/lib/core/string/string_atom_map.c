@@ -0,0 +1,116 @@
+#include "./string_atom_map.h"
+
+#include "../memory/memory.h"
+
+static inline size_t string_atom_map_max_load(size_t capacity) { return capacity - (capacity >> 2); }
+
+// Atoms are handed out in sequence, the odd multiplier spreads neighbouring atoms over the table
+static inline size_t string_atom_map_home_slot(const StringAtomMap* map, StringAtom atom) {
+    return (size_t)(atom * 2654435769u) & (map->cap - 1);
+}
+
+static size_t string_atom_map_find_slot(const StringAtomMap* map, StringAtom atom) {
+    size_t slot = string_atom_map_home_slot(map, atom);
+    while (map->keys[slot] != atom && map->keys[slot] != STRING_ATOM_NONE) {
+        slot = (slot + 1) & (map->cap - 1);
+    }
+    return slot;
+}
+
+static bool string_atom_map_resize(StringAtomMap* map, size_t capacity) {
+    StringAtom* keys = mem_alloc(capacity * (sizeof(StringAtom) + sizeof(uint32_t)));
+    if (keys == NULL) {
+        return false;
+    }
+    mem_set(keys, STRING_ATOM_NONE, capacity * sizeof(StringAtom));
+
+    StringAtomMap resized = {.keys = keys, .values = (uint32_t*)(keys + capacity), .cap = capacity, .size = map->size};
+    for (size_t i = 0; i < map->cap; ++i) {
+        if (map->keys[i] == STRING_ATOM_NONE) {
+            continue;
+        }
+        size_t slot = string_atom_map_find_slot(&resized, map->keys[i]);
+        resized.keys[slot] = map->keys[i];
+        resized.values[slot] = map->values[i];
+    }
+
+    mem_free(map->keys);
+    *map = resized;
+
+    return true;
+}
+
+bool string_atom_map_reserve(StringAtomMap* map, size_t min_size) {
+    size_t capacity = map->cap == 0 ? STRING_ATOM_MAP_MIN_CAPACITY : map->cap;
+    while (string_atom_map_max_load(capacity) < min_size) {
+        capacity <<= 1;
+    }
+    return capacity == map->cap || string_atom_map_resize(map, capacity);
+}
+
+bool string_atom_map_set(StringAtomMap* map, StringAtom atom, uint32_t value) {
+    if (!string_atom_is_valid(atom) || !string_atom_map_reserve(map, map->size + 1)) {
+        return false;
+    }
+
+    size_t slot = string_atom_map_find_slot(map, atom);
+    if (map->keys[slot] == STRING_ATOM_NONE) {
+        map->keys[slot] = atom;
+        map->size += 1;
+    }
+    map->values[slot] = value;
+
+    return true;
+}
+
+bool string_atom_map_get(const StringAtomMap* map, StringAtom atom, uint32_t* value) {
+    if (map->size == 0 || !string_atom_is_valid(atom)) {
+        return false;
+    }
+
+    size_t slot = string_atom_map_find_slot(map, atom);
+    if (map->keys[slot] == STRING_ATOM_NONE) {
+        return false;
+    }
+    *value = map->values[slot];
+
+    return true;
+}
+
+bool string_atom_map_delete(StringAtomMap* map, StringAtom atom) {
+    if (map->size == 0 || !string_atom_is_valid(atom)) {
+        return false;
+    }
+
+    const size_t mask = map->cap - 1;
+    size_t hole = string_atom_map_find_slot(map, atom);
+    if (map->keys[hole] == STRING_ATOM_NONE) {
+        return false;
+    }
+
+    // An entry moves into the hole unless its home slot lies cyclically after the hole, probing would miss it there
+    for (size_t slot = (hole + 1) & mask; map->keys[slot] != STRING_ATOM_NONE; slot = (slot + 1) & mask) {
+        size_t home = string_atom_map_home_slot(map, map->keys[slot]);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            map->keys[hole] = map->keys[slot];
+            map->values[hole] = map->values[slot];
+            hole = slot;
+        }
+    }
+    map->keys[hole] = STRING_ATOM_NONE;
+    map->size -= 1;
+
+    return true;
+}
+
+void string_atom_map_clear_values(StringAtomMap* map) {
+    if (map->cap > 0) {
+        mem_set(map->keys, STRING_ATOM_NONE, map->cap * sizeof(StringAtom));
+    }
+    map->size = 0;
+}
+
+void string_atom_map_destroy(StringAtomMap* map) {
+    mem_free(map->keys);
+    string_atom_map_clear(map);
+}
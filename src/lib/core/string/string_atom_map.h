@@ -0,0 +1,38 @@
+#ifndef STRING_ATOM_MAP_H
+#define STRING_ATOM_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "./string_atom.h"
+
+#define STRING_ATOM_MAP_MIN_CAPACITY 16
+
+// Maps atoms to indices of a registry, sized by the entries it holds and not by the largest atom. Linear probing,
+// STRING_ATOM_NONE marks an empty slot and deletes shift the following entries back so no tombstones are left
+typedef struct StringAtomMap {
+    StringAtom* keys;
+    uint32_t* values;
+    // Power of two, 0 until the first insert
+    size_t cap;
+    size_t size;
+} StringAtomMap;
+
+static inline void string_atom_map_clear(StringAtomMap* map) {
+    map->keys = NULL;
+    map->values = NULL;
+    map->cap = 0;
+    map->size = 0;
+}
+
+bool string_atom_map_reserve(StringAtomMap* map, size_t min_size);
+// Adds the atom or replaces its value, fails for STRING_ATOM_NONE or when the map could not grow
+bool string_atom_map_set(StringAtomMap* map, StringAtom atom, uint32_t value);
+bool string_atom_map_get(const StringAtomMap* map, StringAtom atom, uint32_t* value);
+bool string_atom_map_delete(StringAtomMap* map, StringAtom atom);
+// Removes every entry and keeps the storage
+void string_atom_map_clear_values(StringAtomMap* map);
+void string_atom_map_destroy(StringAtomMap* map);
+
+#endif
@@ -0,0 +1,30 @@
+#include "./mutex.h"
+
+#include <SDL2/SDL.h>
+
+#include "../logger/logger.h"
+
+bool mutex_init(Mutex* mutex) {
+    mutex_clear(mutex);
+
+    mutex->handle = SDL_CreateMutex();
+    if (mutex->handle == NULL) {
+        log_error("Unable to create mutex: %s", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+void mutex_lock(const Mutex* mutex) { SDL_LockMutex(mutex->handle); }
+
+bool mutex_try_lock(const Mutex* mutex) { return SDL_TryLockMutex(mutex->handle) == 0; }
+
+void mutex_unlock(const Mutex* mutex) { SDL_UnlockMutex(mutex->handle); }
+
+void mutex_destroy(Mutex* mutex) {
+    if (mutex->handle != NULL) {
+        SDL_DestroyMutex(mutex->handle);
+    }
+    mutex_clear(mutex);
+}
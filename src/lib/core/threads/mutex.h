@@ -0,0 +1,24 @@
+#ifndef MUTEX_H
+#define MUTEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct SDL_mutex;
+
+typedef struct Mutex {
+    struct SDL_mutex* handle;
+} Mutex;
+
+static inline void mutex_clear(Mutex* mutex) { mutex->handle = NULL; }
+
+static inline bool mutex_is_init(const Mutex* mutex) { return mutex->handle != NULL; }
+
+bool mutex_init(Mutex* mutex);
+// The wrapper only holds the handle, locking does not modify it
+void mutex_lock(const Mutex* mutex);
+bool mutex_try_lock(const Mutex* mutex);
+void mutex_unlock(const Mutex* mutex);
+void mutex_destroy(Mutex* mutex);
+
+#endif
@@ -0,0 +1,28 @@
+#include "./semaphore.h"
+
+#include <SDL2/SDL.h>
+
+#include "../logger/logger.h"
+
+bool semaphore_init(Semaphore* semaphore, uint32_t initial_value) {
+    semaphore_clear(semaphore);
+
+    semaphore->handle = SDL_CreateSemaphore(initial_value);
+    if (semaphore->handle == NULL) {
+        log_error("Unable to create semaphore: %s", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+void semaphore_wait(const Semaphore* semaphore) { SDL_SemWait(semaphore->handle); }
+
+void semaphore_post(const Semaphore* semaphore) { SDL_SemPost(semaphore->handle); }
+
+void semaphore_destroy(Semaphore* semaphore) {
+    if (semaphore->handle != NULL) {
+        SDL_DestroySemaphore(semaphore->handle);
+    }
+    semaphore_clear(semaphore);
+}
@@ -0,0 +1,23 @@
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct SDL_semaphore;
+
+typedef struct Semaphore {
+    struct SDL_semaphore* handle;
+} Semaphore;
+
+static inline void semaphore_clear(Semaphore* semaphore) { semaphore->handle = NULL; }
+
+static inline bool semaphore_is_init(const Semaphore* semaphore) { return semaphore->handle != NULL; }
+
+bool semaphore_init(Semaphore* semaphore, uint32_t initial_value);
+void semaphore_wait(const Semaphore* semaphore);
+void semaphore_post(const Semaphore* semaphore);
+void semaphore_destroy(Semaphore* semaphore);
+
+#endif
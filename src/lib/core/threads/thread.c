@@ -0,0 +1,31 @@
+#include "./thread.h"
+
+#include <SDL2/SDL.h>
+
+#include "../logger/logger.h"
+
+bool thread_init(Thread* thread, const char* name, ThreadFunction function, void* data) {
+    thread_clear(thread);
+
+    thread->handle = SDL_CreateThread(function, name, data);
+    if (thread->handle == NULL) {
+        log_error("Unable to create thread %s: %s", name, SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+int thread_join(Thread* thread) {
+    int status = 0;
+    if (thread->handle != NULL) {
+        SDL_WaitThread(thread->handle, &status);
+    }
+    thread_clear(thread);
+    return status;
+}
+
+uint32_t thread_get_cpu_count(void) {
+    int cpu_count = SDL_GetCPUCount();
+    return cpu_count > 0 ? (uint32_t)cpu_count : 1;
+}
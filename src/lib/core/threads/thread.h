@@ -0,0 +1,34 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct SDL_Thread;
+
+typedef int (*ThreadFunction)(void* data);
+
+typedef struct Thread {
+    struct SDL_Thread* handle;
+} Thread;
+
+static inline void thread_clear(Thread* thread) { thread->handle = NULL; }
+
+static inline bool thread_is_init(const Thread* thread) { return thread->handle != NULL; }
+
+// Spin loop hint, keeps a busy waiting thread from starving its sibling hyperthread
+static inline void thread_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+bool thread_init(Thread* thread, const char* name, ThreadFunction function, void* data);
+// Waits for the thread to finish and returns the value of its function
+int thread_join(Thread* thread);
+uint32_t thread_get_cpu_count(void);
+
+#endif
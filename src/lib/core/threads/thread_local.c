@@ -0,0 +1,21 @@
+#include "./thread_local.h"
+
+#include <SDL2/SDL.h>
+
+#include "../logger/logger.h"
+
+bool thread_local_init(ThreadLocal* slot) {
+    thread_local_clear(slot);
+
+    slot->id = SDL_TLSCreate();
+    if (slot->id == 0) {
+        log_error("Unable to create thread local storage: %s", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+void* thread_local_get(const ThreadLocal* slot) { return SDL_TLSGet(slot->id); }
+
+bool thread_local_set(const ThreadLocal* slot, void* value) { return SDL_TLSSet(slot->id, value, NULL) == 0; }
@@ -0,0 +1,19 @@
+#ifndef THREAD_LOCAL_H
+#define THREAD_LOCAL_H
+
+#include <stdbool.h>
+
+// Pointer slot with a separate value for every thread, the slot starts as NULL in each thread
+typedef struct ThreadLocal {
+    unsigned int id;
+} ThreadLocal;
+
+static inline void thread_local_clear(ThreadLocal* slot) { slot->id = 0; }
+
+static inline bool thread_local_is_init(const ThreadLocal* slot) { return slot->id != 0; }
+
+bool thread_local_init(ThreadLocal* slot);
+void* thread_local_get(const ThreadLocal* slot);
+bool thread_local_set(const ThreadLocal* slot, void* value);
+
+#endif
@@ -0,0 +1,57 @@
+#include "./clock.h"
+
+#include <SDL2/SDL.h>
+
+#include "../threads/thread.h"
+#include "../utils/macro.h"
+
+// The OS sleep is only trusted up to this much before the deadline, the rest is spent polling the counter
+#define CLOCK_SYSTEM_SLEEP_SLACK_NS TIME_MS_TO_NS(2)
+// While more than this is left the polling thread gives up its time slice, a yield can overshoot by the timer slack
+#define CLOCK_SYSTEM_YIELD_THRESHOLD_NS TIME_US_TO_NS(200)
+
+static uint64_t clock_system_now(void* data) {
+    (void)data;
+    const uint64_t frequency = SDL_GetPerformanceFrequency();
+    const uint64_t counter = SDL_GetPerformanceCounter();
+    // Split to avoid overflowing the multiplication for large counter values
+    return (counter / frequency) * 1000000000ull + (counter % frequency) * 1000000000ull / frequency;
+}
+
+static void clock_system_sleep(void* data, uint64_t duration_ns) {
+    const uint64_t deadline = clock_system_now(data) + duration_ns;
+    if (duration_ns > CLOCK_SYSTEM_SLEEP_SLACK_NS) {
+        SDL_Delay((uint32_t)((duration_ns - CLOCK_SYSTEM_SLEEP_SLACK_NS) / TIME_MS_TO_NS(1)));
+    }
+    uint64_t now = clock_system_now(data);
+    while (now < deadline) {
+        if (deadline - now > CLOCK_SYSTEM_YIELD_THRESHOLD_NS) {
+            SDL_Delay(0);
+        } else {
+            thread_pause();
+        }
+        now = clock_system_now(data);
+    }
+}
+
+static uint64_t clock_simulated_now(void* data) { return ((SimulatedClock*)data)->time_ns; }
+
+static void clock_simulated_sleep(void* data, uint64_t duration_ns) {
+    simulated_clock_advance((SimulatedClock*)data, duration_ns);
+}
+
+Clock clock_get_system() {
+    return (Clock){
+        .now = clock_system_now,
+        .sleep = clock_system_sleep,
+        .data = NULL,
+    };
+}
+
+Clock clock_get_simulated(SimulatedClock* simulated_clock) {
+    return (Clock){
+        .now = clock_simulated_now,
+        .sleep = clock_simulated_sleep,
+        .data = simulated_clock,
+    };
+}
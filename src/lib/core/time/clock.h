@@ -0,0 +1,38 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint64_t (*ClockNowFunction)(void* data);
+typedef void (*ClockSleepFunction)(void* data, uint64_t duration_ns);
+
+// Monotonic time in nanoseconds. Timing code takes a clock instead of reading the system time so that a simulated
+// clock can drive it deterministically
+typedef struct Clock {
+    ClockNowFunction now;
+    ClockSleepFunction sleep;
+    void* data;
+} Clock;
+
+// Time only moves when something sleeps on it or it is advanced by hand
+typedef struct SimulatedClock {
+    uint64_t time_ns;
+} SimulatedClock;
+
+static inline uint64_t clock_now(const Clock* clock) { return clock->now(clock->data); }
+
+static inline void clock_sleep(const Clock* clock, uint64_t duration_ns) {
+    if (duration_ns > 0) {
+        clock->sleep(clock->data, duration_ns);
+    }
+}
+
+static inline void simulated_clock_advance(SimulatedClock* clock, uint64_t duration_ns) {
+    clock->time_ns += duration_ns;
+}
+
+Clock clock_get_system();
+Clock clock_get_simulated(SimulatedClock* simulated_clock);
+
+#endif
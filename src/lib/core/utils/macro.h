@@ -11,6 +11,7 @@
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 
 #define TIME_MS_TO_NS(milliseconds) (((uint64_t)(milliseconds)) * (1000 * 1000))
+#define TIME_US_TO_NS(microseconds) (((uint64_t)(microseconds)) * 1000)
 
 #define SWAP_VALUES(x, y)                                                                                              \
     do {                                                                                                               \
@@ -3,22 +3,53 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <vulkan/vulkan.h>
 
+#include "../../core/string/string.h"
 #include "./color/color.h"
 
 typedef struct RenderingContextConfig {
     uint32_t frames_in_flight;
+    // Threads recording secondary command buffers in parallel, each gets a command pool per frame in flight
+    uint32_t recording_thread_count;
     Color clear_color;
     bool depth_enabled;
     uint64_t render_timeout_ms;
+    // Paces frames with a single timeline semaphore instead of a fence per frame, only used when the device was
+    // created with the Vulkan 1.2 timelineSemaphore feature
+    bool timeline_semaphore_enabled;
+    // Falls back to FIFO when the surface does not support it
+    VkPresentModeKHR present_mode;
+    // Holds back the start of a frame so that input is sampled as late as the GPU allows
+    bool just_in_time_wait_enabled;
+    uint64_t just_in_time_margin_us;
 } RenderingContextConfig;
 
+static inline VkPresentModeKHR present_mode_from_string(const char* mode) {
+    if (string_equals(mode, "immediate")) {
+        return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    }
+    if (string_equals(mode, "mailbox")) {
+        return VK_PRESENT_MODE_MAILBOX_KHR;
+    }
+    if (string_equals(mode, "fifo_relaxed")) {
+        return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    }
+
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
 static inline RenderingContextConfig rendering_context_config_default() {
     return (RenderingContextConfig){
         .frames_in_flight = 3,
+        .recording_thread_count = 1,
         .clear_color = color_black(),
         .depth_enabled = false,
         .render_timeout_ms = 10000,
+        .timeline_semaphore_enabled = true,
+        .present_mode = VK_PRESENT_MODE_MAILBOX_KHR,
+        .just_in_time_wait_enabled = false,
+        .just_in_time_margin_us = 1000,
     };
 }
 
@@ -2,9 +2,64 @@
 
 #include "../vulkan/core/errors.h"
 
-void renderer_clear(Renderer* renderer) { renderer->context = NULL; }
+void renderer_clear(Renderer* renderer) {
+    renderer->context = NULL;
+    renderer->memory_context = NULL;
+    renderer->memory_uploader = NULL;
+    renderer->memory_defragmenter = NULL;
+    renderer->defragmentation_interval = 0;
+    renderer->defragmentation_limits = (VulkanMemoryDefragmentationLimits){0};
+    renderer->latency_log_interval = 0;
+}
+
+void renderer_init(Renderer* renderer, const RendererInfo* info) {
+    renderer->context = info->context;
+    renderer->memory_context = info->memory_context;
+    renderer->memory_uploader = info->memory_uploader;
+    renderer->memory_defragmenter = info->memory_defragmenter;
+    renderer->defragmentation_interval = info->defragmentation_interval;
+    renderer->defragmentation_limits = info->defragmentation_limits;
+    renderer->latency_log_interval = info->latency_log_interval;
+}
+
+static bool renderer_update_memory(Renderer* renderer) {
+    MemoryContextError status = MEMORY_CONTEXT_SUCCESS;
+    if (renderer->memory_uploader != NULL) {
+        status = memory_uploader_update(renderer->memory_uploader);
+        ASSERT_SUCCESS_LOG(status, MemoryContextError, memory_context_error_to_string, false);
+    }
+
+    MemoryDefragmenter* defragmenter = renderer->memory_defragmenter;
+    if (defragmenter == NULL || renderer->defragmentation_interval == 0) {
+        return true;
+    }
+
+    if (!memory_defragmenter_is_active(defragmenter) &&
+        renderer->context->frame_number % renderer->defragmentation_interval == 0) {
+        status = memory_defragmenter_begin(defragmenter, &renderer->defragmentation_limits);
+        ASSERT_SUCCESS_LOG(status, MemoryContextError, memory_context_error_to_string, false);
+    }
+
+    // Moves are swapped in before the frame is recorded, the frame already uses the new buffers
+    status = memory_defragmenter_step(defragmenter);
+    if (status == MEMORY_CONTEXT_DEFRAGMENTATION_IN_PROGRESS) {
+        return true;
+    }
+    ASSERT_SUCCESS_LOG(status, MemoryContextError, memory_context_error_to_string, false);
+
+    return true;
+}
 
-void renderer_init(Renderer* renderer, RenderingContext* context) { renderer->context = context; }
+static void renderer_log_latency(const Renderer* renderer) {
+    if (renderer->latency_log_interval == 0 || renderer->context->frame_number % renderer->latency_log_interval != 0) {
+        return;
+    }
+
+    const FrameLatencyStats* stats = rendering_context_get_latency_stats(renderer->context);
+    log_debug("Frame %llu latency: cpu %.2f ms, gpu %.2f ms, cpu to present %.2f ms (last %.2f ms), wait %.2f ms",
+        (unsigned long long)renderer->context->frame_number, stats->cpu_time_ns / 1e6, stats->gpu_time_ns / 1e6,
+        stats->cpu_to_present_ns / 1e6, stats->last_cpu_to_present_ns / 1e6, stats->last_wait_ns / 1e6);
+}
 
 bool renderer_resize(Renderer* renderer) {
     RenderingContextError status = rendering_context_resize(renderer->context);
@@ -13,15 +68,43 @@ bool renderer_resize(Renderer* renderer) {
     return true;
 }
 
+bool renderer_pace_frame(Renderer* renderer) {
+    RenderingContextError status = rendering_context_pace_frame(renderer->context);
+    ASSERT_SUCCESS_LOG(status, RenderingContextError, rendering_context_error_to_string, false);
+
+    return true;
+}
+
 bool renderer_render(Renderer* renderer) {
     RenderingContext* context = renderer->context;
     RenderingContextError status = rendering_context_start_frame(context);
     if (status == RENDERING_CONTEXT_REFRESHING) {
         return true;
     }
+    ASSERT_SUCCESS_LOG(status, RenderingContextError, rendering_context_error_to_string, false);
+
+    // The frame slot's previous frame has finished, its transient memory can be reused
+    memory_context_begin_frame(renderer->memory_context, context->current_frame, context->frame_number,
+        rendering_context_update_completed_frame_number(context));
+    if (!renderer_update_memory(renderer)) {
+        return false;
+    }
 
     // TODO: DRAW STUFF
-    rendering_context_render(context);
+    status = rendering_context_render(context);
+    ASSERT_SUCCESS_LOG(status, RenderingContextError, rendering_context_error_to_string, false);
+
+    // Uploads made during the frame are submitted together, all batches in flight means they wait for the next frame
+    MemoryContextError memory_status = MEMORY_CONTEXT_SUCCESS;
+    if (renderer->memory_uploader != NULL) {
+        memory_status = memory_uploader_flush(renderer->memory_uploader, NULL);
+        if (memory_status != MEMORY_CONTEXT_STAGING_FULL) {
+            ASSERT_SUCCESS_LOG(memory_status, MemoryContextError, memory_context_error_to_string, false);
+        }
+    }
+
+    memory_status = memory_context_flush(renderer->memory_context);
+    ASSERT_SUCCESS_LOG(memory_status, MemoryContextError, memory_context_error_to_string, false);
 
     status = rendering_context_end_frame(context);
     if (status == RENDERING_CONTEXT_REFRESHING) {
@@ -29,5 +112,7 @@ bool renderer_render(Renderer* renderer) {
     }
     ASSERT_SUCCESS_LOG(status, RenderingContextError, rendering_context_error_to_string, false);
 
+    renderer_log_latency(renderer);
+
     return true;
 }
@@ -4,15 +4,40 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "../vulkan/core/memory/defragmenter/memory_defragmenter.h"
+#include "../vulkan/core/memory/memory_context.h"
+#include "../vulkan/core/memory/uploader/memory_uploader.h"
 #include "../vulkan/core/rendering/rendering_context.h"
 
+typedef struct RendererInfo {
+    RenderingContext* context;
+    MemoryContext* memory_context;
+    MemoryUploader* memory_uploader;
+    MemoryDefragmenter* memory_defragmenter;
+
+    // Frames between the starts of defragmentation passes, zero disables them
+    uint32_t defragmentation_interval;
+    VulkanMemoryDefragmentationLimits defragmentation_limits;
+    // Frames between logs of the frame latency stats, zero disables them
+    uint32_t latency_log_interval;
+} RendererInfo;
+
 typedef struct Renderer {
     RenderingContext* context;
+    MemoryContext* memory_context;
+    MemoryUploader* memory_uploader;
+    MemoryDefragmenter* memory_defragmenter;
+
+    uint32_t defragmentation_interval;
+    VulkanMemoryDefragmentationLimits defragmentation_limits;
+    uint32_t latency_log_interval;
 } Renderer;
 
 void renderer_clear(Renderer* renderer);
-void renderer_init(Renderer* renderer, RenderingContext* context);
+void renderer_init(Renderer* renderer, const RendererInfo* info);
 bool renderer_resize(Renderer* renderer);
+// Blocks until the next frame should start, input sampled afterwards makes it into that frame
+bool renderer_pace_frame(Renderer* renderer);
 bool renderer_render(Renderer* renderer);
 
 #endif
@@ -0,0 +1,102 @@
+#include "./command_allocator.h"
+
+#include "../../../core/logger/logger.h"
+
+static inline CommandPool* command_allocator_get_thread_pool(
+    CommandAllocator* allocator, uint32_t thread_index) {
+    if (!command_allocator_is_init(allocator) || thread_index >= allocator->thread_count) {
+        return NULL;
+    }
+    return &allocator->pools[allocator->current_frame][thread_index];
+}
+
+void command_allocator_clear(CommandAllocator* allocator) {
+    allocator->context = NULL;
+    allocator->thread_count = 0;
+    allocator->frame_count = 0;
+    allocator->current_frame = 0;
+    for (uint32_t frame = 0; frame < COMMAND_ALLOCATOR_MAX_FRAMES; ++frame) {
+        for (uint32_t thread = 0; thread < COMMAND_ALLOCATOR_MAX_THREADS; ++thread) {
+            command_pool_clear(&allocator->pools[frame][thread]);
+        }
+    }
+}
+
+bool command_allocator_init(CommandAllocator* allocator, const Context* context, const CommandAllocatorInitInfo* info) {
+    command_allocator_clear(allocator);
+    if (context == NULL || info->thread_count == 0 || info->thread_count > COMMAND_ALLOCATOR_MAX_THREADS ||
+        info->frame_count == 0 || info->frame_count > COMMAND_ALLOCATOR_MAX_FRAMES) {
+        log_error("Invalid command allocator configuration");
+        return false;
+    }
+
+    allocator->context = context;
+    allocator->thread_count = info->thread_count;
+    allocator->frame_count = info->frame_count;
+
+    // Pools are only ever reset as a whole, the buffers do not need to be resettable on their own
+    CommandPoolInitInfo pool_info = {
+        .name = "",
+        .primary_buffer_count = info->primary_buffer_count,
+        .secondary_buffer_count = info->secondary_buffer_count,
+        .queue_family_index = info->queue_family_index,
+        .transient = true,
+        .reset_enabled = false,
+        .protected = false,
+    };
+    for (uint32_t frame = 0; frame < allocator->frame_count; ++frame) {
+        for (uint32_t thread = 0; thread < allocator->thread_count; ++thread) {
+            if (!command_pool_init(&allocator->pools[frame][thread], context, &pool_info)) {
+                log_error("Unable to create command pool for thread %u, frame %u", thread, frame);
+                command_allocator_destroy(allocator);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool command_allocator_is_init(const CommandAllocator* allocator) { return allocator->context != NULL; }
+
+bool command_allocator_begin_frame(CommandAllocator* allocator, uint32_t frame_index) {
+    if (!command_allocator_is_init(allocator) || frame_index >= allocator->frame_count) {
+        return false;
+    }
+
+    allocator->current_frame = frame_index;
+    for (uint32_t thread = 0; thread < allocator->thread_count; ++thread) {
+        CommandPool* pool = &allocator->pools[frame_index][thread];
+        // A pool nothing was taken from has nothing to reset
+        if (command_pool_has_used_buffers(pool) && !command_pool_reset(pool, false)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+VkCommandBuffer command_allocator_get_primary_buffer(CommandAllocator* allocator, uint32_t thread_index) {
+    CommandPool* pool = command_allocator_get_thread_pool(allocator, thread_index);
+    if (pool == NULL) {
+        return VK_NULL_HANDLE;
+    }
+    return command_pool_acquire_primary_buffer(pool);
+}
+
+VkCommandBuffer command_allocator_get_secondary_buffer(CommandAllocator* allocator, uint32_t thread_index) {
+    CommandPool* pool = command_allocator_get_thread_pool(allocator, thread_index);
+    if (pool == NULL) {
+        return VK_NULL_HANDLE;
+    }
+    return command_pool_acquire_secondary_buffer(pool);
+}
+
+void command_allocator_destroy(CommandAllocator* allocator) {
+    for (uint32_t frame = 0; frame < COMMAND_ALLOCATOR_MAX_FRAMES; ++frame) {
+        for (uint32_t thread = 0; thread < COMMAND_ALLOCATOR_MAX_THREADS; ++thread) {
+            command_pool_destroy(&allocator->pools[frame][thread]);
+        }
+    }
+    command_allocator_clear(allocator);
+}
@@ -0,0 +1,49 @@
+#ifndef COMMAND_ALLOCATOR_H
+#define COMMAND_ALLOCATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+#include "../context/context.h"
+#include "./command_pool.h"
+
+#define COMMAND_ALLOCATOR_MAX_THREADS 16
+#define COMMAND_ALLOCATOR_MAX_FRAMES 8
+
+typedef struct CommandAllocatorInitInfo {
+    uint32_t thread_count;
+    uint32_t frame_count;
+    uint32_t queue_family_index;
+    // Buffers allocated up front in every pool, pools grow past them on demand
+    uint32_t primary_buffer_count, secondary_buffer_count;
+} CommandAllocatorInitInfo;
+
+// Owns a command pool per (recording thread, frame in flight), only the recording thread hands out buffers of its
+// pools. Buffers are never reset one by one, the pools of a
+// frame are reset as a whole once the frame's fence has signaled
+typedef struct CommandAllocator {
+    const Context* context;
+    uint32_t thread_count;
+    uint32_t frame_count;
+    uint32_t current_frame;
+
+    CommandPool pools[COMMAND_ALLOCATOR_MAX_FRAMES][COMMAND_ALLOCATOR_MAX_THREADS];
+} CommandAllocator;
+
+void command_allocator_clear(CommandAllocator* allocator);
+bool command_allocator_init(CommandAllocator* allocator, const Context* context, const CommandAllocatorInitInfo* info);
+bool command_allocator_is_init(const CommandAllocator* allocator);
+
+// Resets every pool of the frame, the GPU must be done with the buffers recorded the last time the frame was used.
+// Called from the thread that owns the frame before any buffer of it is handed out
+bool command_allocator_begin_frame(CommandAllocator* allocator, uint32_t frame_index);
+
+// Hands out a free buffer of the thread's pool for the current frame, growing the pool when it has none left.
+// VK_NULL_HANDLE only when the allocation fails. Each thread index must only be used by one thread at a time
+VkCommandBuffer command_allocator_get_primary_buffer(CommandAllocator* allocator, uint32_t thread_index);
+VkCommandBuffer command_allocator_get_secondary_buffer(CommandAllocator* allocator, uint32_t thread_index);
+
+void command_allocator_destroy(CommandAllocator* allocator);
+
+#endif
@@ -1,7 +1,7 @@
 #include "./command_context.h"
 
 static inline VkCommandBuffer command_context_get_buffer(
-    CommandContext* command_context, const char* pool_name, uint32_t buffer_index, bool secondary) {
+    CommandContext* command_context, StringAtom pool_name, uint32_t buffer_index, bool secondary) {
     if (!command_context_is_init(command_context)) {
         return VK_NULL_HANDLE;
     }
@@ -48,7 +48,7 @@ bool command_context_add_command_pool(CommandContext* command_context, const Com
     return status;
 }
 
-bool command_context_remove_command_pool(CommandContext* command_context, const char* name) {
+bool command_context_remove_command_pool(CommandContext* command_context, StringAtom name) {
     if (!command_context_is_init(command_context)) {
         return false;
     }
@@ -57,7 +57,7 @@ bool command_context_remove_command_pool(CommandContext* command_context, const
 }
 
 VkCommandBuffer command_context_get_command_buffer(
-    CommandContext* command_context, const char* pool_name, const CommandBufferInfo* info) {
+    CommandContext* command_context, StringAtom pool_name, const CommandBufferInfo* info) {
     VkCommandBuffer buffer =
         command_context_get_buffer(command_context, pool_name, info->buffer_index, info->secondary);
     return buffer;
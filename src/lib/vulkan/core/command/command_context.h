@@ -24,10 +24,11 @@ void command_context_init(CommandContext* command_context, const Context* contex
 bool command_context_is_init(const CommandContext* command_context);
 
 bool command_context_add_command_pool(CommandContext* command_context, const CommandPoolInitInfo* info);
-bool command_context_remove_command_pool(CommandContext* command_context, const char* name);
+bool command_context_remove_command_pool(CommandContext* command_context, StringAtom name);
 
+// Pools are registered by the name in their init info and looked up by its atom
 VkCommandBuffer command_context_get_command_buffer(
-    CommandContext* command_context, const char* pool_name, const CommandBufferInfo* info);
+    CommandContext* command_context, StringAtom pool_name, const CommandBufferInfo* info);
 
 void command_context_destroy(CommandContext* command_context);
 
@@ -1,29 +1,90 @@
 #include "./command_pool.h"
 
-#include "../../../core/string/string.h"
+#include "../../../core/utils/macro.h"
 #include "../errors.h"
 #include "../functions.h"
 
+static inline void command_pool_buffers_clear(CommandPoolBuffers* buffers) {
+    vector_init(&buffers->handles);
+    buffers->used_count = 0;
+}
+
+static inline VkCommandBuffer command_pool_buffers_get(const CommandPoolBuffers* buffers, uint32_t index) {
+    if (index >= buffers->handles.size) {
+        return VK_NULL_HANDLE;
+    }
+    return buffers->handles.data[index];
+}
+
+// New buffers are appended behind the existing ones and start out free
+static bool command_pool_allocate_buffers(
+    CommandPool* pool, CommandPoolBuffers* buffers, VkCommandBufferLevel level, uint32_t count) {
+    if (!command_pool_is_init(pool) || count == 0) {
+        return false;
+    }
+
+    CommandBufferList* handles = &buffers->handles;
+    if (!vector_reserve_nofill(handles, handles->size + count)) {
+        log_error("Unable to allocate command buffer list");
+        return false;
+    }
+
+    VkCommandBufferAllocateInfo buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pool->handle,
+        .level = level,
+        .commandBufferCount = count,
+    };
+    VkResult status =
+        vkAllocateCommandBuffers(pool->context->device.handle, &buffer_info, &handles->data[handles->size]);
+    ASSERT_VK_LOG(status, "Unable to allocate command buffers", false);
+    handles->size += count;
+
+    return true;
+}
+
+static VkCommandBuffer command_pool_acquire_buffer(
+    CommandPool* pool, CommandPoolBuffers* buffers, VkCommandBufferLevel level) {
+    if (buffers->used_count == buffers->handles.size &&
+        !command_pool_allocate_buffers(pool, buffers, level, COMMAND_POOL_BUFFER_CHUNK_SIZE)) {
+        return VK_NULL_HANDLE;
+    }
+    return buffers->handles.data[buffers->used_count++];
+}
+
+static void command_pool_free_level_buffers(CommandPool* pool, CommandPoolBuffers* buffers) {
+    if (buffers->handles.size > 0) {
+        vkFreeCommandBuffers(
+            pool->context->device.handle, pool->handle, (uint32_t)buffers->handles.size, buffers->handles.data);
+    }
+    vector_clear(&buffers->handles);
+    buffers->used_count = 0;
+}
+
 void command_pool_clear(CommandPool* pool) {
     pool->handle = VK_NULL_HANDLE;
     pool->context = NULL;
-    string_copy(COMMAND_POOL_AVAILABLE_KEY, pool->name, COMMAND_POOL_NAME_SIZE);
+    pool->name = STRING_ATOM_NONE;
     pool->queue_family_index = UINT32_MAX;
-    pool->primary_buffer_count = 0;
-    pool->secondary_buffer_count = 0;
-    for (uint32_t i = 0; i < COMMAND_POOL_MAX_BUFFERS; ++i) {
-        pool->primary_buffers[i] = VK_NULL_HANDLE;
-    }
-    for (uint32_t i = 0; i < COMMAND_POOL_MAX_BUFFERS; ++i) {
-        pool->secondary_buffers[i] = VK_NULL_HANDLE;
-    }
+    pool->reset_enabled = false;
+    command_pool_buffers_clear(&pool->primary_buffers);
+    command_pool_buffers_clear(&pool->secondary_buffers);
 }
 
 bool command_pool_init(CommandPool* pool, const Context* context, const CommandPoolInitInfo* info) {
     command_pool_clear(pool);
-    string_copy(info->name, pool->name, COMMAND_POOL_NAME_SIZE);
+    // Pools owned outside of the cache may stay unnamed
+    if (info->name[0] != '\0') {
+        pool->name = string_atom_intern(info->name);
+        if (!string_atom_is_valid(pool->name)) {
+            log_error("Unable to register command pool name: %s", info->name);
+            return false;
+        }
+    }
     pool->context = context;
     pool->queue_family_index = info->queue_family_index;
+    pool->reset_enabled = info->reset_enabled;
 
     VkCommandPoolCreateFlags flags = 0;
     if (info->transient) {
@@ -67,75 +128,58 @@ void command_pool_copy(const CommandPool* src, CommandPool* dst, bool destroy_ds
     }
     dst->handle = src->handle;
     dst->context = src->context;
-    string_copy(src->name, dst->name, COMMAND_POOL_NAME_SIZE);
+    dst->name = src->name;
     dst->queue_family_index = src->queue_family_index;
-    dst->primary_buffer_count = src->primary_buffer_count;
-    dst->secondary_buffer_count = src->secondary_buffer_count;
-    for (uint32_t i = 0; i < src->primary_buffer_count; ++i) {
-        dst->primary_buffers[i] = src->primary_buffers[i];
-    }
-    for (uint32_t i = 0; i < dst->secondary_buffer_count; ++i) {
-        dst->secondary_buffers[i] = src->secondary_buffers[i];
-    }
+    dst->reset_enabled = src->reset_enabled;
+    dst->primary_buffers = src->primary_buffers;
+    dst->secondary_buffers = src->secondary_buffers;
 }
 
 VkCommandBuffer command_pool_get_primary_buffer(const CommandPool* pool, uint32_t index) {
-    if (index >= pool->primary_buffer_count) {
-        return VK_NULL_HANDLE;
-    }
-    return pool->primary_buffers[index];
+    return command_pool_buffers_get(&pool->primary_buffers, index);
 }
 
 VkCommandBuffer command_pool_get_secondary_buffer(const CommandPool* pool, uint32_t index) {
-    if (index >= pool->secondary_buffer_count) {
-        return VK_NULL_HANDLE;
-    }
-    return pool->secondary_buffers[index];
+    return command_pool_buffers_get(&pool->secondary_buffers, index);
 }
 
 bool command_pool_add_primary_buffers(CommandPool* pool, uint32_t count) {
-    if (!command_pool_is_init(pool)) {
-        return false;
-    }
-    if (count == 0 || pool->primary_buffer_count + count > COMMAND_POOL_MAX_BUFFERS) {
-        return false;
-    }
+    return command_pool_allocate_buffers(pool, &pool->primary_buffers, VK_COMMAND_BUFFER_LEVEL_PRIMARY, count);
+}
 
-    VkCommandBufferAllocateInfo buffer_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .pNext = NULL,
-        .commandPool = pool->handle,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = count,
-    };
-    VkResult status = vkAllocateCommandBuffers(
-        pool->context->device.handle, &buffer_info, &pool->primary_buffers[pool->primary_buffer_count]);
-    ASSERT_VK_LOG(status, "Unable to allocate primary command buffers", false);
-    pool->primary_buffer_count += count;
+bool command_pool_add_secondary_buffers(CommandPool* pool, uint32_t count) {
+    return command_pool_allocate_buffers(pool, &pool->secondary_buffers, VK_COMMAND_BUFFER_LEVEL_SECONDARY, count);
+}
 
-    return true;
+VkCommandBuffer command_pool_acquire_primary_buffer(CommandPool* pool) {
+    return command_pool_acquire_buffer(pool, &pool->primary_buffers, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 }
 
-bool command_pool_add_secondary_buffers(CommandPool* pool, uint32_t count) {
-    if (!command_pool_is_init(pool)) {
+VkCommandBuffer command_pool_acquire_secondary_buffer(CommandPool* pool) {
+    return command_pool_acquire_buffer(pool, &pool->secondary_buffers, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+}
+
+bool command_pool_release_buffer(CommandPool* pool, VkCommandBuffer buffer, bool secondary) {
+    if (!pool->reset_enabled) {
+        log_error("Command buffers of a pool without reset_enabled can only be released by resetting the pool");
         return false;
     }
-    if (count == 0 || pool->secondary_buffer_count + count > COMMAND_POOL_MAX_BUFFERS) {
-        return false;
+
+    CommandPoolBuffers* buffers = secondary ? &pool->secondary_buffers : &pool->primary_buffers;
+    for (uint32_t i = 0; i < buffers->used_count; ++i) {
+        if (buffers->handles.data[i] == buffer) {
+            // The buffer is reset implicitly by the next vkBeginCommandBuffer
+            SWAP_VALUES(buffers->handles.data[i], buffers->handles.data[buffers->used_count - 1]);
+            --buffers->used_count;
+            return true;
+        }
     }
 
-    VkCommandBufferAllocateInfo buffer_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .pNext = NULL,
-        .commandPool = pool->handle,
-        .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
-        .commandBufferCount = count,
-    };
-    VkResult status = vkAllocateCommandBuffers(pool->context->device.handle, &buffer_info, pool->secondary_buffers);
-    ASSERT_VK_LOG(status, "Unable to allocate secondary command buffers", false);
-    pool->secondary_buffer_count += count;
+    return false;
+}
 
-    return true;
+bool command_pool_has_used_buffers(const CommandPool* pool) {
+    return pool->primary_buffers.used_count > 0 || pool->secondary_buffers.used_count > 0;
 }
 
 void command_pool_free_buffers(CommandPool* pool) {
@@ -143,22 +187,8 @@ void command_pool_free_buffers(CommandPool* pool) {
         return;
     }
 
-    VkDevice device = pool->context->device.handle;
-    if (pool->secondary_buffer_count > 0) {
-        vkFreeCommandBuffers(device, pool->handle, pool->secondary_buffer_count, pool->secondary_buffers);
-        pool->secondary_buffer_count = 0;
-        for (uint32_t i = 0; i < COMMAND_POOL_MAX_BUFFERS; ++i) {
-            pool->secondary_buffers[i] = VK_NULL_HANDLE;
-        }
-    }
-
-    if (pool->primary_buffer_count > 0) {
-        vkFreeCommandBuffers(device, pool->handle, pool->primary_buffer_count, pool->primary_buffers);
-        pool->primary_buffer_count = 0;
-        for (uint32_t i = 0; i < COMMAND_POOL_MAX_BUFFERS; ++i) {
-            pool->primary_buffers[i] = VK_NULL_HANDLE;
-        }
-    }
+    command_pool_free_level_buffers(pool, &pool->secondary_buffers);
+    command_pool_free_level_buffers(pool, &pool->primary_buffers);
 }
 
 bool command_pool_reset(CommandPool* pool, bool release_resources) {
@@ -173,6 +203,8 @@ bool command_pool_reset(CommandPool* pool, bool release_resources) {
 
     VkResult status = vkResetCommandPool(pool->context->device.handle, pool->handle, flags);
     ASSERT_VK_LOG(status, "Unable to reset command pool", false);
+    pool->primary_buffers.used_count = 0;
+    pool->secondary_buffers.used_count = 0;
 
     return true;
 }
@@ -181,6 +213,9 @@ void command_pool_destroy(CommandPool* pool) {
     if (!command_pool_is_init(pool)) {
         return;
     }
+    // Destroying the pool frees its buffers, only the lists are left
     vkDestroyCommandPool(pool->context->device.handle, pool->handle, NULL);
+    vector_destroy(&pool->primary_buffers.handles);
+    vector_destroy(&pool->secondary_buffers.handles);
     command_pool_clear(pool);
 }
@@ -5,11 +5,13 @@
 #include <stdint.h>
 #include <vulkan/vulkan.h>
 
+#include "../../../core/collections/vector.h"
+#include "../../../core/string/string_atom.h"
 #include "../context/context.h"
 
 #define COMMAND_POOL_NAME_SIZE 256
-#define COMMAND_POOL_MAX_BUFFERS 10
-#define COMMAND_POOL_AVAILABLE_KEY "_AVAIL"
+// Buffers allocated at once when an acquire finds no free buffer
+#define COMMAND_POOL_BUFFER_CHUNK_SIZE 8
 
 typedef struct CommandPoolInitInfo {
     char name[COMMAND_POOL_NAME_SIZE];
@@ -20,29 +22,46 @@ typedef struct CommandPoolInitInfo {
     bool protected;
 } CommandPoolInitInfo;
 
+typedef struct CommandBufferList VECTOR(VkCommandBuffer) CommandBufferList;
+
+// Buffers of one level. The ones before used_count are handed out, the rest are the free list acquire takes from
+typedef struct CommandPoolBuffers {
+    CommandBufferList handles;
+    uint32_t used_count;
+} CommandPoolBuffers;
+
 typedef struct CommandPool {
     VkCommandPool handle;
     const Context* context;
 
-    char name[COMMAND_POOL_NAME_SIZE];
+    // STRING_ATOM_NONE for unnamed pools, only named pools can be added to the cache
+    StringAtom name;
     uint32_t queue_family_index;
+    // Buffers can only go back to the free list one by one when the pool lets them be reset individually
+    bool reset_enabled;
 
-    VkCommandBuffer primary_buffers[COMMAND_POOL_MAX_BUFFERS];
-    uint32_t primary_buffer_count;
-
-    VkCommandBuffer secondary_buffers[COMMAND_POOL_MAX_BUFFERS];
-    uint32_t secondary_buffer_count;
+    CommandPoolBuffers primary_buffers;
+    CommandPoolBuffers secondary_buffers;
 } CommandPool;
 
 void command_pool_clear(CommandPool* pool);
 bool command_pool_init(CommandPool* pool, const Context* context, const CommandPoolInitInfo* info);
 bool command_pool_is_init(const CommandPool* pool);
+// Takes over the buffer arrays of src, only dst may be destroyed afterwards
 void command_pool_copy(const CommandPool* src, CommandPool* dst, bool destroy_dst);
 VkCommandBuffer command_pool_get_primary_buffer(const CommandPool* pool, uint32_t index);
 VkCommandBuffer command_pool_get_secondary_buffer(const CommandPool* pool, uint32_t index);
 bool command_pool_add_primary_buffers(CommandPool* pool, uint32_t count);
 bool command_pool_add_secondary_buffers(CommandPool* pool, uint32_t count);
+// Hands out a free buffer, allocating COMMAND_POOL_BUFFER_CHUNK_SIZE more when there is none. Buffers become free
+// again on reset or release. Acquire and release reorder the buffers, indices of earlier get calls do not hold
+VkCommandBuffer command_pool_acquire_primary_buffer(CommandPool* pool);
+VkCommandBuffer command_pool_acquire_secondary_buffer(CommandPool* pool);
+// Only for pools with reset_enabled, the buffer must not be pending execution
+bool command_pool_release_buffer(CommandPool* pool, VkCommandBuffer buffer, bool secondary);
+bool command_pool_has_used_buffers(const CommandPool* pool);
 void command_pool_free_buffers(CommandPool* pool);
+// Every buffer goes back to the free list
 bool command_pool_reset(CommandPool* pool, bool release_resources);
 void command_pool_destroy(CommandPool* pool);
 
@@ -1,7 +1,5 @@
 #include "./command_pool_cache.h"
 
-#include "../../../core/string/string.h"
-
 void command_pool_cache_clear(CommandPoolCache* cache) {
     for (uint32_t i = 0; i < COMMAND_POOL_CACHE_MAX_POOLS; ++i) {
         command_pool_clear(&cache->items[i]);
@@ -9,11 +7,11 @@ void command_pool_cache_clear(CommandPoolCache* cache) {
 }
 
 bool command_pool_cache_add(CommandPoolCache* cache, const CommandPool* pool) {
-    if (command_pool_cache_has(cache, pool->name)) {
+    if (!string_atom_is_valid(pool->name) || command_pool_cache_has(cache, pool->name)) {
         return false;
     }
     for (uint32_t i = 0; i < COMMAND_POOL_CACHE_MAX_POOLS; ++i) {
-        if (string_equals(cache->items[i].name, COMMAND_POOL_AVAILABLE_KEY)) {
+        if (!string_atom_is_valid(cache->items[i].name)) {
             command_pool_copy(pool, &cache->items[i], false);
             return true;
         }
@@ -21,32 +19,37 @@ bool command_pool_cache_add(CommandPoolCache* cache, const CommandPool* pool) {
     return false;
 }
 
-CommandPool* command_pool_cache_get(CommandPoolCache* cache, const char* name) {
+CommandPool* command_pool_cache_get(CommandPoolCache* cache, StringAtom name) {
+    if (!string_atom_is_valid(name)) {
+        return NULL;
+    }
     for (uint32_t i = 0; i < COMMAND_POOL_CACHE_MAX_POOLS; ++i) {
-        if (string_equals(cache->items[i].name, name)) {
+        if (cache->items[i].name == name) {
             return &cache->items[i];
         }
     }
     return NULL;
 }
 
-bool command_pool_cache_has(const CommandPoolCache* cache, const char* name) {
+bool command_pool_cache_has(const CommandPoolCache* cache, StringAtom name) {
+    if (!string_atom_is_valid(name)) {
+        return false;
+    }
     for (uint32_t i = 0; i < COMMAND_POOL_CACHE_MAX_POOLS; ++i) {
-        if (string_equals(cache->items[i].name, name)) {
+        if (cache->items[i].name == name) {
             return true;
         }
     }
     return false;
 }
 
-bool command_pool_cache_remove(CommandPoolCache* cache, const char* name) {
-    for (uint32_t i = 0; i < COMMAND_POOL_CACHE_MAX_POOLS; ++i) {
-        if (string_equals(cache->items[i].name, name)) {
-            command_pool_destroy(&cache->items[i]);
-            return true;
-        }
+bool command_pool_cache_remove(CommandPoolCache* cache, StringAtom name) {
+    CommandPool* pool = command_pool_cache_get(cache, name);
+    if (pool == NULL) {
+        return false;
     }
-    return false;
+    command_pool_destroy(pool);
+    return true;
 }
 
 void command_pool_cache_destroy(CommandPoolCache* cache) {
@@ -6,7 +6,6 @@
 #include "./command_pool.h"
 
 #define COMMAND_POOL_CACHE_MAX_POOLS 32
-#define CACHE_KEY_AVAILABLE "_AVAIL"
 
 typedef struct CommandPoolCache {
     CommandPool items[COMMAND_POOL_CACHE_MAX_POOLS];
@@ -14,9 +13,9 @@ typedef struct CommandPoolCache {
 
 void command_pool_cache_clear(CommandPoolCache* cache);
 bool command_pool_cache_add(CommandPoolCache* cache, const CommandPool* pool);
-CommandPool* command_pool_cache_get(CommandPoolCache* cache, const char* name);
-bool command_pool_cache_has(const CommandPoolCache* cache, const char* name);
-bool command_pool_cache_remove(CommandPoolCache* cache, const char* name);
+CommandPool* command_pool_cache_get(CommandPoolCache* cache, StringAtom name);
+bool command_pool_cache_has(const CommandPoolCache* cache, StringAtom name);
+bool command_pool_cache_remove(CommandPoolCache* cache, StringAtom name);
 void command_pool_cache_destroy(CommandPoolCache* cache);
 
 #endif
@@ -256,7 +256,9 @@ typedef enum RenderingContextError {
     RENDERING_CONTEXT_QUEUE_SUBMIT_FAILED,
     RENDERING_CONTEXT_PRESENT_FAILED,
     RENDERING_CONTEXT_REFRESHING,
+    RENDERING_CONTEXT_FRAME_NOT_SUBMITTED,
     TOO_MANY_FRAMES_REQUESTED,
+    TOO_MANY_RECORDING_THREADS_REQUESTED,
 } RenderingContextError;
 
 static inline const char* rendering_context_error_to_string(RenderingContextError err) {
@@ -279,8 +281,12 @@ static inline const char* rendering_context_error_to_string(RenderingContextErro
             return "RENDERING_CONTEXT_PRESENT_FAILED";
         case TOO_MANY_FRAMES_REQUESTED:
             return "TOO_MANY_FRAMES_REQUESTED";
+        case TOO_MANY_RECORDING_THREADS_REQUESTED:
+            return "TOO_MANY_RECORDING_THREADS_REQUESTED";
         case RENDERING_CONTEXT_REFRESHING:
             return "RENDERING_CONTEXT_REFRESHING";
+        case RENDERING_CONTEXT_FRAME_NOT_SUBMITTED:
+            return "RENDERING_CONTEXT_FRAME_NOT_SUBMITTED";
         default:
             return "Uknown";
     }
@@ -300,6 +306,13 @@ typedef enum MemoryContextError {
     MEMORY_CONTEXT_INVALID_BUFFER_SIZE,
     MEMORY_CONTEXT_BUFFER_INIT_ERROR,
     MEMORY_CONTEXT_CACHE_FULL,
+    MEMORY_CONTEXT_BUFFER_BIND_ERROR,
+    MEMORY_CONTEXT_COMMAND_BUFFER_ERROR,
+    MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED,
+    MEMORY_CONTEXT_DEFRAGMENTATION_IN_PROGRESS,
+    MEMORY_CONTEXT_OUT_OF_BUDGET,
+    MEMORY_CONTEXT_INVALID_BUFFER_HANDLE,
+    MEMORY_CONTEXT_STAGING_FULL,
 } MemoryContextError;
 
 static inline const char* memory_context_error_to_string(MemoryContextError err) {
@@ -328,6 +341,20 @@ static inline const char* memory_context_error_to_string(MemoryContextError err)
             return "MEMORY_CONTEXT_BUFFER_INIT_ERROR";
         case MEMORY_CONTEXT_CACHE_FULL:
             return "MEMORY_CONTEXT_CACHE_FULL";
+        case MEMORY_CONTEXT_BUFFER_BIND_ERROR:
+            return "MEMORY_CONTEXT_BUFFER_BIND_ERROR";
+        case MEMORY_CONTEXT_COMMAND_BUFFER_ERROR:
+            return "MEMORY_CONTEXT_COMMAND_BUFFER_ERROR";
+        case MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED:
+            return "MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED";
+        case MEMORY_CONTEXT_DEFRAGMENTATION_IN_PROGRESS:
+            return "MEMORY_CONTEXT_DEFRAGMENTATION_IN_PROGRESS";
+        case MEMORY_CONTEXT_OUT_OF_BUDGET:
+            return "MEMORY_CONTEXT_OUT_OF_BUDGET";
+        case MEMORY_CONTEXT_INVALID_BUFFER_HANDLE:
+            return "MEMORY_CONTEXT_INVALID_BUFFER_HANDLE";
+        case MEMORY_CONTEXT_STAGING_FULL:
+            return "MEMORY_CONTEXT_STAGING_FULL";
         default:
             return "Uknown";
     }
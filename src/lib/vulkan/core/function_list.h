@@ -27,6 +27,7 @@ INSTANCE_LEVEL_VK_FUNCTION(vkGetPhysicalDeviceFeatures2)
 INSTANCE_LEVEL_VK_FUNCTION(vkGetPhysicalDeviceProperties)
 INSTANCE_LEVEL_VK_FUNCTION(vkGetPhysicalDeviceQueueFamilyProperties)
 INSTANCE_LEVEL_VK_FUNCTION(vkGetPhysicalDeviceMemoryProperties)
+INSTANCE_LEVEL_VK_FUNCTION(vkGetPhysicalDeviceMemoryProperties2)
 INSTANCE_LEVEL_VK_FUNCTION(vkGetPhysicalDeviceFormatProperties)
 INSTANCE_LEVEL_VK_FUNCTION(vkGetPhysicalDeviceImageFormatProperties)
 INSTANCE_LEVEL_VK_FUNCTION(vkCreateDevice)
@@ -66,6 +67,7 @@ DEVICE_LEVEL_VK_FUNCTION(vkGetBufferMemoryRequirements)
 DEVICE_LEVEL_VK_FUNCTION(vkGetBufferMemoryRequirements2)
 DEVICE_LEVEL_VK_FUNCTION(vkAllocateMemory)
 DEVICE_LEVEL_VK_FUNCTION(vkBindBufferMemory)
+DEVICE_LEVEL_VK_FUNCTION(vkBindBufferMemory2)
 DEVICE_LEVEL_VK_FUNCTION(vkCmdPipelineBarrier)
 DEVICE_LEVEL_VK_FUNCTION(vkCreateImage)
 DEVICE_LEVEL_VK_FUNCTION(vkGetImageMemoryRequirements)
@@ -90,8 +92,11 @@ DEVICE_LEVEL_VK_FUNCTION(vkCreateSemaphore)
 DEVICE_LEVEL_VK_FUNCTION(vkCreateFence)
 DEVICE_LEVEL_VK_FUNCTION(vkWaitForFences)
 DEVICE_LEVEL_VK_FUNCTION(vkResetFences)
+DEVICE_LEVEL_VK_FUNCTION(vkGetFenceStatus)
 DEVICE_LEVEL_VK_FUNCTION(vkDestroyFence)
 DEVICE_LEVEL_VK_FUNCTION(vkDestroySemaphore)
+DEVICE_LEVEL_VK_FUNCTION(vkWaitSemaphores)
+DEVICE_LEVEL_VK_FUNCTION(vkGetSemaphoreCounterValue)
 DEVICE_LEVEL_VK_FUNCTION(vkResetCommandBuffer)
 DEVICE_LEVEL_VK_FUNCTION(vkFreeCommandBuffers)
 DEVICE_LEVEL_VK_FUNCTION(vkResetCommandPool)
@@ -2,7 +2,7 @@
 
 #include "../../../core/memory/memory.h"
 #include "../../../core/utils/macro.h"
-#include "../../core/functions.h"
+#include "../../utils/memory.h"
 
 static bool vulkan_memory_block_is_on_same_page(
     VkDeviceSize ra_offset, VkDeviceSize ra_size, VkDeviceSize rb_offset, VkDeviceSize page_size) {
@@ -40,28 +40,277 @@ static bool vulkan_memory_block_has_granularity_conflict(VulkanAllocationType ty
     }
 }
 
+static inline uint32_t vulkan_memory_block_msb(uint64_t value) { return 63 - __builtin_clzll(value); }
+
+static inline uint32_t vulkan_memory_block_lsb(uint64_t value) { return __builtin_ctzll(value); }
+
+static void vulkan_memory_block_mapping_insert(VkDeviceSize size, uint32_t* fl, uint32_t* sl) {
+    if (size < VULKAN_MEMORY_BLOCK_SL_INDEX_COUNT) {
+        *fl = 0;
+        *sl = (uint32_t)size;
+        return;
+    }
+
+    uint32_t msb = vulkan_memory_block_msb(size);
+    *fl = msb - VULKAN_MEMORY_BLOCK_SL_INDEX_LOG2 + 1;
+    *sl = (uint32_t)(size >> (msb - VULKAN_MEMORY_BLOCK_SL_INDEX_LOG2)) ^ VULKAN_MEMORY_BLOCK_SL_INDEX_COUNT;
+}
+
+static void vulkan_memory_block_mapping_search(VkDeviceSize size, uint32_t* fl, uint32_t* sl) {
+    // Round up to the next size class so every chunk in the found list is large enough
+    if (size >= VULKAN_MEMORY_BLOCK_SL_INDEX_COUNT) {
+        size += (1ULL << (vulkan_memory_block_msb(size) - VULKAN_MEMORY_BLOCK_SL_INDEX_LOG2)) - 1;
+    }
+    vulkan_memory_block_mapping_insert(size, fl, sl);
+}
+
+static void vulkan_memory_block_insert_free_chunk(VulkanMemoryBlock* block, VulkanMemoryBlockChunk* chunk) {
+    uint32_t fl, sl;
+    vulkan_memory_block_mapping_insert(chunk->size, &fl, &sl);
+
+    VulkanMemoryBlockChunk* head = block->free_lists[fl][sl];
+    chunk->prev_free = NULL;
+    chunk->next_free = head;
+    if (head != NULL) {
+        head->prev_free = chunk;
+    }
+
+    block->free_lists[fl][sl] = chunk;
+    block->fl_bitmap |= 1ULL << fl;
+    block->sl_bitmap[fl] |= 1U << sl;
+}
+
+static void vulkan_memory_block_remove_free_chunk(VulkanMemoryBlock* block, VulkanMemoryBlockChunk* chunk) {
+    uint32_t fl, sl;
+    vulkan_memory_block_mapping_insert(chunk->size, &fl, &sl);
+
+    if (chunk->next_free != NULL) {
+        chunk->next_free->prev_free = chunk->prev_free;
+    }
+    if (chunk->prev_free != NULL) {
+        chunk->prev_free->next_free = chunk->next_free;
+    } else {
+        block->free_lists[fl][sl] = chunk->next_free;
+        if (block->free_lists[fl][sl] == NULL) {
+            block->sl_bitmap[fl] &= ~(1U << sl);
+            if (block->sl_bitmap[fl] == 0) {
+                block->fl_bitmap &= ~(1ULL << fl);
+            }
+        }
+    }
+
+    chunk->prev_free = NULL;
+    chunk->next_free = NULL;
+}
+
+static VulkanMemoryBlockChunk* vulkan_memory_block_find_free_chunk(const VulkanMemoryBlock* block, VkDeviceSize size) {
+    uint32_t fl, sl;
+    vulkan_memory_block_mapping_search(size, &fl, &sl);
+    if (fl >= VULKAN_MEMORY_BLOCK_FL_INDEX_COUNT) {
+        return NULL;
+    }
+
+    uint32_t sl_bitmap = block->sl_bitmap[fl] & (~0U << sl);
+    if (sl_bitmap == 0) {
+        uint64_t fl_bitmap = block->fl_bitmap & (~0ULL << (fl + 1));
+        if (fl_bitmap == 0) {
+            return NULL;
+        }
+        fl = vulkan_memory_block_lsb(fl_bitmap);
+        sl_bitmap = block->sl_bitmap[fl];
+    }
+    sl = vulkan_memory_block_lsb(sl_bitmap);
+
+    return block->free_lists[fl][sl];
+}
+
+static bool vulkan_memory_block_chunk_fits(
+    const VulkanMemoryBlockChunk* chunk, const VulkanAllocationInfo* alloc_info, VkDeviceSize* out_offset) {
+    if (chunk == NULL) {
+        return false;
+    }
+
+    VkDeviceSize offset = ALIGN(chunk->offset, (VkDeviceSize)MAX(alloc_info->align, 1));
+
+    // Check for linear/optimal granularity conflict with previous allocation
+    const VulkanMemoryBlockChunk* prev = chunk->prev;
+    if (prev != NULL && alloc_info->granularity > 1) {
+        if (vulkan_memory_block_is_on_same_page(prev->offset, prev->size, offset, alloc_info->granularity)) {
+            if (vulkan_memory_block_has_granularity_conflict(prev->type, alloc_info->allocation_type)) {
+                offset = ALIGN(offset, alloc_info->granularity);
+            }
+        }
+    }
+
+    if (offset + alloc_info->size > chunk->offset + chunk->size) {
+        return false;
+    }
+
+    const VulkanMemoryBlockChunk* next = chunk->next;
+    if (next != NULL && alloc_info->granularity > 1) {
+        if (vulkan_memory_block_is_on_same_page(offset, alloc_info->size, next->offset, alloc_info->granularity)) {
+            if (vulkan_memory_block_has_granularity_conflict(alloc_info->allocation_type, next->type)) {
+                return false;
+            }
+        }
+    }
+
+    *out_offset = offset;
+    return true;
+}
+
+static VulkanMemoryBlockChunk* vulkan_memory_block_find_fit(
+    const VulkanMemoryBlock* block, const VulkanAllocationInfo* alloc_info, VkDeviceSize* out_offset) {
+    VkDeviceSize search_size = (VkDeviceSize)alloc_info->size + MAX(alloc_info->align, 1) - 1;
+
+    VulkanMemoryBlockChunk* chunk = vulkan_memory_block_find_free_chunk(block, search_size);
+    if (vulkan_memory_block_chunk_fits(chunk, alloc_info, out_offset)) {
+        return chunk;
+    }
+
+    // Leave room for the granularity padding on both sides of the allocation
+    if (alloc_info->granularity > 1) {
+        chunk = vulkan_memory_block_find_free_chunk(block, search_size + 2 * (alloc_info->granularity - 1));
+        if (vulkan_memory_block_chunk_fits(chunk, alloc_info, out_offset)) {
+            return chunk;
+        }
+    }
+
+    // The rounded up searches skip chunks from the exact size class, give its head a chance before failing
+    uint32_t fl, sl;
+    vulkan_memory_block_mapping_insert(alloc_info->size, &fl, &sl);
+    if (fl < VULKAN_MEMORY_BLOCK_FL_INDEX_COUNT) {
+        chunk = block->free_lists[fl][sl];
+        if (vulkan_memory_block_chunk_fits(chunk, alloc_info, out_offset)) {
+            return chunk;
+        }
+    }
+
+    return NULL;
+}
+
+static bool vulkan_memory_block_chunk_pool_grow(VulkanMemoryBlockChunkPool* pool) {
+    VulkanMemoryBlockChunkSlab* slab = mem_alloc(sizeof(VulkanMemoryBlockChunkSlab));
+    ASSERT_ALLOC(slab, "Unable to allocate memory block chunk slab", false);
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_count += 1;
+
+    for (uint32_t i = VULKAN_MEMORY_BLOCK_CHUNK_SLAB_SIZE; i > 0; --i) {
+        VulkanMemoryBlockChunk* node = &slab->chunks[i - 1];
+        vulkan_memory_block_chunk_clear(node);
+        node->next_free = pool->free_nodes;
+        pool->free_nodes = node;
+    }
+
+    return true;
+}
+
+static void vulkan_memory_block_chunk_pool_destroy(VulkanMemoryBlockChunkPool* pool) {
+    VulkanMemoryBlockChunkSlab* slab = pool->slabs;
+    while (slab != NULL) {
+        VulkanMemoryBlockChunkSlab* next = slab->next;
+        mem_free(slab);
+        slab = next;
+    }
+    vulkan_memory_block_chunk_pool_clear(pool);
+}
+
+static VulkanMemoryBlockChunk* vulkan_memory_block_create_chunk(VulkanMemoryBlock* block) {
+    VulkanMemoryBlockChunkPool* pool = &block->chunk_pool;
+    if (pool->free_nodes == NULL && !vulkan_memory_block_chunk_pool_grow(pool)) {
+        return NULL;
+    }
+
+    VulkanMemoryBlockChunk* chunk = pool->free_nodes;
+    pool->free_nodes = chunk->next_free;
+    pool->used_count += 1;
+    pool->peak_used_count = MAX(pool->peak_used_count, pool->used_count);
+
+    // The id survives in the pool so stale allocations pointing at a recycled node are still rejected on free
+    uint32_t id = chunk->id;
+    vulkan_memory_block_chunk_clear(chunk);
+    chunk->id = id;
+
+    return chunk;
+}
+
+static void vulkan_memory_block_destroy_chunk(VulkanMemoryBlock* block, VulkanMemoryBlockChunk* chunk) {
+    VulkanMemoryBlockChunkPool* pool = &block->chunk_pool;
+
+    chunk->type = VULKAN_ALLOCATION_TYPE_FREE;
+    chunk->prev = NULL;
+    chunk->next = NULL;
+    chunk->prev_free = NULL;
+    chunk->next_free = pool->free_nodes;
+    pool->free_nodes = chunk;
+    pool->used_count -= 1;
+}
+
+static void vulkan_memory_block_split_chunk(
+    VulkanMemoryBlock* block, VulkanMemoryBlockChunk* chunk, VulkanMemoryBlockChunk* rest, VkDeviceSize size) {
+    rest->id = block->next_block_id++;
+    rest->offset = chunk->offset + size;
+    rest->size = chunk->size - size;
+    rest->type = VULKAN_ALLOCATION_TYPE_FREE;
+
+    rest->prev = chunk;
+    rest->next = chunk->next;
+    if (chunk->next != NULL) {
+        chunk->next->prev = rest;
+    }
+    chunk->next = rest;
+    chunk->size = size;
+}
+
+static void vulkan_memory_block_merge_chunks(
+    VulkanMemoryBlock* block, VulkanMemoryBlockChunk* left, VulkanMemoryBlockChunk* right) {
+    left->size += right->size;
+    left->next = right->next;
+    if (right->next != NULL) {
+        right->next->prev = left;
+    }
+    vulkan_memory_block_destroy_chunk(block, right);
+}
+
 MemoryContextError vulkan_memory_block_init(VulkanMemoryBlock* block, const VulkanMemoryBlockInfo* info) {
     vulkan_memory_block_clear(block);
     block->device = info->device;
+    block->backend = info->backend;
     block->memory_type_index = info->memory_type_index;
     block->usage = info->usage;
     block->size = info->size;
+    block->is_dedicated = info->dedicated;
 
     if (block->memory_type_index == UINT32_MAX) {
         return MEMORY_CONTEXT_INVALID_MEMORY_INDEX;
     }
+    if (block->size == 0 || block->size >= (1ULL << VULKAN_MEMORY_BLOCK_MAX_SIZE_LOG2)) {
+        log_error("Unsupported memory block size: %lu", (unsigned long)block->size);
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
 
+    VkMemoryDedicatedAllocateInfo dedicated_info = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+        .pNext = NULL,
+        .image = VK_NULL_HANDLE,
+        .buffer = info->dedicated_buffer,
+    };
     VkMemoryAllocateInfo mem_info = {
         .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
         .pNext = NULL,
         .allocationSize = block->size,
         .memoryTypeIndex = block->memory_type_index,
     };
+    if (info->dedicated && info->dedicated_buffer != VK_NULL_HANDLE) {
+        mem_info.pNext = &dedicated_info;
+    }
 
     VkDeviceMemory memory = VK_NULL_HANDLE;
     VkResult status;
 
-    status = vkAllocateMemory(block->device->handle, &mem_info, NULL, &memory);
+    status = vulkan_memory_backend_allocate_memory(block->backend, block->device->handle, &mem_info, &memory);
     ASSERT_VK_LOG(status, "Unable to allocate memory for the block", MEMORY_CONTEXT_ALLOCATION_ERROR);
 
     if (memory == VK_NULL_HANDLE) {
@@ -69,18 +318,20 @@ MemoryContextError vulkan_memory_block_init(VulkanMemoryBlock* block, const Vulk
         return MEMORY_CONTEXT_ALLOCATION_ERROR;
     }
     block->device_memory_handle = memory;
+    block->is_coherent = memory_utils_is_memory_type_coherent(block->device, block->memory_type_index);
 
     if (vulkan_memory_block_is_host_visible(block)) {
-        status = vkMapMemory(block->device->handle, memory, 0, block->size, 0, (void**)&block->data);
+        status = vulkan_memory_backend_map_memory(
+            block->backend, block->device->handle, memory, 0, block->size, (void**)&block->data);
         ASSERT_VK_LOG(status, "Unable to map the block memory", MEMORY_CONTEXT_MAPPING_ERROR);
         block->is_data_mapped = true;
     }
 
-    block->head = mem_alloc(sizeof(VulkanMemoryBlockChunk));
+    block->head = vulkan_memory_block_create_chunk(block);
     ASSERT_ALLOC(block->head, "Unable to create memory block's head", MEMORY_CONTEXT_INIT_ERROR);
-    vulkan_memory_block_chunk_clear(block->head);
     block->head->id = block->next_block_id++;
     block->head->size = block->size;
+    vulkan_memory_block_insert_free_chunk(block, block->head);
 
     return MEMORY_CONTEXT_SUCCESS;
 }
@@ -95,162 +346,148 @@ MemoryContextError vulkan_memory_block_allocate(
         return MEMORY_CONTEXT_LOW_FREE_BLOCK_SPACE;
     }
 
-    VulkanMemoryBlockChunk* iter = NULL;
-    VulkanMemoryBlockChunk* best_fit = NULL;
-    VulkanMemoryBlockChunk* prev = NULL;
-
-    VkDeviceSize padding = 0;
     VkDeviceSize offset = 0;
-    VkDeviceSize aligned_size = 0;
-
-    for (iter = block->head; iter != NULL; prev = iter, iter = iter->next) {
-        if (iter->type != VULKAN_ALLOCATION_TYPE_FREE) {
-            continue;
-        }
-        if (iter->size < alloc_info->size) {
-            continue;
-        }
-
-        offset = ALIGN(iter->offset, alloc_info->align);
-
-        // Check for linear/optimal granularity conflict with previous allocation
-        if (prev != NULL && alloc_info->granularity > 1) {
-            if (vulkan_memory_block_is_on_same_page(prev->offset, prev->size, offset, alloc_info->granularity)) {
-                if (vulkan_memory_block_has_granularity_conflict(prev->type, alloc_info->allocation_type)) {
-                    offset = ALIGN(offset, alloc_info->granularity);
-                }
-            }
-        }
+    VulkanMemoryBlockChunk* chunk = vulkan_memory_block_find_fit(block, alloc_info, &offset);
 
-        padding = offset - iter->offset;
-        aligned_size = alloc_info->size + padding;
+    if (chunk == NULL) {
+        return MEMORY_CONTEXT_UNSUITABLE_BLOCK;
+    }
 
-        if (iter->size < aligned_size) {
-            continue;
-        }
-        if (block->size <= aligned_size + block->allocated) {
-            return MEMORY_CONTEXT_LOW_FREE_BLOCK_SPACE;
-        }
+    // Reserve the split chunks up front so a failed allocation leaves the block untouched
+    VkDeviceSize padding = offset - chunk->offset;
+    VkDeviceSize remainder = chunk->size - padding - alloc_info->size;
 
-        if (alloc_info->granularity > 1 && iter->next != NULL) {
-            if (vulkan_memory_block_is_on_same_page(
-                    offset, alloc_info->size, iter->next->offset, alloc_info->granularity)) {
-                if (vulkan_memory_block_has_granularity_conflict(alloc_info->allocation_type, iter->next->type)) {
-                    continue;
-                }
+    VulkanMemoryBlockChunk* padding_chunk = NULL;
+    VulkanMemoryBlockChunk* remainder_chunk = NULL;
+    if (padding > 0) {
+        padding_chunk = vulkan_memory_block_create_chunk(block);
+        ASSERT_ALLOC(padding_chunk, "Unable to allocate memory to split the block", MEMORY_CONTEXT_INIT_ERROR);
+    }
+    if (remainder > 0) {
+        remainder_chunk = vulkan_memory_block_create_chunk(block);
+        if (remainder_chunk == NULL) {
+            if (padding_chunk != NULL) {
+                vulkan_memory_block_destroy_chunk(block, padding_chunk);
             }
+            log_error("Unable to allocate memory to split the block");
+            return MEMORY_CONTEXT_INIT_ERROR;
         }
-
-        best_fit = iter;
-        break;
     }
 
-    if (best_fit == NULL) {
-        return MEMORY_CONTEXT_UNSUITABLE_BLOCK;
-    }
-
-    // Split the free space into a new block chunk
-    if (best_fit->size > alloc_info->size) {
-        VulkanMemoryBlockChunk* chunk = mem_alloc(sizeof(VulkanMemoryBlockChunk));
-        ASSERT_ALLOC(chunk, "Unable to allocate memory to split the block", MEMORY_CONTEXT_INIT_ERROR);
-        vulkan_memory_block_chunk_clear(chunk);
-
-        VulkanMemoryBlockChunk* next = best_fit->next;
-
-        chunk->id = block->next_block_id++;
-        chunk->prev = best_fit;
-        best_fit->next = chunk;
+    vulkan_memory_block_remove_free_chunk(block, chunk);
 
-        chunk->next = next;
-        if (next != NULL) {
-            next->prev = chunk;
-        }
-
-        chunk->size = best_fit->size - aligned_size;
-        chunk->offset = offset + alloc_info->size;
-        chunk->type = VULKAN_ALLOCATION_TYPE_FREE;
+    // Alignment padding stays in the block as a free chunk of its own
+    if (padding_chunk != NULL) {
+        vulkan_memory_block_split_chunk(block, chunk, padding_chunk, padding);
+        vulkan_memory_block_insert_free_chunk(block, chunk);
+        chunk = padding_chunk;
+    }
+    if (remainder_chunk != NULL) {
+        vulkan_memory_block_split_chunk(block, chunk, remainder_chunk, alloc_info->size);
+        vulkan_memory_block_insert_free_chunk(block, remainder_chunk);
     }
 
-    best_fit->type = alloc_info->allocation_type;
-    best_fit->size = alloc_info->size;
+    chunk->id = block->next_block_id++;
+    chunk->type = alloc_info->allocation_type;
+    chunk->padding = padding;
 
-    block->allocated += aligned_size;
+    block->allocated += chunk->size;
 
-    allocation->size = best_fit->size;
-    allocation->id = best_fit->id;
+    allocation->size = chunk->size;
+    allocation->id = chunk->id;
+    allocation->chunk = chunk;
     allocation->device_memory_handle = block->device_memory_handle;
     if (vulkan_memory_block_is_host_visible(block)) {
         allocation->data = block->data + offset;
     }
     allocation->offset = offset;
     allocation->block = block;
+    allocation->is_coherent = block->is_coherent;
+    allocation->memory_size = block->size;
 
     return MEMORY_CONTEXT_SUCCESS;
 }
 
 void vulkan_memory_block_free_allocation(VulkanMemoryBlock* block, VulkanAllocation* allocation) {
-    VulkanMemoryBlockChunk* iter = NULL;
-    for (iter = block->head; iter != NULL; iter = iter->next) {
-        if (iter->id == allocation->id) {
-            break;
-        }
-    }
+    VulkanMemoryBlockChunk* chunk = allocation->chunk;
 
-    if (iter == NULL) {
+    if (chunk == NULL || allocation->block != block || chunk->id != allocation->id ||
+        chunk->type == VULKAN_ALLOCATION_TYPE_FREE) {
         log_warning("Tried to free an unknown allocation");
         return;
     }
 
-    iter->type = VULKAN_ALLOCATION_TYPE_FREE;
+    block->allocated -= chunk->size;
+    chunk->type = VULKAN_ALLOCATION_TYPE_FREE;
+    chunk->padding = 0;
 
     // Merge with the previous block chunk if it's empty
-    if (iter->prev != NULL && iter->prev->type == VULKAN_ALLOCATION_TYPE_FREE) {
-        VulkanMemoryBlockChunk* prev = iter->prev;
-
-        prev->next = iter->next;
-        if (iter->next != NULL) {
-            iter->next->prev = prev;
-        }
-        prev->size += iter->size;
-        mem_free(iter);
-        iter = prev;
+    if (chunk->prev != NULL && chunk->prev->type == VULKAN_ALLOCATION_TYPE_FREE) {
+        VulkanMemoryBlockChunk* prev = chunk->prev;
+        vulkan_memory_block_remove_free_chunk(block, prev);
+        vulkan_memory_block_merge_chunks(block, prev, chunk);
+        chunk = prev;
     }
 
     // Merge with the next block chunk if it's empty
-    if (iter->next != NULL && iter->next == VULKAN_ALLOCATION_TYPE_FREE) {
-        VulkanMemoryBlockChunk* next = iter->next;
-        if (next->next != NULL) {
-            next->next->prev = iter;
-        }
-        iter->next = next->next;
-        iter->size += next->size;
-        mem_free(next);
+    if (chunk->next != NULL && chunk->next->type == VULKAN_ALLOCATION_TYPE_FREE) {
+        VulkanMemoryBlockChunk* next = chunk->next;
+        vulkan_memory_block_remove_free_chunk(block, next);
+        vulkan_memory_block_merge_chunks(block, chunk, next);
     }
 
-    block->allocated -= allocation->size;
+    vulkan_memory_block_insert_free_chunk(block, chunk);
 }
 
 void vulkan_memory_block_destroy(VulkanMemoryBlock* block) {
+    mutex_destroy(&block->mutex);
+
     if (block->device == NULL) {
         return;
     }
 
     if (block->is_data_mapped) {
-        vkUnmapMemory(block->device->handle, block->device_memory_handle);
+        vulkan_memory_backend_unmap_memory(block->backend, block->device->handle, block->device_memory_handle);
     }
 
     if (block->device_memory_handle != VK_NULL_HANDLE) {
-        vkFreeMemory(block->device->handle, block->device_memory_handle, NULL);
+        vulkan_memory_backend_free_memory(block->backend, block->device->handle, block->device_memory_handle);
     }
 
-    VulkanMemoryBlockChunk* prev = NULL;
-    VulkanMemoryBlockChunk* current = block->head;
-
-    while (current != NULL) {
-        prev = current;
-        current = current->next;
-        mem_free(prev);
-    }
+    vulkan_memory_block_chunk_pool_destroy(&block->chunk_pool);
 
     vulkan_memory_block_clear(block);
 }
+
+void vulkan_memory_block_get_chunk_pool_stats(const VulkanMemoryBlock* block, VulkanMemoryBlockChunkPoolStats* stats) {
+    const VulkanMemoryBlockChunkPool* pool = &block->chunk_pool;
+
+    stats->slab_count = pool->slab_count;
+    stats->capacity = pool->slab_count * VULKAN_MEMORY_BLOCK_CHUNK_SLAB_SIZE;
+    stats->used_count = pool->used_count;
+    stats->peak_used_count = pool->peak_used_count;
+}
+
+void vulkan_memory_block_get_stats(const VulkanMemoryBlock* block, VulkanMemoryStatInfo* stats) {
+    vulkan_memory_stat_info_clear(stats);
+
+    stats->block_count = 1;
+    stats->block_bytes = block->size;
+    stats->used_bytes = block->allocated;
+    stats->free_bytes = block->size - block->allocated;
+
+    for (const VulkanMemoryBlockChunk* chunk = block->head; chunk != NULL; chunk = chunk->next) {
+        if (chunk->type == VULKAN_ALLOCATION_TYPE_FREE) {
+            stats->free_range_count += 1;
+            if (chunk->size > stats->largest_free_range) {
+                stats->largest_free_range = chunk->size;
+            }
+            continue;
+        }
+
+        stats->allocation_count += 1;
+        if (chunk->padding > 0 && chunk->prev != NULL && chunk->prev->type == VULKAN_ALLOCATION_TYPE_FREE) {
+            stats->padding_bytes += chunk->padding < chunk->prev->size ? chunk->padding : chunk->prev->size;
+        }
+    }
+}
@@ -7,8 +7,19 @@
 
 #include "../../../core/collections/vector.h"
 #include "../../../core/memory/memory.h"
+#include "../../../core/threads/mutex.h"
 #include "../../core/device/device.h"
 #include "../../core/errors.h"
+#include "./backend/memory_backend.h"
+
+// Two-level segregated fit (TLSF) free lists: the first level splits sizes by power of two, the second level splits
+// each power of two range linearly into VULKAN_MEMORY_BLOCK_SL_INDEX_COUNT classes
+#define VULKAN_MEMORY_BLOCK_SL_INDEX_LOG2 4
+#define VULKAN_MEMORY_BLOCK_SL_INDEX_COUNT (1 << VULKAN_MEMORY_BLOCK_SL_INDEX_LOG2)
+#define VULKAN_MEMORY_BLOCK_MAX_SIZE_LOG2 40
+#define VULKAN_MEMORY_BLOCK_FL_INDEX_COUNT (VULKAN_MEMORY_BLOCK_MAX_SIZE_LOG2 - VULKAN_MEMORY_BLOCK_SL_INDEX_LOG2 + 1)
+
+#define VULKAN_MEMORY_BLOCK_CHUNK_SLAB_SIZE 64
 
 typedef enum VulkanMemoryUsage {
     VULKAN_MEMORY_USAGE_UNKNOWN,
@@ -19,6 +30,13 @@ typedef enum VulkanMemoryUsage {
     VULKAN_MEMORY_USAGES_TOTAL,
 } VulkanMemoryUsage;
 
+typedef enum VulkanMemoryStrategy {
+    VULKAN_MEMORY_STRATEGY_DEFAULT,
+    VULKAN_MEMORY_STRATEGY_LINEAR,
+    VULKAN_MEMORY_STRATEGY_RING,
+    VULKAN_MEMORY_STRATEGIES_TOTAL,
+} VulkanMemoryStrategy;
+
 typedef enum VulkanAllocationType {
     VULKAN_ALLOCATION_TYPE_FREE,
     VULKAN_ALLOCATION_TYPE_BUFFER,
@@ -32,7 +50,7 @@ typedef struct VulkanMemoryBlock VulkanMemoryBlock;
 typedef struct VulkanMemoryBlockChunk VulkanMemoryBlockChunk;
 
 typedef struct VulkanAllocationInfo {
-    uint32_t size;
+    VkDeviceSize size;
     uint32_t align;
     VkDeviceSize granularity;
     VulkanAllocationType allocation_type;
@@ -40,42 +58,65 @@ typedef struct VulkanAllocationInfo {
 
 typedef struct VulkanAllocation {
     uint32_t id;
+    VulkanMemoryStrategy strategy;
 
     VulkanMemoryBlock* block;
+    VulkanMemoryBlockChunk* chunk;
 
     VkDeviceMemory device_memory_handle;
     VkDeviceSize offset;
     VkDeviceSize size;
 
     byte* data;
+    // Host writes to non coherent memory have to be flushed, the flushed ranges must not go past the memory size
+    bool is_coherent;
+    VkDeviceSize memory_size;
+
+    // Set when the allocator records a trace, zero otherwise
+    uint32_t trace_id;
 } VulkanAllocation;
 
 typedef struct VulkanAllocationList VECTOR(VulkanAllocation) VulkanAllocationList;
 
 static inline void vulkan_allocation_clear(VulkanAllocation* allocation) {
     allocation->id = 0;
+    allocation->strategy = VULKAN_MEMORY_STRATEGY_DEFAULT;
     allocation->block = NULL;
+    allocation->chunk = NULL;
     allocation->device_memory_handle = VK_NULL_HANDLE;
     allocation->offset = 0;
     allocation->size = 0;
     allocation->data = NULL;
+    allocation->is_coherent = true;
+    allocation->memory_size = 0;
+    allocation->trace_id = 0;
 }
 
 static inline void vulkan_allocation_copy(const VulkanAllocation* src, VulkanAllocation* dst) {
     vulkan_allocation_clear(dst);
     dst->id = src->id;
+    dst->strategy = src->strategy;
     dst->block = src->block;
+    dst->chunk = src->chunk;
     dst->device_memory_handle = src->device_memory_handle;
     dst->offset = src->offset;
     dst->size = src->size;
     dst->data = src->data;
+    dst->is_coherent = src->is_coherent;
+    dst->memory_size = src->memory_size;
+    dst->trace_id = src->trace_id;
 }
 
 typedef struct VulkanMemoryBlockInfo {
     const Device* device;
+    const VulkanMemoryBackend* backend;
     uint32_t memory_type_index;
     VkDeviceSize size;
     VulkanMemoryUsage usage;
+
+    // Dedicated blocks back a single resource, the buffer is passed to the driver when set
+    bool dedicated;
+    VkBuffer dedicated_buffer;
 } VulkanMemoryBlockInfo;
 
 struct VulkanMemoryBlockChunk {
@@ -83,10 +124,18 @@ struct VulkanMemoryBlockChunk {
 
     VkDeviceSize size;
     VkDeviceSize offset;
+    // Alignment gap requested in front of the chunk when it was allocated
+    VkDeviceSize padding;
 
+    // Physical neighbours inside the block
     VulkanMemoryBlockChunk* prev;
     VulkanMemoryBlockChunk* next;
 
+    // Neighbours in the segregated free list, only valid for free chunks, unused nodes in the chunk pool are linked
+    // through next_free
+    VulkanMemoryBlockChunk* prev_free;
+    VulkanMemoryBlockChunk* next_free;
+
     VulkanAllocationType type;
 };
 
@@ -94,45 +143,147 @@ static inline void vulkan_memory_block_chunk_clear(VulkanMemoryBlockChunk* chunk
     chunk->id = 0;
     chunk->size = 0;
     chunk->offset = 0;
+    chunk->padding = 0;
     chunk->prev = NULL;
     chunk->next = NULL;
+    chunk->prev_free = NULL;
+    chunk->next_free = NULL;
     chunk->type = VULKAN_ALLOCATION_TYPE_FREE;
 }
 
+typedef struct VulkanMemoryBlockChunkSlab VulkanMemoryBlockChunkSlab;
+
+struct VulkanMemoryBlockChunkSlab {
+    VulkanMemoryBlockChunkSlab* next;
+    VulkanMemoryBlockChunk chunks[VULKAN_MEMORY_BLOCK_CHUNK_SLAB_SIZE];
+};
+
+typedef struct VulkanMemoryBlockChunkPool {
+    VulkanMemoryBlockChunkSlab* slabs;
+    VulkanMemoryBlockChunk* free_nodes;
+
+    uint32_t slab_count;
+    uint32_t used_count;
+    uint32_t peak_used_count;
+} VulkanMemoryBlockChunkPool;
+
+static inline void vulkan_memory_block_chunk_pool_clear(VulkanMemoryBlockChunkPool* pool) {
+    pool->slabs = NULL;
+    pool->free_nodes = NULL;
+    pool->slab_count = 0;
+    pool->used_count = 0;
+    pool->peak_used_count = 0;
+}
+
+typedef struct VulkanMemoryStatInfo {
+    uint32_t block_count;
+    uint32_t allocation_count;
+    uint32_t free_range_count;
+
+    VkDeviceSize block_bytes;
+    VkDeviceSize used_bytes;
+    VkDeviceSize free_bytes;
+    VkDeviceSize largest_free_range;
+    // Free bytes left in front of allocations by their alignment that no other allocation has filled yet
+    VkDeviceSize padding_bytes;
+    // Freed ranges held by the thread caches, their chunks are still allocated but they are counted in neither the
+    // used nor the free bytes
+    VkDeviceSize cached_bytes;
+} VulkanMemoryStatInfo;
+
+static inline void vulkan_memory_stat_info_clear(VulkanMemoryStatInfo* info) {
+    info->block_count = 0;
+    info->allocation_count = 0;
+    info->free_range_count = 0;
+    info->block_bytes = 0;
+    info->used_bytes = 0;
+    info->free_bytes = 0;
+    info->largest_free_range = 0;
+    info->padding_bytes = 0;
+    info->cached_bytes = 0;
+}
+
+static inline void vulkan_memory_stat_info_add(VulkanMemoryStatInfo* dst, const VulkanMemoryStatInfo* src) {
+    dst->block_count += src->block_count;
+    dst->allocation_count += src->allocation_count;
+    dst->free_range_count += src->free_range_count;
+    dst->block_bytes += src->block_bytes;
+    dst->used_bytes += src->used_bytes;
+    dst->free_bytes += src->free_bytes;
+    if (src->largest_free_range > dst->largest_free_range) {
+        dst->largest_free_range = src->largest_free_range;
+    }
+    dst->padding_bytes += src->padding_bytes;
+    dst->cached_bytes += src->cached_bytes;
+}
+
+typedef struct VulkanMemoryBlockChunkPoolStats {
+    uint32_t slab_count;
+    uint32_t capacity;
+    uint32_t used_count;
+    uint32_t peak_used_count;
+} VulkanMemoryBlockChunkPoolStats;
+
 struct VulkanMemoryBlock {
     const Device* device;
+    const VulkanMemoryBackend* backend;
     VulkanMemoryBlockChunk* head;
     uint32_t next_block_id;
 
+    VulkanMemoryBlockChunkPool chunk_pool;
+
+    uint64_t fl_bitmap;
+    uint32_t sl_bitmap[VULKAN_MEMORY_BLOCK_FL_INDEX_COUNT];
+    VulkanMemoryBlockChunk* free_lists[VULKAN_MEMORY_BLOCK_FL_INDEX_COUNT][VULKAN_MEMORY_BLOCK_SL_INDEX_COUNT];
+
     uint32_t memory_type_index;
     VulkanMemoryUsage usage;
     VkDeviceMemory device_memory_handle;
 
     VkDeviceSize size;
     VkDeviceSize allocated;
+    bool is_dedicated;
     bool is_data_mapped;
+    bool is_coherent;
     byte* data;
+
+    // Only created by a concurrent allocator, guards the chunks of the block
+    Mutex mutex;
 };
 
 typedef struct VulkanMemoryBlockList VECTOR(VulkanMemoryBlock*) VulkanMemoryBlockList;
 
 static inline void vulkan_memory_block_clear(VulkanMemoryBlock* block) {
     block->device = NULL;
+    block->backend = NULL;
     block->head = NULL;
     block->next_block_id = 0;
+    vulkan_memory_block_chunk_pool_clear(&block->chunk_pool);
+    block->fl_bitmap = 0;
+    for (uint32_t fl = 0; fl < VULKAN_MEMORY_BLOCK_FL_INDEX_COUNT; ++fl) {
+        block->sl_bitmap[fl] = 0;
+        for (uint32_t sl = 0; sl < VULKAN_MEMORY_BLOCK_SL_INDEX_COUNT; ++sl) {
+            block->free_lists[fl][sl] = NULL;
+        }
+    }
     block->memory_type_index = 0;
     block->usage = VULKAN_MEMORY_USAGE_UNKNOWN;
     block->device_memory_handle = VK_NULL_HANDLE;
     block->size = 0;
     block->allocated = 0;
+    block->is_dedicated = false;
     block->is_data_mapped = false;
+    block->is_coherent = false;
     block->data = NULL;
+    mutex_clear(&block->mutex);
 }
 
 MemoryContextError vulkan_memory_block_init(VulkanMemoryBlock* block, const VulkanMemoryBlockInfo* info);
 MemoryContextError vulkan_memory_block_allocate(
     VulkanMemoryBlock* block, const VulkanAllocationInfo* alloc_info, VulkanAllocation* allocation);
 void vulkan_memory_block_free_allocation(VulkanMemoryBlock* block, VulkanAllocation* allocation);
+void vulkan_memory_block_get_chunk_pool_stats(const VulkanMemoryBlock* block, VulkanMemoryBlockChunkPoolStats* stats);
+void vulkan_memory_block_get_stats(const VulkanMemoryBlock* block, VulkanMemoryStatInfo* stats);
 
 static inline bool vulkan_memory_block_is_host_visible(const VulkanMemoryBlock* block) {
     return block->usage != VULKAN_MEMORY_USAGE_GPU_ONLY;
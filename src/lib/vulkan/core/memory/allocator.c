@@ -1,30 +1,555 @@
 #include "./allocator.h"
 
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "../../../core/memory/memory.h"
+#include "../../../core/utils/macro.h"
 #include "../../utils/memory.h"
 
-static void vulkan_memory_allocator_empty_garbage_index(VulkanMemoryAllocator* allocator, size_t index) {
-    VulkanAllocationList* garbage = &allocator->garbage_lists[index];
+// Allocations released by one empty_garbage call are few on a typical frame and stay off the heap
+#define VULKAN_MEMORY_ALLOCATOR_INLINE_RELEASE_COUNT 32
+
+typedef struct VulkanMemoryStatsJson VECTOR(char) VulkanMemoryStatsJson;
+typedef struct VulkanReleasedGarbageList SMALL_VECTOR(VulkanMemoryGarbage, VULKAN_MEMORY_ALLOCATOR_INLINE_RELEASE_COUNT)
+    VulkanReleasedGarbageList;
+
+typedef struct VulkanMemoryAllocatorBatchItem {
+    size_t request_index;
+    uint32_t memory_type_index;
+    VkDeviceSize size;
+} VulkanMemoryAllocatorBatchItem;
+
+static inline void vulkan_memory_allocator_lock(const VulkanMemoryAllocator* allocator, const Mutex* mutex) {
+    if (allocator->is_concurrent) {
+        mutex_lock(mutex);
+    }
+}
+
+static inline void vulkan_memory_allocator_unlock(const VulkanMemoryAllocator* allocator, const Mutex* mutex) {
+    if (allocator->is_concurrent) {
+        mutex_unlock(mutex);
+    }
+}
+
+static MemoryContextError vulkan_memory_allocator_check_budget(
+    const VulkanMemoryAllocator* allocator, uint32_t memory_type_index, VkDeviceSize size) {
+    VulkanMemoryHeapBudget budgets[VK_MAX_MEMORY_HEAPS];
+    bool has_memory_budget = memory_utils_get_memory_budget(allocator->device, budgets);
+    uint32_t heap_index = memory_utils_get_memory_heap_index(allocator->device, memory_type_index);
+
+    // The driver usage already covers the blocks that were allocated but not the ones still being allocated
+    VkDeviceSize usage = has_memory_budget ? budgets[heap_index].usage + allocator->heap_pending_bytes[heap_index]
+                                           : allocator->heap_block_bytes[heap_index];
+    if (usage + size > budgets[heap_index].budget) {
+        return MEMORY_CONTEXT_OUT_OF_BUDGET;
+    }
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+static void vulkan_memory_allocator_track_block_bytes(
+    VulkanMemoryAllocator* allocator, uint32_t memory_type_index, VkDeviceSize size, bool allocated) {
+    uint32_t heap_index = memory_utils_get_memory_heap_index(allocator->device, memory_type_index);
+    if (allocated) {
+        allocator->heap_block_bytes[heap_index] += size;
+    } else {
+        allocator->heap_block_bytes[heap_index] -= size;
+    }
+}
+
+// Reserves the bytes before the device memory is allocated so concurrent threads cannot overshoot the budget together,
+// the reservation stays pending until vulkan_memory_allocator_settle_block_bytes
+static MemoryContextError vulkan_memory_allocator_reserve_block_bytes(
+    VulkanMemoryAllocator* allocator, uint32_t memory_type_index, VkDeviceSize size) {
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    MemoryContextError status = vulkan_memory_allocator_check_budget(allocator, memory_type_index, size);
+    if (status == MEMORY_CONTEXT_SUCCESS) {
+        vulkan_memory_allocator_track_block_bytes(allocator, memory_type_index, size, true);
+        allocator->heap_pending_bytes[memory_utils_get_memory_heap_index(allocator->device, memory_type_index)] += size;
+    }
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+
+    return status;
+}
+
+// Called once the device memory of a reserved block is allocated or has failed, either way the driver usage is accurate
+static void vulkan_memory_allocator_settle_block_bytes(
+    VulkanMemoryAllocator* allocator, uint32_t memory_type_index, VkDeviceSize size) {
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    allocator->heap_pending_bytes[memory_utils_get_memory_heap_index(allocator->device, memory_type_index)] -= size;
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+}
+
+static void vulkan_memory_allocator_release_block_bytes(
+    VulkanMemoryAllocator* allocator, uint32_t memory_type_index, VkDeviceSize size) {
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    vulkan_memory_allocator_track_block_bytes(allocator, memory_type_index, size, false);
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+}
+
+// Freed device memory must not be flushed anymore
+static void vulkan_memory_allocator_discard_dirty_ranges(VulkanMemoryAllocator* allocator, VkDeviceMemory memory) {
+    size_t count = 0;
+    for (size_t i = 0; i < allocator->dirty_ranges.size; ++i) {
+        if (allocator->dirty_ranges.data[i].memory != memory) {
+            allocator->dirty_ranges.data[count++] = allocator->dirty_ranges.data[i];
+        }
+    }
+    allocator->dirty_ranges.size = count;
+}
+
+static int vulkan_memory_allocator_compare_ranges(const void* a, const void* b) {
+    const VkMappedMemoryRange* range_a = (const VkMappedMemoryRange*)a;
+    const VkMappedMemoryRange* range_b = (const VkMappedMemoryRange*)b;
+
+    if (range_a->memory != range_b->memory) {
+        return range_a->memory < range_b->memory ? -1 : 1;
+    }
+    if (range_a->offset != range_b->offset) {
+        return range_a->offset < range_b->offset ? -1 : 1;
+    }
+    return 0;
+}
+
+static bool vulkan_memory_allocator_try_merge_range(
+    VkMappedMemoryRange* range, VkDeviceMemory memory, VkDeviceSize start, VkDeviceSize end) {
+    VkDeviceSize range_end = range->offset + range->size;
+    if (range->memory != memory || start > range_end || end < range->offset) {
+        return false;
+    }
+
+    VkDeviceSize merged_start = MIN(range->offset, start);
+    range->size = MAX(range_end, end) - merged_start;
+    range->offset = merged_start;
+    return true;
+}
+
+// The block lock is released before the memory type lock is taken, by then another thread may have allocated from the
+// block or destroyed it, so the block is only looked up by address until it is found in the list
+static void vulkan_memory_allocator_remove_empty_block(
+    VulkanMemoryAllocator* allocator, VulkanMemoryBlock* block, uint32_t memory_type_index) {
+    const Mutex* type_lock = &allocator->memory_type_locks[memory_type_index];
+    VulkanMemoryBlockList* blocks = &allocator->blocks[memory_type_index];
+    bool is_empty = false;
+
+    vulkan_memory_allocator_lock(allocator, type_lock);
+    ssize_t index;
+    vector_index_of(blocks, block, &index);
+    if (index != -1) {
+        vulkan_memory_allocator_lock(allocator, &block->mutex);
+        is_empty = block->allocated == 0;
+        vulkan_memory_allocator_unlock(allocator, &block->mutex);
+        if (is_empty) {
+            vector_swap_remove(blocks, index);
+        }
+    }
+    vulkan_memory_allocator_unlock(allocator, type_lock);
+
+    if (!is_empty) {
+        return;
+    }
+
+    vulkan_memory_allocator_release_block_bytes(allocator, memory_type_index, block->size);
+    if (!block->is_coherent) {
+        vulkan_memory_allocator_lock(allocator, &allocator->lock);
+        vulkan_memory_allocator_discard_dirty_ranges(allocator, block->device_memory_handle);
+        vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+    }
+    vulkan_memory_block_destroy(block);
+    mem_free(block);
+}
+
+static void vulkan_memory_allocator_release_allocation(VulkanMemoryAllocator* allocator, VulkanAllocation* allocation) {
+    if (allocation->strategy != VULKAN_MEMORY_STRATEGY_DEFAULT || allocation->block == NULL) {
+        vulkan_allocation_clear(allocation);
+        return;
+    }
+
+    VulkanMemoryBlock* block = allocation->block;
+    uint32_t memory_type_index = block->memory_type_index;
+
+    vulkan_memory_allocator_lock(allocator, &block->mutex);
+    vulkan_memory_block_free_allocation(block, allocation);
+    bool is_empty = block->allocated == 0;
+    vulkan_memory_allocator_unlock(allocator, &block->mutex);
+
+    if (is_empty) {
+        vulkan_memory_allocator_remove_empty_block(allocator, block, memory_type_index);
+    }
+
+    vulkan_allocation_clear(allocation);
+}
+
+static VulkanMemoryThreadCache* vulkan_memory_allocator_get_thread_cache(VulkanMemoryAllocator* allocator) {
+    VulkanMemoryThreadCache* cache = thread_local_get(&allocator->thread_cache);
+    if (cache != NULL) {
+        return cache;
+    }
+
+    cache = mem_alloc(sizeof(VulkanMemoryThreadCache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->count = 0;
+    cache->is_released = false;
+    if (!mutex_init(&cache->lock)) {
+        mem_free(cache);
+        return NULL;
+    }
+
+    // Registered so the caches of every thread are trimmed by the garbage and released with the allocator
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    bool status = vector_push(&allocator->thread_caches, cache);
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+    if (!status) {
+        mutex_destroy(&cache->lock);
+        mem_free(cache);
+        return NULL;
+    }
+    thread_local_set(&allocator->thread_cache, cache);
+
+    return cache;
+}
+
+// Cache of the calling thread for an allocation it frees, NULL when the allocation has to go back to its block
+static VulkanMemoryThreadCache* vulkan_memory_allocator_get_freeing_cache(
+    VulkanMemoryAllocator* allocator, const VulkanAllocation* allocation) {
+    if (!allocator->is_concurrent || allocation->strategy != VULKAN_MEMORY_STRATEGY_DEFAULT ||
+        allocation->block == NULL || allocation->block->is_dedicated) {
+        return NULL;
+    }
+
+    VulkanMemoryThreadCache* cache = vulkan_memory_allocator_get_thread_cache(allocator);
+    if (cache != NULL && cache->is_released) {
+        vulkan_memory_allocator_lock(allocator, &cache->lock);
+        cache->is_released = false;
+        vulkan_memory_allocator_unlock(allocator, &cache->lock);
+    }
+
+    return cache;
+}
+
+// Returns false when the completed garbage has to go back to its block, when the cache is full its oldest range is
+// evicted into the evicted allocation instead
+static bool vulkan_memory_allocator_cache_allocation(
+    VulkanMemoryAllocator* allocator, const VulkanMemoryGarbage* garbage, VulkanAllocation* evicted) {
+    vulkan_allocation_clear(evicted);
+    VulkanMemoryThreadCache* cache = garbage->cache;
+    if (cache == NULL) {
+        return false;
+    }
+
+    vulkan_memory_allocator_lock(allocator, &cache->lock);
+    if (cache->is_released) {
+        vulkan_memory_allocator_unlock(allocator, &cache->lock);
+        return false;
+    }
+    if (cache->count == VULKAN_MEMORY_THREAD_CACHE_SIZE) {
+        vulkan_allocation_copy(&cache->entries[0].allocation, evicted);
+        mem_move(&cache->entries[1], &cache->entries[0], sizeof(VulkanMemoryThreadCacheEntry) * (cache->count - 1));
+        cache->count -= 1;
+    }
+    VulkanMemoryThreadCacheEntry* entry = &cache->entries[cache->count++];
+    vulkan_allocation_copy(&garbage->allocation, &entry->allocation);
+    entry->frame_number = garbage->frame_number;
+    vulkan_memory_allocator_unlock(allocator, &cache->lock);
+
+    return true;
+}
+
+// A cached range is reused by a request of the same allocation type that leaves at most a quarter of it unused
+static bool vulkan_memory_allocator_take_cached_allocation(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryAllocatorRequest* req, uint32_t memory_type_index, VulkanAllocation* allocation) {
+    if (!allocator->is_concurrent) {
+        return false;
+    }
+
+    VulkanMemoryThreadCache* cache = thread_local_get(&allocator->thread_cache);
+    if (cache == NULL) {
+        return false;
+    }
+
+    uint32_t align = MAX(req->align, 1U);
+    bool is_found = false;
+    vulkan_memory_allocator_lock(allocator, &cache->lock);
+    for (uint32_t i = cache->count; i-- > 0;) {
+        const VulkanAllocation* cached = &cache->entries[i].allocation;
+        if (cached->block->memory_type_index != memory_type_index || cached->chunk->type != req->allocation_type ||
+            cached->size < req->size || cached->size - req->size > req->size / 4 || cached->offset % align != 0) {
+            continue;
+        }
+
+        vulkan_allocation_copy(cached, allocation);
+        mem_move(&cache->entries[i + 1], &cache->entries[i],
+            sizeof(VulkanMemoryThreadCacheEntry) * (cache->count - i - 1));
+        cache->count -= 1;
+        is_found = true;
+        break;
+    }
+    vulkan_memory_allocator_unlock(allocator, &cache->lock);
 
-    for (size_t i = 0; i < garbage->size; ++i) {
-        VulkanAllocation* allocation = &garbage->data[i];
+    return is_found;
+}
 
-        vulkan_memory_block_free_allocation(allocation->block, allocation);
+// Returns the cached ranges not reused within VULKAN_MEMORY_THREAD_CACHE_MAX_AGE frames to their blocks, or every
+// cached range of every thread
+static void vulkan_memory_allocator_trim_thread_caches(VulkanMemoryAllocator* allocator, bool release_all) {
+    if (!allocator->is_concurrent) {
+        return;
+    }
 
-        if (allocation->block->allocated == 0) {
-            VulkanMemoryBlockList* blocks = &allocator->blocks[allocation->block->memory_type_index];
-            ssize_t index;
-            vector_index_of(blocks, allocation->block, &index);
-            if (index != -1) {
-                vector_swap_remove(blocks, index);
-                mem_free(allocation->block);
+    VulkanReleasedGarbageList released;
+    small_vector_init(&released);
+
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    uint64_t frame_number = allocator->frame_number;
+    for (size_t i = 0; i < allocator->thread_caches.size; ++i) {
+        VulkanMemoryThreadCache* cache = allocator->thread_caches.data[i];
+        vulkan_memory_allocator_lock(allocator, &cache->lock);
+        uint32_t count = 0;
+        for (uint32_t j = 0; j < cache->count; ++j) {
+            VulkanMemoryThreadCacheEntry* entry = &cache->entries[j];
+            bool is_expired = release_all || entry->frame_number + VULKAN_MEMORY_THREAD_CACHE_MAX_AGE < frame_number;
+            VulkanMemoryGarbage garbage = {
+                .allocation = entry->allocation,
+                .frame_number = entry->frame_number,
+                .cache = NULL,
+            };
+            if (!is_expired || !small_vector_push(&released, garbage)) {
+                cache->entries[count++] = *entry;
             }
         }
+        cache->count = count;
+        vulkan_memory_allocator_unlock(allocator, &cache->lock);
+    }
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+
+    for (size_t i = 0; i < released.size; ++i) {
+        vulkan_memory_allocator_release_allocation(allocator, &released.data[i].allocation);
+    }
+    small_vector_destroy(&released);
+}
 
+// Moves the cached ranges of the memory type, or of the block when it is given, from the used bytes to the cached ones
+static void vulkan_memory_allocator_exclude_cached_bytes(const VulkanMemoryAllocator* allocator,
+    uint32_t memory_type_index, const VulkanMemoryBlock* block, VulkanMemoryStatInfo* info) {
+    if (!allocator->is_concurrent) {
+        return;
+    }
+
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    for (size_t i = 0; i < allocator->thread_caches.size; ++i) {
+        const VulkanMemoryThreadCache* cache = allocator->thread_caches.data[i];
+        vulkan_memory_allocator_lock(allocator, &cache->lock);
+        for (uint32_t j = 0; j < cache->count; ++j) {
+            const VulkanAllocation* cached = &cache->entries[j].allocation;
+            if (block != NULL ? cached->block != block : cached->block->memory_type_index != memory_type_index) {
+                continue;
+            }
+            info->allocation_count -= 1;
+            info->used_bytes -= cached->size;
+            info->cached_bytes += cached->size;
+        }
+        vulkan_memory_allocator_unlock(allocator, &cache->lock);
+    }
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+}
+
+static void vulkan_memory_allocator_sort_blocks_by_usage(VulkanMemoryBlockList* blocks) {
+    for (size_t i = 1; i < blocks->size; ++i) {
+        VulkanMemoryBlock* block = blocks->data[i];
+        size_t j = i;
+        for (; j > 0 && blocks->data[j - 1]->allocated > block->allocated; --j) {
+            blocks->data[j] = blocks->data[j - 1];
+        }
+        blocks->data[j] = block;
+    }
+}
+
+static ssize_t vulkan_memory_allocator_find_defragmentation_candidate(
+    const VulkanMemoryDefragmentationCandidate* candidates, size_t candidate_count,
+    const VulkanMemoryBlockChunk* chunk) {
+    for (size_t i = 0; i < candidate_count; ++i) {
+        const VulkanAllocation* allocation = &candidates[i].allocation;
+        if (allocation->chunk == chunk && allocation->id == chunk->id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// The caller holds the lock of the destination block
+static void vulkan_memory_allocator_release_move_destination(VulkanMemoryDefragmentationMove* move) {
+    if (move->destination.block != NULL) {
+        vulkan_memory_block_free_allocation(move->destination.block, &move->destination);
+    }
+    vulkan_allocation_clear(&move->destination);
+}
+
+static void vulkan_memory_allocator_rollback_defragmentation_moves(
+    VulkanMemoryDefragmentationMoveList* moves, size_t move_count) {
+    while (moves->size > move_count) {
+        vulkan_memory_allocator_release_move_destination(&moves->data[--moves->size]);
+    }
+}
+
+static bool vulkan_memory_allocator_plan_block_defragmentation(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryBlockList* blocks, size_t source_index, const VulkanMemoryDefragmentationCandidate* candidates,
+    size_t candidate_count, VulkanMemoryDefragmentationMoveList* moves) {
+    VkDeviceSize granularity = memory_utils_get_buffer_granularity_from_device(allocator->device);
+    const VulkanMemoryBlock* source = blocks->data[source_index];
+
+    for (const VulkanMemoryBlockChunk* chunk = source->head; chunk != NULL; chunk = chunk->next) {
+        if (chunk->type == VULKAN_ALLOCATION_TYPE_FREE) {
+            continue;
+        }
+
+        ssize_t candidate_index =
+            vulkan_memory_allocator_find_defragmentation_candidate(candidates, candidate_count, chunk);
+        if (candidate_index == -1) {
+            return false;
+        }
+
+        VulkanAllocationInfo allocation_info = {
+            .size = chunk->size,
+            .align = candidates[candidate_index].align,
+            .granularity = granularity,
+            .allocation_type = chunk->type,
+        };
+        VulkanMemoryDefragmentationMove move = {
+            .candidate_index = candidate_index,
+        };
+        vulkan_allocation_copy(&candidates[candidate_index].allocation, &move.source);
+
+        // Fill the fullest blocks first
+        bool reserved = false;
+        for (size_t i = blocks->size - 1; i > source_index && !reserved; --i) {
+            reserved = vulkan_memory_block_allocate(blocks->data[i], &allocation_info, &move.destination) ==
+                       MEMORY_CONTEXT_SUCCESS;
+        }
+        if (!reserved) {
+            return false;
+        }
+        if (!vector_push(moves, move)) {
+            vulkan_memory_allocator_release_move_destination(&move);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool vulkan_memory_allocator_needs_dedicated_allocation(
+    const VulkanMemoryAllocator* allocator, const VulkanMemoryAllocatorRequest* req, VkDeviceSize block_size) {
+    if (req->requires_dedicated_allocation || req->prefers_dedicated_allocation) {
+        return true;
+    }
+    if (allocator->dedicated_allocation_threshold_bytes > 0 &&
+        req->size >= allocator->dedicated_allocation_threshold_bytes) {
+        return true;
+    }
+    return req->size > block_size;
+}
+
+static MemoryContextError vulkan_memory_allocator_create_block(
+    VulkanMemoryAllocator* allocator, const VulkanMemoryBlockInfo* block_info, VulkanMemoryBlock** block) {
+    *block = mem_alloc(sizeof(VulkanMemoryBlock));
+    ASSERT_ALLOC(*block, "Unable to create an allocation block", MEMORY_CONTEXT_INIT_ERROR);
+
+    MemoryContextError status = vulkan_memory_block_init(*block, block_info);
+    if (status == MEMORY_CONTEXT_SUCCESS && allocator->is_concurrent && !mutex_init(&(*block)->mutex)) {
+        status = MEMORY_CONTEXT_INIT_ERROR;
+    }
+    if (status != MEMORY_CONTEXT_SUCCESS) {
+        vulkan_memory_block_destroy(*block);
+        mem_free(*block);
+        *block = NULL;
+    }
+
+    return status;
+}
+
+static MemoryContextError vulkan_memory_allocator_add_block(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryBlockInfo* block_info, const VulkanAllocationInfo* allocation_info,
+    VulkanAllocation* allocation) {
+    MemoryContextError status =
+        vulkan_memory_allocator_reserve_block_bytes(allocator, block_info->memory_type_index, block_info->size);
+    ASSERT_SUCCESS(status, status);
+
+    // The block stays private until it is pushed, so the first allocation needs no lock
+    VulkanMemoryBlock* block = NULL;
+    status = vulkan_memory_allocator_create_block(allocator, block_info, &block);
+    vulkan_memory_allocator_settle_block_bytes(allocator, block_info->memory_type_index, block_info->size);
+    if (status == MEMORY_CONTEXT_SUCCESS) {
+        status = vulkan_memory_block_allocate(block, allocation_info, allocation);
+    }
+    if (status == MEMORY_CONTEXT_SUCCESS) {
+        const Mutex* type_lock = &allocator->memory_type_locks[block_info->memory_type_index];
+        vulkan_memory_allocator_lock(allocator, type_lock);
+        bool is_added = vector_push(&allocator->blocks[block_info->memory_type_index], block);
+        vulkan_memory_allocator_unlock(allocator, type_lock);
+        status = is_added ? MEMORY_CONTEXT_SUCCESS : MEMORY_CONTEXT_UNABLE_TO_ADD_BLOCK;
+    }
+
+    if (status != MEMORY_CONTEXT_SUCCESS) {
+        if (block != NULL) {
+            vulkan_memory_block_destroy(block);
+            mem_free(block);
+        }
         vulkan_allocation_clear(allocation);
+        vulkan_memory_allocator_release_block_bytes(allocator, block_info->memory_type_index, block_info->size);
     }
 
-    vector_empty_noshrink(garbage);
+    return status;
+}
+
+// The caller holds the allocator lock
+static MemoryContextError vulkan_memory_allocator_allocate_from_transient_block(
+    VulkanMemoryAllocator* allocator, const VulkanMemoryAllocatorRequest* req, VulkanAllocation* allocation) {
+    VulkanTransientBlock* block = &allocator->ring_block;
+    if (req->strategy == VULKAN_MEMORY_STRATEGY_LINEAR) {
+        block = &allocator->linear_blocks[allocator->frame_index];
+    }
+
+    if (!vulkan_transient_block_is_init(block)) {
+        VulkanTransientBlockInfo block_info = {
+            .device = allocator->device,
+            .backend = allocator->backend,
+            .memory_type_index = memory_utils_find_memory_type_index(
+                allocator->device, req->memory_type_bits, VULKAN_MEMORY_USAGE_CPU_TO_GPU),
+            .size = allocator->transient_block_size_bytes,
+            .strategy = req->strategy,
+        };
+        if (block_info.memory_type_index == UINT32_MAX) {
+            return MEMORY_CONTEXT_NO_SUITABLE_MEMORY_INDEX;
+        }
+
+        MemoryContextError status =
+            vulkan_memory_allocator_check_budget(allocator, block_info.memory_type_index, block_info.size);
+        ASSERT_SUCCESS(status, status);
+
+        status = vulkan_transient_block_init(block, &block_info);
+        ASSERT_SUCCESS(status, status);
+        block->frame_index = allocator->frame_index;
+        vulkan_memory_allocator_track_block_bytes(allocator, block->memory_type_index, block->size, true);
+    }
+
+    if ((req->memory_type_bits & (1U << block->memory_type_index)) == 0) {
+        return MEMORY_CONTEXT_UNSUITABLE_BLOCK;
+    }
+
+    return vulkan_transient_block_allocate(block, req->size, req->align, allocation);
+}
+
+static MemoryContextError vulkan_memory_allocator_allocate_transient(
+    VulkanMemoryAllocator* allocator, const VulkanMemoryAllocatorRequest* req, VulkanAllocation* allocation) {
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    MemoryContextError status = vulkan_memory_allocator_allocate_from_transient_block(allocator, req, allocation);
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+
+    return status;
 }
 
 MemoryContextError vulkan_memory_allocator_init(
@@ -46,41 +571,42 @@ MemoryContextError vulkan_memory_allocator_init(
         return MEMORY_CONTEXT_INIT_ERROR;
     }
 
-    if (allocator_info->garbage_list_count > 0) {
-        VulkanAllocationList* garbage_lists =
-            mem_alloc(sizeof(VulkanAllocationList) * allocator_info->garbage_list_count);
-        ASSERT_ALLOC(garbage_lists, "Unable to create garbage block lists", MEMORY_CONTEXT_INIT_ERROR);
+    if (!vector_reserve(&allocator->garbage, reserve_size)) {
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
 
-        for (size_t i = 0; i < allocator_info->garbage_list_count && status; ++i) {
-            vector_init(&garbage_lists[i]);
-            status = vector_reserve(&garbage_lists[i], reserve_size);
+    allocator->is_concurrent = allocator_info->concurrent;
+    if (allocator->is_concurrent) {
+        status = mutex_init(&allocator->lock) && thread_local_init(&allocator->thread_cache);
+        for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES && status; ++i) {
+            status = mutex_init(&allocator->memory_type_locks[i]);
         }
         if (!status) {
-            mem_free(garbage_lists);
             return MEMORY_CONTEXT_INIT_ERROR;
         }
-
-        allocator->garbage_list_count = allocator_info->garbage_list_count;
-        allocator->garbage_lists = garbage_lists;
     }
 
     allocator->device = allocator_info->device;
+    allocator->backend =
+        allocator_info->backend != NULL ? allocator_info->backend : vulkan_memory_backend_get_default();
+    allocator->non_coherent_atom_size =
+        MAX(allocator->device->physical_device->properties.limits.nonCoherentAtomSize, (VkDeviceSize)1);
     allocator->device_local_block_size_bytes = MB_TO_BYTES(allocator_info->device_local_block_size_MB);
     allocator->host_visible_block_size_bytes = MB_TO_BYTES(allocator_info->host_visible_block_size_MB);
+    allocator->transient_block_size_bytes = MB_TO_BYTES(allocator_info->transient_block_size_MB);
+    allocator->dedicated_allocation_threshold_bytes = MB_TO_BYTES(allocator_info->dedicated_allocation_threshold_MB);
+
+    // Tracing is a debugging aid, the allocator keeps working without it
+    if (allocator_info->trace_path != NULL && allocator_info->trace_path[0] != '\0' &&
+        vulkan_memory_trace_open(&allocator->trace, allocator_info->trace_path) != MEMORY_CONTEXT_SUCCESS) {
+        log_warning("Memory allocator trace disabled");
+    }
 
     return MEMORY_CONTEXT_SUCCESS;
 }
 
-MemoryContextError vulkan_memory_allocator_allocate(
-    VulkanMemoryAllocator* allocator, const VulkanMemoryAllocatorRequest* req, VulkanAllocation* allocation) {
-    vulkan_allocation_clear(allocation);
-
-    uint32_t memory_type_index =
-        memory_utils_find_memory_type_index(allocator->device, req->memory_type_bits, req->usage);
-    if (memory_type_index == UINT32_MAX) {
-        return MEMORY_CONTEXT_NO_SUITABLE_MEMORY_INDEX;
-    }
-
+static MemoryContextError vulkan_memory_allocator_allocate_from_memory_type(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryAllocatorRequest* req, uint32_t memory_type_index, VulkanAllocation* allocation) {
     VulkanAllocationInfo allocation_info = {
         .size = req->size,
         .align = req->align,
@@ -88,79 +614,731 @@ MemoryContextError vulkan_memory_allocator_allocate(
         .allocation_type = req->allocation_type,
     };
 
+    VkDeviceSize block_size = allocator->host_visible_block_size_bytes;
+    if (req->usage == VULKAN_MEMORY_USAGE_GPU_ONLY) {
+        block_size = allocator->device_local_block_size_bytes;
+    }
+
+    VulkanMemoryBlockInfo block_info = {
+        .device = allocator->device,
+        .backend = allocator->backend,
+        .memory_type_index = memory_type_index,
+        .size = block_size,
+        .usage = req->usage,
+        .dedicated = false,
+        .dedicated_buffer = VK_NULL_HANDLE,
+    };
+
+    // Large resources get their own device memory instead of wasting most of a shared block
+    if (vulkan_memory_allocator_needs_dedicated_allocation(allocator, req, block_size)) {
+        block_info.size = req->size;
+        block_info.dedicated = true;
+        if (req->requires_dedicated_allocation || req->prefers_dedicated_allocation) {
+            block_info.dedicated_buffer = req->buffer;
+        }
+        return vulkan_memory_allocator_add_block(allocator, &block_info, &allocation_info, allocation);
+    }
+
+    if (vulkan_memory_allocator_take_cached_allocation(allocator, req, memory_type_index, allocation)) {
+        return MEMORY_CONTEXT_SUCCESS;
+    }
+
+    const Mutex* type_lock = &allocator->memory_type_locks[memory_type_index];
     VulkanMemoryBlockList* blocks = &allocator->blocks[memory_type_index];
-    MemoryContextError status;
+    MemoryContextError status = MEMORY_CONTEXT_LOW_FREE_BLOCK_SPACE;
+
+    vulkan_memory_allocator_lock(allocator, type_lock);
     for (size_t i = 0; i < blocks->size; ++i) {
         VulkanMemoryBlock* block = blocks->data[i];
 
-        if (block->memory_type_index != memory_type_index) {
+        if (block->memory_type_index != memory_type_index || block->is_dedicated) {
             continue;
         }
 
+        vulkan_memory_allocator_lock(allocator, &block->mutex);
         status = vulkan_memory_block_allocate(block, &allocation_info, allocation);
-        if (status == MEMORY_CONTEXT_SUCCESS) {
-            return MEMORY_CONTEXT_SUCCESS;
-        }
+        vulkan_memory_allocator_unlock(allocator, &block->mutex);
 
         if (status != MEMORY_CONTEXT_LOW_FREE_BLOCK_SPACE && status != MEMORY_CONTEXT_UNSUITABLE_BLOCK) {
-            return status;
+            break;
         }
     }
+    vulkan_memory_allocator_unlock(allocator, type_lock);
 
-    VkDeviceSize block_size = allocator->host_visible_block_size_bytes;
-    if (req->usage == VULKAN_MEMORY_USAGE_GPU_ONLY) {
-        block_size = allocator->device_local_block_size_bytes;
+    if (status != MEMORY_CONTEXT_LOW_FREE_BLOCK_SPACE && status != MEMORY_CONTEXT_UNSUITABLE_BLOCK) {
+        return status;
     }
 
-    VulkanMemoryBlock* block = mem_alloc(sizeof(VulkanMemoryBlock));
-    ASSERT_ALLOC(block, "Unable to create an allocation block", MEMORY_CONTEXT_INIT_ERROR);
+    return vulkan_memory_allocator_add_block(allocator, &block_info, &allocation_info, allocation);
+}
 
-    VulkanMemoryBlockInfo block_info = {
-        .device = allocator->device,
-        .memory_type_index = memory_type_index,
-        .size = block_size,
+static uint32_t vulkan_memory_allocator_get_heap_memory_type_bits(
+    const VulkanMemoryAllocator* allocator, uint32_t heap_index) {
+    const VkPhysicalDeviceMemoryProperties* memory_props = &allocator->device->physical_device->memory_properties;
+
+    uint32_t memory_type_bits = 0;
+    for (uint32_t i = 0; i < memory_props->memoryTypeCount; ++i) {
+        if (memory_props->memoryTypes[i].heapIndex == heap_index) {
+            memory_type_bits |= 1U << i;
+        }
+    }
+    return memory_type_bits;
+}
+
+static void vulkan_memory_allocator_trace_allocate(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryAllocatorRequest* req, VulkanAllocation* allocation, bool is_allocated) {
+    if (!vulkan_memory_trace_is_open(&allocator->trace)) {
+        return;
+    }
+
+    VulkanMemoryTraceRequest trace_request = {
+        .size = req->size,
+        .align = req->align,
+        .memory_type_bits = req->memory_type_bits,
         .usage = req->usage,
+        .allocation_type = req->allocation_type,
+        .strategy = req->strategy,
+        .prefers_dedicated_allocation = req->prefers_dedicated_allocation,
+        .requires_dedicated_allocation = req->requires_dedicated_allocation,
     };
-    status = vulkan_memory_block_init(block, &block_info);
-    if (status != MEMORY_CONTEXT_SUCCESS) {
-        mem_free(block);
+    uint32_t trace_id = vulkan_memory_trace_record_allocate(&allocator->trace, &trace_request);
+    if (is_allocated) {
+        allocation->trace_id = trace_id;
+    }
+}
+
+static MemoryContextError vulkan_memory_allocator_allocate_untraced(
+    VulkanMemoryAllocator* allocator, const VulkanMemoryAllocatorRequest* req, VulkanAllocation* allocation) {
+    vulkan_allocation_clear(allocation);
+
+    allocator->allocate_call_count += 1;
+    allocator->frame_allocate_call_count += 1;
+
+    if (req->strategy != VULKAN_MEMORY_STRATEGY_DEFAULT) {
+        return vulkan_memory_allocator_allocate_transient(allocator, req, allocation);
+    }
+
+    uint32_t memory_type_index =
+        memory_utils_find_memory_type_index(allocator->device, req->memory_type_bits, req->usage);
+    if (memory_type_index == UINT32_MAX) {
+        return MEMORY_CONTEXT_NO_SUITABLE_MEMORY_INDEX;
+    }
+
+    MemoryContextError status =
+        vulkan_memory_allocator_allocate_from_memory_type(allocator, req, memory_type_index, allocation);
+    if (status != MEMORY_CONTEXT_OUT_OF_BUDGET) {
         return status;
     }
-    if (!vector_push(blocks, block)) {
-        vulkan_memory_block_destroy(block);
-        mem_free(block);
-        return MEMORY_CONTEXT_UNABLE_TO_ADD_BLOCK;
+
+    // Spill into a memory type from another heap before the driver runs out of memory
+    uint32_t heap_index = memory_utils_get_memory_heap_index(allocator->device, memory_type_index);
+    uint32_t spill_memory_type_bits =
+        req->memory_type_bits & ~vulkan_memory_allocator_get_heap_memory_type_bits(allocator, heap_index);
+    uint32_t spill_memory_type_index =
+        memory_utils_find_memory_type_index(allocator->device, spill_memory_type_bits, req->usage);
+    if (spill_memory_type_index == UINT32_MAX) {
+        log_warning("Memory heap %u is out of budget", heap_index);
+        return MEMORY_CONTEXT_OUT_OF_BUDGET;
     }
 
-    status = vulkan_memory_block_allocate(block, &allocation_info, allocation);
+    log_debug("Memory heap %u is out of budget, spilling to memory type %u", heap_index, spill_memory_type_index);
+    return vulkan_memory_allocator_allocate_from_memory_type(allocator, req, spill_memory_type_index, allocation);
+}
+
+MemoryContextError vulkan_memory_allocator_allocate(
+    VulkanMemoryAllocator* allocator, const VulkanMemoryAllocatorRequest* req, VulkanAllocation* allocation) {
+    MemoryContextError status = vulkan_memory_allocator_allocate_untraced(allocator, req, allocation);
+    vulkan_memory_allocator_trace_allocate(allocator, req, allocation, status == MEMORY_CONTEXT_SUCCESS);
+
+    return status;
+}
+
+static int vulkan_memory_allocator_compare_batch_items(const void* a, const void* b) {
+    const VulkanMemoryAllocatorBatchItem* item_a = a;
+    const VulkanMemoryAllocatorBatchItem* item_b = b;
+
+    if (item_a->memory_type_index != item_b->memory_type_index) {
+        return item_a->memory_type_index < item_b->memory_type_index ? -1 : 1;
+    }
+    // Largest first, the small allocations then fill the gaps
+    if (item_a->size != item_b->size) {
+        return item_a->size > item_b->size ? -1 : 1;
+    }
+    if (item_a->request_index != item_b->request_index) {
+        return item_a->request_index < item_b->request_index ? -1 : 1;
+    }
+    return 0;
+}
+
+MemoryContextError vulkan_memory_allocator_allocate_batch(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryAllocatorRequest* requests, size_t request_count, VulkanAllocation* allocations) {
+    if (request_count == 0) {
+        return MEMORY_CONTEXT_SUCCESS;
+    }
+
+    VulkanMemoryAllocatorBatchItem* items = mem_alloc(sizeof(VulkanMemoryAllocatorBatchItem) * request_count);
+    ASSERT_ALLOC(items, "Unable to allocate memory allocator batch", MEMORY_CONTEXT_INIT_ERROR);
+
+    for (size_t i = 0; i < request_count; ++i) {
+        const VulkanMemoryAllocatorRequest* req = &requests[i];
+        items[i].request_index = i;
+        items[i].size = req->size;
+        items[i].memory_type_index = UINT32_MAX;
+        if (req->strategy == VULKAN_MEMORY_STRATEGY_DEFAULT) {
+            items[i].memory_type_index =
+                memory_utils_find_memory_type_index(allocator->device, req->memory_type_bits, req->usage);
+        }
+        vulkan_allocation_clear(&allocations[i]);
+    }
+    qsort(items, request_count, sizeof(VulkanMemoryAllocatorBatchItem), vulkan_memory_allocator_compare_batch_items);
+
+    VkDeviceSize granularity = memory_utils_get_buffer_granularity_from_device(allocator->device);
+    VulkanMemoryBlock* current_block = NULL;
+    MemoryContextError status = MEMORY_CONTEXT_SUCCESS;
+
+    size_t i = 0;
+    for (; i < request_count && status == MEMORY_CONTEXT_SUCCESS; ++i) {
+        const VulkanMemoryAllocatorRequest* req = &requests[items[i].request_index];
+        VulkanAllocation* allocation = &allocations[items[i].request_index];
+
+        if (current_block != NULL && current_block->memory_type_index != items[i].memory_type_index) {
+            current_block = NULL;
+        }
+
+        // Keep filling the block the previous request landed in, the full allocation path is only taken when it
+        // runs out of space
+        VkDeviceSize block_size = req->usage == VULKAN_MEMORY_USAGE_GPU_ONLY ? allocator->device_local_block_size_bytes
+                                                                             : allocator->host_visible_block_size_bytes;
+        if (current_block != NULL && current_block->usage == req->usage &&
+            !vulkan_memory_allocator_needs_dedicated_allocation(allocator, req, block_size)) {
+            VulkanAllocationInfo allocation_info = {
+                .size = req->size,
+                .align = req->align,
+                .granularity = granularity,
+                .allocation_type = req->allocation_type,
+            };
+            vulkan_memory_allocator_lock(allocator, &current_block->mutex);
+            bool is_allocated =
+                vulkan_memory_block_allocate(current_block, &allocation_info, allocation) == MEMORY_CONTEXT_SUCCESS;
+            vulkan_memory_allocator_unlock(allocator, &current_block->mutex);
+            if (is_allocated) {
+                allocator->allocate_call_count += 1;
+                allocator->frame_allocate_call_count += 1;
+                continue;
+            }
+        }
+
+        status = vulkan_memory_allocator_allocate_untraced(allocator, req, allocation);
+        if (status == MEMORY_CONTEXT_SUCCESS && allocation->block != NULL && !allocation->block->is_dedicated) {
+            current_block = allocation->block;
+        }
+    }
+
+    if (status != MEMORY_CONTEXT_SUCCESS) {
+        for (size_t j = 0; j + 1 < i; ++j) {
+            vulkan_memory_allocator_release_allocation(allocator, &allocations[items[j].request_index]);
+        }
+    }
+
+    // A failed batch is not recorded, its allocations were rolled back
+    for (size_t j = 0; j < request_count && status == MEMORY_CONTEXT_SUCCESS; ++j) {
+        vulkan_memory_allocator_trace_allocate(allocator, &requests[j], &allocations[j], true);
+    }
+
+    mem_free(items);
+
+    return status;
+}
+
+static bool vulkan_memory_allocator_free_deferred(
+    VulkanMemoryAllocator* allocator, VulkanAllocation allocation, bool is_cacheable) {
+    allocator->free_call_count += 1;
+    allocator->frame_free_call_count += 1;
+
+    if (vulkan_memory_trace_is_open(&allocator->trace)) {
+        vulkan_memory_trace_record_free(&allocator->trace, allocation.trace_id, false);
+    }
+
+    // Transient allocations are reclaimed together with their frame
+    if (allocation.strategy != VULKAN_MEMORY_STRATEGY_DEFAULT) {
+        return true;
+    }
+
+    VulkanMemoryThreadCache* cache =
+        is_cacheable ? vulkan_memory_allocator_get_freeing_cache(allocator, &allocation) : NULL;
+
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    VulkanMemoryGarbage garbage = {
+        .allocation = allocation,
+        .frame_number = allocator->frame_number,
+        .cache = cache,
+    };
+    bool status = vector_push(&allocator->garbage, garbage);
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
 
     return status;
 }
 
 bool vulkan_memory_allocator_free(VulkanMemoryAllocator* allocator, VulkanAllocation allocation) {
-    if (allocator->garbage_list_count <= 0) {
-        return false;
+    return vulkan_memory_allocator_free_deferred(allocator, allocation, true);
+}
+
+bool vulkan_memory_allocator_free_uncached(VulkanMemoryAllocator* allocator, VulkanAllocation allocation) {
+    return vulkan_memory_allocator_free_deferred(allocator, allocation, false);
+}
+
+void vulkan_memory_allocator_empty_garbage(VulkanMemoryAllocator* allocator, uint64_t completed_frame_number) {
+    if (vulkan_memory_trace_is_open(&allocator->trace)) {
+        vulkan_memory_trace_record_empty_garbage(&allocator->trace, completed_frame_number);
     }
-    return vector_push(&allocator->garbage_lists[allocator->garbage_list_index], allocation);
+
+    // Releasing takes the memory type and block locks, those must not be taken while holding the allocator lock so the
+    // completed allocations are moved out of the queue first
+    VulkanReleasedGarbageList released;
+    small_vector_init(&released);
+
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    size_t count = 0;
+    while (count < allocator->garbage.size && allocator->garbage.data[count].frame_number <= completed_frame_number) {
+        count += 1;
+    }
+    if (count > 0 && small_vector_reserve_nofill(&released, count)) {
+        for (size_t i = 0; i < count; ++i) {
+            released.data[i] = allocator->garbage.data[i];
+        }
+        released.size = count;
+        vector_remove_slice_noshrink(&allocator->garbage, 0, count);
+    }
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+
+    // The device is done with the ranges, the cacheable ones are handed out again by the threads that freed them
+    for (size_t i = 0; i < released.size; ++i) {
+        VulkanMemoryGarbage* garbage = &released.data[i];
+        VulkanAllocation* allocation = &garbage->allocation;
+        VulkanAllocation evicted;
+        if (vulkan_memory_allocator_cache_allocation(allocator, garbage, &evicted)) {
+            allocation = &evicted;
+        }
+        vulkan_memory_allocator_release_allocation(allocator, allocation);
+    }
+    small_vector_destroy(&released);
+
+    vulkan_memory_allocator_trim_thread_caches(allocator, false);
+}
+
+void vulkan_memory_allocator_free_immediately(VulkanMemoryAllocator* allocator, VulkanAllocation* allocation) {
+    allocator->free_call_count += 1;
+    allocator->frame_free_call_count += 1;
+
+    if (vulkan_memory_trace_is_open(&allocator->trace)) {
+        vulkan_memory_trace_record_free(&allocator->trace, allocation->trace_id, true);
+    }
+
+    vulkan_memory_allocator_release_allocation(allocator, allocation);
 }
 
-void vulkan_memory_allocator_empty_garbage(VulkanMemoryAllocator* allocator) {
-    if (allocator->garbage_list_count <= 0) {
+void vulkan_memory_allocator_release_thread_cache(VulkanMemoryAllocator* allocator) {
+    if (!allocator->is_concurrent) {
         return;
     }
 
-    allocator->garbage_list_index = (allocator->garbage_list_index + 1) % allocator->garbage_list_count;
+    VulkanMemoryThreadCache* cache = thread_local_get(&allocator->thread_cache);
+    if (cache == NULL) {
+        return;
+    }
+
+    // Released outside of the cache lock, the block locks come before it
+    VulkanMemoryThreadCacheEntry entries[VULKAN_MEMORY_THREAD_CACHE_SIZE];
+    vulkan_memory_allocator_lock(allocator, &cache->lock);
+    uint32_t count = cache->count;
+    mem_copy(cache->entries, entries, sizeof(VulkanMemoryThreadCacheEntry) * count);
+    cache->count = 0;
+    cache->is_released = true;
+    vulkan_memory_allocator_unlock(allocator, &cache->lock);
 
-    vulkan_memory_allocator_empty_garbage_index(allocator, allocator->garbage_list_index);
+    for (uint32_t i = 0; i < count; ++i) {
+        vulkan_memory_allocator_release_allocation(allocator, &entries[i].allocation);
+    }
 }
 
-void vulkan_memory_allocator_destroy(VulkanMemoryAllocator* allocator) {
-    for (size_t i = 0; i < allocator->garbage_list_count; ++i) {
-        vulkan_memory_allocator_empty_garbage_index(allocator, i);
-        vector_clear(&allocator->garbage_lists[i]);
+MemoryContextError vulkan_memory_allocator_write(VulkanMemoryAllocator* allocator, const VulkanAllocation* allocation,
+    VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    if (allocation->data == NULL) {
+        return MEMORY_CONTEXT_MAPPING_ERROR;
+    }
+    if (offset + size > allocation->size) {
+        return MEMORY_CONTEXT_INVALID_BUFFER_SIZE;
+    }
+
+    mem_copy(data, allocation->data + offset, size);
+    if (!vulkan_memory_allocator_mark_dirty(allocator, allocation, offset, size)) {
+        return MEMORY_CONTEXT_ALLOCATION_ERROR;
+    }
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+bool vulkan_memory_allocator_mark_dirty(
+    VulkanMemoryAllocator* allocator, const VulkanAllocation* allocation, VkDeviceSize offset, VkDeviceSize size) {
+    if (allocation->is_coherent || size == 0) {
+        return true;
+    }
+
+    // Flushed ranges have to start and end on an atom boundary or end at the end of the memory
+    VkDeviceSize atom_size = allocator->non_coherent_atom_size;
+    VkDeviceSize start = allocation->offset + offset;
+    VkDeviceSize end = start + size;
+    start -= start % atom_size;
+    end = MIN((end + atom_size - 1) / atom_size * atom_size, allocation->memory_size);
+
+    VkMappedMemoryRange range = {
+        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+        .pNext = NULL,
+        .memory = allocation->device_memory_handle,
+        .offset = start,
+        .size = end - start,
+    };
+
+    // Consecutive writes usually hit the same or a neighbouring range
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    VulkanMappedMemoryRangeList* ranges = &allocator->dirty_ranges;
+    bool status = (ranges->size > 0 && vulkan_memory_allocator_try_merge_range(
+                                           &ranges->data[ranges->size - 1], range.memory, start, end)) ||
+                  vector_push(ranges, range);
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+
+    return status;
+}
+
+MemoryContextError vulkan_memory_allocator_flush(VulkanMemoryAllocator* allocator) {
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    VulkanMappedMemoryRangeList* ranges = &allocator->dirty_ranges;
+    if (ranges->size == 0) {
+        vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+        return MEMORY_CONTEXT_SUCCESS;
+    }
+
+    qsort(ranges->data, ranges->size, sizeof(VkMappedMemoryRange), vulkan_memory_allocator_compare_ranges);
+    size_t count = 1;
+    for (size_t i = 1; i < ranges->size; ++i) {
+        const VkMappedMemoryRange* range = &ranges->data[i];
+        if (!vulkan_memory_allocator_try_merge_range(
+                &ranges->data[count - 1], range->memory, range->offset, range->offset + range->size)) {
+            ranges->data[count++] = *range;
+        }
+    }
+
+    VkResult status = vulkan_memory_backend_flush_memory(
+        allocator->backend, allocator->device->handle, (uint32_t)count, ranges->data);
+    vector_empty_noshrink(ranges);
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+    ASSERT_VK_LOG(status, "Unable to flush mapped memory", MEMORY_CONTEXT_MAPPING_ERROR);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+void vulkan_memory_allocator_begin_frame(
+    VulkanMemoryAllocator* allocator, uint32_t frame_index, uint64_t frame_number) {
+    if (frame_index >= VULKAN_TRANSIENT_BLOCK_MAX_FRAMES) {
+        log_warning("Memory allocator frame index %u out of range", frame_index);
+        return;
+    }
+
+    if (vulkan_memory_trace_is_open(&allocator->trace)) {
+        vulkan_memory_trace_record_begin_frame(&allocator->trace, frame_index, frame_number);
+    }
+
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    allocator->frame_index = frame_index;
+    allocator->frame_number = frame_number;
+
+    allocator->last_frame_allocate_call_count = atomic_exchange(&allocator->frame_allocate_call_count, 0);
+    allocator->last_frame_free_call_count = atomic_exchange(&allocator->frame_free_call_count, 0);
+
+    if (vulkan_transient_block_is_init(&allocator->ring_block)) {
+        vulkan_transient_block_begin_frame(&allocator->ring_block, frame_index);
     }
-    mem_free(allocator->garbage_lists);
-    allocator->garbage_list_count = 0;
+    if (vulkan_transient_block_is_init(&allocator->linear_blocks[frame_index])) {
+        vulkan_transient_block_begin_frame(&allocator->linear_blocks[frame_index], frame_index);
+    }
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+}
+
+MemoryContextError vulkan_memory_allocator_plan_defragmentation(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryDefragmentationCandidate* candidates, size_t candidate_count,
+    const VulkanMemoryDefragmentationLimits* limits, VulkanMemoryDefragmentationMoveList* moves) {
+    // Cached ranges are not candidates, left in the caches they would keep their blocks from being emptied
+    vulkan_memory_allocator_trim_thread_caches(allocator, true);
+
+    VulkanMemoryBlockList sorted_blocks;
+    vector_init(&sorted_blocks);
+    VkDeviceSize planned_bytes = 0;
+
+    for (uint32_t memory_index = 0; memory_index < VK_MAX_MEMORY_TYPES; ++memory_index) {
+        const Mutex* type_lock = &allocator->memory_type_locks[memory_index];
+        const VulkanMemoryBlockList* blocks = &allocator->blocks[memory_index];
+        vector_empty_noshrink(&sorted_blocks);
+
+        vulkan_memory_allocator_lock(allocator, type_lock);
+        for (size_t i = 0; i < blocks->size; ++i) {
+            if (!blocks->data[i]->is_dedicated && !vector_push(&sorted_blocks, blocks->data[i])) {
+                vulkan_memory_allocator_unlock(allocator, type_lock);
+                vector_clear(&sorted_blocks);
+                return MEMORY_CONTEXT_INIT_ERROR;
+            }
+        }
+
+        // Holding the memory type lock keeps other threads from locking more than one block at a time
+        for (size_t i = 0; i < sorted_blocks.size; ++i) {
+            vulkan_memory_allocator_lock(allocator, &sorted_blocks.data[i]->mutex);
+        }
+        vulkan_memory_allocator_sort_blocks_by_usage(&sorted_blocks);
+
+        // Try to empty the least used blocks into the fuller ones, a partially emptied block frees nothing so its
+        // moves are rolled back unless every allocation inside it can be moved
+        for (size_t i = 0; i + 1 < sorted_blocks.size; ++i) {
+            VkDeviceSize block_bytes = sorted_blocks.data[i]->allocated;
+            if (block_bytes == 0) {
+                continue;
+            }
+
+            size_t move_count = moves->size;
+            bool status = vulkan_memory_allocator_plan_block_defragmentation(
+                allocator, &sorted_blocks, i, candidates, candidate_count, moves);
+            status = status && (limits->max_moves == 0 || moves->size <= limits->max_moves);
+            status = status && (limits->max_bytes == 0 || planned_bytes + block_bytes <= limits->max_bytes);
+            if (!status) {
+                vulkan_memory_allocator_rollback_defragmentation_moves(moves, move_count);
+                continue;
+            }
+            planned_bytes += block_bytes;
+        }
+
+        for (size_t i = 0; i < sorted_blocks.size; ++i) {
+            vulkan_memory_allocator_unlock(allocator, &sorted_blocks.data[i]->mutex);
+        }
+        vulkan_memory_allocator_unlock(allocator, type_lock);
+    }
+
+    vector_clear(&sorted_blocks);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+void vulkan_memory_allocator_cancel_defragmentation_move(
+    VulkanMemoryAllocator* allocator, VulkanMemoryDefragmentationMove* move) {
+    VulkanMemoryBlock* block = move->destination.block;
+    if (block == NULL) {
+        vulkan_allocation_clear(&move->destination);
+        return;
+    }
+
+    vulkan_memory_allocator_lock(allocator, &block->mutex);
+    vulkan_memory_allocator_release_move_destination(move);
+    vulkan_memory_allocator_unlock(allocator, &block->mutex);
+}
+
+static const char* vulkan_memory_usage_to_string(VulkanMemoryUsage usage) {
+    switch (usage) {
+        case VULKAN_MEMORY_USAGE_GPU_ONLY:
+            return "gpu_only";
+        case VULKAN_MEMORY_USAGE_CPU_ONLY:
+            return "cpu_only";
+        case VULKAN_MEMORY_USAGE_CPU_TO_GPU:
+            return "cpu_to_gpu";
+        case VULKAN_MEMORY_USAGE_GPU_TO_CPU:
+            return "gpu_to_cpu";
+        default:
+            return "unknown";
+    }
+}
+
+static bool vulkan_memory_stats_json_append(VulkanMemoryStatsJson* json, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    // Keep room for the null terminator written by vsnprintf
+    if (length < 0 || !vector_reserve(json, json->size + length + 1)) {
+        return false;
+    }
+
+    va_start(args, format);
+    vsnprintf(&json->data[json->size], length + 1, format, args);
+    va_end(args);
+    json->size += length;
+
+    return true;
+}
+
+static bool vulkan_memory_stats_json_append_info(
+    VulkanMemoryStatsJson* json, const char* name, const VulkanMemoryStatInfo* info) {
+    return vulkan_memory_stats_json_append(json,
+        "\"%s\":{\"block_count\":%u,\"allocation_count\":%u,\"free_range_count\":%u,\"block_bytes\":%llu,"
+        "\"used_bytes\":%llu,\"free_bytes\":%llu,\"largest_free_range\":%llu,\"padding_bytes\":%llu,"
+        "\"cached_bytes\":%llu}",
+        name, info->block_count, info->allocation_count, info->free_range_count,
+        (unsigned long long)info->block_bytes, (unsigned long long)info->used_bytes,
+        (unsigned long long)info->free_bytes, (unsigned long long)info->largest_free_range,
+        (unsigned long long)info->padding_bytes, (unsigned long long)info->cached_bytes);
+}
+
+static bool vulkan_memory_stats_json_append_block(VulkanMemoryStatsJson* json, const char* strategy,
+    uint32_t memory_type_index, VulkanMemoryUsage usage, bool dedicated, const VulkanMemoryStatInfo* info) {
+    return vulkan_memory_stats_json_append(json, "%s{\"strategy\":\"%s\",\"memory_type\":%u,\"usage\":\"%s\",",
+               json->data[json->size - 1] == '[' ? "" : ",", strategy, memory_type_index,
+               vulkan_memory_usage_to_string(usage)) &&
+           vulkan_memory_stats_json_append(json, "\"dedicated\":%s,", dedicated ? "true" : "false") &&
+           vulkan_memory_stats_json_append_info(json, "stats", info) &&
+           vulkan_memory_stats_json_append(json, "}");
+}
+
+static bool vulkan_memory_stats_json_append_transient_block(
+    VulkanMemoryStatsJson* json, const VulkanTransientBlock* block) {
+    if (!vulkan_transient_block_is_init(block)) {
+        return true;
+    }
+
+    VulkanMemoryStatInfo info;
+    vulkan_transient_block_get_stats(block, &info);
+    const char* strategy = block->strategy == VULKAN_MEMORY_STRATEGY_RING ? "ring" : "linear";
+    return vulkan_memory_stats_json_append_block(
+        json, strategy, block->memory_type_index, VULKAN_MEMORY_USAGE_CPU_TO_GPU, false, &info);
+}
+
+static bool vulkan_memory_allocator_write_stats_json(
+    const VulkanMemoryAllocator* allocator, VulkanMemoryStatsJson* json) {
+    VulkanMemoryStats stats;
+    vulkan_memory_allocator_get_stats(allocator, &stats);
+    const VkPhysicalDeviceMemoryProperties* memory_props = &allocator->device->physical_device->memory_properties;
+
+    bool status = vulkan_memory_stats_json_append(json,
+        "{\"allocate_call_count\":%llu,\"free_call_count\":%llu,\"frame_allocate_call_count\":%u,"
+        "\"frame_free_call_count\":%u,\"has_memory_budget\":%s,",
+        (unsigned long long)stats.allocate_call_count, (unsigned long long)stats.free_call_count,
+        stats.frame_allocate_call_count, stats.frame_free_call_count, stats.has_memory_budget ? "true" : "false");
+    status = status && vulkan_memory_stats_json_append_info(json, "total", &stats.total);
+
+    status = status && vulkan_memory_stats_json_append(json, ",\"memory_heaps\":[");
+    for (uint32_t i = 0; i < memory_props->memoryHeapCount && status; ++i) {
+        status = vulkan_memory_stats_json_append(json, "%s{\"index\":%u,\"size\":%llu,\"budget\":%llu,\"usage\":%llu,",
+                     i == 0 ? "" : ",", i, (unsigned long long)memory_props->memoryHeaps[i].size,
+                     (unsigned long long)stats.heap_budgets[i].budget,
+                     (unsigned long long)stats.heap_budgets[i].usage) &&
+                 vulkan_memory_stats_json_append_info(json, "stats", &stats.memory_heaps[i]) &&
+                 vulkan_memory_stats_json_append(json, "}");
+    }
+
+    status = status && vulkan_memory_stats_json_append(json, "],\"memory_types\":[");
+    for (uint32_t i = 0; i < memory_props->memoryTypeCount && status; ++i) {
+        status = vulkan_memory_stats_json_append(json, "%s{\"index\":%u,\"heap_index\":%u,\"property_flags\":%u,",
+                     i == 0 ? "" : ",", i, memory_props->memoryTypes[i].heapIndex,
+                     memory_props->memoryTypes[i].propertyFlags) &&
+                 vulkan_memory_stats_json_append_info(json, "stats", &stats.memory_types[i]) &&
+                 vulkan_memory_stats_json_append(json, "}");
+    }
+
+    status = status && vulkan_memory_stats_json_append(json, "],\"blocks\":[");
+    for (uint32_t memory_index = 0; memory_index < VK_MAX_MEMORY_TYPES && status; ++memory_index) {
+        const Mutex* type_lock = &allocator->memory_type_locks[memory_index];
+        const VulkanMemoryBlockList* blocks = &allocator->blocks[memory_index];
+        vulkan_memory_allocator_lock(allocator, type_lock);
+        for (size_t i = 0; i < blocks->size && status; ++i) {
+            const VulkanMemoryBlock* block = blocks->data[i];
+            VulkanMemoryStatInfo info;
+            vulkan_memory_allocator_lock(allocator, &block->mutex);
+            vulkan_memory_block_get_stats(block, &info);
+            vulkan_memory_allocator_unlock(allocator, &block->mutex);
+            vulkan_memory_allocator_exclude_cached_bytes(allocator, memory_index, block, &info);
+            status = vulkan_memory_stats_json_append_block(
+                json, "default", block->memory_type_index, block->usage, block->is_dedicated, &info);
+        }
+        vulkan_memory_allocator_unlock(allocator, type_lock);
+    }
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    status = status && vulkan_memory_stats_json_append_transient_block(json, &allocator->ring_block);
+    for (uint32_t i = 0; i < VULKAN_TRANSIENT_BLOCK_MAX_FRAMES && status; ++i) {
+        status = vulkan_memory_stats_json_append_transient_block(json, &allocator->linear_blocks[i]);
+    }
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+
+    return status && vulkan_memory_stats_json_append(json, "]}");
+}
+
+void vulkan_memory_allocator_get_stats(const VulkanMemoryAllocator* allocator, VulkanMemoryStats* stats) {
+    vulkan_memory_stat_info_clear(&stats->total);
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; ++i) {
+        vulkan_memory_stat_info_clear(&stats->memory_types[i]);
+    }
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; ++i) {
+        vulkan_memory_stat_info_clear(&stats->memory_heaps[i]);
+    }
+
+    VulkanMemoryStatInfo info;
+    for (uint32_t memory_index = 0; memory_index < VK_MAX_MEMORY_TYPES; ++memory_index) {
+        const Mutex* type_lock = &allocator->memory_type_locks[memory_index];
+        const VulkanMemoryBlockList* blocks = &allocator->blocks[memory_index];
+        vulkan_memory_allocator_lock(allocator, type_lock);
+        for (size_t i = 0; i < blocks->size; ++i) {
+            vulkan_memory_allocator_lock(allocator, &blocks->data[i]->mutex);
+            vulkan_memory_block_get_stats(blocks->data[i], &info);
+            vulkan_memory_allocator_unlock(allocator, &blocks->data[i]->mutex);
+            vulkan_memory_stat_info_add(&stats->memory_types[memory_index], &info);
+        }
+        vulkan_memory_allocator_exclude_cached_bytes(allocator, memory_index, NULL, &stats->memory_types[memory_index]);
+        vulkan_memory_allocator_unlock(allocator, type_lock);
+    }
+
+    vulkan_memory_allocator_lock(allocator, &allocator->lock);
+    vulkan_transient_block_get_stats(&allocator->ring_block, &info);
+    vulkan_memory_stat_info_add(&stats->memory_types[allocator->ring_block.memory_type_index], &info);
+    for (uint32_t i = 0; i < VULKAN_TRANSIENT_BLOCK_MAX_FRAMES; ++i) {
+        const VulkanTransientBlock* block = &allocator->linear_blocks[i];
+        vulkan_transient_block_get_stats(block, &info);
+        vulkan_memory_stat_info_add(&stats->memory_types[block->memory_type_index], &info);
+    }
+    vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+
+    const VkPhysicalDeviceMemoryProperties* memory_props = &allocator->device->physical_device->memory_properties;
+    for (uint32_t i = 0; i < memory_props->memoryTypeCount; ++i) {
+        uint32_t heap_index = memory_props->memoryTypes[i].heapIndex;
+        vulkan_memory_stat_info_add(&stats->memory_heaps[heap_index], &stats->memory_types[i]);
+        vulkan_memory_stat_info_add(&stats->total, &stats->memory_types[i]);
+    }
+
+    stats->has_memory_budget = memory_utils_get_memory_budget(allocator->device, stats->heap_budgets);
+    if (!stats->has_memory_budget) {
+        vulkan_memory_allocator_lock(allocator, &allocator->lock);
+        for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; ++i) {
+            stats->heap_budgets[i].usage = allocator->heap_block_bytes[i];
+        }
+        vulkan_memory_allocator_unlock(allocator, &allocator->lock);
+    }
+
+    stats->allocate_call_count = allocator->allocate_call_count;
+    stats->free_call_count = allocator->free_call_count;
+    stats->frame_allocate_call_count = allocator->last_frame_allocate_call_count;
+    stats->frame_free_call_count = allocator->last_frame_free_call_count;
+}
+
+char* vulkan_memory_allocator_build_stats_json(const VulkanMemoryAllocator* allocator) {
+    VulkanMemoryStatsJson json;
+    vector_init(&json);
+
+    if (allocator->device == NULL || !vulkan_memory_allocator_write_stats_json(allocator, &json)) {
+        vector_clear(&json);
+        return NULL;
+    }
+
+    return json.data;
+}
+
+void vulkan_memory_allocator_destroy(VulkanMemoryAllocator* allocator) {
+    vulkan_memory_allocator_empty_garbage(allocator, UINT64_MAX);
+    vector_clear(&allocator->garbage);
+    vulkan_memory_trace_close(&allocator->trace);
+    vector_clear(&allocator->dirty_ranges);
 
     for (uint32_t memory_index = 0; memory_index < VK_MAX_MEMORY_TYPES; ++memory_index) {
         VulkanMemoryBlockList* blocks = &allocator->blocks[memory_index];
@@ -171,5 +1349,25 @@ void vulkan_memory_allocator_destroy(VulkanMemoryAllocator* allocator) {
         vector_clear(blocks);
     }
 
+    vulkan_transient_block_destroy(&allocator->ring_block);
+    for (uint32_t i = 0; i < VULKAN_TRANSIENT_BLOCK_MAX_FRAMES; ++i) {
+        vulkan_transient_block_destroy(&allocator->linear_blocks[i]);
+    }
+
+    // The cached ranges went away with their blocks
+    for (size_t i = 0; i < allocator->thread_caches.size; ++i) {
+        mutex_destroy(&allocator->thread_caches.data[i]->lock);
+        mem_free(allocator->thread_caches.data[i]);
+    }
+    vector_clear(&allocator->thread_caches);
+    if (thread_local_is_init(&allocator->thread_cache)) {
+        thread_local_set(&allocator->thread_cache, NULL);
+    }
+
+    mutex_destroy(&allocator->lock);
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; ++i) {
+        mutex_destroy(&allocator->memory_type_locks[i]);
+    }
+
     vulkan_memory_allocator_clear(allocator);
 }
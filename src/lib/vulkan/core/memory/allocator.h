@@ -1,64 +1,227 @@
 #ifndef ALLOCATOR_H
 #define ALLOCATOR_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <vulkan/vulkan.h>
 
 #include "../../../core/collections/vector.h"
+#include "../../../core/threads/mutex.h"
+#include "../../../core/threads/thread_local.h"
 #include "../../core/device/device.h"
 #include "../../core/errors.h"
+#include "../../utils/memory.h"
 #include "./allocation_blocks.h"
+#include "./backend/memory_backend.h"
+#include "./trace/memory_trace.h"
+#include "./transient_block.h"
 
 typedef struct VulkanMemoryAllocatorInfo {
     const Device* device;
+    // NULL selects the Vulkan backend
+    const VulkanMemoryBackend* backend;
 
     VkDeviceSize device_local_block_size_MB;
     VkDeviceSize host_visible_block_size_MB;
+    VkDeviceSize transient_block_size_MB;
+    VkDeviceSize dedicated_allocation_threshold_MB;
 
-    size_t garbage_list_count;
+    // Allows allocating and freeing from several threads at once
+    bool concurrent;
+    // Records every request into the file when set
+    const char* trace_path;
 } VulkanMemoryAllocatorInfo;
 
 static inline VulkanMemoryAllocatorInfo vulkan_memory_allocator_info_get_default() {
     return (VulkanMemoryAllocatorInfo){
         .device = NULL,
+        .backend = NULL,
         .device_local_block_size_MB = 256,
         .host_visible_block_size_MB = 256,
-        .garbage_list_count = 1,
+        .transient_block_size_MB = 16,
+        .dedicated_allocation_threshold_MB = 64,
+        .concurrent = false,
+        .trace_path = NULL,
     };
 }
 
 typedef struct VulkanMemoryAllocatorRequest {
-    uint32_t size;
+    VkDeviceSize size;
     uint32_t align;
     uint32_t memory_type_bits;
     VulkanMemoryUsage usage;
     VulkanAllocationType allocation_type;
+    VulkanMemoryStrategy strategy;
+
+    // Filled from VkMemoryDedicatedRequirements, the buffer is optional and only used for the dedicated allocation
+    bool prefers_dedicated_allocation;
+    bool requires_dedicated_allocation;
+    VkBuffer buffer;
 } VulkanMemoryAllocatorRequest;
 
+typedef struct VulkanMemoryDefragmentationCandidate {
+    VulkanAllocation allocation;
+    uint32_t align;
+} VulkanMemoryDefragmentationCandidate;
+
+typedef struct VulkanMemoryDefragmentationMove {
+    size_t candidate_index;
+    VulkanAllocation source;
+    VulkanAllocation destination;
+} VulkanMemoryDefragmentationMove;
+
+typedef struct VulkanMemoryDefragmentationMoveList VECTOR(VulkanMemoryDefragmentationMove)
+    VulkanMemoryDefragmentationMoveList;
+
+// Zero means no limit
+typedef struct VulkanMemoryDefragmentationLimits {
+    VkDeviceSize max_bytes;
+    uint32_t max_moves;
+} VulkanMemoryDefragmentationLimits;
+
+typedef struct VulkanMemoryStats {
+    VulkanMemoryStatInfo total;
+    VulkanMemoryStatInfo memory_types[VK_MAX_MEMORY_TYPES];
+    VulkanMemoryStatInfo memory_heaps[VK_MAX_MEMORY_HEAPS];
+
+    // Without VK_EXT_memory_budget the usage only covers the memory owned by the allocator
+    bool has_memory_budget;
+    VulkanMemoryHeapBudget heap_budgets[VK_MAX_MEMORY_HEAPS];
+
+    uint64_t allocate_call_count;
+    uint64_t free_call_count;
+    // Calls made during the last finished frame
+    uint32_t frame_allocate_call_count;
+    uint32_t frame_free_call_count;
+} VulkanMemoryStats;
+
+struct VulkanMemoryThreadCache;
+
+// An allocation freed while the frame with the given number could still be using it
+typedef struct VulkanMemoryGarbage {
+    VulkanAllocation allocation;
+    uint64_t frame_number;
+    // Cache of the thread that freed the allocation, the completed range goes there instead of its block. NULL for
+    // uncached frees
+    struct VulkanMemoryThreadCache* cache;
+} VulkanMemoryGarbage;
+
+typedef struct VulkanMemoryGarbageList VECTOR(VulkanMemoryGarbage) VulkanMemoryGarbageList;
+
+typedef struct VulkanMappedMemoryRangeList VECTOR(VkMappedMemoryRange) VulkanMappedMemoryRangeList;
+
+#define VULKAN_MEMORY_THREAD_CACHE_SIZE 16
+// Cached ranges not reused within this many frames after they were freed go back to their blocks
+#define VULKAN_MEMORY_THREAD_CACHE_MAX_AGE 8
+
+typedef struct VulkanMemoryThreadCacheEntry {
+    VulkanAllocation allocation;
+    // Frame the range was freed in
+    uint64_t frame_number;
+} VulkanMemoryThreadCacheEntry;
+
+// Completed ranges freed by one thread, their chunks stay allocated in the blocks so the thread can hand them out again
+// without the memory type and block locks. The thread emptying the garbage fills the cache and trims the old entries,
+// the cache lock is only contended by those. Ordered from the oldest
+typedef struct VulkanMemoryThreadCache {
+    Mutex lock;
+    VulkanMemoryThreadCacheEntry entries[VULKAN_MEMORY_THREAD_CACHE_SIZE];
+    uint32_t count;
+    // Set once the owner released the cache, completed ranges go back to their blocks until the owner frees again
+    bool is_released;
+} VulkanMemoryThreadCache;
+
+typedef struct VulkanMemoryThreadCacheList VECTOR(VulkanMemoryThreadCache*) VulkanMemoryThreadCacheList;
+
 typedef struct VulkanMemoryAllocator {
     const Device* device;
+    const VulkanMemoryBackend* backend;
 
     VkDeviceSize device_local_block_size_bytes;
     VkDeviceSize host_visible_block_size_bytes;
+    VkDeviceSize dedicated_allocation_threshold_bytes;
 
     VulkanMemoryBlockList blocks[VK_MAX_MEMORY_TYPES];
 
-    size_t garbage_list_index;
-    size_t garbage_list_count;
-    VulkanAllocationList* garbage_lists;
+    // Per frame memory, linear blocks are owned by one frame slot each, the ring block is shared by all frames
+    VkDeviceSize transient_block_size_bytes;
+    uint32_t frame_index;
+    VulkanTransientBlock ring_block;
+    VulkanTransientBlock linear_blocks[VULKAN_TRANSIENT_BLOCK_MAX_FRAMES];
+
+    // Frame number of the frame being recorded, frees are deferred until it completes. The garbage is ordered by
+    // frame number
+    uint64_t frame_number;
+    VulkanMemoryGarbageList garbage;
+
+    // Written ranges of non coherent memory waiting for vulkan_memory_allocator_flush, aligned to the atom size
+    VkDeviceSize non_coherent_atom_size;
+    VulkanMappedMemoryRangeList dirty_ranges;
+
+    // Device memory allocated by the allocator per heap, used for the budget when the driver does not report usage.
+    // Pending bytes are reserved for blocks whose device memory is being allocated, the driver usage misses those
+    VkDeviceSize heap_block_bytes[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize heap_pending_bytes[VK_MAX_MEMORY_HEAPS];
+
+    // The memory type locks guard the block lists, the block locks guard the chunks of a block and the allocator lock
+    // guards the rest of the shared state, a thread cache lock guards its entries. Locks are taken in that order and
+    // only when the allocator is concurrent
+    bool is_concurrent;
+    Mutex memory_type_locks[VK_MAX_MEMORY_TYPES];
+    Mutex lock;
+    ThreadLocal thread_cache;
+    VulkanMemoryThreadCacheList thread_caches;
+
+    VulkanMemoryTrace trace;
+
+    atomic_uint_least64_t allocate_call_count;
+    atomic_uint_least64_t free_call_count;
+    atomic_uint_least32_t frame_allocate_call_count;
+    atomic_uint_least32_t frame_free_call_count;
+    uint32_t last_frame_allocate_call_count;
+    uint32_t last_frame_free_call_count;
 } VulkanMemoryAllocator;
 
 static inline void vulkan_memory_allocator_clear(VulkanMemoryAllocator* allocator) {
     allocator->device = NULL;
-    allocator->garbage_list_index = 0;
+    allocator->backend = NULL;
     allocator->device_local_block_size_bytes = 0;
     allocator->host_visible_block_size_bytes = 0;
-    allocator->garbage_list_count = 0;
-    allocator->garbage_lists = NULL;
+    allocator->dedicated_allocation_threshold_bytes = 0;
+    allocator->frame_number = 0;
+    vector_init(&allocator->garbage);
+    allocator->non_coherent_atom_size = 1;
+    vector_init(&allocator->dirty_ranges);
 
     for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; ++i) {
         vector_init(&allocator->blocks[i]);
+        mutex_clear(&allocator->memory_type_locks[i]);
+    }
+
+    allocator->is_concurrent = false;
+    mutex_clear(&allocator->lock);
+    thread_local_clear(&allocator->thread_cache);
+    vector_init(&allocator->thread_caches);
+    vulkan_memory_trace_clear(&allocator->trace);
+
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; ++i) {
+        allocator->heap_block_bytes[i] = 0;
+        allocator->heap_pending_bytes[i] = 0;
+    }
+
+    allocator->allocate_call_count = 0;
+    allocator->free_call_count = 0;
+    allocator->frame_allocate_call_count = 0;
+    allocator->frame_free_call_count = 0;
+    allocator->last_frame_allocate_call_count = 0;
+    allocator->last_frame_free_call_count = 0;
+
+    allocator->transient_block_size_bytes = 0;
+    allocator->frame_index = 0;
+    vulkan_transient_block_clear(&allocator->ring_block);
+    for (uint32_t i = 0; i < VULKAN_TRANSIENT_BLOCK_MAX_FRAMES; ++i) {
+        vulkan_transient_block_clear(&allocator->linear_blocks[i]);
     }
 }
 
@@ -67,8 +230,43 @@ MemoryContextError vulkan_memory_allocator_init(
 
 MemoryContextError vulkan_memory_allocator_allocate(
     VulkanMemoryAllocator* allocator, const VulkanMemoryAllocatorRequest* req, VulkanAllocation* allocation);
+// Serves every request or none, the requests are sorted by memory type and size so consecutive allocations are
+// carved out of the same block
+MemoryContextError vulkan_memory_allocator_allocate_batch(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryAllocatorRequest* requests, size_t request_count, VulkanAllocation* allocations);
 bool vulkan_memory_allocator_free(VulkanMemoryAllocator* allocator, VulkanAllocation allocation);
-void vulkan_memory_allocator_empty_garbage(VulkanMemoryAllocator* allocator);
+// Deferred like vulkan_memory_allocator_free but the range goes back to its block, used for the sources of
+// defragmentation moves so the blocks being emptied are not kept alive by a thread cache
+bool vulkan_memory_allocator_free_uncached(VulkanMemoryAllocator* allocator, VulkanAllocation allocation);
+// Returns the range to its block right away, meant for allocations the device never used
+void vulkan_memory_allocator_free_immediately(VulkanMemoryAllocator* allocator, VulkanAllocation* allocation);
+// Returns the ranges cached by the calling thread to their blocks, worker threads call it before they exit. Garbage the
+// thread freed earlier goes to the blocks as well once it completes
+void vulkan_memory_allocator_release_thread_cache(VulkanMemoryAllocator* allocator);
+// Releases the garbage of every frame up to and including the completed frame number, cacheable ranges are kept in the
+// thread cache of the thread that freed them. Cached ranges older than VULKAN_MEMORY_THREAD_CACHE_MAX_AGE frames are
+// returned to their blocks
+void vulkan_memory_allocator_empty_garbage(VulkanMemoryAllocator* allocator, uint64_t completed_frame_number);
+// Host writes to mapped memory, writes to non coherent memory are made visible to the device by the next flush
+MemoryContextError vulkan_memory_allocator_write(VulkanMemoryAllocator* allocator, const VulkanAllocation* allocation,
+    VkDeviceSize offset, const void* data, VkDeviceSize size);
+// For memory written through allocation->data directly
+bool vulkan_memory_allocator_mark_dirty(
+    VulkanMemoryAllocator* allocator, const VulkanAllocation* allocation, VkDeviceSize offset, VkDeviceSize size);
+// Flushes every dirty range with a single call, meant to be called once per frame before the submit
+MemoryContextError vulkan_memory_allocator_flush(VulkanMemoryAllocator* allocator);
+void vulkan_memory_allocator_begin_frame(
+    VulkanMemoryAllocator* allocator, uint32_t frame_index, uint64_t frame_number);
+
+MemoryContextError vulkan_memory_allocator_plan_defragmentation(VulkanMemoryAllocator* allocator,
+    const VulkanMemoryDefragmentationCandidate* candidates, size_t candidate_count,
+    const VulkanMemoryDefragmentationLimits* limits, VulkanMemoryDefragmentationMoveList* moves);
+void vulkan_memory_allocator_cancel_defragmentation_move(
+    VulkanMemoryAllocator* allocator, VulkanMemoryDefragmentationMove* move);
+
+void vulkan_memory_allocator_get_stats(const VulkanMemoryAllocator* allocator, VulkanMemoryStats* stats);
+// Returns a null terminated JSON document with the stats and every block, the caller releases it with mem_free
+char* vulkan_memory_allocator_build_stats_json(const VulkanMemoryAllocator* allocator);
 
 void vulkan_memory_allocator_destroy(VulkanMemoryAllocator* allocator);
 
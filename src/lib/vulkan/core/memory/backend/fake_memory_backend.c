@@ -0,0 +1,162 @@
+#include "./fake_memory_backend.h"
+
+#include <stddef.h>
+
+#include "../../../../core/memory/memory.h"
+#include "../../../../core/utils/macro.h"
+
+typedef struct FakeDeviceMemory {
+    VkDeviceSize size;
+    uint32_t heap_index;
+    byte* data;
+} FakeDeviceMemory;
+
+static inline FakeDeviceMemory* fake_memory_backend_get_memory(VkDeviceMemory memory) {
+    return (FakeDeviceMemory*)(uintptr_t)memory;
+}
+
+static VkResult fake_memory_backend_allocate(
+    void* user, VkDevice device, const VkMemoryAllocateInfo* info, VkDeviceMemory* memory) {
+    FakeMemoryBackend* fake = user;
+    const VkPhysicalDeviceMemoryProperties* memory_props = &fake->physical_device.memory_properties;
+    if (info->memoryTypeIndex >= memory_props->memoryTypeCount || info->allocationSize == 0) {
+        return VK_ERROR_UNKNOWN;
+    }
+
+    uint32_t heap_index = memory_props->memoryTypes[info->memoryTypeIndex].heapIndex;
+    VkResult status = VK_SUCCESS;
+
+    mutex_lock(&fake->lock);
+    fake->allocate_call_count += 1;
+    if (fake->heap_usage[heap_index] + info->allocationSize > memory_props->memoryHeaps[heap_index].size) {
+        status = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    } else {
+        fake->heap_usage[heap_index] += info->allocationSize;
+        fake->peak_heap_usage[heap_index] = MAX(fake->peak_heap_usage[heap_index], fake->heap_usage[heap_index]);
+        fake->usage += info->allocationSize;
+        fake->peak_usage = MAX(fake->peak_usage, fake->usage);
+        fake->allocation_count += 1;
+    }
+    mutex_unlock(&fake->lock);
+    if (status != VK_SUCCESS) {
+        return status;
+    }
+
+    FakeDeviceMemory* fake_memory = mem_alloc(sizeof(FakeDeviceMemory));
+    if (fake_memory == NULL) {
+        mutex_lock(&fake->lock);
+        fake->heap_usage[heap_index] -= info->allocationSize;
+        fake->usage -= info->allocationSize;
+        fake->allocation_count -= 1;
+        mutex_unlock(&fake->lock);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    fake_memory->size = info->allocationSize;
+    fake_memory->heap_index = heap_index;
+    fake_memory->data = NULL;
+
+    *memory = (VkDeviceMemory)(uintptr_t)fake_memory;
+    return VK_SUCCESS;
+}
+
+static void fake_memory_backend_free(void* user, VkDevice device, VkDeviceMemory memory) {
+    FakeMemoryBackend* fake = user;
+    FakeDeviceMemory* fake_memory = fake_memory_backend_get_memory(memory);
+    if (fake_memory == NULL) {
+        return;
+    }
+
+    mutex_lock(&fake->lock);
+    fake->heap_usage[fake_memory->heap_index] -= fake_memory->size;
+    fake->usage -= fake_memory->size;
+    fake->allocation_count -= 1;
+    mutex_unlock(&fake->lock);
+
+    mem_free(fake_memory->data);
+    mem_free(fake_memory);
+}
+
+static VkResult fake_memory_backend_map(
+    void* user, VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, void** data) {
+    FakeMemoryBackend* fake = user;
+    FakeDeviceMemory* fake_memory = fake_memory_backend_get_memory(memory);
+
+    mutex_lock(&fake->lock);
+    fake->map_call_count += 1;
+    mutex_unlock(&fake->lock);
+
+    if (fake_memory->data == NULL) {
+        fake_memory->data = mem_alloc(fake_memory->size);
+        if (fake_memory->data == NULL) {
+            return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+    }
+
+    *data = fake_memory->data + offset;
+    return VK_SUCCESS;
+}
+
+// The host memory is kept so a later map sees the same contents
+static void fake_memory_backend_unmap(void* user, VkDevice device, VkDeviceMemory memory) {}
+
+static VkResult fake_memory_backend_flush(
+    void* user, VkDevice device, uint32_t range_count, const VkMappedMemoryRange* ranges) {
+    FakeMemoryBackend* fake = user;
+
+    mutex_lock(&fake->lock);
+    fake->flush_call_count += 1;
+    mutex_unlock(&fake->lock);
+
+    return VK_SUCCESS;
+}
+
+MemoryContextError fake_memory_backend_init(FakeMemoryBackend* fake, const FakeMemoryBackendInfo* info) {
+    fake_memory_backend_clear(fake);
+
+    if (info->memory_type_count > VK_MAX_MEMORY_TYPES || info->memory_heap_count > VK_MAX_MEMORY_HEAPS) {
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
+    for (uint32_t i = 0; i < info->memory_type_count; ++i) {
+        if (info->memory_types[i].heapIndex >= info->memory_heap_count) {
+            log_error("Fake memory type %u uses unknown heap %u", i, info->memory_types[i].heapIndex);
+            return MEMORY_CONTEXT_INIT_ERROR;
+        }
+    }
+
+    if (!mutex_init(&fake->lock)) {
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
+
+    VkPhysicalDeviceMemoryProperties* memory_props = &fake->physical_device.memory_properties;
+    memory_props->memoryTypeCount = info->memory_type_count;
+    for (uint32_t i = 0; i < info->memory_type_count; ++i) {
+        memory_props->memoryTypes[i] = info->memory_types[i];
+    }
+    memory_props->memoryHeapCount = info->memory_heap_count;
+    for (uint32_t i = 0; i < info->memory_heap_count; ++i) {
+        memory_props->memoryHeaps[i] = info->memory_heaps[i];
+    }
+    fake->physical_device.properties.limits.bufferImageGranularity = MAX(info->buffer_image_granularity, 1);
+    fake->physical_device.properties.limits.nonCoherentAtomSize = MAX(info->non_coherent_atom_size, 1);
+    fake->device.physical_device = &fake->physical_device;
+
+    fake->backend = (VulkanMemoryBackend){
+        .user = fake,
+        .allocate = fake_memory_backend_allocate,
+        .free = fake_memory_backend_free,
+        .map = fake_memory_backend_map,
+        .unmap = fake_memory_backend_unmap,
+        .flush = fake_memory_backend_flush,
+    };
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+void fake_memory_backend_destroy(FakeMemoryBackend* fake) {
+    if (fake->allocation_count > 0) {
+        log_warning("Fake memory backend destroyed with %u live allocations", fake->allocation_count);
+    }
+
+    mutex_destroy(&fake->lock);
+    fake_memory_backend_clear(fake);
+}
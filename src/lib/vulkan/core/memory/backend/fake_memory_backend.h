@@ -0,0 +1,90 @@
+#ifndef FAKE_MEMORY_BACKEND_H
+#define FAKE_MEMORY_BACKEND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+#include "../../../../core/threads/mutex.h"
+#include "../../device/device.h"
+#include "../../errors.h"
+#include "../../physical_device/physical_device.h"
+#include "./memory_backend.h"
+
+typedef struct FakeMemoryBackendInfo {
+    VkMemoryType memory_types[VK_MAX_MEMORY_TYPES];
+    uint32_t memory_type_count;
+    VkMemoryHeap memory_heaps[VK_MAX_MEMORY_HEAPS];
+    uint32_t memory_heap_count;
+
+    VkDeviceSize buffer_image_granularity;
+    VkDeviceSize non_coherent_atom_size;
+} FakeMemoryBackendInfo;
+
+// Discrete GPU layout: device local heap, host heap with a coherent and a cached non coherent type and a small host
+// visible window into the device local heap
+static inline FakeMemoryBackendInfo fake_memory_backend_info_get_default() {
+    return (FakeMemoryBackendInfo){
+        .memory_types =
+            {
+                {.propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .heapIndex = 0},
+                {.propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                    .heapIndex = 1},
+                {.propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                    .heapIndex = 1},
+                {.propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                    .heapIndex = 2},
+            },
+        .memory_type_count = 4,
+        .memory_heaps =
+            {
+                {.size = 8ULL << 30, .flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT},
+                {.size = 16ULL << 30, .flags = 0},
+                {.size = 256ULL << 20, .flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT},
+            },
+        .memory_heap_count = 3,
+        .buffer_image_granularity = 1024,
+        .non_coherent_atom_size = 64,
+    };
+}
+
+// Device memory backed by host memory, host memory is only allocated once the device memory is mapped. The device is
+// handed to the allocator in place of a real one
+typedef struct FakeMemoryBackend {
+    VulkanMemoryBackend backend;
+    PhysicalDevice physical_device;
+    Device device;
+
+    Mutex lock;
+    VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize peak_heap_usage[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize usage;
+    VkDeviceSize peak_usage;
+    uint32_t allocation_count;
+    uint64_t allocate_call_count;
+    uint64_t map_call_count;
+    uint64_t flush_call_count;
+} FakeMemoryBackend;
+
+static inline void fake_memory_backend_clear(FakeMemoryBackend* fake) {
+    fake->backend = (VulkanMemoryBackend){0};
+    physical_device_clear(&fake->physical_device);
+    device_clear(&fake->device);
+    mutex_clear(&fake->lock);
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; ++i) {
+        fake->heap_usage[i] = 0;
+        fake->peak_heap_usage[i] = 0;
+    }
+    fake->usage = 0;
+    fake->peak_usage = 0;
+    fake->allocation_count = 0;
+    fake->allocate_call_count = 0;
+    fake->map_call_count = 0;
+    fake->flush_call_count = 0;
+}
+
+MemoryContextError fake_memory_backend_init(FakeMemoryBackend* fake, const FakeMemoryBackendInfo* info);
+void fake_memory_backend_destroy(FakeMemoryBackend* fake);
+
+#endif
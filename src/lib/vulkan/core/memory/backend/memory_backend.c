@@ -0,0 +1,39 @@
+#include "./memory_backend.h"
+
+#include <stddef.h>
+
+#include "../../functions.h"
+
+static VkResult vulkan_memory_backend_vulkan_allocate(
+    void* user, VkDevice device, const VkMemoryAllocateInfo* info, VkDeviceMemory* memory) {
+    return vkAllocateMemory(device, info, NULL, memory);
+}
+
+static void vulkan_memory_backend_vulkan_free(void* user, VkDevice device, VkDeviceMemory memory) {
+    vkFreeMemory(device, memory, NULL);
+}
+
+static VkResult vulkan_memory_backend_vulkan_map(
+    void* user, VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, void** data) {
+    return vkMapMemory(device, memory, offset, size, 0, data);
+}
+
+static void vulkan_memory_backend_vulkan_unmap(void* user, VkDevice device, VkDeviceMemory memory) {
+    vkUnmapMemory(device, memory);
+}
+
+static VkResult vulkan_memory_backend_vulkan_flush(
+    void* user, VkDevice device, uint32_t range_count, const VkMappedMemoryRange* ranges) {
+    return vkFlushMappedMemoryRanges(device, range_count, ranges);
+}
+
+static const VulkanMemoryBackend vulkan_memory_backend_vulkan = {
+    .user = NULL,
+    .allocate = vulkan_memory_backend_vulkan_allocate,
+    .free = vulkan_memory_backend_vulkan_free,
+    .map = vulkan_memory_backend_vulkan_map,
+    .unmap = vulkan_memory_backend_vulkan_unmap,
+    .flush = vulkan_memory_backend_vulkan_flush,
+};
+
+const VulkanMemoryBackend* vulkan_memory_backend_get_default() { return &vulkan_memory_backend_vulkan; }
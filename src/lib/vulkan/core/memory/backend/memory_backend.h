@@ -0,0 +1,55 @@
+#ifndef MEMORY_BACKEND_H
+#define MEMORY_BACKEND_H
+
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+typedef VkResult (*vulkan_memory_backend_allocate)(
+    void* user, VkDevice device, const VkMemoryAllocateInfo* info, VkDeviceMemory* memory);
+typedef void (*vulkan_memory_backend_free)(void* user, VkDevice device, VkDeviceMemory memory);
+typedef VkResult (*vulkan_memory_backend_map)(
+    void* user, VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, void** data);
+typedef void (*vulkan_memory_backend_unmap)(void* user, VkDevice device, VkDeviceMemory memory);
+typedef VkResult (*vulkan_memory_backend_flush)(
+    void* user, VkDevice device, uint32_t range_count, const VkMappedMemoryRange* ranges);
+
+// Device memory calls made by the allocator, swapped out to run the allocator without a GPU
+typedef struct VulkanMemoryBackend {
+    void* user;
+
+    vulkan_memory_backend_allocate allocate;
+    vulkan_memory_backend_free free;
+    vulkan_memory_backend_map map;
+    vulkan_memory_backend_unmap unmap;
+    vulkan_memory_backend_flush flush;
+} VulkanMemoryBackend;
+
+// Forwards to the loaded Vulkan functions
+const VulkanMemoryBackend* vulkan_memory_backend_get_default();
+
+static inline VkResult vulkan_memory_backend_allocate_memory(const VulkanMemoryBackend* backend, VkDevice device,
+    const VkMemoryAllocateInfo* info, VkDeviceMemory* memory) {
+    return backend->allocate(backend->user, device, info, memory);
+}
+
+static inline void vulkan_memory_backend_free_memory(
+    const VulkanMemoryBackend* backend, VkDevice device, VkDeviceMemory memory) {
+    backend->free(backend->user, device, memory);
+}
+
+static inline VkResult vulkan_memory_backend_map_memory(const VulkanMemoryBackend* backend, VkDevice device,
+    VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, void** data) {
+    return backend->map(backend->user, device, memory, offset, size, data);
+}
+
+static inline void vulkan_memory_backend_unmap_memory(
+    const VulkanMemoryBackend* backend, VkDevice device, VkDeviceMemory memory) {
+    backend->unmap(backend->user, device, memory);
+}
+
+static inline VkResult vulkan_memory_backend_flush_memory(
+    const VulkanMemoryBackend* backend, VkDevice device, uint32_t range_count, const VkMappedMemoryRange* ranges) {
+    return backend->flush(backend->user, device, range_count, ranges);
+}
+
+#endif
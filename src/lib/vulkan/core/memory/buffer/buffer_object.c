@@ -6,7 +6,11 @@
 static VkBufferUsageFlags vulkan_buffer_get_usage_flags(VKBOPropertyFlags flags) {
     VkBufferUsageFlags usage = 0;
     if (FLAGS_CHECK_FLAG(flags, VKBO_STATIC_USAGE_BIT)) {
-        usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        // Static buffers are filled by transfers and can be relocated by the defragmenter
+        usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    }
+    if (FLAGS_CHECK_FLAG(flags, VKBO_STAGING_BIT)) {
+        usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
     }
     if (FLAGS_CHECK_FLAG(flags, VKBO_VERTEX_BIT)) {
         usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
@@ -20,7 +24,7 @@ static VkBufferUsageFlags vulkan_buffer_get_usage_flags(VKBOPropertyFlags flags)
     return usage;
 }
 
-MemoryContextError vulkan_buffer_object_init(VulkanBufferObject* buff, const VulkanBufferObjectInfo* info) {
+MemoryContextError vulkan_buffer_object_create(VulkanBufferObject* buff, const VulkanBufferObjectInfo* info) {
     vulkan_buffer_object_clear(buff);
 
     if (info->device == NULL) {
@@ -28,7 +32,7 @@ MemoryContextError vulkan_buffer_object_init(VulkanBufferObject* buff, const Vul
     }
     buff->device = info->device;
 
-    if (info->size == 0 || is_16_byte_aligned_size(info->size)) {
+    if (info->size == 0 || !is_16_byte_aligned_size(info->size)) {
         return MEMORY_CONTEXT_INVALID_BUFFER_SIZE;
     }
 
@@ -45,6 +49,11 @@ MemoryContextError vulkan_buffer_object_init(VulkanBufferObject* buff, const Vul
         .queueFamilyIndexCount = 0,
         .pQueueFamilyIndices = NULL,
     };
+    if (info->queue_family_index_count > 1) {
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = info->queue_family_index_count;
+        buffer_info.pQueueFamilyIndices = info->queue_family_indices;
+    }
     status = vkCreateBuffer(buff->device->handle, &buffer_info, NULL, &buffer_handle);
     ASSERT_VK_LOG(status, "Unable to create buffer", MEMORY_CONTEXT_BUFFER_INIT_ERROR);
 
@@ -52,12 +61,40 @@ MemoryContextError vulkan_buffer_object_init(VulkanBufferObject* buff, const Vul
     buff->size = info->size;
     buff->property_flags = info->flags;
 
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+void vulkan_buffer_object_query_memory_requirements(VulkanBufferObject* buff) {
     VkBufferMemoryRequirementsInfo2 memory_req_info = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2,
         .pNext = NULL,
         .buffer = buff->handle,
     };
+    VkMemoryDedicatedRequirements dedicated_requirements = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+        .pNext = NULL,
+        .prefersDedicatedAllocation = VK_FALSE,
+        .requiresDedicatedAllocation = VK_FALSE,
+    };
+    buff->memory_requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    buff->memory_requirements.pNext = &dedicated_requirements;
     vkGetBufferMemoryRequirements2(buff->device->handle, &memory_req_info, &buff->memory_requirements);
+    buff->memory_requirements.pNext = NULL;
+    buff->prefers_dedicated_allocation = dedicated_requirements.prefersDedicatedAllocation == VK_TRUE;
+    buff->requires_dedicated_allocation = dedicated_requirements.requiresDedicatedAllocation == VK_TRUE;
+}
+
+void vulkan_buffer_object_copy_memory_requirements(const VulkanBufferObject* src, VulkanBufferObject* dst) {
+    dst->memory_requirements = src->memory_requirements;
+    dst->prefers_dedicated_allocation = src->prefers_dedicated_allocation;
+    dst->requires_dedicated_allocation = src->requires_dedicated_allocation;
+}
+
+MemoryContextError vulkan_buffer_object_init(VulkanBufferObject* buff, const VulkanBufferObjectInfo* info) {
+    MemoryContextError status = vulkan_buffer_object_create(buff, info);
+    ASSERT_SUCCESS(status, status);
+
+    vulkan_buffer_object_query_memory_requirements(buff);
 
     return MEMORY_CONTEXT_SUCCESS;
 }
@@ -69,6 +106,8 @@ void vulkan_buffer_object_copy(const VulkanBufferObject* src, VulkanBufferObject
     dst->memory_requirements = src->memory_requirements;
     dst->property_flags = src->property_flags;
     dst->size = src->size;
+    dst->prefers_dedicated_allocation = src->prefers_dedicated_allocation;
+    dst->requires_dedicated_allocation = src->requires_dedicated_allocation;
 }
 
 void vulkan_buffer_object_destroy(VulkanBufferObject* buff) {
@@ -1,6 +1,7 @@
 #ifndef BUFFER_OBJECT_H
 #define BUFFER_OBJECT_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <vulkan/vulkan.h>
 
@@ -16,12 +17,17 @@ typedef enum VKBOPropertyFlagBits {
     VKBO_VERTEX_BIT = FLAG_CREATE(3),
     VKBO_UNIFORM_BIT = FLAG_CREATE(4),
     VKBO_INDEX_BIT = FLAG_CREATE(5),
+    VKBO_STAGING_BIT = FLAG_CREATE(6),
 } VKBOPropertyFlagBits;
 
 typedef struct VulkanBufferObjectInfo {
     const Device* device;
     VkDeviceSize size;
     VKBOPropertyFlagBits flags;
+
+    // More than one queue family makes the buffer concurrently shared between them
+    const uint32_t* queue_family_indices;
+    uint32_t queue_family_index_count;
 } VulkanBufferObjectInfo;
 
 typedef struct VulkanBufferObject {
@@ -33,6 +39,8 @@ typedef struct VulkanBufferObject {
     VkDeviceSize size;
 
     VkMemoryRequirements2 memory_requirements;
+    bool prefers_dedicated_allocation;
+    bool requires_dedicated_allocation;
 } VulkanBufferObject;
 
 static inline void vulkan_buffer_object_clear(VulkanBufferObject* buff) {
@@ -41,9 +49,16 @@ static inline void vulkan_buffer_object_clear(VulkanBufferObject* buff) {
     buff->property_flags = 0;
     buff->size = 0;
     buff->memory_requirements = (VkMemoryRequirements2){0};
+    buff->prefers_dedicated_allocation = false;
+    buff->requires_dedicated_allocation = false;
 }
 
 MemoryContextError vulkan_buffer_object_init(VulkanBufferObject* buff, const VulkanBufferObjectInfo* info);
+// Split init for batches: buffers with the same size and flags have the same memory requirements, so only one of
+// them has to be queried
+MemoryContextError vulkan_buffer_object_create(VulkanBufferObject* buff, const VulkanBufferObjectInfo* info);
+void vulkan_buffer_object_query_memory_requirements(VulkanBufferObject* buff);
+void vulkan_buffer_object_copy_memory_requirements(const VulkanBufferObject* src, VulkanBufferObject* dst);
 void vulkan_buffer_object_copy(const VulkanBufferObject* src, VulkanBufferObject* dst);
 
 void vulkan_buffer_object_destroy(VulkanBufferObject* buff);
@@ -0,0 +1,391 @@
+#include "./memory_defragmenter.h"
+
+#include "../../../../core/string/string.h"
+#include "../../functions.h"
+#include "../memory_allocation_cache/memory_allocation_cache.h"
+
+typedef struct MemoryDefragmentationCandidateList VECTOR(VulkanMemoryDefragmentationCandidate)
+    MemoryDefragmentationCandidateList;
+typedef struct MemoryDefragmentationRecordIndexList VECTOR(size_t) MemoryDefragmentationRecordIndexList;
+
+static VkDevice memory_defragmenter_get_device(const MemoryDefragmenter* defragmenter) {
+    return defragmenter->memory_context->device->handle;
+}
+
+static bool memory_defragmenter_is_record_movable(const MemoryAllocationCacheRecord* record) {
+    if (memory_allocation_cache_record_is_empty(record) || record->type != MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD) {
+        return false;
+    }
+
+    // Host visible memory may be written by the CPU at any time, only device local blocks are compacted
+    const VulkanAllocation* allocation = &record->allocation;
+    return allocation->strategy == VULKAN_MEMORY_STRATEGY_DEFAULT && allocation->block != NULL &&
+           !allocation->block->is_dedicated && !vulkan_memory_block_is_host_visible(allocation->block);
+}
+
+static bool memory_defragmenter_is_move_valid(
+    const MemoryDefragmenter* defragmenter, const MemoryDefragmentationMove* move) {
+    const MemoryAllocationCacheRecord* record =
+        &defragmenter->memory_context->allocation_cache.records[move->record_index];
+    const VulkanAllocation* source = &move->allocation_move.source;
+
+    return !memory_allocation_cache_record_is_empty(record) && record->allocation.chunk == source->chunk &&
+           record->allocation.id == source->id;
+}
+
+static void memory_defragmenter_cancel_move(MemoryDefragmenter* defragmenter, MemoryDefragmentationMove* move) {
+    vulkan_buffer_object_destroy(&move->buffer);
+    vulkan_memory_allocator_cancel_defragmentation_move(
+        &defragmenter->memory_context->allocator, &move->allocation_move);
+    move->state = MEMORY_DEFRAGMENTATION_MOVE_DONE;
+}
+
+static MemoryContextError memory_defragmenter_prepare_move(
+    MemoryDefragmenter* defragmenter, MemoryDefragmentationMove* move) {
+    const MemoryAllocationCacheRecord* record =
+        &defragmenter->memory_context->allocation_cache.records[move->record_index];
+    const VulkanAllocation* destination = &move->allocation_move.destination;
+
+    VulkanBufferObjectInfo buffer_info = {
+        .device = record->buffer_object.device,
+        .size = record->buffer_object.size,
+        .flags = record->buffer_object.property_flags,
+    };
+    memory_context_get_buffer_object_info(defragmenter->memory_context, &buffer_info, &buffer_info);
+    MemoryContextError status = vulkan_buffer_object_init(&move->buffer, &buffer_info);
+    ASSERT_SUCCESS(status, status);
+
+    VkResult bind_status = vkBindBufferMemory(memory_defragmenter_get_device(defragmenter), move->buffer.handle,
+        destination->device_memory_handle, destination->offset);
+    ASSERT_VK_LOG(bind_status, "Unable to bind the defragmentation buffer", MEMORY_CONTEXT_BUFFER_BIND_ERROR);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+static MemoryContextError memory_defragmenter_start_copies(MemoryDefragmenter* defragmenter) {
+    if (defragmenter->next_move_index >= defragmenter->moves.size) {
+        return MEMORY_CONTEXT_SUCCESS;
+    }
+
+    CommandBufferInfo buffer_info = {
+        .buffer_index = 0,
+        .secondary = false,
+    };
+    VkCommandBuffer command_buffer = command_context_get_command_buffer(
+        defragmenter->command_context, defragmenter->command_pool_name, &buffer_info);
+    if (command_buffer == VK_NULL_HANDLE) {
+        return MEMORY_CONTEXT_COMMAND_BUFFER_ERROR;
+    }
+
+    // One barrier per copy at most, pushing them cannot fail once recording has started
+    vector_empty_noshrink(&defragmenter->barriers);
+    if (!vector_reserve(&defragmenter->barriers, defragmenter->moves.size - defragmenter->next_move_index)) {
+        return MEMORY_CONTEXT_ALLOCATION_ERROR;
+    }
+
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL,
+    };
+    ASSERT_VK(vkResetCommandBuffer(command_buffer, 0), MEMORY_CONTEXT_COMMAND_BUFFER_ERROR);
+    ASSERT_VK(vkBeginCommandBuffer(command_buffer, &begin_info), MEMORY_CONTEXT_COMMAND_BUFFER_ERROR);
+
+    const MemoryAllocationCache* cache = &defragmenter->memory_context->allocation_cache;
+    VkDeviceSize copied_bytes = 0;
+    uint32_t copy_count = 0;
+    size_t first_move_index = defragmenter->next_move_index;
+
+    while (defragmenter->next_move_index < defragmenter->moves.size) {
+        MemoryDefragmentationMove* move = &defragmenter->moves.data[defragmenter->next_move_index];
+        const VulkanBufferObject* source_buffer = &cache->records[move->record_index].buffer_object;
+
+        if (copy_count > 0) {
+            if (defragmenter->max_moves_per_step > 0 && copy_count >= defragmenter->max_moves_per_step) {
+                break;
+            }
+            if (defragmenter->max_bytes_per_step > 0 &&
+                copied_bytes + source_buffer->size > defragmenter->max_bytes_per_step) {
+                break;
+            }
+        }
+        defragmenter->next_move_index += 1;
+
+        if (!memory_defragmenter_is_move_valid(defragmenter, move)) {
+            memory_defragmenter_cancel_move(defragmenter, move);
+            continue;
+        }
+        MemoryContextError status = memory_defragmenter_prepare_move(defragmenter, move);
+        if (status != MEMORY_CONTEXT_SUCCESS) {
+            log_warning("Skipping defragmentation move: %s", memory_context_error_to_string(status));
+            memory_defragmenter_cancel_move(defragmenter, move);
+            continue;
+        }
+
+        // Earlier submissions may still write the source
+        VkBufferMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = source_buffer->handle,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE,
+        };
+        vector_push(&defragmenter->barriers, barrier);
+
+        move->state = MEMORY_DEFRAGMENTATION_MOVE_COPYING;
+        copied_bytes += source_buffer->size;
+        copy_count += 1;
+    }
+
+    if (copy_count > 0) {
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+            NULL, (uint32_t)defragmenter->barriers.size, defragmenter->barriers.data, 0, NULL);
+    }
+    for (size_t i = first_move_index; i < defragmenter->next_move_index; ++i) {
+        const MemoryDefragmentationMove* move = &defragmenter->moves.data[i];
+        if (move->state != MEMORY_DEFRAGMENTATION_MOVE_COPYING) {
+            continue;
+        }
+
+        const VulkanBufferObject* source_buffer = &cache->records[move->record_index].buffer_object;
+        VkBufferCopy region = {
+            .srcOffset = 0,
+            .dstOffset = 0,
+            .size = source_buffer->size,
+        };
+        vkCmdCopyBuffer(command_buffer, source_buffer->handle, move->buffer.handle, 1, &region);
+    }
+
+    // Make the copies visible to everything submitted after the swap
+    VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1,
+        &barrier, 0, NULL, 0, NULL);
+    ASSERT_VK(vkEndCommandBuffer(command_buffer), MEMORY_CONTEXT_COMMAND_BUFFER_ERROR);
+
+    if (copy_count == 0) {
+        return MEMORY_CONTEXT_SUCCESS;
+    }
+
+    VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &command_buffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL,
+    };
+    VkResult status = vkQueueSubmit(defragmenter->queue.handle, 1, &submit_info, defragmenter->fence);
+    ASSERT_VK_LOG(status, "Unable to submit the defragmentation copies", MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED);
+    defragmenter->is_copy_in_flight = true;
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+static void memory_defragmenter_finish_copies(MemoryDefragmenter* defragmenter) {
+    MemoryAllocationCache* cache = &defragmenter->memory_context->allocation_cache;
+
+    for (size_t i = 0; i < defragmenter->next_move_index; ++i) {
+        MemoryDefragmentationMove* move = &defragmenter->moves.data[i];
+        if (move->state != MEMORY_DEFRAGMENTATION_MOVE_COPYING) {
+            continue;
+        }
+        if (!memory_defragmenter_is_move_valid(defragmenter, move)) {
+            memory_defragmenter_cancel_move(defragmenter, move);
+            continue;
+        }
+
+        // Swap the copy into the record, frames recorded before the swap may still use the old buffer and allocation
+        MemoryAllocationCacheRecord* record = &cache->records[move->record_index];
+        VulkanBufferObject retired_buffer;
+        vulkan_buffer_object_copy(&record->buffer_object, &retired_buffer);
+        vulkan_buffer_object_copy(&move->buffer, &record->buffer_object);
+        vulkan_buffer_object_clear(&move->buffer);
+        vulkan_allocation_copy(&move->allocation_move.destination, &record->allocation);
+
+        // The source range goes back to its block, cached it would keep the block from being emptied
+        memory_context_retire_buffer(
+            defragmenter->memory_context, &retired_buffer, move->allocation_move.source, false);
+        move->state = MEMORY_DEFRAGMENTATION_MOVE_DONE;
+    }
+}
+
+static MemoryContextError memory_defragmenter_plan(MemoryDefragmenter* defragmenter,
+    const VulkanMemoryDefragmentationLimits* limits, VulkanMemoryDefragmentationMoveList* allocation_moves,
+    MemoryDefragmentationRecordIndexList* record_indices) {
+    const MemoryAllocationCache* cache = &defragmenter->memory_context->allocation_cache;
+    MemoryDefragmentationCandidateList candidates;
+    vector_init(&candidates);
+
+    for (size_t i = 0; i < cache->records_size; ++i) {
+        const MemoryAllocationCacheRecord* record = &cache->records[i];
+        if (!memory_defragmenter_is_record_movable(record)) {
+            continue;
+        }
+
+        VulkanMemoryDefragmentationCandidate candidate = {
+            .align = record->buffer_object.memory_requirements.memoryRequirements.alignment,
+        };
+        vulkan_allocation_copy(&record->allocation, &candidate.allocation);
+        if (!vector_push(&candidates, candidate) || !vector_push(record_indices, i)) {
+            vector_clear(&candidates);
+            return MEMORY_CONTEXT_INIT_ERROR;
+        }
+    }
+
+    MemoryContextError status = vulkan_memory_allocator_plan_defragmentation(
+        &defragmenter->memory_context->allocator, candidates.data, candidates.size, limits, allocation_moves);
+    vector_clear(&candidates);
+
+    return status;
+}
+
+MemoryContextError memory_defragmenter_init(MemoryDefragmenter* defragmenter, const MemoryDefragmenterInfo* info) {
+    memory_defragmenter_clear(defragmenter);
+
+    if (info->memory_context == NULL || info->memory_context->device == NULL || info->command_context == NULL) {
+        return MEMORY_CONTEXT_DEVICE_NOT_PROVIDED;
+    }
+
+    defragmenter->memory_context = info->memory_context;
+    defragmenter->command_context = info->command_context;
+    defragmenter->queue = info->queue;
+    defragmenter->max_bytes_per_step = info->max_bytes_per_step;
+    defragmenter->max_moves_per_step = info->max_moves_per_step;
+
+    CommandPoolInitInfo pool_info = {
+        .primary_buffer_count = 1,
+        .secondary_buffer_count = 0,
+        .queue_family_index = defragmenter->queue.family_index,
+        .reset_enabled = true,
+        .transient = true,
+    };
+    string_copy(MEMORY_DEFRAGMENTER_COMMAND_POOL_NAME, pool_info.name, COMMAND_POOL_NAME_SIZE);
+    if (!command_context_add_command_pool(defragmenter->command_context, &pool_info)) {
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
+    defragmenter->command_pool_name = string_atom_intern(MEMORY_DEFRAGMENTER_COMMAND_POOL_NAME);
+
+    VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+    };
+    VkResult status =
+        vkCreateFence(memory_defragmenter_get_device(defragmenter), &fence_info, NULL, &defragmenter->fence);
+    ASSERT_VK_LOG(status, "Unable to create the defragmentation fence", MEMORY_CONTEXT_INIT_ERROR);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError memory_defragmenter_begin(
+    MemoryDefragmenter* defragmenter, const VulkanMemoryDefragmentationLimits* limits) {
+    if (memory_defragmenter_is_active(defragmenter)) {
+        return MEMORY_CONTEXT_DEFRAGMENTATION_IN_PROGRESS;
+    }
+
+    VulkanMemoryDefragmentationMoveList allocation_moves;
+    MemoryDefragmentationRecordIndexList record_indices;
+    vector_init(&allocation_moves);
+    vector_init(&record_indices);
+
+    MemoryContextError status = memory_defragmenter_plan(defragmenter, limits, &allocation_moves, &record_indices);
+    if (status == MEMORY_CONTEXT_SUCCESS && !vector_reserve(&defragmenter->moves, allocation_moves.size)) {
+        status = MEMORY_CONTEXT_INIT_ERROR;
+    }
+    if (status != MEMORY_CONTEXT_SUCCESS) {
+        for (size_t i = 0; i < allocation_moves.size; ++i) {
+            vulkan_memory_allocator_cancel_defragmentation_move(
+                &defragmenter->memory_context->allocator, &allocation_moves.data[i]);
+        }
+        vector_clear(&allocation_moves);
+        vector_clear(&record_indices);
+        return status;
+    }
+
+    for (size_t i = 0; i < allocation_moves.size; ++i) {
+        MemoryDefragmentationMove move = {
+            .state = MEMORY_DEFRAGMENTATION_MOVE_PENDING,
+            .record_index = record_indices.data[allocation_moves.data[i].candidate_index],
+            .allocation_move = allocation_moves.data[i],
+        };
+        vulkan_buffer_object_clear(&move.buffer);
+        vector_push(&defragmenter->moves, move);
+    }
+    defragmenter->next_move_index = 0;
+
+    vector_clear(&allocation_moves);
+    vector_clear(&record_indices);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError memory_defragmenter_step(MemoryDefragmenter* defragmenter) {
+    if (!memory_defragmenter_is_active(defragmenter)) {
+        return MEMORY_CONTEXT_SUCCESS;
+    }
+
+    VkDevice device = memory_defragmenter_get_device(defragmenter);
+
+    if (defragmenter->is_copy_in_flight) {
+        VkResult fence_status = vkGetFenceStatus(device, defragmenter->fence);
+        if (fence_status == VK_NOT_READY) {
+            return MEMORY_CONTEXT_DEFRAGMENTATION_IN_PROGRESS;
+        }
+        ASSERT_VK_LOG(fence_status, "Defragmentation copy failed", MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED);
+        ASSERT_VK(vkResetFences(device, 1, &defragmenter->fence), MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED);
+
+        defragmenter->is_copy_in_flight = false;
+        memory_defragmenter_finish_copies(defragmenter);
+    }
+
+    MemoryContextError status = memory_defragmenter_start_copies(defragmenter);
+    ASSERT_SUCCESS(status, status);
+
+    if (defragmenter->is_copy_in_flight || defragmenter->next_move_index < defragmenter->moves.size) {
+        return MEMORY_CONTEXT_DEFRAGMENTATION_IN_PROGRESS;
+    }
+
+    vector_empty_noshrink(&defragmenter->moves);
+    defragmenter->next_move_index = 0;
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+void memory_defragmenter_destroy(MemoryDefragmenter* defragmenter) {
+    if (defragmenter->memory_context == NULL) {
+        return;
+    }
+
+    VkDevice device = memory_defragmenter_get_device(defragmenter);
+    if (defragmenter->is_copy_in_flight) {
+        vkWaitForFences(device, 1, &defragmenter->fence, VK_TRUE, UINT64_MAX);
+        memory_defragmenter_finish_copies(defragmenter);
+    }
+    for (size_t i = defragmenter->next_move_index; i < defragmenter->moves.size; ++i) {
+        memory_defragmenter_cancel_move(defragmenter, &defragmenter->moves.data[i]);
+    }
+    vector_clear(&defragmenter->moves);
+    vector_clear(&defragmenter->barriers);
+
+    if (defragmenter->fence != VK_NULL_HANDLE) {
+        vkDestroyFence(device, defragmenter->fence, NULL);
+    }
+    if (string_atom_is_valid(defragmenter->command_pool_name)) {
+        command_context_remove_command_pool(defragmenter->command_context, defragmenter->command_pool_name);
+    }
+
+    memory_defragmenter_clear(defragmenter);
+}
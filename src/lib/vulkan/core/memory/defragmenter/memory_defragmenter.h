@@ -0,0 +1,91 @@
+#ifndef MEMORY_DEFRAGMENTER_H
+#define MEMORY_DEFRAGMENTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+#include "../../../../core/collections/vector.h"
+#include "../../command/command_context.h"
+#include "../../errors.h"
+#include "../../queue/queue.h"
+#include "../allocator.h"
+#include "../buffer/buffer_object.h"
+#include "../memory_context.h"
+
+#define MEMORY_DEFRAGMENTER_COMMAND_POOL_NAME "_defragmentation"
+
+typedef enum MemoryDefragmentationMoveState {
+    MEMORY_DEFRAGMENTATION_MOVE_PENDING,
+    MEMORY_DEFRAGMENTATION_MOVE_COPYING,
+    MEMORY_DEFRAGMENTATION_MOVE_DONE,
+} MemoryDefragmentationMoveState;
+
+typedef struct MemoryDefragmentationMove {
+    MemoryDefragmentationMoveState state;
+    size_t record_index;
+    VulkanMemoryDefragmentationMove allocation_move;
+
+    // The new buffer while copying
+    VulkanBufferObject buffer;
+} MemoryDefragmentationMove;
+
+typedef struct MemoryDefragmentationMoveList VECTOR(MemoryDefragmentationMove) MemoryDefragmentationMoveList;
+typedef struct MemoryDefragmentationBarrierList VECTOR(VkBufferMemoryBarrier) MemoryDefragmentationBarrierList;
+
+typedef struct MemoryDefragmenterInfo {
+    MemoryContext* memory_context;
+    CommandContext* command_context;
+    Queue queue;
+
+    VkDeviceSize max_bytes_per_step;
+    uint32_t max_moves_per_step;
+} MemoryDefragmenterInfo;
+
+// Moves buffers of device local blocks into fewer blocks. A replaced buffer is retired through the memory context and
+// stays alive until the frame that swapped it has completed, buffer handles should be resolved every frame
+typedef struct MemoryDefragmenter {
+    MemoryContext* memory_context;
+    CommandContext* command_context;
+    Queue queue;
+    StringAtom command_pool_name;
+
+    VkFence fence;
+    bool is_copy_in_flight;
+
+    VkDeviceSize max_bytes_per_step;
+    uint32_t max_moves_per_step;
+
+    MemoryDefragmentationMoveList moves;
+    MemoryDefragmentationBarrierList barriers;
+    size_t next_move_index;
+} MemoryDefragmenter;
+
+static inline void memory_defragmenter_clear(MemoryDefragmenter* defragmenter) {
+    defragmenter->memory_context = NULL;
+    defragmenter->command_context = NULL;
+    queue_clear(&defragmenter->queue);
+    defragmenter->command_pool_name = STRING_ATOM_NONE;
+    defragmenter->fence = VK_NULL_HANDLE;
+    defragmenter->is_copy_in_flight = false;
+    defragmenter->max_bytes_per_step = 0;
+    defragmenter->max_moves_per_step = 0;
+    vector_init(&defragmenter->moves);
+    vector_init(&defragmenter->barriers);
+    defragmenter->next_move_index = 0;
+}
+
+static inline bool memory_defragmenter_is_active(const MemoryDefragmenter* defragmenter) {
+    return defragmenter->moves.size > 0;
+}
+
+MemoryContextError memory_defragmenter_init(MemoryDefragmenter* defragmenter, const MemoryDefragmenterInfo* info);
+MemoryContextError memory_defragmenter_begin(
+    MemoryDefragmenter* defragmenter, const VulkanMemoryDefragmentationLimits* limits);
+// Meant to be called once per frame after memory_context_begin_frame, returns MEMORY_CONTEXT_DEFRAGMENTATION_IN_PROGRESS
+// until every move has been swapped in
+MemoryContextError memory_defragmenter_step(MemoryDefragmenter* defragmenter);
+void memory_defragmenter_destroy(MemoryDefragmenter* defragmenter);
+
+#endif
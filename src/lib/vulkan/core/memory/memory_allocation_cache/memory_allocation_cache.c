@@ -2,19 +2,95 @@
 
 #include "../../../../core/memory/memory.h"
 
-static inline ssize_t memory_allocation_cache_next_avail_record_index(const MemoryAllocationCache* cache) {
-    ssize_t i;
-    for (i = 0; i < cache->records_size; ++i) {
-        if (memory_allocation_cache_record_is_empty(&cache->records[i])) {
+#define MEMORY_ALLOCATION_CACHE_INDEX_MIN_SIZE 16
+
+// The name atom, the type and the page are mixed and finalized with the murmur3 finalizer
+static uint32_t memory_allocation_cache_hash(
+    StringAtom name, MemoryAllocationCacheRecordType type, uint32_t page_index) {
+    uint32_t hash = name * 0x9E3779B9U;
+    hash ^= (uint32_t)type * 0x85EBCA6BU;
+    hash ^= page_index + 0x7F4A7C15U + (hash << 6) + (hash >> 2);
+
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BU;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35U;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static ssize_t memory_allocation_cache_find_index_position(const MemoryAllocationCache* cache, StringAtom name,
+    MemoryAllocationCacheRecordType type, uint32_t page_index, uint32_t hash) {
+    if (cache->index == NULL) {
+        return -1;
+    }
+
+    for (size_t i = hash & cache->index_mask;; i = (i + 1) & cache->index_mask) {
+        const MemoryAllocationCacheIndexEntry* entry = &cache->index[i];
+        if (entry->record_index == MEMORY_ALLOCATION_CACHE_INDEX_EMPTY) {
+            return -1;
+        }
+        if (entry->hash == hash &&
+            memory_allocation_cache_record_page_equals(&cache->records[entry->record_index], name, type, page_index)) {
+            return i;
+        }
+    }
+}
+
+static void memory_allocation_cache_index_insert(MemoryAllocationCache* cache, uint32_t hash, uint32_t record_index) {
+    size_t i = hash & cache->index_mask;
+    while (cache->index[i].record_index != MEMORY_ALLOCATION_CACHE_INDEX_EMPTY) {
+        i = (i + 1) & cache->index_mask;
+    }
+
+    cache->index[i].hash = hash;
+    cache->index[i].record_index = record_index;
+}
+
+static void memory_allocation_cache_index_remove_at(MemoryAllocationCache* cache, size_t position) {
+    // Shift the following entries of the probe sequence back so lookups never stop at the hole
+    size_t hole = position;
+    for (size_t i = (position + 1) & cache->index_mask;; i = (i + 1) & cache->index_mask) {
+        MemoryAllocationCacheIndexEntry* entry = &cache->index[i];
+        if (entry->record_index == MEMORY_ALLOCATION_CACHE_INDEX_EMPTY) {
             break;
         }
+
+        size_t home = entry->hash & cache->index_mask;
+        size_t distance_to_entry = (i - home) & cache->index_mask;
+        size_t distance_to_hole = (hole - home) & cache->index_mask;
+        if (distance_to_hole < distance_to_entry) {
+            cache->index[hole] = *entry;
+            hole = i;
+        }
     }
 
-    if (i >= cache->records_size) {
-        return -1;
+    cache->index[hole].hash = 0;
+    cache->index[hole].record_index = MEMORY_ALLOCATION_CACHE_INDEX_EMPTY;
+}
+
+static MemoryAllocationCacheRecord* memory_allocation_cache_find_record(
+    const MemoryAllocationCache* cache, StringAtom name, MemoryAllocationCacheRecordType type, uint32_t page_index) {
+    uint32_t hash = memory_allocation_cache_hash(name, type, page_index);
+    ssize_t position = memory_allocation_cache_find_index_position(cache, name, type, page_index, hash);
+    if (position == -1) {
+        return NULL;
     }
+    return &cache->records[cache->index[position].record_index];
+}
+
+static void memory_allocation_cache_release_slot(
+    MemoryAllocationCache* cache, uint32_t record_index, MemoryAllocationCacheRecord* removed) {
+    MemoryAllocationCacheRecord* record = &cache->records[record_index];
+    *removed = *record;
+    memory_allocation_cache_record_clear(record);
 
-    return i;
+    // Outstanding handles to the slot become stale
+    record->generation += 1;
+    if (record->generation == 0) {
+        record->generation = 1;
+    }
+    cache->free_slots[cache->free_slot_count++] = record_index;
 }
 
 void memory_allocation_cache_record_destroy(MemoryAllocationCacheRecord* record) {
@@ -29,74 +105,167 @@ void memory_allocation_cache_record_destroy(MemoryAllocationCacheRecord* record)
 }
 
 bool memory_allocation_cache_init(MemoryAllocationCache* cache, size_t cache_size) {
+    memory_allocation_cache_clear(cache);
+
+    if (cache_size > MEMORY_ALLOCATION_CACHE_MAX_SIZE) {
+        log_error("Vulkan memory allocation cache size %zu is too big", cache_size);
+        return false;
+    }
+
+    // Keep the load factor at or below 0.5
+    size_t index_size = MEMORY_ALLOCATION_CACHE_INDEX_MIN_SIZE;
+    while (index_size < cache_size * 2) {
+        index_size <<= 1;
+    }
+
     MemoryAllocationCacheRecord* records = mem_alloc(sizeof(MemoryAllocationCacheRecord) * cache_size);
-    ASSERT_ALLOC(records, "Unable to allocate vulkan memory allocation cache", false);
+    MemoryAllocationCacheIndexEntry* index = mem_alloc(sizeof(MemoryAllocationCacheIndexEntry) * index_size);
+    uint32_t* free_slots = mem_alloc(sizeof(uint32_t) * cache_size);
+    if (records == NULL || index == NULL || free_slots == NULL) {
+        log_error("Unable to allocate vulkan memory allocation cache");
+        mem_free(records);
+        mem_free(index);
+        mem_free(free_slots);
+        return false;
+    }
 
     cache->records = records;
     cache->records_size = cache_size;
+    cache->index = index;
+    cache->index_mask = index_size - 1;
+    cache->free_slots = free_slots;
 
     for (size_t i = 0; i < cache->records_size; ++i) {
         memory_allocation_cache_record_clear(&cache->records[i]);
+        cache->records[i].generation = 1;
+        // Lower slots are handed out first
+        cache->free_slots[cache->free_slot_count++] = cache->records_size - i - 1;
+    }
+    for (size_t i = 0; i < index_size; ++i) {
+        cache->index[i].hash = 0;
+        cache->index[i].record_index = MEMORY_ALLOCATION_CACHE_INDEX_EMPTY;
     }
 
     return true;
 }
 
+uint32_t memory_allocation_cache_get_page_count(
+    const MemoryAllocationCache* cache, StringAtom name, MemoryAllocationCacheRecordType type) {
+    const MemoryAllocationCacheRecord* first_page = memory_allocation_cache_find_record(cache, name, type, 0);
+    if (first_page == NULL) {
+        return 0;
+    }
+    return first_page->page_count;
+}
+
 const MemoryAllocationCacheRecord* memory_allocation_cache_get_record(
-    const MemoryAllocationCache* cache, const char* name, MemoryAllocationCacheRecordType type, uint32_t page_index) {
-    for (size_t i = 0; i < cache->records_size; ++i) {
-        if (memory_allocation_cache_record_page_equals(&cache->records[i], name, type, page_index)) {
-            return &cache->records[i];
+    const MemoryAllocationCache* cache, StringAtom name, MemoryAllocationCacheRecordType type, uint32_t page_index) {
+    return memory_allocation_cache_find_record(cache, name, type, page_index);
+}
+
+bool memory_allocation_cache_remove_record(MemoryAllocationCache* cache, StringAtom name,
+    MemoryAllocationCacheRecordType type, uint32_t page_index, MemoryAllocationCacheRecord* removed) {
+    uint32_t hash = memory_allocation_cache_hash(name, type, page_index);
+    ssize_t position = memory_allocation_cache_find_index_position(cache, name, type, page_index, hash);
+    if (position == -1) {
+        return false;
+    }
+
+    uint32_t page_count = memory_allocation_cache_get_page_count(cache, name, type);
+
+    uint32_t record_index = cache->index[position].record_index;
+    memory_allocation_cache_index_remove_at(cache, position);
+    memory_allocation_cache_release_slot(cache, record_index, removed);
+
+    // Close the gap in the page numbering
+    for (uint32_t page = page_index + 1; page < page_count; ++page) {
+        uint32_t page_hash = memory_allocation_cache_hash(name, type, page);
+        position = memory_allocation_cache_find_index_position(cache, name, type, page, page_hash);
+        if (position == -1) {
+            continue;
         }
+
+        record_index = cache->index[position].record_index;
+        memory_allocation_cache_index_remove_at(cache, position);
+        cache->records[record_index].page_index = page - 1;
+        memory_allocation_cache_index_insert(cache, memory_allocation_cache_hash(name, type, page - 1), record_index);
+    }
+
+    MemoryAllocationCacheRecord* first_page = memory_allocation_cache_find_record(cache, name, type, 0);
+    if (first_page != NULL) {
+        first_page->page_count = page_count - 1;
     }
-    return NULL;
+
+    return true;
 }
 
-bool memory_allocation_cache_remove_record(
-    MemoryAllocationCache* cache, const char* name, MemoryAllocationCacheRecordType type, uint32_t page_index) {
-    bool found = false;
-    for (size_t i = 0; i < cache->records_size; ++i) {
-        if (memory_allocation_cache_record_page_equals(&cache->records[i], name, type, page_index)) {
-            memory_allocation_cache_record_destroy(&cache->records[i]);
-        }
+bool memory_allocation_cache_remove_handle(
+    MemoryAllocationCache* cache, MemoryAllocationCacheHandle handle, MemoryAllocationCacheRecord* removed) {
+    uint32_t index = handle & MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_MASK;
+    if (index >= cache->records_size) {
+        return false;
     }
 
-    if (!found) {
+    const MemoryAllocationCacheRecord* record = &cache->records[index];
+    if (memory_allocation_cache_record_is_empty(record) ||
+        record->generation != handle >> MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_BITS) {
         return false;
     }
 
-    for (size_t i = 0; i < cache->records_size; ++i) {
-        const MemoryAllocationCacheRecord* record = &cache->records[i];
-        if (string_equals(record->name, name) && record->type == type && record->page_index > page_index) {
-            cache->records[i].page_index -= 1;
-        }
+    if (memory_allocation_cache_record_has_name(record)) {
+        return memory_allocation_cache_remove_record(cache, record->name, record->type, record->page_index, removed);
     }
 
+    memory_allocation_cache_release_slot(cache, index, removed);
     return true;
 }
 
-bool memory_allocation_cache_add_buffer_record(MemoryAllocationCache* cache, const char* name,
+MemoryAllocationCacheHandle memory_allocation_cache_add_buffer_record(MemoryAllocationCache* cache, StringAtom name,
     const VulkanBufferObject* buffer_object, const VulkanAllocation* allocation) {
-    ssize_t i = memory_allocation_cache_next_avail_record_index(cache);
-    if (i == -1) {
-        return false;
+    if (memory_allocation_cache_is_full(cache)) {
+        return MEMORY_ALLOCATION_CACHE_INVALID_HANDLE;
+    }
+
+    const MemoryAllocationCacheRecordType type = MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD;
+    bool has_name = string_atom_is_valid(name);
+    MemoryAllocationCacheRecord* first_page = NULL;
+    uint32_t new_page_index = 0;
+    if (has_name) {
+        first_page = memory_allocation_cache_find_record(cache, name, type, 0);
+        new_page_index = first_page == NULL ? 0 : first_page->page_count;
     }
 
-    uint32_t new_page_index =
-        memory_allocation_cache_get_page_count(cache, name, MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD);
-    string_copy(name, cache->records[i].name, MEMORY_ALLOCATION_NAME_MAX_SIZE);
-    cache->records[i].type = MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD;
-    cache->records[i].page_index = new_page_index;
-    vulkan_allocation_copy(allocation, &cache->records[i].allocation);
-    vulkan_buffer_object_copy(buffer_object, &cache->records[i].buffer_object);
+    uint32_t i = cache->free_slots[--cache->free_slot_count];
+    MemoryAllocationCacheRecord* record = &cache->records[i];
+    record->name = name;
+    record->type = type;
+    record->page_index = new_page_index;
+    vulkan_allocation_copy(allocation, &record->allocation);
+    vulkan_buffer_object_copy(buffer_object, &record->buffer_object);
 
-    return true;
+    if (has_name) {
+        if (first_page == NULL) {
+            first_page = record;
+        }
+        first_page->page_count = new_page_index + 1;
+
+        memory_allocation_cache_index_insert(
+            cache, memory_allocation_cache_hash(record->name, type, new_page_index), i);
+    }
+
+    return memory_allocation_cache_get_handle(cache, record);
 }
 
 void memory_allocation_cache_destroy(MemoryAllocationCache* cache) {
     if (cache->records != NULL) {
         mem_free(cache->records);
     }
+    if (cache->index != NULL) {
+        mem_free(cache->index);
+    }
+    if (cache->free_slots != NULL) {
+        mem_free(cache->free_slots);
+    }
 
     memory_allocation_cache_clear(cache);
 }
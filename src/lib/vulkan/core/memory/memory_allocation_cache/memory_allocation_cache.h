@@ -2,14 +2,19 @@
 #define MEMORY_ALLOCATION_CACHE_H
 
 #include <sys/types.h>
-#define MEMORY_ALLOCATION_NAME_MAX_SIZE 128
-#define MEMORY_ALLOCATION_FREE_NAME "_AVAIL"
+
+// Handles pack the record slot into the low bits and the slot generation into the high bits, generation 0 is never
+// used so a zero handle is always invalid
+#define MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_BITS 16
+#define MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_MASK ((1U << MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_BITS) - 1)
+#define MEMORY_ALLOCATION_CACHE_MAX_SIZE (MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_MASK + 1)
+#define MEMORY_ALLOCATION_CACHE_INVALID_HANDLE 0
 
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#include "../../../../core/string/string.h"
+#include "../../../../core/string/string_atom.h"
 #include "../allocation_blocks.h"
 #include "../buffer/buffer_object.h"
 
@@ -18,9 +23,17 @@ typedef enum MemoryAllocationCacheRecordType {
     MEMORY_ALLOCACTION_CACHE_UKNOWN_RECORD,
 } MemoryAllocationCacheRecordType;
 
+typedef uint32_t MemoryAllocationCacheHandle;
+
 typedef struct MemoryAllocationCacheRecord {
-    char name[MEMORY_ALLOCATION_NAME_MAX_SIZE];
+    // Optional label, unnamed records can only be reached through their handle
+    StringAtom name;
     uint32_t page_index;
+    // Number of pages with the same name and type, only maintained on the first page
+    uint32_t page_count;
+
+    // Bumped every time the slot is released, survives memory_allocation_cache_record_clear
+    uint16_t generation;
 
     MemoryAllocationCacheRecordType type;
     VulkanAllocation allocation;
@@ -30,67 +43,102 @@ typedef struct MemoryAllocationCacheRecord {
 } MemoryAllocationCacheRecord;
 
 static inline void memory_allocation_cache_record_clear(MemoryAllocationCacheRecord* record) {
-    string_copy(MEMORY_ALLOCATION_FREE_NAME, record->name, MEMORY_ALLOCATION_NAME_MAX_SIZE);
+    record->name = STRING_ATOM_NONE;
     record->page_index = 0;
+    record->page_count = 0;
     record->type = MEMORY_ALLOCACTION_CACHE_UKNOWN_RECORD;
     vulkan_allocation_clear(&record->allocation);
 }
 
 static inline bool memory_allocation_cache_record_is_empty(const MemoryAllocationCacheRecord* record) {
-    return string_equals(record->name, MEMORY_ALLOCATION_FREE_NAME);
+    return record->type == MEMORY_ALLOCACTION_CACHE_UKNOWN_RECORD;
 }
 
 static inline bool memory_allocation_cache_record_page_equals(const MemoryAllocationCacheRecord* record,
-    const char* name, MemoryAllocationCacheRecordType type, uint32_t page_index) {
-    return string_equals(record->name, name) && record->type == type && record->page_index == page_index;
+    StringAtom name, MemoryAllocationCacheRecordType type, uint32_t page_index) {
+    return record->name == name && record->type == type && record->page_index == page_index;
+}
+
+static inline bool memory_allocation_cache_record_has_name(const MemoryAllocationCacheRecord* record) {
+    return string_atom_is_valid(record->name);
 }
 
 void memory_allocation_cache_record_destroy(MemoryAllocationCacheRecord* record);
 
+#define MEMORY_ALLOCATION_CACHE_INDEX_EMPTY UINT32_MAX
+
+typedef struct MemoryAllocationCacheIndexEntry {
+    uint32_t hash;
+    uint32_t record_index;
+} MemoryAllocationCacheIndexEntry;
+
 typedef struct MemoryAllocationCache {
     MemoryAllocationCacheRecord* records;
     size_t records_size;
+
+    // Open addressing index from (name, type, page) to the record, linear probing with backward shift deletion so
+    // the table never fills up with tombstones
+    MemoryAllocationCacheIndexEntry* index;
+    size_t index_mask;
+
+    // Stack of empty record slots
+    uint32_t* free_slots;
+    size_t free_slot_count;
 } MemoryAllocationCache;
 
 static inline void memory_allocation_cache_clear(MemoryAllocationCache* cache) {
     cache->records = NULL;
     cache->records_size = 0;
+    cache->index = NULL;
+    cache->index_mask = 0;
+    cache->free_slots = NULL;
+    cache->free_slot_count = 0;
 }
 
 static inline bool memory_allocation_cache_is_full(const MemoryAllocationCache* cache) {
-    for (size_t i = 0; i < cache->records_size; ++i) {
-        if (memory_allocation_cache_record_is_empty(&cache->records[i])) {
-            return false;
-        }
-    }
-    return true;
+    return cache->free_slot_count == 0;
+}
+
+static inline MemoryAllocationCacheHandle memory_allocation_cache_get_handle(
+    const MemoryAllocationCache* cache, const MemoryAllocationCacheRecord* record) {
+    uint32_t index = (uint32_t)(record - cache->records);
+    return ((uint32_t)record->generation << MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_BITS) | index;
 }
 
-static inline uint32_t memory_allocation_cache_get_page_count(
-    const MemoryAllocationCache* cache, const char* name, MemoryAllocationCacheRecordType type) {
-    uint32_t page_count = 0;
-    for (size_t i = 0; i < cache->records_size; ++i) {
-        const MemoryAllocationCacheRecord* record = &cache->records[i];
-        if (string_equals(record->name, name) && record->type == type) {
-            ++page_count;
-        }
+static inline const MemoryAllocationCacheRecord* memory_allocation_cache_resolve(
+    const MemoryAllocationCache* cache, MemoryAllocationCacheHandle handle, MemoryAllocationCacheRecordType type) {
+    uint32_t index = handle & MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_MASK;
+    if (index >= cache->records_size) {
+        return NULL;
     }
-    return page_count;
+
+    const MemoryAllocationCacheRecord* record = &cache->records[index];
+    if (record->generation != handle >> MEMORY_ALLOCATION_CACHE_HANDLE_INDEX_BITS || record->type != type) {
+        return NULL;
+    }
+    return record;
 }
 
+uint32_t memory_allocation_cache_get_page_count(
+    const MemoryAllocationCache* cache, StringAtom name, MemoryAllocationCacheRecordType type);
+
 bool memory_allocation_cache_init(MemoryAllocationCache* cache, size_t cache_size);
 
 const MemoryAllocationCacheRecord* memory_allocation_cache_get_record(
-    const MemoryAllocationCache* cache, const char* name, MemoryAllocationCacheRecordType type, uint32_t page_index);
-bool memory_allocation_cache_remove_record(
-    MemoryAllocationCache* cache, const char* name, MemoryAllocationCacheRecordType type, uint32_t page_index);
+    const MemoryAllocationCache* cache, StringAtom name, MemoryAllocationCacheRecordType type, uint32_t page_index);
+// The removed record is copied into removed, its buffer and allocation are owned by the caller afterwards
+bool memory_allocation_cache_remove_record(MemoryAllocationCache* cache, StringAtom name,
+    MemoryAllocationCacheRecordType type, uint32_t page_index, MemoryAllocationCacheRecord* removed);
+bool memory_allocation_cache_remove_handle(
+    MemoryAllocationCache* cache, MemoryAllocationCacheHandle handle, MemoryAllocationCacheRecord* removed);
 
 static inline const MemoryAllocationCacheRecord* memory_allocation_cache_get_buffer(
-    const MemoryAllocationCache* cache, const char* name, uint32_t page_index) {
+    const MemoryAllocationCache* cache, StringAtom name, uint32_t page_index) {
     return memory_allocation_cache_get_record(cache, name, MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD, page_index);
 }
 
-bool memory_allocation_cache_add_buffer_record(MemoryAllocationCache* cache, const char* name,
+// The name is optional, returns MEMORY_ALLOCATION_CACHE_INVALID_HANDLE when the cache is full
+MemoryAllocationCacheHandle memory_allocation_cache_add_buffer_record(MemoryAllocationCache* cache, StringAtom name,
     const VulkanBufferObject* buffer_object, const VulkanAllocation* allocation);
 
 void memory_allocation_cache_destroy(MemoryAllocationCache* cache);
@@ -2,36 +2,252 @@
 
 #include "../../../core/memory/memory.h"
 #include "../errors.h"
+#include "../functions.h"
 #include "allocation_blocks.h"
 #include "allocator.h"
 #include "buffer/buffer_object.h"
 #include "memory_allocation_cache/memory_allocation_cache.h"
 
-MemoryContextError memory_context_allocate_buffer(
-    MemoryContext* context, const char* name, const VulkanBufferObjectInfo* buffer_info) {
+typedef struct MemoryContextBufferBatchItem {
+    size_t index;
+    VKBOPropertyFlags flags;
+    VkDeviceSize size;
+} MemoryContextBufferBatchItem;
+
+typedef struct MemoryContextBufferBatch {
+    size_t buffer_count;
+    size_t created_count;
+    bool allocated;
+
+    MemoryContextBufferBatchItem* order;
+    VulkanBufferObject* buffers;
+    VulkanMemoryAllocatorRequest* requests;
+    VulkanAllocation* allocations;
+    VkBindBufferMemoryInfo* bind_infos;
+} MemoryContextBufferBatch;
+
+static VulkanMemoryAllocatorRequest memory_context_get_buffer_request(const VulkanBufferObject* buffer) {
+    VulkanMemoryUsage usage = VULKAN_MEMORY_USAGE_CPU_TO_GPU;
+    if (FLAGS_CHECK_FLAG(buffer->property_flags, VKBO_STATIC_USAGE_BIT)) {
+        usage = VULKAN_MEMORY_USAGE_GPU_ONLY;
+    } else if (FLAGS_CHECK_FLAG(buffer->property_flags, VKBO_STAGING_BIT)) {
+        usage = VULKAN_MEMORY_USAGE_CPU_ONLY;
+    }
+
+    return (VulkanMemoryAllocatorRequest){
+        .allocation_type = VULKAN_ALLOCATION_TYPE_BUFFER,
+        .memory_type_bits = buffer->memory_requirements.memoryRequirements.memoryTypeBits,
+        .align = buffer->memory_requirements.memoryRequirements.alignment,
+        .size = buffer->memory_requirements.memoryRequirements.size,
+        .usage = usage,
+        .strategy = VULKAN_MEMORY_STRATEGY_DEFAULT,
+        .prefers_dedicated_allocation = buffer->prefers_dedicated_allocation,
+        .requires_dedicated_allocation = buffer->requires_dedicated_allocation,
+        .buffer = buffer->handle,
+    };
+}
+
+static int memory_context_compare_buffer_batch_items(const void* a, const void* b) {
+    const MemoryContextBufferBatchItem* item_a = a;
+    const MemoryContextBufferBatchItem* item_b = b;
+
+    if (item_a->flags != item_b->flags) {
+        return item_a->flags < item_b->flags ? -1 : 1;
+    }
+    if (item_a->size != item_b->size) {
+        return item_a->size < item_b->size ? -1 : 1;
+    }
+    return 0;
+}
+
+static bool memory_context_buffer_batch_init(MemoryContextBufferBatch* batch, size_t buffer_count) {
+    batch->buffer_count = buffer_count;
+    batch->created_count = 0;
+    batch->allocated = false;
+    batch->order = mem_alloc(sizeof(MemoryContextBufferBatchItem) * buffer_count);
+    batch->buffers = mem_alloc(sizeof(VulkanBufferObject) * buffer_count);
+    batch->requests = mem_alloc(sizeof(VulkanMemoryAllocatorRequest) * buffer_count);
+    batch->allocations = mem_alloc(sizeof(VulkanAllocation) * buffer_count);
+    batch->bind_infos = mem_alloc(sizeof(VkBindBufferMemoryInfo) * buffer_count);
+
+    return batch->order != NULL && batch->buffers != NULL && batch->requests != NULL && batch->allocations != NULL &&
+           batch->bind_infos != NULL;
+}
+
+// Releases everything that was not handed over to the allocation cache
+static void memory_context_buffer_batch_destroy(
+    MemoryContext* context, MemoryContextBufferBatch* batch, bool release_resources) {
+    if (release_resources) {
+        for (size_t i = 0; i < batch->created_count; ++i) {
+            if (batch->allocated) {
+                vulkan_memory_allocator_free_immediately(&context->allocator, &batch->allocations[i]);
+            }
+            vulkan_buffer_object_destroy(&batch->buffers[i]);
+        }
+    }
+
+    mem_free(batch->order);
+    mem_free(batch->buffers);
+    mem_free(batch->requests);
+    mem_free(batch->allocations);
+    mem_free(batch->bind_infos);
+}
+
+static MemoryContextError memory_context_buffer_batch_create_buffers(const MemoryContext* context,
+    MemoryContextBufferBatch* batch, const VulkanBufferObjectInfo* buffer_infos) {
+    for (size_t i = 0; i < batch->buffer_count; ++i) {
+        VulkanBufferObjectInfo buffer_info;
+        memory_context_get_buffer_object_info(context, &buffer_infos[i], &buffer_info);
+        MemoryContextError status = vulkan_buffer_object_create(&batch->buffers[i], &buffer_info);
+        if (status != MEMORY_CONTEXT_SUCCESS) {
+            vulkan_buffer_object_destroy(&batch->buffers[i]);
+            return status;
+        }
+        batch->created_count += 1;
+        batch->order[i] = (MemoryContextBufferBatchItem){
+            .index = i,
+            .flags = buffer_infos[i].flags,
+            .size = buffer_infos[i].size,
+        };
+    }
+
+    // Buffers created with the same size and flags share their memory requirements, query one buffer per group
+    qsort(batch->order, batch->buffer_count, sizeof(MemoryContextBufferBatchItem),
+        memory_context_compare_buffer_batch_items);
+
+    const VulkanBufferObject* group_buffer = NULL;
+    for (size_t i = 0; i < batch->buffer_count; ++i) {
+        size_t index = batch->order[i].index;
+        VulkanBufferObject* buffer = &batch->buffers[index];
+        if (group_buffer != NULL && group_buffer->property_flags == buffer->property_flags &&
+            group_buffer->size == buffer->size) {
+            vulkan_buffer_object_copy_memory_requirements(group_buffer, buffer);
+        } else {
+            vulkan_buffer_object_query_memory_requirements(buffer);
+            group_buffer = buffer;
+        }
+        batch->requests[index] = memory_context_get_buffer_request(buffer);
+    }
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+bool memory_context_set_shared_queue_families(
+    MemoryContext* context, const uint32_t* queue_family_indices, uint32_t queue_family_index_count) {
+    if (queue_family_index_count > MEMORY_CONTEXT_MAX_SHARED_QUEUE_FAMILIES) {
+        return false;
+    }
+
+    context->shared_queue_family_index_count = 0;
+    for (uint32_t i = 0; i < queue_family_index_count; ++i) {
+        bool is_duplicate = false;
+        for (uint32_t j = 0; j < context->shared_queue_family_index_count && !is_duplicate; ++j) {
+            is_duplicate = context->shared_queue_family_indices[j] == queue_family_indices[i];
+        }
+        if (!is_duplicate) {
+            context->shared_queue_family_indices[context->shared_queue_family_index_count++] = queue_family_indices[i];
+        }
+    }
+
+    return true;
+}
+
+void memory_context_get_buffer_object_info(
+    const MemoryContext* context, const VulkanBufferObjectInfo* src, VulkanBufferObjectInfo* dst) {
+    *dst = *src;
+    if (src->queue_family_index_count == 0 && FLAGS_CHECK_FLAG(src->flags, VKBO_STATIC_USAGE_BIT)) {
+        dst->queue_family_indices = context->shared_queue_family_indices;
+        dst->queue_family_index_count = context->shared_queue_family_index_count;
+    }
+}
+
+MemoryContextError memory_context_allocate_buffers(MemoryContext* context, const char* const* names,
+    const VulkanBufferObjectInfo* buffer_infos, size_t buffer_count, MemoryBufferHandle* handles) {
+    for (size_t i = 0; i < buffer_count && handles != NULL; ++i) {
+        handles[i] = MEMORY_BUFFER_HANDLE_INVALID;
+    }
+    if (buffer_count == 0) {
+        return MEMORY_CONTEXT_SUCCESS;
+    }
+    if (context->allocation_cache.free_slot_count < buffer_count) {
+        return MEMORY_CONTEXT_CACHE_FULL;
+    }
+    if (buffer_count > UINT32_MAX) {
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
+
+    MemoryContextBufferBatch batch;
+    if (!memory_context_buffer_batch_init(&batch, buffer_count)) {
+        log_error("Unable to allocate memory for the buffer batch");
+        memory_context_buffer_batch_destroy(context, &batch, false);
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
+
+    MemoryContextError status = memory_context_buffer_batch_create_buffers(context, &batch, buffer_infos);
+    if (status != MEMORY_CONTEXT_SUCCESS) {
+        memory_context_buffer_batch_destroy(context, &batch, true);
+        return status;
+    }
+
+    status = vulkan_memory_allocator_allocate_batch(
+        &context->allocator, batch.requests, buffer_count, batch.allocations);
+    if (status != MEMORY_CONTEXT_SUCCESS) {
+        memory_context_buffer_batch_destroy(context, &batch, true);
+        return status;
+    }
+    batch.allocated = true;
+
+    for (size_t i = 0; i < buffer_count; ++i) {
+        batch.bind_infos[i] = (VkBindBufferMemoryInfo){
+            .sType = VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_INFO,
+            .pNext = NULL,
+            .buffer = batch.buffers[i].handle,
+            .memory = batch.allocations[i].device_memory_handle,
+            .memoryOffset = batch.allocations[i].offset,
+        };
+    }
+    VkResult bind_status = vkBindBufferMemory2(context->device->handle, (uint32_t)buffer_count, batch.bind_infos);
+    if (bind_status != VK_SUCCESS) {
+        log_error("VK error: Unable to bind buffer memory - %s", vulkan_result_to_string(bind_status));
+        memory_context_buffer_batch_destroy(context, &batch, true);
+        return MEMORY_CONTEXT_BUFFER_BIND_ERROR;
+    }
+
+    for (size_t i = 0; i < buffer_count; ++i) {
+        StringAtom name = names != NULL ? string_atom_intern(names[i]) : STRING_ATOM_NONE;
+        MemoryBufferHandle handle = memory_allocation_cache_add_buffer_record(
+            &context->allocation_cache, name, &batch.buffers[i], &batch.allocations[i]);
+        if (handles != NULL) {
+            handles[i] = handle;
+        }
+    }
+
+    memory_context_buffer_batch_destroy(context, &batch, false);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError memory_context_allocate_buffer(MemoryContext* context, const char* name,
+    const VulkanBufferObjectInfo* buffer_info, MemoryBufferHandle* handle) {
+    if (handle != NULL) {
+        *handle = MEMORY_BUFFER_HANDLE_INVALID;
+    }
     if (memory_allocation_cache_is_full(&context->allocation_cache)) {
         return MEMORY_CONTEXT_CACHE_FULL;
     }
 
+    VulkanBufferObjectInfo shared_buffer_info;
+    memory_context_get_buffer_object_info(context, buffer_info, &shared_buffer_info);
+
     VulkanBufferObject buffer;
-    MemoryContextError status = vulkan_buffer_object_init(&buffer, buffer_info);
+    MemoryContextError status = vulkan_buffer_object_init(&buffer, &shared_buffer_info);
     if (status != MEMORY_CONTEXT_SUCCESS) {
         vulkan_buffer_object_destroy(&buffer);
         return status;
     }
 
-    VulkanMemoryUsage usage = VULKAN_MEMORY_USAGE_CPU_TO_GPU;
-    if (FLAGS_CHECK_FLAG(buffer.property_flags, VKBO_STATIC_USAGE_BIT)) {
-        usage = VULKAN_MEMORY_USAGE_GPU_ONLY;
-    }
     VulkanAllocation allocation;
-    VulkanMemoryAllocatorRequest request = {
-        .allocation_type = VULKAN_ALLOCATION_TYPE_BUFFER,
-        .memory_type_bits = buffer.memory_requirements.memoryRequirements.memoryTypeBits,
-        .align = buffer.memory_requirements.memoryRequirements.alignment,
-        .size = buffer.memory_requirements.memoryRequirements.size,
-        .usage = usage,
-    };
+    VulkanMemoryAllocatorRequest request = memory_context_get_buffer_request(&buffer);
 
     status = vulkan_memory_allocator_allocate(&context->allocator, &request, &allocation);
     if (status != MEMORY_CONTEXT_SUCCESS) {
@@ -39,13 +255,55 @@ MemoryContextError memory_context_allocate_buffer(
         return status;
     }
 
-    memory_allocation_cache_add_buffer_record(&context->allocation_cache, name, &buffer, &allocation);
+    VkResult bind_status =
+        vkBindBufferMemory(context->device->handle, buffer.handle, allocation.device_memory_handle, allocation.offset);
+    if (bind_status != VK_SUCCESS) {
+        log_error("VK error: Unable to bind buffer memory - %s", vulkan_result_to_string(bind_status));
+        vulkan_memory_allocator_free_immediately(&context->allocator, &allocation);
+        vulkan_buffer_object_destroy(&buffer);
+        return MEMORY_CONTEXT_BUFFER_BIND_ERROR;
+    }
+
+    MemoryBufferHandle buffer_handle = memory_allocation_cache_add_buffer_record(
+        &context->allocation_cache, string_atom_intern(name), &buffer, &allocation);
+    if (handle != NULL) {
+        *handle = buffer_handle;
+    }
 
     return MEMORY_CONTEXT_SUCCESS;
 }
 
+MemoryContextError memory_context_free_buffer(MemoryContext* context, MemoryBufferHandle handle) {
+    MemoryAllocationCacheRecord record;
+    if (!memory_allocation_cache_remove_handle(&context->allocation_cache, handle, &record)) {
+        return MEMORY_CONTEXT_INVALID_BUFFER_HANDLE;
+    }
+
+    memory_context_retire_buffer(context, &record.buffer_object, record.allocation, true);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError memory_context_write_buffer(
+    MemoryContext* context, MemoryBufferHandle handle, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    const MemoryAllocationCacheRecord* record =
+        memory_allocation_cache_resolve(&context->allocation_cache, handle, MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD);
+    if (record == NULL) {
+        return MEMORY_CONTEXT_INVALID_BUFFER_HANDLE;
+    }
+    if (offset + size > record->buffer_object.size) {
+        return MEMORY_CONTEXT_INVALID_BUFFER_SIZE;
+    }
+
+    return vulkan_memory_allocator_write(&context->allocator, &record->allocation, offset, data, size);
+}
+
+MemoryContextError memory_context_flush(MemoryContext* context) {
+    return vulkan_memory_allocator_flush(&context->allocator);
+}
+
 const VulkanBufferObject* memory_context_get_buffer(
-    const MemoryContext* context, const char* name, uint32_t page_index) {
+    const MemoryContext* context, StringAtom name, uint32_t page_index) {
     const MemoryAllocationCacheRecord* record = memory_allocation_cache_get_record(
         &context->allocation_cache, name, MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD, page_index);
     if (record == NULL) {
@@ -54,7 +312,49 @@ const VulkanBufferObject* memory_context_get_buffer(
     return &record->buffer_object;
 }
 
+void memory_context_retire_buffer(
+    MemoryContext* context, VulkanBufferObject* buffer, VulkanAllocation allocation, bool is_cacheable) {
+    if (is_cacheable) {
+        vulkan_memory_allocator_free(&context->allocator, allocation);
+    } else {
+        vulkan_memory_allocator_free_uncached(&context->allocator, allocation);
+    }
+
+    MemoryContextBufferGarbage garbage = {
+        .frame_number = context->allocator.frame_number,
+    };
+    vulkan_buffer_object_copy(buffer, &garbage.buffer);
+    vulkan_buffer_object_clear(buffer);
+    if (!vector_push(&context->buffer_garbage, garbage)) {
+        log_warning("Unable to defer the buffer destruction, waiting for the device");
+        vkDeviceWaitIdle(context->device->handle);
+        vulkan_buffer_object_destroy(&garbage.buffer);
+    }
+}
+
+static void memory_context_empty_buffer_garbage(MemoryContext* context, uint64_t completed_frame_number) {
+    size_t count = 0;
+    while (count < context->buffer_garbage.size &&
+           context->buffer_garbage.data[count].frame_number <= completed_frame_number) {
+        vulkan_buffer_object_destroy(&context->buffer_garbage.data[count].buffer);
+        count += 1;
+    }
+    if (count > 0) {
+        vector_remove_slice_noshrink(&context->buffer_garbage, 0, count);
+    }
+}
+
+void memory_context_begin_frame(
+    MemoryContext* context, uint32_t frame_index, uint64_t frame_number, uint64_t completed_frame_number) {
+    vulkan_memory_allocator_begin_frame(&context->allocator, frame_index, frame_number);
+    memory_context_empty_buffer_garbage(context, completed_frame_number);
+    vulkan_memory_allocator_empty_garbage(&context->allocator, completed_frame_number);
+}
+
 void memory_context_destroy(MemoryContext* context) {
+    memory_context_empty_buffer_garbage(context, UINT64_MAX);
+    vector_clear(&context->buffer_garbage);
+
     for (size_t i = 0; i < context->allocation_cache.records_size; ++i) {
         MemoryAllocationCacheRecord* record = &context->allocation_cache.records[i];
         if (memory_allocation_cache_record_is_empty(record)) {
@@ -6,23 +6,83 @@
 #include "./buffer/buffer_object.h"
 #include "./memory_allocation_cache/memory_allocation_cache.h"
 
+typedef MemoryAllocationCacheHandle MemoryBufferHandle;
+
+#define MEMORY_BUFFER_HANDLE_INVALID MEMORY_ALLOCATION_CACHE_INVALID_HANDLE
+#define MEMORY_CONTEXT_MAX_SHARED_QUEUE_FAMILIES 4
+
+typedef struct MemoryContextBufferGarbage {
+    VulkanBufferObject buffer;
+    uint64_t frame_number;
+} MemoryContextBufferGarbage;
+
+typedef struct MemoryContextBufferGarbageList VECTOR(MemoryContextBufferGarbage) MemoryContextBufferGarbageList;
+
 typedef struct MemoryContext {
     const Device* device;
 
+    // Static buffers are shared between these queue families so they can be filled from a dedicated transfer queue
+    uint32_t shared_queue_family_indices[MEMORY_CONTEXT_MAX_SHARED_QUEUE_FAMILIES];
+    uint32_t shared_queue_family_index_count;
+
     VulkanMemoryAllocator allocator;
     MemoryAllocationCache allocation_cache;
+    // Retired buffers in frame number order, destroyed once their frame has completed
+    MemoryContextBufferGarbageList buffer_garbage;
 } MemoryContext;
 
 static inline void memory_context_clear(MemoryContext* context) {
     context->device = NULL;
+    context->shared_queue_family_index_count = 0;
     vulkan_memory_allocator_clear(&context->allocator);
     memory_allocation_cache_clear(&context->allocation_cache);
+    vector_init(&context->buffer_garbage);
+}
+
+// The name is an optional debug label, the returned handle is what the buffer should be looked up by
+MemoryContextError memory_context_allocate_buffer(MemoryContext* context, const char* name,
+    const VulkanBufferObjectInfo* buffer_info, MemoryBufferHandle* handle);
+
+// Only affects static buffers created afterwards
+bool memory_context_set_shared_queue_families(
+    MemoryContext* context, const uint32_t* queue_family_indices, uint32_t queue_family_index_count);
+void memory_context_get_buffer_object_info(
+    const MemoryContext* context, const VulkanBufferObjectInfo* src, VulkanBufferObjectInfo* dst);
+
+// Creates all buffers or none, names and handles are optional arrays with buffer_count entries
+MemoryContextError memory_context_allocate_buffers(MemoryContext* context, const char* const* names,
+    const VulkanBufferObjectInfo* buffer_infos, size_t buffer_count, MemoryBufferHandle* handles);
+
+static inline const VulkanBufferObject* memory_context_resolve_buffer(
+    const MemoryContext* context, MemoryBufferHandle handle) {
+    const MemoryAllocationCacheRecord* record = memory_allocation_cache_resolve(
+        &context->allocation_cache, handle, MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD);
+    if (record == NULL) {
+        return NULL;
+    }
+    return &record->buffer_object;
 }
 
-MemoryContextError memory_context_allocate_buffer(
-    MemoryContext* context, const char* name, const VulkanBufferObjectInfo* buffer_info);
+// The handle is invalid right away, the buffer and its memory are released once the frames using them complete
+MemoryContextError memory_context_free_buffer(MemoryContext* context, MemoryBufferHandle handle);
+
+// Writes to a host visible buffer, see vulkan_memory_allocator_write
+MemoryContextError memory_context_write_buffer(
+    MemoryContext* context, MemoryBufferHandle handle, VkDeviceSize offset, const void* data, VkDeviceSize size);
+MemoryContextError memory_context_flush(MemoryContext* context);
+
+// Lookup by the atom of the debug label, meant for tools and debugging
 const VulkanBufferObject* memory_context_get_buffer(
-    const MemoryContext* context, const char* name, uint32_t page_index);
+    const MemoryContext* context, StringAtom name, uint32_t page_index);
+
+// Takes over the buffer and its allocation, both are released once the frames that could still use them complete. An
+// uncached allocation goes back to its block instead of a thread cache
+void memory_context_retire_buffer(
+    MemoryContext* context, VulkanBufferObject* buffer, VulkanAllocation allocation, bool is_cacheable);
+
+// Frees made from now on wait for the frame number to complete, the garbage of completed frames is released
+void memory_context_begin_frame(
+    MemoryContext* context, uint32_t frame_index, uint64_t frame_number, uint64_t completed_frame_number);
 
 void memory_context_destroy(MemoryContext* context);
 
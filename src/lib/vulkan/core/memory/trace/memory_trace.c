@@ -0,0 +1,242 @@
+#include "./memory_trace.h"
+
+#include <SDL2/SDL.h>
+
+#include "../../../../core/logger/logger.h"
+
+#define VULKAN_MEMORY_TRACE_MAX_RECORD_SIZE 32
+
+static size_t vulkan_memory_trace_put_u8(byte* dst, uint8_t value) {
+    dst[0] = value;
+    return 1;
+}
+
+static size_t vulkan_memory_trace_put_u32(byte* dst, uint32_t value) {
+    for (uint32_t i = 0; i < 4; ++i) {
+        dst[i] = (byte)(value >> (i * 8));
+    }
+    return 4;
+}
+
+static size_t vulkan_memory_trace_put_u64(byte* dst, uint64_t value) {
+    for (uint32_t i = 0; i < 8; ++i) {
+        dst[i] = (byte)(value >> (i * 8));
+    }
+    return 8;
+}
+
+static uint32_t vulkan_memory_trace_get_u32(const byte* src) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        value |= (uint32_t)src[i] << (i * 8);
+    }
+    return value;
+}
+
+static uint64_t vulkan_memory_trace_get_u64(const byte* src) {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < 8; ++i) {
+        value |= (uint64_t)src[i] << (i * 8);
+    }
+    return value;
+}
+
+// The caller holds the trace lock
+static void vulkan_memory_trace_flush_buffer(VulkanMemoryTrace* trace) {
+    if (trace->buffer_size == 0 || trace->has_write_error) {
+        trace->buffer_size = 0;
+        return;
+    }
+
+    if (SDL_RWwrite(trace->file, trace->buffer, 1, trace->buffer_size) != trace->buffer_size) {
+        log_error("Unable to write the memory trace, recording stopped: %s", SDL_GetError());
+        trace->has_write_error = true;
+    }
+    trace->buffer_size = 0;
+}
+
+static void vulkan_memory_trace_write(VulkanMemoryTrace* trace, const byte* record, size_t size) {
+    if (trace->buffer_size + size > VULKAN_MEMORY_TRACE_BUFFER_SIZE) {
+        vulkan_memory_trace_flush_buffer(trace);
+    }
+    mem_copy(record, &trace->buffer[trace->buffer_size], size);
+    trace->buffer_size += size;
+}
+
+MemoryContextError vulkan_memory_trace_open(VulkanMemoryTrace* trace, const char* path) {
+    vulkan_memory_trace_clear(trace);
+
+    if (!mutex_init(&trace->lock)) {
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
+
+    trace->file = SDL_RWFromFile(path, "wb");
+    if (trace->file == NULL) {
+        log_error("Unable to open the memory trace %s: %s", path, SDL_GetError());
+        mutex_destroy(&trace->lock);
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
+
+    byte header[VULKAN_MEMORY_TRACE_HEADER_SIZE] = {0};
+    mem_copy(VULKAN_MEMORY_TRACE_MAGIC, header, 4);
+    vulkan_memory_trace_put_u32(&header[4], VULKAN_MEMORY_TRACE_VERSION);
+    vulkan_memory_trace_write(trace, header, VULKAN_MEMORY_TRACE_HEADER_SIZE);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+uint32_t vulkan_memory_trace_record_allocate(VulkanMemoryTrace* trace, const VulkanMemoryTraceRequest* request) {
+    uint8_t flags = 0;
+    if (request->prefers_dedicated_allocation) {
+        flags |= VULKAN_MEMORY_TRACE_FLAG_PREFERS_DEDICATED;
+    }
+    if (request->requires_dedicated_allocation) {
+        flags |= VULKAN_MEMORY_TRACE_FLAG_REQUIRES_DEDICATED;
+    }
+
+    mutex_lock(&trace->lock);
+    uint32_t allocation_id = trace->next_allocation_id++;
+
+    byte record[VULKAN_MEMORY_TRACE_MAX_RECORD_SIZE];
+    size_t size = vulkan_memory_trace_put_u8(record, VULKAN_MEMORY_TRACE_OP_ALLOCATE);
+    size += vulkan_memory_trace_put_u32(&record[size], allocation_id);
+    size += vulkan_memory_trace_put_u64(&record[size], request->size);
+    size += vulkan_memory_trace_put_u32(&record[size], request->align);
+    size += vulkan_memory_trace_put_u32(&record[size], request->memory_type_bits);
+    size += vulkan_memory_trace_put_u8(&record[size], request->usage);
+    size += vulkan_memory_trace_put_u8(&record[size], request->allocation_type);
+    size += vulkan_memory_trace_put_u8(&record[size], request->strategy);
+    size += vulkan_memory_trace_put_u8(&record[size], flags);
+    vulkan_memory_trace_write(trace, record, size);
+    mutex_unlock(&trace->lock);
+
+    return allocation_id;
+}
+
+void vulkan_memory_trace_record_free(VulkanMemoryTrace* trace, uint32_t allocation_id, bool immediately) {
+    byte record[VULKAN_MEMORY_TRACE_MAX_RECORD_SIZE];
+    size_t size = vulkan_memory_trace_put_u8(
+        record, immediately ? VULKAN_MEMORY_TRACE_OP_FREE_IMMEDIATELY : VULKAN_MEMORY_TRACE_OP_FREE);
+    size += vulkan_memory_trace_put_u32(&record[size], allocation_id);
+
+    mutex_lock(&trace->lock);
+    vulkan_memory_trace_write(trace, record, size);
+    mutex_unlock(&trace->lock);
+}
+
+void vulkan_memory_trace_record_begin_frame(VulkanMemoryTrace* trace, uint32_t frame_index, uint64_t frame_number) {
+    byte record[VULKAN_MEMORY_TRACE_MAX_RECORD_SIZE];
+    size_t size = vulkan_memory_trace_put_u8(record, VULKAN_MEMORY_TRACE_OP_BEGIN_FRAME);
+    size += vulkan_memory_trace_put_u32(&record[size], frame_index);
+    size += vulkan_memory_trace_put_u64(&record[size], frame_number);
+
+    mutex_lock(&trace->lock);
+    vulkan_memory_trace_write(trace, record, size);
+    mutex_unlock(&trace->lock);
+}
+
+void vulkan_memory_trace_record_empty_garbage(VulkanMemoryTrace* trace, uint64_t completed_frame_number) {
+    byte record[VULKAN_MEMORY_TRACE_MAX_RECORD_SIZE];
+    size_t size = vulkan_memory_trace_put_u8(record, VULKAN_MEMORY_TRACE_OP_EMPTY_GARBAGE);
+    size += vulkan_memory_trace_put_u64(&record[size], completed_frame_number);
+
+    mutex_lock(&trace->lock);
+    vulkan_memory_trace_write(trace, record, size);
+    mutex_unlock(&trace->lock);
+}
+
+void vulkan_memory_trace_close(VulkanMemoryTrace* trace) {
+    if (trace->file != NULL) {
+        vulkan_memory_trace_flush_buffer(trace);
+        SDL_RWclose(trace->file);
+    }
+
+    mutex_destroy(&trace->lock);
+    vulkan_memory_trace_clear(trace);
+}
+
+bool vulkan_memory_trace_reader_init(VulkanMemoryTraceReader* reader, const byte* data, size_t size) {
+    reader->data = data;
+    reader->size = size;
+    reader->offset = VULKAN_MEMORY_TRACE_HEADER_SIZE;
+    reader->is_valid = false;
+
+    if (size < VULKAN_MEMORY_TRACE_HEADER_SIZE || mem_cmp(data, VULKAN_MEMORY_TRACE_MAGIC, 4) != 0) {
+        log_error("Not a memory trace");
+        return false;
+    }
+    uint32_t version = vulkan_memory_trace_get_u32(&data[4]);
+    if (version != VULKAN_MEMORY_TRACE_VERSION) {
+        log_error("Unsupported memory trace version: %u", version);
+        return false;
+    }
+
+    reader->is_valid = true;
+    return true;
+}
+
+static size_t vulkan_memory_trace_get_record_size(VulkanMemoryTraceOp op) {
+    switch (op) {
+        case VULKAN_MEMORY_TRACE_OP_ALLOCATE:
+            return 25;
+        case VULKAN_MEMORY_TRACE_OP_FREE:
+        case VULKAN_MEMORY_TRACE_OP_FREE_IMMEDIATELY:
+            return 5;
+        case VULKAN_MEMORY_TRACE_OP_BEGIN_FRAME:
+            return 13;
+        case VULKAN_MEMORY_TRACE_OP_EMPTY_GARBAGE:
+            return 9;
+        default:
+            return 0;
+    }
+}
+
+bool vulkan_memory_trace_reader_next(VulkanMemoryTraceReader* reader, VulkanMemoryTraceEvent* event) {
+    if (!reader->is_valid || reader->offset == reader->size) {
+        return false;
+    }
+
+    const byte* record = &reader->data[reader->offset];
+    VulkanMemoryTraceOp op = record[0];
+    size_t record_size = vulkan_memory_trace_get_record_size(op);
+    if (record_size == 0 || reader->offset + record_size > reader->size) {
+        log_error("Corrupted memory trace at offset %lu", (unsigned long)reader->offset);
+        reader->is_valid = false;
+        return false;
+    }
+    reader->offset += record_size;
+
+    event->op = op;
+    event->allocation_id = 0;
+    event->frame_index = 0;
+    event->frame_number = 0;
+
+    switch (op) {
+        case VULKAN_MEMORY_TRACE_OP_ALLOCATE:
+            event->allocation_id = vulkan_memory_trace_get_u32(&record[1]);
+            event->request.size = vulkan_memory_trace_get_u64(&record[5]);
+            event->request.align = vulkan_memory_trace_get_u32(&record[13]);
+            event->request.memory_type_bits = vulkan_memory_trace_get_u32(&record[17]);
+            event->request.usage = record[21];
+            event->request.allocation_type = record[22];
+            event->request.strategy = record[23];
+            event->request.prefers_dedicated_allocation =
+                (record[24] & VULKAN_MEMORY_TRACE_FLAG_PREFERS_DEDICATED) != 0;
+            event->request.requires_dedicated_allocation =
+                (record[24] & VULKAN_MEMORY_TRACE_FLAG_REQUIRES_DEDICATED) != 0;
+            break;
+        case VULKAN_MEMORY_TRACE_OP_FREE:
+        case VULKAN_MEMORY_TRACE_OP_FREE_IMMEDIATELY:
+            event->allocation_id = vulkan_memory_trace_get_u32(&record[1]);
+            break;
+        case VULKAN_MEMORY_TRACE_OP_BEGIN_FRAME:
+            event->frame_index = vulkan_memory_trace_get_u32(&record[1]);
+            event->frame_number = vulkan_memory_trace_get_u64(&record[5]);
+            break;
+        default:
+            event->frame_number = vulkan_memory_trace_get_u64(&record[1]);
+            break;
+    }
+
+    return true;
+}
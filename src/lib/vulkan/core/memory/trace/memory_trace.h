@@ -0,0 +1,99 @@
+#ifndef MEMORY_TRACE_H
+#define MEMORY_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+#include "../../../../core/memory/memory.h"
+#include "../../../../core/threads/mutex.h"
+#include "../../errors.h"
+#include "../allocation_blocks.h"
+
+#define VULKAN_MEMORY_TRACE_MAGIC "VKMT"
+#define VULKAN_MEMORY_TRACE_VERSION 1
+#define VULKAN_MEMORY_TRACE_HEADER_SIZE 8
+#define VULKAN_MEMORY_TRACE_BUFFER_SIZE KB_TO_BYTES(64)
+
+// Little endian records, every record starts with the op byte:
+// allocate: id u32, size u64, align u32, memory type bits u32, usage u8, allocation type u8, strategy u8, flags u8
+// free, free immediately: id u32
+// begin frame: frame index u32, frame number u64
+// empty garbage: completed frame number u64
+typedef enum VulkanMemoryTraceOp {
+    VULKAN_MEMORY_TRACE_OP_NONE,
+    VULKAN_MEMORY_TRACE_OP_ALLOCATE,
+    VULKAN_MEMORY_TRACE_OP_FREE,
+    VULKAN_MEMORY_TRACE_OP_FREE_IMMEDIATELY,
+    VULKAN_MEMORY_TRACE_OP_BEGIN_FRAME,
+    VULKAN_MEMORY_TRACE_OP_EMPTY_GARBAGE,
+    VULKAN_MEMORY_TRACE_OPS_TOTAL,
+} VulkanMemoryTraceOp;
+
+#define VULKAN_MEMORY_TRACE_FLAG_PREFERS_DEDICATED 1
+#define VULKAN_MEMORY_TRACE_FLAG_REQUIRES_DEDICATED 2
+
+typedef struct VulkanMemoryTraceRequest {
+    VkDeviceSize size;
+    uint32_t align;
+    uint32_t memory_type_bits;
+    VulkanMemoryUsage usage;
+    VulkanAllocationType allocation_type;
+    VulkanMemoryStrategy strategy;
+    bool prefers_dedicated_allocation;
+    bool requires_dedicated_allocation;
+} VulkanMemoryTraceRequest;
+
+typedef struct VulkanMemoryTraceEvent {
+    VulkanMemoryTraceOp op;
+    // Ids start at 1, allocations that failed while recording are never freed
+    uint32_t allocation_id;
+    VulkanMemoryTraceRequest request;
+    uint32_t frame_index;
+    uint64_t frame_number;
+} VulkanMemoryTraceEvent;
+
+struct SDL_RWops;
+
+typedef struct VulkanMemoryTrace {
+    struct SDL_RWops* file;
+    Mutex lock;
+
+    uint32_t next_allocation_id;
+    byte buffer[VULKAN_MEMORY_TRACE_BUFFER_SIZE];
+    size_t buffer_size;
+    bool has_write_error;
+} VulkanMemoryTrace;
+
+static inline void vulkan_memory_trace_clear(VulkanMemoryTrace* trace) {
+    trace->file = NULL;
+    mutex_clear(&trace->lock);
+    trace->next_allocation_id = 1;
+    trace->buffer_size = 0;
+    trace->has_write_error = false;
+}
+
+static inline bool vulkan_memory_trace_is_open(const VulkanMemoryTrace* trace) { return trace->file != NULL; }
+
+MemoryContextError vulkan_memory_trace_open(VulkanMemoryTrace* trace, const char* path);
+// Returns the id of the recorded allocation
+uint32_t vulkan_memory_trace_record_allocate(VulkanMemoryTrace* trace, const VulkanMemoryTraceRequest* request);
+void vulkan_memory_trace_record_free(VulkanMemoryTrace* trace, uint32_t allocation_id, bool immediately);
+void vulkan_memory_trace_record_begin_frame(VulkanMemoryTrace* trace, uint32_t frame_index, uint64_t frame_number);
+void vulkan_memory_trace_record_empty_garbage(VulkanMemoryTrace* trace, uint64_t completed_frame_number);
+void vulkan_memory_trace_close(VulkanMemoryTrace* trace);
+
+// Reads events out of a whole trace loaded in memory
+typedef struct VulkanMemoryTraceReader {
+    const byte* data;
+    size_t size;
+    size_t offset;
+    bool is_valid;
+} VulkanMemoryTraceReader;
+
+bool vulkan_memory_trace_reader_init(VulkanMemoryTraceReader* reader, const byte* data, size_t size);
+// Returns false at the end of the trace, is_valid is cleared when the trace is truncated or corrupted
+bool vulkan_memory_trace_reader_next(VulkanMemoryTraceReader* reader, VulkanMemoryTraceEvent* event);
+
+#endif
@@ -0,0 +1,150 @@
+#include "./transient_block.h"
+
+#include "../../../core/utils/macro.h"
+#include "../../utils/memory.h"
+
+MemoryContextError vulkan_transient_block_init(VulkanTransientBlock* block, const VulkanTransientBlockInfo* info) {
+    vulkan_transient_block_clear(block);
+    block->device = info->device;
+    block->backend = info->backend;
+    block->strategy = info->strategy;
+    block->memory_type_index = info->memory_type_index;
+    block->size = info->size;
+
+    if (block->memory_type_index == UINT32_MAX) {
+        return MEMORY_CONTEXT_INVALID_MEMORY_INDEX;
+    }
+    block->is_coherent = memory_utils_is_memory_type_coherent(block->device, block->memory_type_index);
+
+    VkMemoryAllocateInfo mem_info = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = NULL,
+        .allocationSize = block->size,
+        .memoryTypeIndex = block->memory_type_index,
+    };
+
+    VkResult status = vulkan_memory_backend_allocate_memory(
+        block->backend, block->device->handle, &mem_info, &block->device_memory_handle);
+    ASSERT_VK_LOG(status, "Unable to allocate memory for the transient block", MEMORY_CONTEXT_ALLOCATION_ERROR);
+
+    status = vulkan_memory_backend_map_memory(
+        block->backend, block->device->handle, block->device_memory_handle, 0, block->size, (void**)&block->data);
+    if (status != VK_SUCCESS) {
+        log_error("VK error: Unable to map the transient block memory - %s", vulkan_result_to_string(status));
+        vulkan_transient_block_destroy(block);
+        return MEMORY_CONTEXT_MAPPING_ERROR;
+    }
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError vulkan_transient_block_allocate(
+    VulkanTransientBlock* block, VkDeviceSize size, VkDeviceSize align, VulkanAllocation* allocation) {
+    vulkan_allocation_clear(allocation);
+
+    align = MAX(align, 1);
+    if (block->used == 0) {
+        block->head = 0;
+        block->tail = 0;
+    }
+
+    VkDeviceSize offset = ALIGN(block->head, align);
+    VkDeviceSize consumed = 0;
+
+    // The free space is [head, size) followed by [0, tail) until the ring wraps, then only [head, tail)
+    bool wrapped = block->used > 0 && block->head <= block->tail;
+    if (wrapped) {
+        if (offset + size > block->tail) {
+            return MEMORY_CONTEXT_LOW_FREE_BLOCK_SPACE;
+        }
+        consumed = offset + size - block->head;
+    } else if (offset + size <= block->size) {
+        consumed = offset + size - block->head;
+    } else if (block->strategy == VULKAN_MEMORY_STRATEGY_RING && size <= block->tail) {
+        // Skip the end of the block and wrap around to the start
+        offset = 0;
+        consumed = block->size - block->head + size;
+    } else {
+        return MEMORY_CONTEXT_LOW_FREE_BLOCK_SPACE;
+    }
+
+    block->head = offset + size;
+    block->used += consumed;
+    block->frame_used[block->frame_index] += consumed;
+
+    allocation->strategy = block->strategy;
+    allocation->device_memory_handle = block->device_memory_handle;
+    allocation->offset = offset;
+    allocation->size = size;
+    allocation->data = block->data + offset;
+    allocation->is_coherent = block->is_coherent;
+    allocation->memory_size = block->size;
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+void vulkan_transient_block_begin_frame(VulkanTransientBlock* block, uint32_t frame_index) {
+    if (frame_index >= VULKAN_TRANSIENT_BLOCK_MAX_FRAMES) {
+        log_warning("Transient block frame index %u out of range", frame_index);
+        return;
+    }
+
+    if (block->strategy == VULKAN_MEMORY_STRATEGY_LINEAR) {
+        // Linear blocks are owned by a single frame slot whose fence has already signaled
+        block->head = 0;
+        block->tail = 0;
+        block->used = 0;
+        block->frame_used[block->frame_index] = 0;
+        block->frame_index = frame_index;
+        return;
+    }
+
+    // Close the frame that was recording, then release everything written by the previous use of this slot
+    block->frame_ends[block->frame_index] = block->head;
+    block->frame_index = frame_index;
+
+    if (block->frame_used[frame_index] > 0) {
+        block->used -= block->frame_used[frame_index];
+        block->tail = block->frame_ends[frame_index];
+        block->frame_used[frame_index] = 0;
+    }
+}
+
+void vulkan_transient_block_get_stats(const VulkanTransientBlock* block, VulkanMemoryStatInfo* stats) {
+    vulkan_memory_stat_info_clear(stats);
+    if (!vulkan_transient_block_is_init(block)) {
+        return;
+    }
+
+    stats->block_count = 1;
+    stats->block_bytes = block->size;
+    stats->used_bytes = block->used;
+    stats->free_bytes = block->size - block->used;
+
+    // Same free space layout as in vulkan_transient_block_allocate
+    if (block->used == 0) {
+        stats->largest_free_range = block->size;
+        stats->free_range_count = 1;
+    } else if (block->head <= block->tail) {
+        stats->largest_free_range = block->tail - block->head;
+        stats->free_range_count = stats->largest_free_range > 0 ? 1 : 0;
+    } else {
+        stats->largest_free_range = MAX(block->size - block->head, block->tail);
+        stats->free_range_count = (block->size > block->head ? 1 : 0) + (block->tail > 0 ? 1 : 0);
+    }
+}
+
+void vulkan_transient_block_destroy(VulkanTransientBlock* block) {
+    if (block->device == NULL) {
+        return;
+    }
+
+    if (block->device_memory_handle != VK_NULL_HANDLE) {
+        if (block->data != NULL) {
+            vulkan_memory_backend_unmap_memory(block->backend, block->device->handle, block->device_memory_handle);
+        }
+        vulkan_memory_backend_free_memory(block->backend, block->device->handle, block->device_memory_handle);
+    }
+
+    vulkan_transient_block_clear(block);
+}
@@ -0,0 +1,76 @@
+#ifndef TRANSIENT_BLOCK_H
+#define TRANSIENT_BLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+#include "../../../core/memory/memory.h"
+#include "../../core/device/device.h"
+#include "../../core/errors.h"
+#include "./allocation_blocks.h"
+#include "./backend/memory_backend.h"
+
+#define VULKAN_TRANSIENT_BLOCK_MAX_FRAMES 8
+
+typedef struct VulkanTransientBlockInfo {
+    const Device* device;
+    const VulkanMemoryBackend* backend;
+    uint32_t memory_type_index;
+    VkDeviceSize size;
+    VulkanMemoryStrategy strategy;
+} VulkanTransientBlockInfo;
+
+// Persistently mapped block for memory that lives at most as long as the frames in flight, allocations are only
+// pointer bumps and are reclaimed all at once in vulkan_transient_block_begin_frame
+typedef struct VulkanTransientBlock {
+    const Device* device;
+    const VulkanMemoryBackend* backend;
+    VulkanMemoryStrategy strategy;
+
+    uint32_t memory_type_index;
+    VkDeviceMemory device_memory_handle;
+    VkDeviceSize size;
+    bool is_coherent;
+    byte* data;
+
+    VkDeviceSize head;
+    VkDeviceSize tail;
+    VkDeviceSize used;
+
+    uint32_t frame_index;
+    VkDeviceSize frame_ends[VULKAN_TRANSIENT_BLOCK_MAX_FRAMES];
+    VkDeviceSize frame_used[VULKAN_TRANSIENT_BLOCK_MAX_FRAMES];
+} VulkanTransientBlock;
+
+static inline void vulkan_transient_block_clear(VulkanTransientBlock* block) {
+    block->device = NULL;
+    block->backend = NULL;
+    block->strategy = VULKAN_MEMORY_STRATEGY_LINEAR;
+    block->memory_type_index = 0;
+    block->device_memory_handle = VK_NULL_HANDLE;
+    block->size = 0;
+    block->is_coherent = false;
+    block->data = NULL;
+    block->head = 0;
+    block->tail = 0;
+    block->used = 0;
+    block->frame_index = 0;
+    for (uint32_t i = 0; i < VULKAN_TRANSIENT_BLOCK_MAX_FRAMES; ++i) {
+        block->frame_ends[i] = 0;
+        block->frame_used[i] = 0;
+    }
+}
+
+static inline bool vulkan_transient_block_is_init(const VulkanTransientBlock* block) {
+    return block->device_memory_handle != VK_NULL_HANDLE;
+}
+
+MemoryContextError vulkan_transient_block_init(VulkanTransientBlock* block, const VulkanTransientBlockInfo* info);
+MemoryContextError vulkan_transient_block_allocate(
+    VulkanTransientBlock* block, VkDeviceSize size, VkDeviceSize align, VulkanAllocation* allocation);
+void vulkan_transient_block_begin_frame(VulkanTransientBlock* block, uint32_t frame_index);
+void vulkan_transient_block_get_stats(const VulkanTransientBlock* block, VulkanMemoryStatInfo* stats);
+void vulkan_transient_block_destroy(VulkanTransientBlock* block);
+
+#endif
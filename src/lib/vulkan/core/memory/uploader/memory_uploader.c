@@ -0,0 +1,402 @@
+#include "./memory_uploader.h"
+
+#include <stdlib.h>
+
+#include "../../../../core/string/string.h"
+#include "../../../../core/utils/macro.h"
+#include "../../../utils/queue.h"
+#include "../../functions.h"
+
+static VkDevice memory_uploader_get_device(const MemoryUploader* uploader) {
+    return uploader->memory_context->device->handle;
+}
+
+static MemoryUploadBatch* memory_uploader_get_oldest_batch(MemoryUploader* uploader) {
+    return &uploader->batches[uploader->first_batch_index];
+}
+
+static int memory_uploader_compare_regions(const void* a, const void* b) {
+    const MemoryUploadRegion* region_a = (const MemoryUploadRegion*)a;
+    const MemoryUploadRegion* region_b = (const MemoryUploadRegion*)b;
+
+    if (region_a->buffer != region_b->buffer) {
+        return region_a->buffer < region_b->buffer ? -1 : 1;
+    }
+    if (region_a->copy.dstOffset != region_b->copy.dstOffset) {
+        return region_a->copy.dstOffset < region_b->copy.dstOffset ? -1 : 1;
+    }
+    return 0;
+}
+
+static void memory_uploader_select_queue(MemoryUploader* uploader, const Queue* fallback_queue) {
+    const Device* device = uploader->memory_context->device;
+    uploader->queue = *fallback_queue;
+
+    uint32_t transfer_family_index =
+        queue_utils_get_dedicated_queue_index(device->physical_device, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_COMPUTE_BIT);
+    if (transfer_family_index == UINT32_MAX) {
+        return;
+    }
+
+    Queue transfer_queue;
+    if (!device_get_queues(device, &transfer_queue, transfer_family_index, 0, 1)) {
+        log_warning("Dedicated transfer queue family %u has no queues, uploading on the fallback queue",
+            transfer_family_index);
+        return;
+    }
+    uploader->queue = transfer_queue;
+}
+
+static bool memory_uploader_reserve_staging(
+    MemoryUploader* uploader, VkDeviceSize size, VkDeviceSize* offset, VkDeviceSize* reserved) {
+    if (uploader->staging_used == 0) {
+        uploader->staging_head = 0;
+    }
+
+    VkDeviceSize start = ALIGN(uploader->staging_head, uploader->staging_alignment);
+    VkDeviceSize reserved_bytes = start - uploader->staging_head + size;
+    if (start + size > uploader->staging_size) {
+        // Wrap around, the skipped tail of the ring is released together with the batch
+        start = 0;
+        reserved_bytes = uploader->staging_size - uploader->staging_head + size;
+    }
+    if (uploader->staging_used + reserved_bytes > uploader->staging_size) {
+        return false;
+    }
+
+    uploader->staging_head = start + size;
+    uploader->staging_used += reserved_bytes;
+    uploader->pending_staging_bytes += reserved_bytes;
+    *offset = start;
+    *reserved = reserved_bytes;
+
+    return true;
+}
+
+// Undoes the latest reservation, nothing has been reserved after it
+static void memory_uploader_unreserve_staging(
+    MemoryUploader* uploader, VkDeviceSize previous_head, VkDeviceSize reserved_bytes) {
+    uploader->staging_head = previous_head;
+    uploader->staging_used -= reserved_bytes;
+    uploader->pending_staging_bytes -= reserved_bytes;
+}
+
+static bool memory_uploader_add_region(
+    MemoryUploader* uploader, VkBuffer buffer, VkDeviceSize staging_offset, VkDeviceSize offset, VkDeviceSize size) {
+    if (uploader->pending_regions.size > 0) {
+        // Consecutive writes to consecutive ranges become one region
+        MemoryUploadRegion* last = &uploader->pending_regions.data[uploader->pending_regions.size - 1];
+        if (last->buffer == buffer && last->copy.srcOffset + last->copy.size == staging_offset &&
+            last->copy.dstOffset + last->copy.size == offset) {
+            last->copy.size += size;
+            return true;
+        }
+    }
+
+    MemoryUploadRegion region = {
+        .buffer = buffer,
+        .copy =
+            {
+                .srcOffset = staging_offset,
+                .dstOffset = offset,
+                .size = size,
+            },
+    };
+    return vector_push(&uploader->pending_regions, region);
+}
+
+static MemoryContextError memory_uploader_record_copies(MemoryUploader* uploader, VkCommandBuffer command_buffer) {
+    const VulkanBufferObject* staging_buffer =
+        memory_context_resolve_buffer(uploader->memory_context, uploader->staging_buffer);
+    if (staging_buffer == NULL) {
+        return MEMORY_CONTEXT_INVALID_BUFFER_HANDLE;
+    }
+
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL,
+    };
+    ASSERT_VK(vkResetCommandBuffer(command_buffer, 0), MEMORY_CONTEXT_COMMAND_BUFFER_ERROR);
+    ASSERT_VK(vkBeginCommandBuffer(command_buffer, &begin_info), MEMORY_CONTEXT_COMMAND_BUFFER_ERROR);
+
+    // One copy command per destination buffer
+    MemoryUploadRegionList* regions = &uploader->pending_regions;
+    qsort(regions->data, regions->size, sizeof(MemoryUploadRegion), memory_uploader_compare_regions);
+
+    size_t first = 0;
+    while (first < regions->size) {
+        vector_empty_noshrink(&uploader->copies);
+        size_t last = first;
+        while (last < regions->size && regions->data[last].buffer == regions->data[first].buffer) {
+            if (!vector_push(&uploader->copies, regions->data[last].copy)) {
+                return MEMORY_CONTEXT_ALLOCATION_ERROR;
+            }
+            last += 1;
+        }
+
+        vkCmdCopyBuffer(command_buffer, staging_buffer->handle, regions->data[first].buffer,
+            (uint32_t)uploader->copies.size, uploader->copies.data);
+        first = last;
+    }
+
+    VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1,
+        &barrier, 0, NULL, 0, NULL);
+    ASSERT_VK(vkEndCommandBuffer(command_buffer), MEMORY_CONTEXT_COMMAND_BUFFER_ERROR);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError memory_uploader_init(MemoryUploader* uploader, const MemoryUploaderInfo* info) {
+    memory_uploader_clear(uploader);
+
+    if (info->memory_context == NULL || info->memory_context->device == NULL || info->command_context == NULL) {
+        return MEMORY_CONTEXT_DEVICE_NOT_PROVIDED;
+    }
+    if (info->staging_size == 0) {
+        return MEMORY_CONTEXT_INVALID_BUFFER_SIZE;
+    }
+
+    uploader->memory_context = info->memory_context;
+    uploader->command_context = info->command_context;
+    memory_uploader_select_queue(uploader, &info->queue);
+
+    // Static buffers created from now on can be written by the transfer queue and read by the fallback queue
+    if (uploader->queue.family_index != info->queue.family_index) {
+        uint32_t queue_family_indices[2] = {info->queue.family_index, uploader->queue.family_index};
+        memory_context_set_shared_queue_families(uploader->memory_context, queue_family_indices, 2);
+    }
+
+    CommandPoolInitInfo pool_info = {
+        .primary_buffer_count = MEMORY_UPLOADER_MAX_BATCHES,
+        .secondary_buffer_count = 0,
+        .queue_family_index = uploader->queue.family_index,
+        .reset_enabled = true,
+        .transient = true,
+    };
+    string_copy(MEMORY_UPLOADER_COMMAND_POOL_NAME, pool_info.name, COMMAND_POOL_NAME_SIZE);
+    if (!command_context_add_command_pool(uploader->command_context, &pool_info)) {
+        return MEMORY_CONTEXT_INIT_ERROR;
+    }
+    uploader->command_pool_name = string_atom_intern(MEMORY_UPLOADER_COMMAND_POOL_NAME);
+
+    VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+    };
+    for (uint32_t i = 0; i < MEMORY_UPLOADER_MAX_BATCHES; ++i) {
+        VkResult status =
+            vkCreateFence(memory_uploader_get_device(uploader), &fence_info, NULL, &uploader->batches[i].fence);
+        ASSERT_VK_LOG(status, "Unable to create the upload fence", MEMORY_CONTEXT_INIT_ERROR);
+    }
+
+    // The staging buffer is owned by the memory context and released together with it
+    VulkanBufferObjectInfo staging_info = {
+        .device = uploader->memory_context->device,
+        .size = GET_NEAREST_MULTIPLE_16(info->staging_size),
+        .flags = VKBO_STAGING_BIT,
+    };
+    MemoryContextError status = memory_context_allocate_buffer(
+        uploader->memory_context, MEMORY_UPLOADER_STAGING_BUFFER_NAME, &staging_info, &uploader->staging_buffer);
+    ASSERT_SUCCESS_LOG(status, MemoryContextError, memory_context_error_to_string, status);
+
+    const MemoryAllocationCacheRecord* staging_record = memory_allocation_cache_resolve(
+        &uploader->memory_context->allocation_cache, uploader->staging_buffer, MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD);
+    if (staging_record == NULL || staging_record->allocation.data == NULL) {
+        log_error("Upload staging buffer is not host visible");
+        return MEMORY_CONTEXT_MAPPING_ERROR;
+    }
+
+    const VkPhysicalDeviceLimits* limits = &uploader->memory_context->device->physical_device->properties.limits;
+    uploader->staging_data = staging_record->allocation.data;
+    uploader->staging_size = staging_info.size;
+    uploader->staging_alignment = MAX(limits->optimalBufferCopyOffsetAlignment, (VkDeviceSize)16);
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError memory_uploader_upload_buffer(MemoryUploader* uploader, MemoryBufferHandle buffer,
+    VkDeviceSize offset, const void* data, VkDeviceSize size, MemoryUploadTicket* ticket) {
+    const VulkanBufferObject* buffer_object = memory_context_resolve_buffer(uploader->memory_context, buffer);
+    if (buffer_object == NULL || !FLAGS_CHECK_FLAG(buffer_object->property_flags, VKBO_STATIC_USAGE_BIT)) {
+        return MEMORY_CONTEXT_INVALID_BUFFER_HANDLE;
+    }
+    if (size == 0 || offset + size > buffer_object->size || size > uploader->staging_size) {
+        return MEMORY_CONTEXT_INVALID_BUFFER_SIZE;
+    }
+
+    VkDeviceSize previous_head = uploader->staging_head;
+    VkDeviceSize staging_offset, reserved_bytes;
+    if (!memory_uploader_reserve_staging(uploader, size, &staging_offset, &reserved_bytes)) {
+        MemoryContextError status = memory_uploader_update(uploader);
+        ASSERT_SUCCESS(status, status);
+
+        if (!memory_uploader_reserve_staging(uploader, size, &staging_offset, &reserved_bytes)) {
+            // Submit what is staged so the space frees up once the copies complete
+            status = memory_uploader_flush(uploader, NULL);
+            if (status != MEMORY_CONTEXT_SUCCESS && status != MEMORY_CONTEXT_STAGING_FULL) {
+                return status;
+            }
+            return MEMORY_CONTEXT_STAGING_FULL;
+        }
+    }
+
+    if (!memory_uploader_add_region(uploader, buffer_object->handle, staging_offset, offset, size)) {
+        memory_uploader_unreserve_staging(uploader, previous_head, reserved_bytes);
+        return MEMORY_CONTEXT_ALLOCATION_ERROR;
+    }
+    mem_copy(data, uploader->staging_data + staging_offset, size);
+
+    if (ticket != NULL) {
+        *ticket = uploader->next_ticket;
+    }
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError memory_uploader_flush(MemoryUploader* uploader, MemoryUploadTicket* ticket) {
+    if (ticket != NULL) {
+        *ticket = uploader->next_ticket - 1;
+    }
+    if (uploader->pending_regions.size == 0) {
+        return MEMORY_CONTEXT_SUCCESS;
+    }
+
+    MemoryContextError status = memory_uploader_update(uploader);
+    ASSERT_SUCCESS(status, status);
+    if (uploader->batch_count == MEMORY_UPLOADER_MAX_BATCHES) {
+        return MEMORY_CONTEXT_STAGING_FULL;
+    }
+
+    uint32_t batch_index = (uploader->first_batch_index + uploader->batch_count) % MEMORY_UPLOADER_MAX_BATCHES;
+    MemoryUploadBatch* batch = &uploader->batches[batch_index];
+
+    CommandBufferInfo buffer_info = {
+        .buffer_index = batch_index,
+        .secondary = false,
+    };
+    VkCommandBuffer command_buffer =
+        command_context_get_command_buffer(uploader->command_context, uploader->command_pool_name, &buffer_info);
+    if (command_buffer == VK_NULL_HANDLE) {
+        return MEMORY_CONTEXT_COMMAND_BUFFER_ERROR;
+    }
+
+    status = memory_uploader_record_copies(uploader, command_buffer);
+    ASSERT_SUCCESS(status, status);
+
+    VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &command_buffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL,
+    };
+    VkResult submit_status = vkQueueSubmit(uploader->queue.handle, 1, &submit_info, batch->fence);
+    ASSERT_VK_LOG(submit_status, "Unable to submit the upload copies", MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED);
+
+    batch->ticket = uploader->next_ticket;
+    batch->staging_bytes = uploader->pending_staging_bytes;
+    uploader->batch_count += 1;
+    uploader->next_ticket += 1;
+    uploader->pending_staging_bytes = 0;
+    vector_empty_noshrink(&uploader->pending_regions);
+
+    if (ticket != NULL) {
+        *ticket = batch->ticket;
+    }
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+MemoryContextError memory_uploader_update(MemoryUploader* uploader) {
+    VkDevice device = memory_uploader_get_device(uploader);
+
+    while (uploader->batch_count > 0) {
+        MemoryUploadBatch* batch = memory_uploader_get_oldest_batch(uploader);
+        VkResult fence_status = vkGetFenceStatus(device, batch->fence);
+        if (fence_status == VK_NOT_READY) {
+            break;
+        }
+        ASSERT_VK_LOG(fence_status, "Upload copy failed", MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED);
+        ASSERT_VK(vkResetFences(device, 1, &batch->fence), MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED);
+
+        uploader->staging_used -= batch->staging_bytes;
+        uploader->completed_ticket = batch->ticket;
+        uploader->first_batch_index = (uploader->first_batch_index + 1) % MEMORY_UPLOADER_MAX_BATCHES;
+        uploader->batch_count -= 1;
+    }
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+bool memory_uploader_is_complete(MemoryUploader* uploader, MemoryUploadTicket ticket) {
+    if (ticket > uploader->completed_ticket) {
+        memory_uploader_update(uploader);
+    }
+    return ticket <= uploader->completed_ticket;
+}
+
+MemoryContextError memory_uploader_wait(MemoryUploader* uploader, MemoryUploadTicket ticket) {
+    if (ticket >= uploader->next_ticket && uploader->pending_regions.size == 0) {
+        ticket = uploader->next_ticket - 1;
+    }
+
+    VkDevice device = memory_uploader_get_device(uploader);
+    while (uploader->completed_ticket < ticket) {
+        if (ticket >= uploader->next_ticket) {
+            MemoryContextError status = memory_uploader_flush(uploader, NULL);
+            if (status != MEMORY_CONTEXT_SUCCESS && status != MEMORY_CONTEXT_STAGING_FULL) {
+                return status;
+            }
+            if (status == MEMORY_CONTEXT_SUCCESS) {
+                continue;
+            }
+        }
+
+        MemoryUploadBatch* batch = memory_uploader_get_oldest_batch(uploader);
+        VkResult wait_status = vkWaitForFences(device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+        ASSERT_VK_LOG(wait_status, "Unable to wait for the upload copies", MEMORY_CONTEXT_QUEUE_SUBMIT_FAILED);
+
+        MemoryContextError status = memory_uploader_update(uploader);
+        ASSERT_SUCCESS(status, status);
+    }
+
+    return MEMORY_CONTEXT_SUCCESS;
+}
+
+void memory_uploader_destroy(MemoryUploader* uploader) {
+    if (uploader->memory_context == NULL) {
+        return;
+    }
+
+    VkDevice device = memory_uploader_get_device(uploader);
+    for (uint32_t i = 0; i < uploader->batch_count; ++i) {
+        const MemoryUploadBatch* batch =
+            &uploader->batches[(uploader->first_batch_index + i) % MEMORY_UPLOADER_MAX_BATCHES];
+        vkWaitForFences(device, 1, &batch->fence, VK_TRUE, UINT64_MAX);
+    }
+    for (uint32_t i = 0; i < MEMORY_UPLOADER_MAX_BATCHES; ++i) {
+        if (uploader->batches[i].fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, uploader->batches[i].fence, NULL);
+        }
+    }
+    vector_clear(&uploader->pending_regions);
+    vector_clear(&uploader->copies);
+    if (string_atom_is_valid(uploader->command_pool_name)) {
+        command_context_remove_command_pool(uploader->command_context, uploader->command_pool_name);
+    }
+
+    memory_uploader_clear(uploader);
+}
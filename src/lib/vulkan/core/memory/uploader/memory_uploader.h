@@ -0,0 +1,113 @@
+#ifndef MEMORY_UPLOADER_H
+#define MEMORY_UPLOADER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vulkan/vulkan.h>
+
+#include "../../../../core/collections/vector.h"
+#include "../../command/command_context.h"
+#include "../../errors.h"
+#include "../../queue/queue.h"
+#include "../memory_context.h"
+
+#define MEMORY_UPLOADER_COMMAND_POOL_NAME "_upload"
+#define MEMORY_UPLOADER_STAGING_BUFFER_NAME "_upload_staging"
+#define MEMORY_UPLOADER_MAX_BATCHES 4
+
+// Increases with every flushed batch, an upload is complete once the completed ticket reaches its ticket
+typedef uint64_t MemoryUploadTicket;
+
+typedef struct MemoryUploadRegion {
+    VkBuffer buffer;
+    VkBufferCopy copy;
+} MemoryUploadRegion;
+
+typedef struct MemoryUploadRegionList VECTOR(MemoryUploadRegion) MemoryUploadRegionList;
+typedef struct MemoryUploadCopyList VECTOR(VkBufferCopy) MemoryUploadCopyList;
+
+typedef struct MemoryUploadBatch {
+    VkFence fence;
+    MemoryUploadTicket ticket;
+    // Staging bytes released when the batch completes, including the gap skipped when the ring wrapped
+    VkDeviceSize staging_bytes;
+} MemoryUploadBatch;
+
+typedef struct MemoryUploaderInfo {
+    MemoryContext* memory_context;
+    CommandContext* command_context;
+    // Used when the device has no dedicated transfer queue
+    Queue queue;
+
+    VkDeviceSize staging_size;
+} MemoryUploaderInfo;
+
+// Copies data into static buffers through a persistently mapped staging ring, the copies recorded since the last
+// flush are submitted together and complete asynchronously
+typedef struct MemoryUploader {
+    MemoryContext* memory_context;
+    CommandContext* command_context;
+    Queue queue;
+    StringAtom command_pool_name;
+
+    MemoryBufferHandle staging_buffer;
+    byte* staging_data;
+    VkDeviceSize staging_size;
+    VkDeviceSize staging_alignment;
+    VkDeviceSize staging_head;
+    VkDeviceSize staging_used;
+    VkDeviceSize pending_staging_bytes;
+
+    // Submitted batches form a queue that retires in submission order
+    MemoryUploadBatch batches[MEMORY_UPLOADER_MAX_BATCHES];
+    uint32_t first_batch_index;
+    uint32_t batch_count;
+
+    MemoryUploadRegionList pending_regions;
+    MemoryUploadCopyList copies;
+
+    MemoryUploadTicket next_ticket;
+    MemoryUploadTicket completed_ticket;
+} MemoryUploader;
+
+static inline void memory_uploader_clear(MemoryUploader* uploader) {
+    uploader->memory_context = NULL;
+    uploader->command_context = NULL;
+    queue_clear(&uploader->queue);
+    uploader->command_pool_name = STRING_ATOM_NONE;
+    uploader->staging_buffer = MEMORY_BUFFER_HANDLE_INVALID;
+    uploader->staging_data = NULL;
+    uploader->staging_size = 0;
+    uploader->staging_alignment = 0;
+    uploader->staging_head = 0;
+    uploader->staging_used = 0;
+    uploader->pending_staging_bytes = 0;
+    for (uint32_t i = 0; i < MEMORY_UPLOADER_MAX_BATCHES; ++i) {
+        uploader->batches[i].fence = VK_NULL_HANDLE;
+        uploader->batches[i].ticket = 0;
+        uploader->batches[i].staging_bytes = 0;
+    }
+    uploader->first_batch_index = 0;
+    uploader->batch_count = 0;
+    vector_init(&uploader->pending_regions);
+    vector_init(&uploader->copies);
+    uploader->next_ticket = 1;
+    uploader->completed_ticket = 0;
+}
+
+MemoryContextError memory_uploader_init(MemoryUploader* uploader, const MemoryUploaderInfo* info);
+
+// Stages the data right away, the copy is recorded by the next flush. Returns MEMORY_CONTEXT_STAGING_FULL when the
+// ring has no room until earlier batches complete
+MemoryContextError memory_uploader_upload_buffer(MemoryUploader* uploader, MemoryBufferHandle buffer,
+    VkDeviceSize offset, const void* data, VkDeviceSize size, MemoryUploadTicket* ticket);
+MemoryContextError memory_uploader_flush(MemoryUploader* uploader, MemoryUploadTicket* ticket);
+// Retires the completed batches without blocking, the renderer calls it once per frame
+MemoryContextError memory_uploader_update(MemoryUploader* uploader);
+bool memory_uploader_is_complete(MemoryUploader* uploader, MemoryUploadTicket ticket);
+MemoryContextError memory_uploader_wait(MemoryUploader* uploader, MemoryUploadTicket ticket);
+
+void memory_uploader_destroy(MemoryUploader* uploader);
+
+#endif
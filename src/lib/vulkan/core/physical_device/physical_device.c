@@ -135,6 +135,18 @@ bool physical_device_has_extension(const PhysicalDevice* device, const char* ext
     return false;
 }
 
+const void* physical_device_get_extended_features(const PhysicalDevice* device, VkStructureType feature_type) {
+    const PhysicalDeviceFeatureItems* items = &device->extended_features_chain;
+    for (uint32_t i = 0; i < items->length; ++i) {
+        VkStructureType item_type;
+        mem_copy(items->items[i].features, &item_type, sizeof(VkStructureType));
+        if (item_type == feature_type) {
+            return items->items[i].features;
+        }
+    }
+    return NULL;
+}
+
 void physical_device_destroy(PhysicalDevice* device) {
     physical_device_feature_items_destroy(&device->extended_features_chain);
     physical_device_clear(device);
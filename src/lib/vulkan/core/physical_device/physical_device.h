@@ -87,6 +87,8 @@ static inline void physical_device_clear(PhysicalDevice* device) {
 
 bool physical_device_add_extension(PhysicalDevice* device, const char* extension_name);
 bool physical_device_has_extension(const PhysicalDevice* device, const char* extension_name);
+// Feature structure of the type the device was created with, NULL when the chain does not have it
+const void* physical_device_get_extended_features(const PhysicalDevice* device, VkStructureType feature_type);
 void physical_device_destroy(PhysicalDevice* device);
 
 #endif
@@ -0,0 +1,116 @@
+#include "./frame_latency_controller.h"
+
+#include "../../../core/utils/macro.h"
+
+#define FRAME_LATENCY_TRACKED_FRAMES_MASK (FRAME_LATENCY_MAX_TRACKED_FRAMES - 1)
+// Weight of a new sample is 1 / 2^shift
+#define FRAME_LATENCY_AVERAGE_SHIFT 3
+
+static inline void frame_latency_update_average(uint64_t* average, uint64_t sample) {
+    if (*average == 0) {
+        *average = sample;
+        return;
+    }
+    *average = (uint64_t)((int64_t)*average + (((int64_t)sample - (int64_t)*average) >> FRAME_LATENCY_AVERAGE_SHIFT));
+}
+
+static inline uint32_t frame_latency_get_index(uint64_t frame_number) {
+    return (uint32_t)(frame_number & FRAME_LATENCY_TRACKED_FRAMES_MASK);
+}
+
+void frame_latency_controller_init(
+    FrameLatencyController* controller, const FrameLatencyConfig* config, const Clock* clock) {
+    controller->clock = *clock;
+    controller->config = *config;
+    for (uint32_t i = 0; i < FRAME_LATENCY_MAX_TRACKED_FRAMES; ++i) {
+        controller->frame_start_times[i] = 0;
+        controller->frame_submit_times[i] = 0;
+    }
+    controller->completed_frame_number = 0;
+    controller->last_completion_time = 0;
+    controller->stats = (FrameLatencyStats){0};
+}
+
+uint64_t frame_latency_controller_get_wait_time(
+    const FrameLatencyController* controller, uint64_t now, uint64_t frame_number) {
+    const FrameLatencyStats* stats = &controller->stats;
+    const uint64_t first_queued_frame_number = controller->completed_frame_number + 1;
+    if (!controller->config.just_in_time_wait_enabled || stats->gpu_time_ns == 0 ||
+        first_queued_frame_number >= frame_number ||
+        frame_number - first_queued_frame_number >= FRAME_LATENCY_MAX_TRACKED_FRAMES) {
+        return 0;
+    }
+
+    // The GPU starts a frame once it is submitted and the previous one has finished, the last completion is only seen
+    // late so the prediction errs on the side of waiting less
+    uint64_t drain_time = controller->last_completion_time;
+    for (uint64_t queued_frame_number = first_queued_frame_number; queued_frame_number < frame_number;
+         ++queued_frame_number) {
+        const uint64_t submit_time = controller->frame_submit_times[frame_latency_get_index(queued_frame_number)];
+        drain_time = MAX(drain_time, submit_time) + stats->gpu_time_ns;
+    }
+
+    const uint64_t ready_time = now + stats->cpu_time_ns + controller->config.safety_margin_ns;
+    return drain_time > ready_time ? drain_time - ready_time : 0;
+}
+
+void frame_latency_controller_begin_frame(FrameLatencyController* controller, uint64_t frame_number) {
+    const uint64_t wait_time =
+        frame_latency_controller_get_wait_time(controller, clock_now(&controller->clock), frame_number);
+    clock_sleep(&controller->clock, wait_time);
+    controller->stats.last_wait_ns = wait_time;
+
+    const uint32_t index = frame_latency_get_index(frame_number);
+    controller->frame_start_times[index] = clock_now(&controller->clock);
+    controller->frame_submit_times[index] = 0;
+}
+
+void frame_latency_controller_submit_frame(FrameLatencyController* controller, uint64_t frame_number) {
+    const uint32_t index = frame_latency_get_index(frame_number);
+    const uint64_t start_time = controller->frame_start_times[index];
+    if (start_time == 0) {
+        return;
+    }
+    const uint64_t now = clock_now(&controller->clock);
+    controller->frame_submit_times[index] = now;
+    frame_latency_update_average(&controller->stats.cpu_time_ns, now - start_time);
+}
+
+void frame_latency_controller_complete_frames(FrameLatencyController* controller, uint64_t completed_frame_number) {
+    if (completed_frame_number <= controller->completed_frame_number) {
+        return;
+    }
+
+    const uint64_t now = clock_now(&controller->clock);
+    FrameLatencyStats* stats = &controller->stats;
+    const uint64_t first_frame_number = controller->completed_frame_number + 1;
+    const uint64_t completed_count = completed_frame_number - controller->completed_frame_number;
+
+    // The GPU was busy with the frames from the later of the first submit and the previous completion. Frames seen
+    // finished together share that time, frames older than the tracked ones are skipped
+    if (controller->last_completion_time != 0 && completed_count <= FRAME_LATENCY_MAX_TRACKED_FRAMES) {
+        const uint64_t first_submit_time = controller->frame_submit_times[frame_latency_get_index(first_frame_number)];
+        const uint64_t busy_start_time = MAX(controller->last_completion_time, first_submit_time);
+        if (first_submit_time != 0 && now > busy_start_time) {
+            frame_latency_update_average(&stats->gpu_time_ns, (now - busy_start_time) / completed_count);
+        }
+    }
+
+    uint64_t frame_number = first_frame_number;
+    if (completed_count > FRAME_LATENCY_MAX_TRACKED_FRAMES) {
+        frame_number = completed_frame_number - FRAME_LATENCY_MAX_TRACKED_FRAMES + 1;
+    }
+    for (; frame_number <= completed_frame_number; ++frame_number) {
+        const uint32_t index = frame_latency_get_index(frame_number);
+        const uint64_t start_time = controller->frame_start_times[index];
+        if (start_time != 0 && start_time <= now) {
+            stats->last_cpu_to_present_ns = now - start_time;
+            frame_latency_update_average(&stats->cpu_to_present_ns, stats->last_cpu_to_present_ns);
+        }
+        controller->frame_start_times[index] = 0;
+        controller->frame_submit_times[index] = 0;
+    }
+
+    controller->last_completion_time = now;
+    controller->completed_frame_number = completed_frame_number;
+}
@@ -0,0 +1,51 @@
+#ifndef FRAME_LATENCY_CONTROLLER_H
+#define FRAME_LATENCY_CONTROLLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../../core/time/clock.h"
+
+// Power of two, more than the frames that can be in flight at once
+#define FRAME_LATENCY_MAX_TRACKED_FRAMES 16
+
+typedef struct FrameLatencyConfig {
+    bool just_in_time_wait_enabled;
+    // Slack left between the end of the CPU work and the moment the GPU is predicted to run out of queued frames
+    uint64_t safety_margin_ns;
+} FrameLatencyConfig;
+
+// Moving averages, a frame counts as presented once the GPU is seen to have finished it. GPU time excludes the time
+// the GPU waited for a submit
+typedef struct FrameLatencyStats {
+    uint64_t cpu_time_ns;
+    uint64_t gpu_time_ns;
+    uint64_t cpu_to_present_ns;
+    uint64_t last_cpu_to_present_ns;
+    uint64_t last_wait_ns;
+} FrameLatencyStats;
+
+typedef struct FrameLatencyController {
+    Clock clock;
+    FrameLatencyConfig config;
+    // Start of the CPU work and submit time of each frame, indexed by frame number
+    uint64_t frame_start_times[FRAME_LATENCY_MAX_TRACKED_FRAMES];
+    uint64_t frame_submit_times[FRAME_LATENCY_MAX_TRACKED_FRAMES];
+    uint64_t completed_frame_number;
+    uint64_t last_completion_time;
+    FrameLatencyStats stats;
+} FrameLatencyController;
+
+void frame_latency_controller_init(
+    FrameLatencyController* controller, const FrameLatencyConfig* config, const Clock* clock);
+// Time to hold back the CPU work of a frame so that it is submitted just as the GPU finishes the frames queued before
+// it, every frame before the frame number must have been submitted
+uint64_t frame_latency_controller_get_wait_time(
+    const FrameLatencyController* controller, uint64_t now, uint64_t frame_number);
+// Sleeps the just in time wait when it is enabled and marks the start of the frame's CPU work
+void frame_latency_controller_begin_frame(FrameLatencyController* controller, uint64_t frame_number);
+void frame_latency_controller_submit_frame(FrameLatencyController* controller, uint64_t frame_number);
+// Every frame up to the frame number was seen finished on the GPU
+void frame_latency_controller_complete_frames(FrameLatencyController* controller, uint64_t completed_frame_number);
+
+#endif
@@ -10,6 +10,13 @@ static VkDevice rendering_context_get_device(const RenderingContext* rendering_c
     return rendering_context->command_context->context->device.handle;
 }
 
+static bool rendering_context_supports_timeline_semaphore(const RenderingContext* rendering_context) {
+    const VkPhysicalDeviceVulkan12Features* features = physical_device_get_extended_features(
+        rendering_context->command_context->context->device.physical_device,
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES);
+    return features != NULL && features->timelineSemaphore;
+}
+
 static RenderingContextError rendering_context_validate_config(
     const RenderingContext* rendering_context, RenderingContextConfig* config) {
     if (config->frames_in_flight > RENDERING_CONTEXT_MAX_FRAMES_IN_FLIGHT) {
@@ -18,6 +25,12 @@ static RenderingContextError rendering_context_validate_config(
     if (config->frames_in_flight == 0) {
         config->frames_in_flight = rendering_context->swapchain.image_count;
     }
+    if (config->recording_thread_count > RENDERING_CONTEXT_MAX_RECORDING_THREADS) {
+        return TOO_MANY_RECORDING_THREADS_REQUESTED;
+    }
+    if (config->recording_thread_count == 0) {
+        config->recording_thread_count = 1;
+    }
     return RENDERING_CONTEXT_SUCCESS;
 }
 
@@ -32,6 +45,8 @@ static SwapchainError rendering_context_create_swapchain(RenderingContext* rende
     if (reuse_old_handle) {
         swapchain_builder.old_swapchain = rendering_context->swapchain.handle;
     }
+    swapchain_builder_add_desired_present_mode(&swapchain_builder, rendering_context->config.present_mode);
+    swapchain_builder_add_desired_present_mode(&swapchain_builder, VK_PRESENT_MODE_FIFO_KHR);
 
     SwapchainError status = swapchain_builder_build(&swapchain_builder, &swapchain);
     if (status != SWAPCHAIN_SUCCESS) {
@@ -47,35 +62,75 @@ static SwapchainError rendering_context_create_swapchain(RenderingContext* rende
     return SWAPCHAIN_SUCCESS;
 }
 
-static RenderingContextError rendering_context_create_command_buffers(RenderingContext* rendering_context) {
-    command_context_remove_command_pool(rendering_context->command_context, "_render");
-
-    CommandPoolInitInfo pool_info = {
-        .primary_buffer_count = rendering_context->swapchain.image_count,
-        .secondary_buffer_count = 0,
+static RenderingContextError rendering_context_create_command_allocator(RenderingContext* rendering_context) {
+    CommandAllocatorInitInfo allocator_info = {
+        .thread_count = rendering_context->config.recording_thread_count,
+        .frame_count = rendering_context->config.frames_in_flight,
         .queue_family_index = rendering_context->swapchain.queue.family_index,
-        .reset_enabled = true,
-        .transient = false,
+        .primary_buffer_count = 1,
+        .secondary_buffer_count = RENDERING_CONTEXT_SECONDARY_BUFFERS_PER_THREAD,
     };
-    string_copy("_render", pool_info.name, COMMAND_POOL_NAME_SIZE);
-    bool context_status = command_context_add_command_pool(rendering_context->command_context, &pool_info);
-    if (!context_status) {
+    bool status = command_allocator_init(
+        &rendering_context->command_allocator, rendering_context->command_context->context, &allocator_info);
+    if (!status) {
         return RENDERING_CONTEXT_COMMAND_CONTEXT_ERROR;
     }
 
     return RENDERING_CONTEXT_SUCCESS;
 }
 
+static void rendering_context_complete_frame(RenderingContext* rendering_context, uint64_t frame_number) {
+    if (frame_number > rendering_context->completed_frame_number) {
+        rendering_context->completed_frame_number = frame_number;
+        frame_latency_controller_complete_frames(&rendering_context->latency_controller, frame_number);
+    }
+}
+
+static RenderingContextError rendering_context_create_frame_timeline(RenderingContext* rendering_context) {
+    VkSemaphoreTypeCreateInfo type_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .pNext = NULL,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = rendering_context->completed_frame_number,
+    };
+    VkSemaphoreCreateInfo semaphore_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_info,
+        .flags = 0,
+    };
+    VkResult status = vkCreateSemaphore(
+        rendering_context_get_device(rendering_context), &semaphore_info, NULL, &rendering_context->frame_timeline);
+    ASSERT_VK_LOG(status, "Unable to create the frame timeline semaphore", RENDERING_CONTEXT_INIT_ERROR);
+
+    return RENDERING_CONTEXT_SUCCESS;
+}
+
+// Waits until the previous frame submitted from the slot is done, its fence is left signaled
+static RenderingContextError rendering_context_wait_for_frame_slot(
+    RenderingContext* rendering_context, const RenderFrameResources* resources) {
+    if (rendering_context->frame_timeline != VK_NULL_HANDLE) {
+        if (resources->frame_number == 0) {
+            return RENDERING_CONTEXT_SUCCESS;
+        }
+        return rendering_context_wait_for_frame(rendering_context, resources->frame_number);
+    }
+
+    VkResult status = vkWaitForFences(rendering_context_get_device(rendering_context), 1, &resources->render_fence,
+        true, TIME_MS_TO_NS(rendering_context->config.render_timeout_ms));
+    ASSERT_VK_LOG(status, "Render timed out", RENDERING_CONTEXT_RENDER_TIMEOUT);
+    rendering_context_complete_frame(rendering_context, resources->frame_number);
+
+    return RENDERING_CONTEXT_SUCCESS;
+}
+
 static RenderingContextError rendering_context_recreate_swapchain(
     RenderingContext* rendering_context, bool reuse_old_handle) {
     vkDeviceWaitIdle(rendering_context_get_device(rendering_context));
+    rendering_context_complete_frame(rendering_context, rendering_context->frame_number - 1);
 
     SwapchainError swapchain_status = rendering_context_create_swapchain(rendering_context, reuse_old_handle);
     ASSERT_SUCCESS(swapchain_status, RENDERING_CONTEXT_SWAPCHAIN_ERROR);
 
-    RenderingContextError status = rendering_context_create_command_buffers(rendering_context);
-    ASSERT_SUCCESS(status, status);
-
     return RENDERING_CONTEXT_SUCCESS;
 }
 
@@ -88,19 +143,36 @@ RenderingContextError rendering_context_init(RenderingContext* rendering_context
 
     rendering_context->command_context = context;
     rendering_context->pipeline_repository = pipeline_repository;
+    rendering_context->pipeline_name = string_atom_intern(RENDERING_CONTEXT_PIPELINE_NAME);
+    if (!string_atom_is_valid(rendering_context->pipeline_name)) {
+        return RENDERING_CONTEXT_INIT_ERROR;
+    }
 
     VkDevice device = rendering_context_get_device(rendering_context);
 
+    rendering_context->config = config;
     SwapchainError swapchain_status = rendering_context_create_swapchain(rendering_context, false);
     ASSERT_SUCCESS(swapchain_status, RENDERING_CONTEXT_SWAPCHAIN_ERROR);
 
-    RenderingContextError status = rendering_context_validate_config(rendering_context, &config);
+    RenderingContextError status = rendering_context_validate_config(rendering_context, &rendering_context->config);
     ASSERT_SUCCESS(status, status);
-    rendering_context->config = config;
 
-    status = rendering_context_create_command_buffers(rendering_context);
+    FrameLatencyConfig latency_config = {
+        .just_in_time_wait_enabled = rendering_context->config.just_in_time_wait_enabled,
+        .safety_margin_ns = TIME_US_TO_NS(rendering_context->config.just_in_time_margin_us),
+    };
+    Clock clock = clock_get_system();
+    frame_latency_controller_init(&rendering_context->latency_controller, &latency_config, &clock);
+
+    status = rendering_context_create_command_allocator(rendering_context);
     ASSERT_SUCCESS(status, status);
 
+    if (rendering_context->config.timeline_semaphore_enabled &&
+        rendering_context_supports_timeline_semaphore(rendering_context)) {
+        status = rendering_context_create_frame_timeline(rendering_context);
+        ASSERT_SUCCESS(status, status);
+    }
+
     VkSemaphoreCreateInfo semaphore_info = {
         .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
         .pNext = NULL,
@@ -121,8 +193,10 @@ RenderingContextError rendering_context_init(RenderingContext* rendering_context
         create_status = vkCreateSemaphore(device, &semaphore_info, NULL, &resources->present_semaphore);
         ASSERT_VK_LOG(create_status, "Unable to create semaphore", RENDERING_CONTEXT_INIT_ERROR);
 
-        create_status = vkCreateFence(device, &fence_info, NULL, &resources->render_fence);
-        ASSERT_VK_LOG(create_status, "Unable to create semaphore", RENDERING_CONTEXT_INIT_ERROR);
+        if (rendering_context->frame_timeline == VK_NULL_HANDLE) {
+            create_status = vkCreateFence(device, &fence_info, NULL, &resources->render_fence);
+            ASSERT_VK_LOG(create_status, "Unable to create fence", RENDERING_CONTEXT_INIT_ERROR);
+        }
     }
 
     return RENDERING_CONTEXT_SUCCESS;
@@ -135,17 +209,40 @@ RenderingContextError rendering_context_resize(RenderingContext* rendering_conte
     return RENDERING_CONTEXT_SUCCESS;
 }
 
+RenderingContextError rendering_context_pace_frame(RenderingContext* rendering_context) {
+    if (rendering_context->paced_frame_number == rendering_context->frame_number) {
+        return RENDERING_CONTEXT_SUCCESS;
+    }
+
+    const RenderFrameResources* resources = &rendering_context->frame_resources[rendering_context->current_frame];
+    RenderingContextError status = rendering_context_wait_for_frame_slot(rendering_context, resources);
+    ASSERT_SUCCESS(status, status);
+
+    // Keeps at most one frame queued, waking up as it finishes times the completion well enough to predict the next
+    if (rendering_context->config.just_in_time_wait_enabled && rendering_context->frame_number > 2) {
+        status = rendering_context_wait_for_frame(rendering_context, rendering_context->frame_number - 2);
+        ASSERT_SUCCESS(status, status);
+    }
+
+    rendering_context_update_completed_frame_number(rendering_context);
+    frame_latency_controller_begin_frame(&rendering_context->latency_controller, rendering_context->frame_number);
+    rendering_context->paced_frame_number = rendering_context->frame_number;
+
+    return RENDERING_CONTEXT_SUCCESS;
+}
+
 RenderingContextError rendering_context_start_frame(RenderingContext* rendering_context) {
     VkDevice device = rendering_context_get_device(rendering_context);
     uint32_t current_frame = rendering_context->current_frame;
     Swapchain* swapchain = &rendering_context->swapchain;
     RenderFrameResources* resources = &rendering_context->frame_resources[current_frame];
 
-    VkResult status = vkWaitForFences(
-        device, 1, &resources->render_fence, true, TIME_MS_TO_NS(rendering_context->config.render_timeout_ms));
-    ASSERT_VK_LOG(status, "Render timed out", RENDERING_CONTEXT_RENDER_TIMEOUT);
-    status = vkResetFences(device, 1, &resources->render_fence);
-    ASSERT_VK_LOG(status, "Unable to reset the fence", RENDERING_CONTEXT_RESET_FENCE_FAILED);
+    RenderingContextError wait_status = rendering_context_pace_frame(rendering_context);
+    ASSERT_SUCCESS(wait_status, wait_status);
+    // Every buffer recorded for this frame slot has finished executing
+    if (!command_allocator_begin_frame(&rendering_context->command_allocator, current_frame)) {
+        return RENDERING_CONTEXT_COMMAND_BUFFER_ERROR;
+    }
 
     SwapchainError swapchain_status = swapchain_acquire_next_image(swapchain, resources->render_semaphore);
     if (swapchain_status == SWAPCHAIN_EXPIRED) {
@@ -154,12 +251,13 @@ RenderingContextError rendering_context_start_frame(RenderingContext* rendering_
         return RENDERING_CONTEXT_REFRESHING;
     }
 
-    CommandBufferInfo buffer_info = {
-        .buffer_index = swapchain->image_index,
-        .secondary = false,
-    };
-    VkCommandBuffer command_buffer =
-        command_context_get_command_buffer(rendering_context->command_context, "_render", &buffer_info);
+    // Reset only once the frame is sure to be submitted, a refreshing frame leaves the fence signaled for the retry
+    if (resources->render_fence != VK_NULL_HANDLE) {
+        VkResult reset_status = vkResetFences(device, 1, &resources->render_fence);
+        ASSERT_VK_LOG(reset_status, "Unable to reset the fence", RENDERING_CONTEXT_RESET_FENCE_FAILED);
+    }
+
+    VkCommandBuffer command_buffer = command_allocator_get_primary_buffer(&rendering_context->command_allocator, 0);
     if (command_buffer == VK_NULL_HANDLE) {
         return RENDERING_CONTEXT_COMMAND_BUFFER_ERROR;
     }
@@ -169,9 +267,8 @@ RenderingContextError rendering_context_start_frame(RenderingContext* rendering_
         .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
         .pInheritanceInfo = NULL,
     };
-    ASSERT_VK(vkResetCommandBuffer(command_buffer, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT),
-        RENDERING_CONTEXT_COMMAND_BUFFER_ERROR);
     ASSERT_VK(vkBeginCommandBuffer(command_buffer, &info), RENDERING_CONTEXT_COMMAND_BUFFER_ERROR);
+    resources->command_buffer = command_buffer;
 
     VkClearColorValue clear_color;
     color_to_float(&rendering_context->config.clear_color, clear_color.float32);
@@ -192,7 +289,7 @@ RenderingContextError rendering_context_start_frame(RenderingContext* rendering_
     VkRenderingInfoKHR rendering_info = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
         .pNext = NULL,
-        .flags = 0,
+        .flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR,
         .renderArea =
             {
                 .offset = {0, 0},
@@ -230,21 +327,6 @@ RenderingContextError rendering_context_start_frame(RenderingContext* rendering_
     vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, NULL, 0, NULL, 1, &image_memory_barrier);
 
-    VkViewport viewport = {0};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)swapchain->extent.width;
-    viewport.height = (float)swapchain->extent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor = {0};
-    scissor.offset = (VkOffset2D){0, 0};
-    scissor.extent = swapchain->extent;
-
-    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
-    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
-
     vkCmdBeginRenderingKHR(command_buffer, &rendering_info);
 
     return RENDERING_CONTEXT_SUCCESS;
@@ -252,12 +334,9 @@ RenderingContextError rendering_context_start_frame(RenderingContext* rendering_
 
 RenderingContextError rendering_context_end_frame(RenderingContext* rendering_context) {
     Swapchain* swapchain = &rendering_context->swapchain;
-    CommandBufferInfo buffer_info = {
-        .buffer_index = swapchain->image_index,
-        .secondary = false,
-    };
-    VkCommandBuffer command_buffer =
-        command_context_get_command_buffer(rendering_context->command_context, "_render", &buffer_info);
+    uint32_t current_frame = rendering_context->current_frame;
+    RenderFrameResources* resources = &rendering_context->frame_resources[current_frame];
+    VkCommandBuffer command_buffer = resources->command_buffer;
     if (command_buffer == VK_NULL_HANDLE) {
         return RENDERING_CONTEXT_COMMAND_BUFFER_ERROR;
     }
@@ -288,25 +367,41 @@ RenderingContextError rendering_context_end_frame(RenderingContext* rendering_co
         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &image_memory_barrier);
 
     ASSERT_VK(vkEndCommandBuffer(command_buffer), RENDERING_CONTEXT_COMMAND_BUFFER_ERROR);
-
-    uint32_t current_frame = rendering_context->current_frame;
-    RenderFrameResources* resources = &rendering_context->frame_resources[current_frame];
+    resources->command_buffer = VK_NULL_HANDLE;
+
+    // With the frame timeline the submit signals it with the frame number next to the binary present semaphore, the
+    // values of binary semaphores are ignored
+    const bool use_timeline = rendering_context->frame_timeline != VK_NULL_HANDLE;
+    const VkSemaphore signal_semaphores[2] = {resources->present_semaphore, rendering_context->frame_timeline};
+    const uint64_t wait_values[1] = {0};
+    const uint64_t signal_values[2] = {0, rendering_context->frame_number};
+    VkTimelineSemaphoreSubmitInfo timeline_info = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreValueCount = 1,
+        .pWaitSemaphoreValues = wait_values,
+        .signalSemaphoreValueCount = 2,
+        .pSignalSemaphoreValues = signal_values,
+    };
 
     VkPipelineStageFlags pipeline_flags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     VkSubmitInfo submit_info = {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .pNext = NULL,
+        .pNext = use_timeline ? &timeline_info : NULL,
         .waitSemaphoreCount = 1,
         .pWaitSemaphores = &resources->render_semaphore,
         .pWaitDstStageMask = &pipeline_flags,
         .commandBufferCount = 1,
         .pCommandBuffers = &command_buffer,
-        .signalSemaphoreCount = 1,
-        .pSignalSemaphores = &resources->present_semaphore,
+        .signalSemaphoreCount = use_timeline ? 2 : 1,
+        .pSignalSemaphores = signal_semaphores,
     };
     VkResult status =
         vkQueueSubmit(rendering_context->swapchain.queue.handle, 1, &submit_info, resources->render_fence);
     ASSERT_VK(status, RENDERING_CONTEXT_QUEUE_SUBMIT_FAILED);
+    frame_latency_controller_submit_frame(&rendering_context->latency_controller, rendering_context->frame_number);
+    resources->frame_number = rendering_context->frame_number;
+    rendering_context->frame_number += 1;
 
     VkPresentInfoKHR present_info = {
         .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
@@ -333,21 +428,160 @@ RenderingContextError rendering_context_end_frame(RenderingContext* rendering_co
     return RENDERING_CONTEXT_SUCCESS;
 }
 
-void rendering_context_render(RenderingContext* rendering_context) {
-    Swapchain* swapchain = &rendering_context->swapchain;
+VkCommandBuffer rendering_context_begin_secondary_buffer(RenderingContext* rendering_context, uint32_t thread_index) {
+    const Swapchain* swapchain = &rendering_context->swapchain;
+    VkCommandBuffer command_buffer =
+        command_allocator_get_secondary_buffer(&rendering_context->command_allocator, thread_index);
+    if (command_buffer == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
 
-    CommandBufferInfo buffer_info = {
-        .buffer_index = swapchain->image_index,
-        .secondary = false,
+    VkCommandBufferInheritanceRenderingInfoKHR inheritance_rendering_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR,
+        .pNext = NULL,
+        .flags = 0,
+        .viewMask = 0,
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &swapchain->image_format,
+        .depthAttachmentFormat = VK_FORMAT_UNDEFINED,
+        .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
     };
-    VkCommandBuffer command_buffer =
-        command_context_get_command_buffer(rendering_context->command_context, "_render", &buffer_info);
+    VkCommandBufferInheritanceInfo inheritance_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = &inheritance_rendering_info,
+        .renderPass = VK_NULL_HANDLE,
+        .subpass = 0,
+        .framebuffer = VK_NULL_HANDLE,
+        .occlusionQueryEnable = VK_FALSE,
+        .queryFlags = 0,
+        .pipelineStatistics = 0,
+    };
+    VkCommandBufferBeginInfo info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritance_info,
+    };
+    ASSERT_VK(vkBeginCommandBuffer(command_buffer, &info), VK_NULL_HANDLE);
+
+    // Dynamic state is not inherited from the primary buffer
+    VkViewport viewport = {0};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)swapchain->extent.width;
+    viewport.height = (float)swapchain->extent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor = {0};
+    scissor.offset = (VkOffset2D){0, 0};
+    scissor.extent = swapchain->extent;
+
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+    return command_buffer;
+}
+
+RenderingContextError rendering_context_end_secondary_buffer(VkCommandBuffer command_buffer) {
+    ASSERT_VK(vkEndCommandBuffer(command_buffer), RENDERING_CONTEXT_COMMAND_BUFFER_ERROR);
+    return RENDERING_CONTEXT_SUCCESS;
+}
+
+void rendering_context_execute_secondary_buffers(
+    RenderingContext* rendering_context, const VkCommandBuffer* command_buffers, uint32_t count) {
+    const RenderFrameResources* resources = &rendering_context->frame_resources[rendering_context->current_frame];
+    if (count == 0 || resources->command_buffer == VK_NULL_HANDLE) {
+        return;
+    }
+    vkCmdExecuteCommands(resources->command_buffer, count, command_buffers);
+}
+
+RenderingContextError rendering_context_render(RenderingContext* rendering_context) {
+    VkCommandBuffer command_buffer = rendering_context_begin_secondary_buffer(rendering_context, 0);
+    if (command_buffer == VK_NULL_HANDLE) {
+        return RENDERING_CONTEXT_COMMAND_BUFFER_ERROR;
+    }
 
     const PipelineRepository* pipeline_repo = rendering_context->pipeline_repository;
-    const GraphicsPipeline* testp = pipeline_repository_get_graphics_pipeline(pipeline_repo, "test");
+    const GraphicsPipeline* testp =
+        pipeline_repository_get_graphics_pipeline(pipeline_repo, rendering_context->pipeline_name);
     vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, testp->handle);
 
     vkCmdDraw(command_buffer, 3, 1, 0, 0);
+
+    RenderingContextError status = rendering_context_end_secondary_buffer(command_buffer);
+    ASSERT_SUCCESS(status, status);
+    rendering_context_execute_secondary_buffers(rendering_context, &command_buffer, 1);
+
+    return RENDERING_CONTEXT_SUCCESS;
+}
+
+uint64_t rendering_context_update_completed_frame_number(RenderingContext* rendering_context) {
+    VkDevice device = rendering_context_get_device(rendering_context);
+    if (rendering_context->frame_timeline != VK_NULL_HANDLE) {
+        uint64_t value = 0;
+        if (vkGetSemaphoreCounterValue(device, rendering_context->frame_timeline, &value) == VK_SUCCESS) {
+            rendering_context_complete_frame(rendering_context, value);
+        }
+        return rendering_context->completed_frame_number;
+    }
+
+    for (uint32_t i = 0; i < rendering_context->config.frames_in_flight; ++i) {
+        const RenderFrameResources* resources = &rendering_context->frame_resources[i];
+        if (resources->frame_number > rendering_context->completed_frame_number &&
+            vkGetFenceStatus(device, resources->render_fence) == VK_SUCCESS) {
+            rendering_context_complete_frame(rendering_context, resources->frame_number);
+        }
+    }
+
+    return rendering_context->completed_frame_number;
+}
+
+RenderingContextError rendering_context_wait_for_frame(RenderingContext* rendering_context, uint64_t frame_number) {
+    if (frame_number <= rendering_context->completed_frame_number) {
+        return RENDERING_CONTEXT_SUCCESS;
+    }
+    if (frame_number >= rendering_context->frame_number) {
+        return RENDERING_CONTEXT_FRAME_NOT_SUBMITTED;
+    }
+
+    VkDevice device = rendering_context_get_device(rendering_context);
+    const uint64_t timeout = TIME_MS_TO_NS(rendering_context->config.render_timeout_ms);
+    if (rendering_context->frame_timeline != VK_NULL_HANDLE) {
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores = &rendering_context->frame_timeline,
+            .pValues = &frame_number,
+        };
+        VkResult status = vkWaitSemaphores(device, &wait_info, timeout);
+        ASSERT_VK_LOG(status, "Render timed out", RENDERING_CONTEXT_RENDER_TIMEOUT);
+        rendering_context_complete_frame(rendering_context, frame_number);
+        return RENDERING_CONTEXT_SUCCESS;
+    }
+
+    // Fences signal in submission order, the earliest frame at or after the requested one covers it
+    const RenderFrameResources* waited_resources = NULL;
+    for (uint32_t i = 0; i < rendering_context->config.frames_in_flight; ++i) {
+        const RenderFrameResources* resources = &rendering_context->frame_resources[i];
+        if (resources->frame_number >= frame_number &&
+            (waited_resources == NULL || resources->frame_number < waited_resources->frame_number)) {
+            waited_resources = resources;
+        }
+    }
+    if (waited_resources == NULL) {
+        return RENDERING_CONTEXT_FRAME_NOT_SUBMITTED;
+    }
+
+    VkResult status = vkWaitForFences(device, 1, &waited_resources->render_fence, true, timeout);
+    ASSERT_VK_LOG(status, "Render timed out", RENDERING_CONTEXT_RENDER_TIMEOUT);
+    rendering_context_complete_frame(rendering_context, waited_resources->frame_number);
+
+    return RENDERING_CONTEXT_SUCCESS;
 }
 
 void rendering_context_destroy(RenderingContext* rendering_context) {
@@ -368,6 +602,10 @@ void rendering_context_destroy(RenderingContext* rendering_context) {
             vkDestroyFence(device, resources->render_fence, NULL);
         }
     }
+    if (rendering_context->frame_timeline != VK_NULL_HANDLE) {
+        vkDestroySemaphore(device, rendering_context->frame_timeline, NULL);
+    }
+    command_allocator_destroy(&rendering_context->command_allocator);
     swapchain_destroy(&rendering_context->swapchain, false);
     rendering_context_clear(rendering_context);
 }
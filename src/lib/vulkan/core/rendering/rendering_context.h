@@ -5,26 +5,52 @@
 #include <vulkan/vulkan.h>
 
 #include "../../../renderer/core/rendering_context_config.h"
+#include "../command/command_allocator.h"
 #include "../command/command_context.h"
 #include "../errors.h"
 #include "../shader/pipeline_repository.h"
 #include "../swapchain/swapchain.h"
+#include "./frame_latency_controller.h"
 
 #define RENDERING_CONTEXT_MAX_FRAMES_IN_FLIGHT 8
 
+#define RENDERING_CONTEXT_MAX_RECORDING_THREADS COMMAND_ALLOCATOR_MAX_THREADS
+// Allocated up front, a thread recording more grows its pool
+#define RENDERING_CONTEXT_SECONDARY_BUFFERS_PER_THREAD 8
+
+#define RENDERING_CONTEXT_PIPELINE_NAME "test"
+
 typedef struct RenderFrameResources {
+    // Not created when frames are paced with the frame timeline
     VkFence render_fence;
     VkSemaphore render_semaphore;
     VkSemaphore present_semaphore;
+    // Primary buffer of the frame, it only begins and ends rendering and executes the secondary buffers
+    VkCommandBuffer command_buffer;
+    // Last frame submitted from this slot, 0 before the first submit
+    uint64_t frame_number;
 } RenderFrameResources;
 
 typedef struct RenderingContext {
     CommandContext* command_context;
     const PipelineRepository* pipeline_repository;
     Swapchain swapchain;
+    // Resolved once in init so that recording a frame does not hash any names
+    StringAtom pipeline_name;
+    CommandAllocator command_allocator;
 
     uint32_t current_frame;
+    // Frame numbers start at 1 and increase with every submitted frame, every frame up to the completed frame number
+    // has finished on the GPU
+    uint64_t frame_number;
+    uint64_t completed_frame_number;
+    // Timeline semaphore signaled with the frame number of every submitted frame, VK_NULL_HANDLE when frames are
+    // paced with the fences of the frame slots
+    VkSemaphore frame_timeline;
     RenderFrameResources frame_resources[RENDERING_CONTEXT_MAX_FRAMES_IN_FLIGHT];
+    FrameLatencyController latency_controller;
+    // Last frame number the frame slot wait and the just in time wait were done for
+    uint64_t paced_frame_number;
 
     RenderingContextConfig config;
 } RenderingContext;
@@ -33,12 +59,20 @@ static inline void rendering_context_clear(RenderingContext* rendering_context)
     rendering_context->command_context = NULL;
     rendering_context->pipeline_repository = NULL;
     swapchain_clear(&rendering_context->swapchain);
+    rendering_context->pipeline_name = STRING_ATOM_NONE;
+    command_allocator_clear(&rendering_context->command_allocator);
     rendering_context->config = (RenderingContextConfig){0};
     rendering_context->current_frame = 0;
+    rendering_context->frame_number = 1;
+    rendering_context->completed_frame_number = 0;
+    rendering_context->frame_timeline = VK_NULL_HANDLE;
+    rendering_context->paced_frame_number = 0;
     for (uint32_t i = 0; i < RENDERING_CONTEXT_MAX_FRAMES_IN_FLIGHT; ++i) {
+        rendering_context->frame_resources[i].frame_number = 0;
         rendering_context->frame_resources[i].render_semaphore = VK_NULL_HANDLE;
         rendering_context->frame_resources[i].present_semaphore = VK_NULL_HANDLE;
         rendering_context->frame_resources[i].render_fence = VK_NULL_HANDLE;
+        rendering_context->frame_resources[i].command_buffer = VK_NULL_HANDLE;
     }
 }
 
@@ -47,10 +81,31 @@ RenderingContextError rendering_context_init(RenderingContext* rendering_context
 
 RenderingContextError rendering_context_resize(RenderingContext* rendering_context);
 
+// Waits for the frame slot and then for the just in time delay, once per frame. Called before sampling input, start
+// frame calls it when it was not
+RenderingContextError rendering_context_pace_frame(RenderingContext* rendering_context);
 RenderingContextError rendering_context_start_frame(RenderingContext* rendering_context);
 RenderingContextError rendering_context_end_frame(RenderingContext* rendering_context);
 
-void rendering_context_render(RenderingContext* rendering_context);
+// Draws are recorded into secondary buffers, each recording thread has its own thread index and pool per frame.
+// Thread index 0 belongs to the thread that starts and ends the frame. Returns VK_NULL_HANDLE when no buffer could be
+// allocated
+VkCommandBuffer rendering_context_begin_secondary_buffer(RenderingContext* rendering_context, uint32_t thread_index);
+RenderingContextError rendering_context_end_secondary_buffer(VkCommandBuffer command_buffer);
+// Called from the thread that started the frame once the secondary buffers are ended, in submission order
+void rendering_context_execute_secondary_buffers(
+    RenderingContext* rendering_context, const VkCommandBuffer* command_buffers, uint32_t count);
+
+RenderingContextError rendering_context_render(RenderingContext* rendering_context);
+
+// Polls the GPU progress without blocking
+uint64_t rendering_context_update_completed_frame_number(RenderingContext* rendering_context);
+// Blocks until the GPU has finished the frame or render_timeout_ms passes, the frame must have been submitted
+RenderingContextError rendering_context_wait_for_frame(RenderingContext* rendering_context, uint64_t frame_number);
+
+static inline const FrameLatencyStats* rendering_context_get_latency_stats(const RenderingContext* rendering_context) {
+    return &rendering_context->latency_controller.stats;
+}
 
 void rendering_context_destroy(RenderingContext* rendering_context);
 
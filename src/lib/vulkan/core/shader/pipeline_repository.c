@@ -3,30 +3,61 @@
 #include "./graphics_pipeline.h"
 #include "./shader_types.h"
 
-void pipeline_repository_clear(PipelineRepository* repository) { hash_string_map_clear(&repository->pipeline_map); }
+static const PipelineRecord* pipeline_repository_get_record(const PipelineRepository* repository, StringAtom name) {
+    uint32_t index;
+    if (!string_atom_map_get(&repository->record_indices, name, &index)) {
+        return NULL;
+    }
+    return &repository->records.data[index];
+}
+
+static void pipeline_repository_destroy_record(PipelineRecord* record) {
+    if (record->type == PIPELINE_TYPE_GRAPHICS) {
+        graphics_pipeline_destroy(&record->graphics_pipeline);
+    }
+}
+
+void pipeline_repository_clear(PipelineRepository* repository) {
+    vector_init(&repository->records);
+    string_atom_map_clear(&repository->record_indices);
+}
 
 bool pipeline_repository_init(PipelineRepository* repository, const PipelineRepositoryConfig* config) {
     size_t reserved_size = config->reserved_size < 10 ? 20 : config->reserved_size;
-    bool status = hash_string_map_reserve(&repository->pipeline_map, reserved_size);
+    bool status = vector_reserve(&repository->records, reserved_size) &&
+                  string_atom_map_reserve(&repository->record_indices, reserved_size);
 
     return status;
 }
 
 bool pipeline_repository_add_graphics_pipeline(
     PipelineRepository* repository, const char* name, const GraphicsPipeline* pipeline) {
-    if (string_length(name) >= HASH_KEY_MAX_SIZE) {
+    StringAtom atom = string_atom_intern(name);
+    if (!string_atom_is_valid(atom)) {
         return false;
     }
 
-    PipelineRecord record = {.type = PIPELINE_TYPE_GRAPHICS, .graphics_pipeline = *pipeline};
-    bool add_status = hash_string_map_add(&repository->pipeline_map, name, record);
+    PipelineRecord record = {.name = atom, .type = PIPELINE_TYPE_GRAPHICS, .graphics_pipeline = *pipeline};
+    PipelineRecord* existing_record = (PipelineRecord*)pipeline_repository_get_record(repository, atom);
+    if (existing_record != NULL) {
+        *existing_record = record;
+        return true;
+    }
 
-    return add_status;
+    if (!string_atom_map_set(&repository->record_indices, atom, (uint32_t)repository->records.size)) {
+        return false;
+    }
+    if (!vector_push(&repository->records, record)) {
+        string_atom_map_delete(&repository->record_indices, atom);
+        return false;
+    }
+
+    return true;
 }
 
 const GraphicsPipeline* const pipeline_repository_get_graphics_pipeline(
-    const PipelineRepository* repository, const char* name) {
-    const PipelineRecord* record = hash_string_map_get_reference(&repository->pipeline_map, name);
+    const PipelineRepository* repository, StringAtom name) {
+    const PipelineRecord* record = pipeline_repository_get_record(repository, name);
     if (record == NULL || record->type != PIPELINE_TYPE_GRAPHICS) {
         return NULL;
     }
@@ -34,19 +65,9 @@ const GraphicsPipeline* const pipeline_repository_get_graphics_pipeline(
 }
 
 void pipeline_repository_destroy(PipelineRepository* repository) {
-    const size_t buffer_size = 32;
-    size_t processed = 0;
-    PipelineRecord* buffer[buffer_size];
-    while (processed < hash_string_map_get_size(&repository->pipeline_map)) {
-        const size_t current_processed =
-            hash_string_map_values_reference_range(&repository->pipeline_map, buffer, processed, buffer_size);
-        processed += current_processed;
-        for (size_t i = 0; i < current_processed; ++i) {
-            if (buffer[i]->type == PIPELINE_TYPE_GRAPHICS) {
-                GraphicsPipeline* pipeline = &buffer[i]->graphics_pipeline;
-                graphics_pipeline_destroy(pipeline);
-            }
-        }
-    }
-    hash_string_map_clear(&repository->pipeline_map);
+    for (size_t i = 0; i < repository->records.size; ++i) {
+        pipeline_repository_destroy_record(&repository->records.data[i]);
+    }
+    vector_clear(&repository->records);
+    string_atom_map_destroy(&repository->record_indices);
 }
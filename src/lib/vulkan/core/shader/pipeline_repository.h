@@ -4,25 +4,30 @@
 #include <stdbool.h>
 #include <stddef.h>
 
-#include "../../../core/collections/hash_string_map.h"
+#include "../../../core/collections/vector.h"
+#include "../../../core/string/string_atom.h"
+#include "../../../core/string/string_atom_map.h"
 #include "./graphics_pipeline.h"
 #include "./shader_types.h"
 
 typedef struct PipelineRecord {
+    StringAtom name;
     PipelineType type;
     union {
         GraphicsPipeline graphics_pipeline;
     };
 } PipelineRecord;
 
-typedef struct PipelineHashMap HASH_STRING_MAP(PipelineRecord) PipelineHashMap;
+typedef struct PipelineRecordVector VECTOR(PipelineRecord) PipelineRecordVector;
 
 typedef struct PipelineRepositoryConfig {
     size_t reserved_size;
 } PipelineRepositoryConfig;
 
+// Maps the atom of a pipeline name to the position of its record
 typedef struct PipelineRepository {
-    PipelineHashMap pipeline_map;
+    PipelineRecordVector records;
+    StringAtomMap record_indices;
 } PipelineRepository;
 
 void pipeline_repository_clear(PipelineRepository* repository);
@@ -31,7 +36,7 @@ bool pipeline_repository_init(PipelineRepository* repository, const PipelineRepo
 bool pipeline_repository_add_graphics_pipeline(
     PipelineRepository* repository, const char* name, const GraphicsPipeline* pipeline);
 const GraphicsPipeline* const pipeline_repository_get_graphics_pipeline(
-    const PipelineRepository* repository, const char* name);
+    const PipelineRepository* repository, StringAtom name);
 
 void pipeline_repository_destroy(PipelineRepository* repository);
 
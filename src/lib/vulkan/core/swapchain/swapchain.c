@@ -15,6 +15,7 @@ void swapchain_copy(const Swapchain* src, Swapchain* dst) {
     dst->image_count = src->image_count;
     dst->image_format = src->image_format;
     dst->extent = src->extent;
+    dst->present_mode = src->present_mode;
     dst->queue = src->queue;
     dst->image_index = src->image_index;
 
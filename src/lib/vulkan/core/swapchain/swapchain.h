@@ -18,6 +18,7 @@ typedef struct Swapchain {
     uint32_t image_count;
     VkFormat image_format;
     VkExtent2D extent;
+    VkPresentModeKHR present_mode;
 
     VkImage images[SWAPCHAIN_MAX_IMAGES];
     bool init_images;
@@ -36,6 +37,7 @@ static inline void swapchain_clear(Swapchain* swapchain) {
     swapchain->image_count = 0;
     swapchain->image_format = VK_FORMAT_UNDEFINED;
     swapchain->extent = (VkExtent2D){.width = 0, .height = 0};
+    swapchain->present_mode = VK_PRESENT_MODE_FIFO_KHR;
     swapchain->init_images = false;
     swapchain->init_image_view_count = 0;
 
@@ -20,9 +20,28 @@ int memory_context_builder_set_config_value(MemoryContextBuilder* builder, const
         return 1;
     }
 
-    if (string_equals(name, "garbage_list_count")) {
+    if (string_equals(name, "transient_block_size_MB")) {
         INI_PARSER_ASSERT_INT("memory_context", name, value, false, 1);
-        builder->allocator_info.garbage_list_count = string_to_int(value, size_t);
+        builder->allocator_info.transient_block_size_MB = string_to_int(value, VkDeviceSize);
+        return 1;
+    }
+
+    if (string_equals(name, "dedicated_allocation_threshold_MB")) {
+        INI_PARSER_ASSERT_INT("memory_context", name, value, false, 1);
+        builder->allocator_info.dedicated_allocation_threshold_MB = string_to_int(value, VkDeviceSize);
+        return 1;
+    }
+
+    if (string_equals(name, "concurrent")) {
+        builder->allocator_info.concurrent = string_equals(value, "1");
+        return 1;
+    }
+
+    if (string_equals(name, "trace_path")) {
+        if (!string_copy(value, builder->trace_path, PATH_MAX_SIZE)) {
+            log_warning("Memory trace path is too long");
+            builder->trace_path[0] = '\0';
+        }
         return 1;
     }
 
@@ -47,7 +66,9 @@ MemoryContextError memory_context_builder_build(MemoryContextBuilder* builder, M
         return MEMORY_CONTEXT_DEVICE_NOT_PROVIDED;
     }
 
+    context->device = builder->device;
     builder->allocator_info.device = builder->device;
+    builder->allocator_info.trace_path = builder->trace_path;
     MemoryContextError status = vulkan_memory_allocator_init(&context->allocator, &builder->allocator_info);
     ASSERT_SUCCESS(status, status);
 
@@ -1,6 +1,7 @@
 #ifndef MEMORY_CONTEXT_BUILDER_H
 #define MEMORY_CONTEXT_BUILDER_H
 
+#include "../../../core/fs/path.h"
 #include "../../core/memory/allocator.h"
 #include "../../core/memory/memory_context.h"
 
@@ -9,12 +10,14 @@ typedef struct MemoryContextBuilder {
 
     VulkanMemoryAllocatorInfo allocator_info;
     size_t allocation_cache_size;
+    char trace_path[PATH_MAX_SIZE];
 } MemoryContextBuilder;
 
 static inline void memory_context_builder_clear(MemoryContextBuilder* builder) {
     builder->device = NULL;
     builder->allocator_info = vulkan_memory_allocator_info_get_default();
     builder->allocation_cache_size = 128;
+    builder->trace_path[0] = '\0';
 }
 
 int memory_context_builder_set_config_value(MemoryContextBuilder* builder, const char* name, const char* value);
@@ -8,9 +8,8 @@
 #include "../../../core/functions.h"
 
 static void shader_loader_cache_store_shader(ShaderLoader* loader, const Shader* shader, const char* filename) {
-    char buffer[PATH_MAX_SIZE];
-    bool status = string_copy(filename, buffer, PATH_MAX_SIZE);
-    if (!status) {
+    StringAtom key = string_atom_intern(filename);
+    if (!string_atom_is_valid(key)) {
         return;
     }
 
@@ -18,8 +17,11 @@ static void shader_loader_cache_store_shader(ShaderLoader* loader, const Shader*
     if (item->value.handle != VK_NULL_HANDLE) {
         vkDestroyShaderModule(loader->device->handle, item->value.handle, NULL);
     }
+    string_atom_map_delete(&loader->cache_index, item->key);
 
-    md5_string(buffer, string_length(buffer), item->key);
+    // The index has room for every item, a failed insert only costs a reload of the shader
+    string_atom_map_set(&loader->cache_index, key, (uint32_t)loader->current_cache_index);
+    item->key = key;
     shader_copy(shader, &item->value);
     item->active = true;
 
@@ -30,24 +32,15 @@ static void shader_loader_cache_store_shader(ShaderLoader* loader, const Shader*
     }
 }
 
+// A filename that was never interned was never cached either
 static const Shader* shader_loader_cache_get_shader(ShaderLoader* loader, const char* filename) {
-    char buffer[PATH_MAX_SIZE];
-    bool status = string_copy(filename, buffer, PATH_MAX_SIZE);
-    if (!status) {
+    uint32_t index;
+    if (!string_atom_map_get(&loader->cache_index, string_atom_find(filename), &index)) {
         return NULL;
     }
 
-    char key[SHADER_LOADER_CACHE_KEY_SIZE];
-    md5_string(buffer, string_length(buffer), key);
-
-    for (size_t i = 0; i < loader->cache_size; ++i) {
-        if (string_equals(key, loader->cache[i].key)) {
-            loader->cache[i].active = true;
-            return &loader->cache[i].value;
-        }
-    }
-
-    return NULL;
+    loader->cache[index].active = true;
+    return &loader->cache[index].value;
 }
 
 void shader_loader_clear(ShaderLoader* loader) {
@@ -57,6 +50,7 @@ void shader_loader_clear(ShaderLoader* loader) {
     loader->buffer_handle = NULL;
     loader->cache_enabled = false;
     loader->cache = NULL;
+    string_atom_map_clear(&loader->cache_index);
     loader->cache_size = 0;
     loader->current_cache_index = 0;
     string_copy("", loader->basepath, PATH_MAX_SIZE);
@@ -93,8 +87,10 @@ bool shader_loader_init(ShaderLoader* loader, const ShaderLoaderConfig* config)
     }
     if (config->cache_enabled) {
         ShaderLoaderCacheItem* cache = mem_alloc(cache_size * sizeof(ShaderLoaderCacheItem));
-        if (cache == NULL) {
+        if (cache == NULL || !string_atom_map_reserve(&loader->cache_index, cache_size)) {
             log_warning("Unable to allocate shader loader cache");
+            mem_free(cache);
+            string_atom_map_destroy(&loader->cache_index);
             return true;
         }
         loader->cache_enabled = true;
@@ -175,10 +171,11 @@ void shader_loader_clear_cache(ShaderLoader* loader, bool destroy_shaders) {
         if (destroy_shaders && item->value.handle != VK_NULL_HANDLE) {
             vkDestroyShaderModule(loader->device->handle, item->value.handle, NULL);
         }
-        string_copy("", item->key, SHADER_LOADER_CACHE_KEY_SIZE);
+        item->key = STRING_ATOM_NONE;
         shader_clear(&item->value);
         item->active = false;
     }
+    string_atom_map_clear_values(&loader->cache_index);
 }
 
 void shader_loader_inactivate_cache_records(ShaderLoader* loader) {
@@ -199,6 +196,7 @@ void shader_loader_destroy(ShaderLoader* loader) {
     if (loader->cache_size > 0) {
         mem_free(loader->cache);
     }
+    string_atom_map_destroy(&loader->cache_index);
     mem_free(loader->buffer_handle);
     shader_loader_clear(loader);
 }
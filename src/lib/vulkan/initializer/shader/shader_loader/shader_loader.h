@@ -5,17 +5,18 @@
 #include <stddef.h>
 
 #include "../../../../core/fs/path.h"
-#include "../../../../core/utils/md5/md5.h"
+#include "../../../../core/string/string_atom.h"
+#include "../../../../core/string/string_atom_map.h"
 #include "../../../core/device/device.h"
 #include "../../../core/shader/shader.h"
 
-#define SHADER_LOADER_CACHE_KEY_SIZE MD5_DIGEST_STRING_LENGTH
 #define SHADER_LOADER_DEFAULT_CACHE_SIZE 64
 
 typedef struct ShaderLoaderCacheItem {
     bool active;
     Shader value;
-    char key[SHADER_LOADER_CACHE_KEY_SIZE];
+    // Atom of the shader filename
+    StringAtom key;
 } ShaderLoaderCacheItem;
 
 typedef struct ShaderLoaderConfig {
@@ -37,6 +38,8 @@ typedef struct ShaderLoader {
 
     bool cache_enabled;
     ShaderLoaderCacheItem* cache;
+    // Atom of the filename to the position of its cache item
+    StringAtomMap cache_index;
     size_t cache_size;
     size_t current_cache_index;
 } ShaderLoader;
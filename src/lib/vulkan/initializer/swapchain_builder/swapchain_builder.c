@@ -95,6 +95,7 @@ SwapchainError swapchain_builder_build(SwapchainBuilder* builder, Swapchain* swa
     swapchain->image_count = image_count;
     swapchain->image_format = surface_format.format;
     swapchain->extent = extent;
+    swapchain->present_mode = present_mode;
     swapchain->queue = device_get_present_queue(builder->device);
 
     if (swapchain->queue.handle == VK_NULL_HANDLE) {
@@ -2,6 +2,12 @@
 
 #include <stdint.h>
 
+#include "../core/functions.h"
+#include "../core/physical_device/physical_device.h"
+
+// Share of a heap that is considered safe to use when the driver does not report a budget
+#define MEMORY_UTILS_HEAP_BUDGET_PERCENT 80
+
 uint32_t memory_utils_find_memory_type_index(const Device* device, uint32_t memory_type_bits, VulkanMemoryUsage usage) {
     const VkPhysicalDeviceMemoryProperties* device_memory_props = &device->physical_device->memory_properties;
 
@@ -63,3 +69,45 @@ uint32_t memory_utils_find_memory_type_index(const Device* device, uint32_t memo
 VkDeviceSize memory_utils_get_buffer_granularity_from_device(const Device* device) {
     return device->physical_device->properties.limits.bufferImageGranularity;
 }
+
+uint32_t memory_utils_get_memory_heap_index(const Device* device, uint32_t memory_type_index) {
+    return device->physical_device->memory_properties.memoryTypes[memory_type_index].heapIndex;
+}
+
+bool memory_utils_is_memory_type_coherent(const Device* device, uint32_t memory_type_index) {
+    const VkMemoryType* memory_type = &device->physical_device->memory_properties.memoryTypes[memory_type_index];
+    return (memory_type->propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+bool memory_utils_get_memory_budget(const Device* device, VulkanMemoryHeapBudget budgets[VK_MAX_MEMORY_HEAPS]) {
+    const PhysicalDevice* physical_device = device->physical_device;
+    const VkPhysicalDeviceMemoryProperties* device_memory_props = &physical_device->memory_properties;
+
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_HEAPS; ++i) {
+        budgets[i].budget = 0;
+        budgets[i].usage = 0;
+    }
+
+    if (physical_device_has_extension(physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_props = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+            .pNext = NULL,
+        };
+        VkPhysicalDeviceMemoryProperties2 memory_props = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &budget_props,
+        };
+        vkGetPhysicalDeviceMemoryProperties2(physical_device->handle, &memory_props);
+
+        for (uint32_t i = 0; i < memory_props.memoryProperties.memoryHeapCount; ++i) {
+            budgets[i].budget = budget_props.heapBudget[i];
+            budgets[i].usage = budget_props.heapUsage[i];
+        }
+        return true;
+    }
+
+    for (uint32_t i = 0; i < device_memory_props->memoryHeapCount; ++i) {
+        budgets[i].budget = device_memory_props->memoryHeaps[i].size / 100 * MEMORY_UTILS_HEAP_BUDGET_PERCENT;
+    }
+    return false;
+}
@@ -1,6 +1,7 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <vulkan/vulkan.h>
 
@@ -9,5 +10,16 @@
 
 uint32_t memory_utils_find_memory_type_index(const Device* device, uint32_t memory_type_bits, VulkanMemoryUsage usage);
 VkDeviceSize memory_utils_get_buffer_granularity_from_device(const Device* device);
+uint32_t memory_utils_get_memory_heap_index(const Device* device, uint32_t memory_type_index);
+bool memory_utils_is_memory_type_coherent(const Device* device, uint32_t memory_type_index);
+
+typedef struct VulkanMemoryHeapBudget {
+    VkDeviceSize budget;
+    VkDeviceSize usage;
+} VulkanMemoryHeapBudget;
+
+// Returns false when VK_EXT_memory_budget is not enabled, the budget is then estimated from the heap size and the
+// usage is left at 0 so the caller has to account for its own allocations
+bool memory_utils_get_memory_budget(const Device* device, VulkanMemoryHeapBudget budgets[VK_MAX_MEMORY_HEAPS]);
 
 #endif
@@ -0,0 +1,191 @@
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "../../src/lib/core/memory/memory.h"
+#include "../../src/lib/vulkan/core/memory/allocator.h"
+#include "../../src/lib/vulkan/core/memory/backend/fake_memory_backend.h"
+#include "../test.h"
+
+#define ALLOCATION_SIZE (256 * 1024)
+#define ALLOCATION_COUNT 10
+
+// Three 1 MB device local blocks: the first keeps one allocation, the second is full and the third keeps two
+typedef struct DefragmentationFixture {
+    FakeMemoryBackend fake;
+    VulkanMemoryAllocator allocator;
+    VulkanAllocation allocations[ALLOCATION_COUNT];
+    VulkanMemoryDefragmentationCandidate candidates[ALLOCATION_COUNT];
+    size_t candidate_count;
+    VulkanMemoryDefragmentationMoveList moves;
+} DefragmentationFixture;
+
+// Holds a fake device, too large for the stack
+static DefragmentationFixture* fixture;
+
+static bool fixture_init(DefragmentationFixture* fixture) {
+    fake_memory_backend_clear(&fixture->fake);
+    vulkan_memory_allocator_clear(&fixture->allocator);
+    vector_init(&fixture->moves);
+    fixture->candidate_count = 0;
+    for (size_t i = 0; i < ALLOCATION_COUNT; ++i) {
+        vulkan_allocation_clear(&fixture->allocations[i]);
+    }
+
+    FakeMemoryBackendInfo fake_info = fake_memory_backend_info_get_default();
+    TEST_ASSERT(fake_memory_backend_init(&fixture->fake, &fake_info) == MEMORY_CONTEXT_SUCCESS);
+
+    VulkanMemoryAllocatorInfo allocator_info = vulkan_memory_allocator_info_get_default();
+    allocator_info.device = &fixture->fake.device;
+    allocator_info.backend = &fixture->fake.backend;
+    allocator_info.device_local_block_size_MB = 1;
+    allocator_info.dedicated_allocation_threshold_MB = 1;
+    TEST_ASSERT(vulkan_memory_allocator_init(&fixture->allocator, &allocator_info) == MEMORY_CONTEXT_SUCCESS);
+
+    VulkanMemoryAllocatorRequest request = {
+        .size = ALLOCATION_SIZE,
+        .align = 256,
+        .memory_type_bits = 1,
+        .usage = VULKAN_MEMORY_USAGE_GPU_ONLY,
+        .allocation_type = VULKAN_ALLOCATION_TYPE_BUFFER,
+        .strategy = VULKAN_MEMORY_STRATEGY_DEFAULT,
+        .prefers_dedicated_allocation = false,
+        .requires_dedicated_allocation = false,
+        .buffer = VK_NULL_HANDLE,
+    };
+    for (size_t i = 0; i < ALLOCATION_COUNT; ++i) {
+        TEST_ASSERT(vulkan_memory_allocator_allocate(&fixture->allocator, &request, &fixture->allocations[i]) ==
+                    MEMORY_CONTEXT_SUCCESS);
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        vulkan_memory_allocator_free_immediately(&fixture->allocator, &fixture->allocations[i]);
+    }
+
+    TEST_ASSERT(fixture->allocations[3].block->allocated == ALLOCATION_SIZE);
+    TEST_ASSERT(fixture->allocations[4].block->allocated == 4 * ALLOCATION_SIZE);
+    TEST_ASSERT(fixture->allocations[8].block->allocated == 2 * ALLOCATION_SIZE);
+    TEST_ASSERT(fixture->allocations[8].block == fixture->allocations[9].block);
+
+    return true;
+}
+
+static void fixture_add_candidates(DefragmentationFixture* fixture, size_t first, size_t last) {
+    for (size_t i = first; i <= last; ++i) {
+        fixture->candidates[fixture->candidate_count++] = (VulkanMemoryDefragmentationCandidate){
+            .allocation = fixture->allocations[i],
+            .align = 256,
+        };
+    }
+}
+
+static bool fixture_destroy(DefragmentationFixture* fixture) {
+    for (size_t i = 0; i < fixture->moves.size; ++i) {
+        vulkan_memory_allocator_cancel_defragmentation_move(&fixture->allocator, &fixture->moves.data[i]);
+    }
+    vector_clear(&fixture->moves);
+    for (size_t i = 0; i < ALLOCATION_COUNT; ++i) {
+        if (fixture->allocations[i].block != NULL) {
+            vulkan_memory_allocator_free_immediately(&fixture->allocator, &fixture->allocations[i]);
+        }
+    }
+    vulkan_memory_allocator_destroy(&fixture->allocator);
+
+    bool is_released = fixture->fake.allocation_count == 0;
+    fake_memory_backend_destroy(&fixture->fake);
+
+    return is_released;
+}
+
+static bool test_least_used_block_moves_into_fuller_block(void) {
+    TEST_ASSERT(fixture_init(fixture));
+    fixture_add_candidates(fixture, 3, 9);
+
+    VulkanMemoryDefragmentationLimits limits = {0};
+    TEST_ASSERT(vulkan_memory_allocator_plan_defragmentation(&fixture->allocator, fixture->candidates,
+                    fixture->candidate_count, &limits, &fixture->moves) == MEMORY_CONTEXT_SUCCESS);
+
+    // The third block is not emptied, the destination reserved in it is not a candidate
+    TEST_ASSERT(fixture->moves.size == 1);
+    const VulkanMemoryDefragmentationMove* move = &fixture->moves.data[0];
+    TEST_ASSERT(move->candidate_index == 0);
+    TEST_ASSERT(move->source.chunk == fixture->allocations[3].chunk);
+    TEST_ASSERT(move->destination.block == fixture->allocations[8].block);
+    TEST_ASSERT(move->destination.size == ALLOCATION_SIZE);
+    TEST_ASSERT(fixture->allocations[8].block->allocated == 3 * ALLOCATION_SIZE);
+
+    return fixture_destroy(fixture);
+}
+
+static bool test_block_with_unmovable_allocation_is_skipped(void) {
+    TEST_ASSERT(fixture_init(fixture));
+    fixture_add_candidates(fixture, 4, 8);
+
+    VulkanMemoryDefragmentationLimits limits = {0};
+    TEST_ASSERT(vulkan_memory_allocator_plan_defragmentation(&fixture->allocator, fixture->candidates,
+                    fixture->candidate_count, &limits, &fixture->moves) == MEMORY_CONTEXT_SUCCESS);
+
+    // The moves planned for a block that cannot be emptied are rolled back
+    TEST_ASSERT(fixture->moves.size == 0);
+    TEST_ASSERT(fixture->allocations[3].block->allocated == ALLOCATION_SIZE);
+    TEST_ASSERT(fixture->allocations[4].block->allocated == 4 * ALLOCATION_SIZE);
+    TEST_ASSERT(fixture->allocations[8].block->allocated == 2 * ALLOCATION_SIZE);
+
+    return fixture_destroy(fixture);
+}
+
+static bool test_limits_are_respected(void) {
+    TEST_ASSERT(fixture_init(fixture));
+    fixture_add_candidates(fixture, 3, 9);
+
+    VulkanMemoryDefragmentationLimits limits = {
+        .max_bytes = ALLOCATION_SIZE - 1,
+        .max_moves = 0,
+    };
+    TEST_ASSERT(vulkan_memory_allocator_plan_defragmentation(&fixture->allocator, fixture->candidates,
+                    fixture->candidate_count, &limits, &fixture->moves) == MEMORY_CONTEXT_SUCCESS);
+    TEST_ASSERT(fixture->moves.size == 0);
+    TEST_ASSERT(fixture->allocations[8].block->allocated == 2 * ALLOCATION_SIZE);
+
+    limits = (VulkanMemoryDefragmentationLimits){
+        .max_bytes = ALLOCATION_SIZE,
+        .max_moves = 1,
+    };
+    TEST_ASSERT(vulkan_memory_allocator_plan_defragmentation(&fixture->allocator, fixture->candidates,
+                    fixture->candidate_count, &limits, &fixture->moves) == MEMORY_CONTEXT_SUCCESS);
+    TEST_ASSERT(fixture->moves.size == 1);
+
+    return fixture_destroy(fixture);
+}
+
+static bool test_cancelled_move_releases_destination(void) {
+    TEST_ASSERT(fixture_init(fixture));
+    fixture_add_candidates(fixture, 3, 9);
+
+    VulkanMemoryDefragmentationLimits limits = {0};
+    TEST_ASSERT(vulkan_memory_allocator_plan_defragmentation(&fixture->allocator, fixture->candidates,
+                    fixture->candidate_count, &limits, &fixture->moves) == MEMORY_CONTEXT_SUCCESS);
+    TEST_ASSERT(fixture->moves.size == 1);
+
+    vulkan_memory_allocator_cancel_defragmentation_move(&fixture->allocator, &fixture->moves.data[0]);
+    vector_empty_noshrink(&fixture->moves);
+    TEST_ASSERT(fixture->allocations[8].block->allocated == 2 * ALLOCATION_SIZE);
+    TEST_ASSERT(fixture->allocations[3].block->allocated == ALLOCATION_SIZE);
+
+    return fixture_destroy(fixture);
+}
+
+int main(int argc, char* args[]) {
+    fixture = mem_alloc(sizeof(DefragmentationFixture));
+    if (fixture == NULL) {
+        return 1;
+    }
+
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_least_used_block_moves_into_fuller_block);
+    failed_count += TEST_RUN(test_block_with_unmovable_allocation_is_skipped);
+    failed_count += TEST_RUN(test_limits_are_respected);
+    failed_count += TEST_RUN(test_cancelled_move_releases_destination);
+
+    mem_free(fixture);
+
+    return failed_count > 0;
+}
@@ -0,0 +1,261 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../src/lib/core/memory/memory.h"
+#include "../../src/lib/core/threads/thread.h"
+#include "../../src/lib/vulkan/core/memory/allocator.h"
+#include "../../src/lib/vulkan/core/memory/backend/fake_memory_backend.h"
+#include "../test.h"
+
+#define THREAD_COUNT 4
+#define ITERATION_COUNT 2000
+#define LIVE_ALLOCATION_COUNT 8
+
+typedef struct ThreadCacheFixture {
+    FakeMemoryBackend fake;
+    VulkanMemoryAllocator allocator;
+} ThreadCacheFixture;
+
+typedef struct LoaderWorker {
+    Thread thread;
+    // Set by the worker after its free and by the test once the garbage is emptied
+    atomic_int step;
+    VulkanAllocation allocation;
+    VulkanAllocation reused;
+} LoaderWorker;
+
+typedef struct StressWorker {
+    Thread thread;
+    uint32_t index;
+    bool is_valid;
+} StressWorker;
+
+// Holds a fake device, too large for the stack
+static ThreadCacheFixture* fixture;
+
+static bool fixture_init(bool concurrent) {
+    fake_memory_backend_clear(&fixture->fake);
+    vulkan_memory_allocator_clear(&fixture->allocator);
+
+    FakeMemoryBackendInfo fake_info = fake_memory_backend_info_get_default();
+    TEST_ASSERT(fake_memory_backend_init(&fixture->fake, &fake_info) == MEMORY_CONTEXT_SUCCESS);
+
+    VulkanMemoryAllocatorInfo allocator_info = vulkan_memory_allocator_info_get_default();
+    allocator_info.device = &fixture->fake.device;
+    allocator_info.backend = &fixture->fake.backend;
+    allocator_info.host_visible_block_size_MB = 1;
+    allocator_info.dedicated_allocation_threshold_MB = 1;
+    allocator_info.concurrent = concurrent;
+    TEST_ASSERT(vulkan_memory_allocator_init(&fixture->allocator, &allocator_info) == MEMORY_CONTEXT_SUCCESS);
+
+    return true;
+}
+
+static bool fixture_destroy(void) {
+    vulkan_memory_allocator_release_thread_cache(&fixture->allocator);
+    vulkan_memory_allocator_empty_garbage(&fixture->allocator, UINT64_MAX);
+    bool is_released = fixture->fake.allocation_count == 0;
+
+    vulkan_memory_allocator_destroy(&fixture->allocator);
+    fake_memory_backend_destroy(&fixture->fake);
+
+    return is_released;
+}
+
+static MemoryContextError fixture_allocate(VkDeviceSize size, VulkanAllocation* allocation) {
+    VulkanMemoryAllocatorRequest request = {
+        .size = size,
+        .align = 256,
+        .memory_type_bits = 1U << 1,
+        .usage = VULKAN_MEMORY_USAGE_CPU_TO_GPU,
+        .allocation_type = VULKAN_ALLOCATION_TYPE_BUFFER,
+        .strategy = VULKAN_MEMORY_STRATEGY_DEFAULT,
+    };
+    return vulkan_memory_allocator_allocate(&fixture->allocator, &request, allocation);
+}
+
+static bool test_completed_garbage_is_reused(void) {
+    TEST_ASSERT(fixture_init(true));
+
+    VulkanAllocation allocation;
+    TEST_ASSERT(fixture_allocate(4096, &allocation) == MEMORY_CONTEXT_SUCCESS);
+    const VulkanMemoryBlock* block = allocation.block;
+    VkDeviceSize offset = allocation.offset;
+
+    vulkan_memory_allocator_begin_frame(&fixture->allocator, 0, 1);
+    TEST_ASSERT(vulkan_memory_allocator_free(&fixture->allocator, allocation));
+    vulkan_memory_allocator_empty_garbage(&fixture->allocator, 1);
+
+    // The cached range keeps its chunk and is handed out again to a request of about the same size, the stats do not
+    // count it as used
+    TEST_ASSERT(block->allocated == 4096);
+    VulkanMemoryStats stats;
+    vulkan_memory_allocator_get_stats(&fixture->allocator, &stats);
+    TEST_ASSERT(stats.memory_types[1].used_bytes == 0 && stats.memory_types[1].allocation_count == 0);
+    TEST_ASSERT(stats.memory_types[1].cached_bytes == 4096 && stats.total.cached_bytes == 4096);
+    TEST_ASSERT(fixture_allocate(3584, &allocation) == MEMORY_CONTEXT_SUCCESS);
+    TEST_ASSERT(allocation.block == block && allocation.offset == offset);
+    vulkan_memory_allocator_free_immediately(&fixture->allocator, &allocation);
+
+    return fixture_destroy();
+}
+
+static int loader_worker_run(void* data) {
+    LoaderWorker* worker = data;
+    if (fixture_allocate(4096, &worker->allocation) != MEMORY_CONTEXT_SUCCESS) {
+        return 1;
+    }
+    vulkan_memory_allocator_free(&fixture->allocator, worker->allocation);
+    atomic_store(&worker->step, 1);
+
+    while (atomic_load(&worker->step) != 2) {
+        thread_pause();
+    }
+    MemoryContextError status = fixture_allocate(4096, &worker->reused);
+    vulkan_memory_allocator_release_thread_cache(&fixture->allocator);
+
+    return status == MEMORY_CONTEXT_SUCCESS ? 0 : 1;
+}
+
+static bool test_garbage_returns_to_freeing_thread(void) {
+    TEST_ASSERT(fixture_init(true));
+
+    LoaderWorker worker = {.step = 0};
+    thread_clear(&worker.thread);
+    TEST_ASSERT(thread_init(&worker.thread, "loader_worker", loader_worker_run, &worker));
+    while (atomic_load(&worker.step) != 1) {
+        thread_pause();
+    }
+
+    // The garbage of the loader is emptied by this thread, the range is kept for the loader and not handed out here
+    vulkan_memory_allocator_empty_garbage(&fixture->allocator, UINT64_MAX);
+    VulkanAllocation allocation;
+    TEST_ASSERT(fixture_allocate(4096, &allocation) == MEMORY_CONTEXT_SUCCESS);
+    TEST_ASSERT(allocation.offset != worker.allocation.offset);
+
+    atomic_store(&worker.step, 2);
+    TEST_ASSERT(thread_join(&worker.thread) == 0);
+    TEST_ASSERT(worker.reused.block == worker.allocation.block && worker.reused.offset == worker.allocation.offset);
+
+    vulkan_memory_allocator_free_immediately(&fixture->allocator, &allocation);
+    vulkan_memory_allocator_free_immediately(&fixture->allocator, &worker.reused);
+
+    return fixture_destroy();
+}
+
+static bool test_idle_cached_ranges_are_released(void) {
+    TEST_ASSERT(fixture_init(true));
+
+    VulkanAllocation allocation;
+    TEST_ASSERT(fixture_allocate(4096, &allocation) == MEMORY_CONTEXT_SUCCESS);
+    vulkan_memory_allocator_begin_frame(&fixture->allocator, 0, 1);
+    TEST_ASSERT(vulkan_memory_allocator_free(&fixture->allocator, allocation));
+    vulkan_memory_allocator_empty_garbage(&fixture->allocator, 1);
+    TEST_ASSERT(fixture->fake.allocation_count == 1);
+
+    // The range freed in frame 1 stays cached for VULKAN_MEMORY_THREAD_CACHE_MAX_AGE frames
+    uint64_t frame_number = 1;
+    while (frame_number < 1 + VULKAN_MEMORY_THREAD_CACHE_MAX_AGE) {
+        frame_number += 1;
+        vulkan_memory_allocator_begin_frame(&fixture->allocator, frame_number % 2, frame_number);
+        vulkan_memory_allocator_empty_garbage(&fixture->allocator, frame_number - 1);
+    }
+    TEST_ASSERT(fixture->fake.allocation_count == 1);
+
+    frame_number += 1;
+    vulkan_memory_allocator_begin_frame(&fixture->allocator, frame_number % 2, frame_number);
+    vulkan_memory_allocator_empty_garbage(&fixture->allocator, frame_number - 1);
+    TEST_ASSERT(fixture->fake.allocation_count == 0);
+
+    return fixture_destroy();
+}
+
+static bool test_uncached_frees_empty_their_blocks(void) {
+    TEST_ASSERT(fixture_init(true));
+
+    VulkanAllocation allocation;
+    TEST_ASSERT(fixture_allocate(4096, &allocation) == MEMORY_CONTEXT_SUCCESS);
+    TEST_ASSERT(vulkan_memory_allocator_free_uncached(&fixture->allocator, allocation));
+    vulkan_memory_allocator_empty_garbage(&fixture->allocator, 0);
+    TEST_ASSERT(fixture->fake.allocation_count == 0);
+
+    // Rollbacks of allocations the device never used skip the cache as well
+    TEST_ASSERT(fixture_allocate(4096, &allocation) == MEMORY_CONTEXT_SUCCESS);
+    vulkan_memory_allocator_free_immediately(&fixture->allocator, &allocation);
+    TEST_ASSERT(fixture->fake.allocation_count == 0);
+
+    return fixture_destroy();
+}
+
+// Every live range is stamped with its owner, a range handed out twice is overwritten by the other thread
+static int stress_worker_run(void* data) {
+    StressWorker* worker = data;
+    VulkanAllocation allocations[LIVE_ALLOCATION_COUNT];
+    uint64_t stamps[LIVE_ALLOCATION_COUNT];
+    uint32_t seed = worker->index + 1;
+    worker->is_valid = true;
+
+    for (uint32_t i = 0; i < ITERATION_COUNT && worker->is_valid; ++i) {
+        for (uint32_t j = 0; j < LIVE_ALLOCATION_COUNT; ++j) {
+            seed = seed * 1664525U + 1013904223U;
+            VkDeviceSize size = 256 << (seed >> 28 & 7);
+            if (fixture_allocate(size, &allocations[j]) != MEMORY_CONTEXT_SUCCESS) {
+                worker->is_valid = false;
+                return 1;
+            }
+            stamps[j] = (uint64_t)worker->index << 32 | (i * LIVE_ALLOCATION_COUNT + j);
+            mem_copy(&stamps[j], allocations[j].data, sizeof(uint64_t));
+        }
+
+        for (uint32_t j = 0; j < LIVE_ALLOCATION_COUNT; ++j) {
+            uint64_t stamp;
+            mem_copy(allocations[j].data, &stamp, sizeof(uint64_t));
+            worker->is_valid = worker->is_valid && stamp == stamps[j];
+            if (j % 2 == 0) {
+                vulkan_memory_allocator_free(&fixture->allocator, allocations[j]);
+            } else {
+                vulkan_memory_allocator_free_immediately(&fixture->allocator, &allocations[j]);
+            }
+        }
+        vulkan_memory_allocator_empty_garbage(&fixture->allocator, UINT64_MAX);
+    }
+    vulkan_memory_allocator_release_thread_cache(&fixture->allocator);
+
+    return 0;
+}
+
+static bool test_threads_do_not_share_ranges(void) {
+    TEST_ASSERT(fixture_init(true));
+
+    StressWorker workers[THREAD_COUNT];
+    for (uint32_t i = 0; i < THREAD_COUNT; ++i) {
+        workers[i] = (StressWorker){.index = i, .is_valid = false};
+        thread_clear(&workers[i].thread);
+        TEST_ASSERT(thread_init(&workers[i].thread, "stress_worker", stress_worker_run, &workers[i]));
+    }
+    for (uint32_t i = 0; i < THREAD_COUNT; ++i) {
+        TEST_ASSERT(thread_join(&workers[i].thread) == 0);
+        TEST_ASSERT(workers[i].is_valid);
+    }
+
+    return fixture_destroy();
+}
+
+int main(int argc, char* args[]) {
+    fixture = mem_alloc(sizeof(ThreadCacheFixture));
+    if (fixture == NULL) {
+        return 1;
+    }
+
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_completed_garbage_is_reused);
+    failed_count += TEST_RUN(test_garbage_returns_to_freeing_thread);
+    failed_count += TEST_RUN(test_idle_cached_ranges_are_released);
+    failed_count += TEST_RUN(test_uncached_frees_empty_their_blocks);
+    failed_count += TEST_RUN(test_threads_do_not_share_ranges);
+
+    mem_free(fixture);
+
+    return failed_count > 0;
+}
@@ -0,0 +1,219 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../src/lib/vulkan/core/command/command_allocator.h"
+#include "../../src/lib/vulkan/core/command/command_pool.h"
+#include "../../src/lib/vulkan/core/functions.h"
+#include "../test.h"
+
+#define MAX_RESETS 16
+#define THREAD_COUNT 3
+#define FRAME_COUNT 2
+
+// Pools and buffers are numbered from 1 in creation order, the device functions the command pools call are replaced
+static uintptr_t next_pool_handle;
+static uintptr_t next_buffer_handle;
+static uint32_t allocate_call_count;
+static uint32_t last_allocate_count;
+static VkCommandBufferLevel last_allocate_level;
+static VkCommandPool reset_pools[MAX_RESETS];
+static uint32_t reset_count;
+
+static VkResult VKAPI_CALL fake_create_command_pool(VkDevice device, const VkCommandPoolCreateInfo* create_info,
+    const VkAllocationCallbacks* allocator, VkCommandPool* pool) {
+    *pool = (VkCommandPool)++next_pool_handle;
+    return VK_SUCCESS;
+}
+
+static void VKAPI_CALL fake_destroy_command_pool(
+    VkDevice device, VkCommandPool pool, const VkAllocationCallbacks* allocator) {}
+
+static VkResult VKAPI_CALL fake_allocate_command_buffers(
+    VkDevice device, const VkCommandBufferAllocateInfo* info, VkCommandBuffer* buffers) {
+    for (uint32_t i = 0; i < info->commandBufferCount; ++i) {
+        buffers[i] = (VkCommandBuffer)++next_buffer_handle;
+    }
+    allocate_call_count += 1;
+    last_allocate_count = info->commandBufferCount;
+    last_allocate_level = info->level;
+    return VK_SUCCESS;
+}
+
+static void VKAPI_CALL fake_free_command_buffers(
+    VkDevice device, VkCommandPool pool, uint32_t count, const VkCommandBuffer* buffers) {}
+
+static VkResult VKAPI_CALL fake_reset_command_pool(VkDevice device, VkCommandPool pool, VkCommandPoolResetFlags flags) {
+    if (reset_count < MAX_RESETS) {
+        reset_pools[reset_count] = pool;
+    }
+    reset_count += 1;
+    return VK_SUCCESS;
+}
+
+static Context context;
+
+static void fixture_init(void) {
+    vkCreateCommandPool = fake_create_command_pool;
+    vkDestroyCommandPool = fake_destroy_command_pool;
+    vkAllocateCommandBuffers = fake_allocate_command_buffers;
+    vkFreeCommandBuffers = fake_free_command_buffers;
+    vkResetCommandPool = fake_reset_command_pool;
+    next_pool_handle = 0;
+    next_buffer_handle = 0;
+    allocate_call_count = 0;
+    last_allocate_count = 0;
+    reset_count = 0;
+
+    context.device.handle = (VkDevice)(uintptr_t)1;
+}
+
+static bool fixture_init_pool(CommandPool* pool, uint32_t primary_buffer_count, bool reset_enabled) {
+    CommandPoolInitInfo info = {
+        .name = "",
+        .primary_buffer_count = primary_buffer_count,
+        .secondary_buffer_count = 0,
+        .queue_family_index = 0,
+        .transient = true,
+        .reset_enabled = reset_enabled,
+        .protected = false,
+    };
+    TEST_ASSERT(command_pool_init(pool, &context, &info));
+    return true;
+}
+
+// Preallocated buffers are handed out first, every acquire past them allocates one chunk of the buffer's level
+static bool test_acquire_grows_by_chunk(void) {
+    fixture_init();
+    CommandPool pool;
+    TEST_ASSERT(fixture_init_pool(&pool, 3, false));
+    TEST_ASSERT(allocate_call_count == 1 && pool.primary_buffers.handles.size == 3);
+
+    for (uintptr_t i = 1; i <= 3 + COMMAND_POOL_BUFFER_CHUNK_SIZE + 1; ++i) {
+        TEST_ASSERT(command_pool_acquire_primary_buffer(&pool) == (VkCommandBuffer)i);
+        TEST_ASSERT(pool.primary_buffers.used_count == i);
+        if (i == 4) {
+            TEST_ASSERT(allocate_call_count == 2 && last_allocate_count == COMMAND_POOL_BUFFER_CHUNK_SIZE);
+            TEST_ASSERT(last_allocate_level == VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        }
+    }
+    TEST_ASSERT(allocate_call_count == 3);
+    TEST_ASSERT(pool.primary_buffers.handles.size == 3 + 2 * COMMAND_POOL_BUFFER_CHUNK_SIZE);
+
+    TEST_ASSERT(command_pool_acquire_secondary_buffer(&pool) != VK_NULL_HANDLE);
+    TEST_ASSERT(allocate_call_count == 4 && last_allocate_level == VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    TEST_ASSERT(pool.secondary_buffers.handles.size == COMMAND_POOL_BUFFER_CHUNK_SIZE);
+    TEST_ASSERT(pool.secondary_buffers.used_count == 1);
+
+    command_pool_destroy(&pool);
+    return true;
+}
+
+// The released buffer swaps places with the last used one and is the next one handed out
+static bool test_release_swaps_with_last(void) {
+    fixture_init();
+    CommandPool pool;
+    TEST_ASSERT(fixture_init_pool(&pool, 0, true));
+
+    VkCommandBuffer buffers[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        buffers[i] = command_pool_acquire_primary_buffer(&pool);
+    }
+
+    TEST_ASSERT(command_pool_release_buffer(&pool, buffers[1], false));
+    TEST_ASSERT(pool.primary_buffers.used_count == 3);
+    TEST_ASSERT(command_pool_get_primary_buffer(&pool, 1) == buffers[3]);
+    TEST_ASSERT(command_pool_get_primary_buffer(&pool, 3) == buffers[1]);
+    TEST_ASSERT(!command_pool_release_buffer(&pool, buffers[1], false));
+    TEST_ASSERT(!command_pool_release_buffer(&pool, buffers[0], true));
+
+    TEST_ASSERT(command_pool_release_buffer(&pool, buffers[3], false));
+    TEST_ASSERT(command_pool_get_primary_buffer(&pool, 1) == buffers[2]);
+    TEST_ASSERT(command_pool_acquire_primary_buffer(&pool) == buffers[3]);
+    TEST_ASSERT(command_pool_acquire_primary_buffer(&pool) == buffers[1]);
+    TEST_ASSERT(allocate_call_count == 1);
+
+    CommandPool frame_pool;
+    TEST_ASSERT(fixture_init_pool(&frame_pool, 0, false));
+    VkCommandBuffer buffer = command_pool_acquire_primary_buffer(&frame_pool);
+    TEST_ASSERT(!command_pool_release_buffer(&frame_pool, buffer, false));
+    TEST_ASSERT(frame_pool.primary_buffers.used_count == 1);
+
+    command_pool_destroy(&frame_pool);
+    command_pool_destroy(&pool);
+    return true;
+}
+
+static bool test_reset_returns_every_buffer(void) {
+    fixture_init();
+    CommandPool pool;
+    TEST_ASSERT(fixture_init_pool(&pool, 0, false));
+
+    const uint32_t primary_count = COMMAND_POOL_BUFFER_CHUNK_SIZE + 2;
+    for (uint32_t i = 0; i < primary_count; ++i) {
+        TEST_ASSERT(command_pool_acquire_primary_buffer(&pool) != VK_NULL_HANDLE);
+    }
+    TEST_ASSERT(command_pool_acquire_secondary_buffer(&pool) != VK_NULL_HANDLE);
+    const uint32_t allocated_count = allocate_call_count;
+
+    TEST_ASSERT(command_pool_reset(&pool, false));
+    TEST_ASSERT(reset_count == 1 && reset_pools[0] == pool.handle);
+    TEST_ASSERT(!command_pool_has_used_buffers(&pool));
+    TEST_ASSERT(pool.primary_buffers.handles.size == 2 * COMMAND_POOL_BUFFER_CHUNK_SIZE);
+
+    // The buffers come back in the same order without allocating again
+    for (uintptr_t i = 1; i <= primary_count; ++i) {
+        TEST_ASSERT(command_pool_acquire_primary_buffer(&pool) == (VkCommandBuffer)i);
+    }
+    TEST_ASSERT(command_pool_acquire_secondary_buffer(&pool) != VK_NULL_HANDLE);
+    TEST_ASSERT(allocate_call_count == allocated_count);
+
+    command_pool_destroy(&pool);
+    return true;
+}
+
+// Only pools of the frame that handed out buffers are reset when the frame comes around again
+static bool test_begin_frame_skips_idle_pools(void) {
+    fixture_init();
+    static CommandAllocator allocator;
+    CommandAllocatorInitInfo info = {
+        .thread_count = THREAD_COUNT,
+        .frame_count = FRAME_COUNT,
+        .queue_family_index = 0,
+        .primary_buffer_count = 0,
+        .secondary_buffer_count = 0,
+    };
+    TEST_ASSERT(command_allocator_init(&allocator, &context, &info));
+    TEST_ASSERT(next_pool_handle == THREAD_COUNT * FRAME_COUNT && allocate_call_count == 0);
+
+    TEST_ASSERT(command_allocator_begin_frame(&allocator, 0));
+    TEST_ASSERT(reset_count == 0);
+    VkCommandBuffer buffer = command_allocator_get_primary_buffer(&allocator, 1);
+    TEST_ASSERT(buffer != VK_NULL_HANDLE);
+    TEST_ASSERT(command_allocator_get_primary_buffer(&allocator, THREAD_COUNT) == VK_NULL_HANDLE);
+
+    TEST_ASSERT(command_allocator_begin_frame(&allocator, 1));
+    TEST_ASSERT(reset_count == 0);
+    TEST_ASSERT(command_allocator_get_secondary_buffer(&allocator, 2) != VK_NULL_HANDLE);
+
+    TEST_ASSERT(command_allocator_begin_frame(&allocator, 0));
+    TEST_ASSERT(reset_count == 1 && reset_pools[0] == allocator.pools[0][1].handle);
+    TEST_ASSERT(command_allocator_get_primary_buffer(&allocator, 1) == buffer);
+
+    TEST_ASSERT(command_allocator_begin_frame(&allocator, 1));
+    TEST_ASSERT(reset_count == 2 && reset_pools[1] == allocator.pools[1][2].handle);
+    TEST_ASSERT(!command_allocator_begin_frame(&allocator, FRAME_COUNT));
+
+    command_allocator_destroy(&allocator);
+    TEST_ASSERT(!command_allocator_is_init(&allocator));
+    return true;
+}
+
+int main(int argc, char* args[]) {
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_acquire_grows_by_chunk);
+    failed_count += TEST_RUN(test_release_swaps_with_last);
+    failed_count += TEST_RUN(test_reset_returns_every_buffer);
+    failed_count += TEST_RUN(test_begin_frame_skips_idle_pools);
+
+    return failed_count > 0;
+}
@@ -0,0 +1,148 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../src/lib/core/time/clock.h"
+#include "../../src/lib/core/utils/macro.h"
+#include "../../src/lib/vulkan/core/rendering/frame_latency_controller.h"
+#include "../test.h"
+
+#define CPU_TIME_NS TIME_MS_TO_NS(2)
+#define GPU_TIME_NS TIME_MS_TO_NS(10)
+#define SAFETY_MARGIN_NS TIME_MS_TO_NS(1)
+
+static SimulatedClock simulated_clock;
+static FrameLatencyController controller;
+
+// Start times of zero mean an untracked frame, the clock starts later than that
+static void fixture_init(bool just_in_time_wait_enabled) {
+    simulated_clock.time_ns = TIME_MS_TO_NS(1);
+    Clock clock = clock_get_simulated(&simulated_clock);
+    FrameLatencyConfig config = {
+        .just_in_time_wait_enabled = just_in_time_wait_enabled,
+        .safety_margin_ns = SAFETY_MARGIN_NS,
+    };
+    frame_latency_controller_init(&controller, &config, &clock);
+}
+
+static void fixture_record_frame(uint64_t frame_number) {
+    frame_latency_controller_begin_frame(&controller, frame_number);
+    simulated_clock_advance(&simulated_clock, CPU_TIME_NS);
+    frame_latency_controller_submit_frame(&controller, frame_number);
+}
+
+// Frame 1 completes at 13 ms, frame 2 is submitted at 15 ms and completes at 25 ms
+static void fixture_record_two_frames(void) {
+    fixture_record_frame(1);
+    simulated_clock_advance(&simulated_clock, GPU_TIME_NS);
+    frame_latency_controller_complete_frames(&controller, 1);
+
+    fixture_record_frame(2);
+    simulated_clock_advance(&simulated_clock, GPU_TIME_NS);
+    frame_latency_controller_complete_frames(&controller, 2);
+}
+
+static bool test_completed_frames_update_stats(void) {
+    fixture_init(true);
+    fixture_record_two_frames();
+
+    // The first completion has no earlier one to measure the GPU time from
+    const FrameLatencyStats* stats = &controller.stats;
+    TEST_ASSERT(stats->cpu_time_ns == CPU_TIME_NS);
+    TEST_ASSERT(stats->gpu_time_ns == GPU_TIME_NS);
+    TEST_ASSERT(stats->last_cpu_to_present_ns == CPU_TIME_NS + GPU_TIME_NS);
+    TEST_ASSERT(stats->cpu_to_present_ns == CPU_TIME_NS + GPU_TIME_NS);
+    TEST_ASSERT(controller.completed_frame_number == 2);
+    TEST_ASSERT(controller.last_completion_time == TIME_MS_TO_NS(25));
+
+    // Completions that do not move forward are ignored
+    simulated_clock_advance(&simulated_clock, GPU_TIME_NS);
+    frame_latency_controller_complete_frames(&controller, 2);
+    frame_latency_controller_complete_frames(&controller, 1);
+    TEST_ASSERT(controller.completed_frame_number == 2);
+    TEST_ASSERT(controller.last_completion_time == TIME_MS_TO_NS(25));
+    TEST_ASSERT(stats->gpu_time_ns == GPU_TIME_NS);
+
+    return true;
+}
+
+static bool test_frames_completed_together_share_gpu_time(void) {
+    fixture_init(true);
+    fixture_record_two_frames();
+    fixture_record_frame(3);
+    fixture_record_frame(4);
+
+    // The GPU was busy from the submit of frame 3 at 27 ms, two frames of 10 ms end at 47 ms. Frame 4 was held back
+    // until 34 ms
+    simulated_clock.time_ns = TIME_MS_TO_NS(47);
+    frame_latency_controller_complete_frames(&controller, 4);
+    TEST_ASSERT(controller.stats.gpu_time_ns == GPU_TIME_NS);
+    TEST_ASSERT(controller.stats.last_cpu_to_present_ns == TIME_MS_TO_NS(47 - 34));
+
+    return true;
+}
+
+static bool test_wait_time_targets_gpu_drain(void) {
+    fixture_init(true);
+    fixture_record_two_frames();
+    TEST_ASSERT(frame_latency_controller_get_wait_time(&controller, simulated_clock.time_ns, 3) == 0);
+    fixture_record_frame(3);
+
+    // Frame 3 was submitted at 27 ms and drains at 37 ms, frame 4 takes 2 ms of CPU work and keeps a 1 ms margin
+    const uint64_t now = simulated_clock.time_ns;
+    TEST_ASSERT(now == TIME_MS_TO_NS(27));
+    TEST_ASSERT(frame_latency_controller_get_wait_time(&controller, now, 4) == TIME_MS_TO_NS(7));
+    TEST_ASSERT(frame_latency_controller_get_wait_time(&controller, now + TIME_MS_TO_NS(7), 4) == 0);
+    TEST_ASSERT(frame_latency_controller_get_wait_time(&controller, now + TIME_MS_TO_NS(20), 4) == 0);
+
+    // Every queued frame adds its GPU time, frame 4 is held back until 34 ms, submitted at 36 ms and drains at 47 ms
+    fixture_record_frame(4);
+    TEST_ASSERT(simulated_clock.time_ns == TIME_MS_TO_NS(36));
+    TEST_ASSERT(frame_latency_controller_get_wait_time(&controller, simulated_clock.time_ns, 5) == TIME_MS_TO_NS(8));
+
+    // Frame numbers past the tracked frames have no submit times to predict from
+    TEST_ASSERT(frame_latency_controller_get_wait_time(
+                    &controller, simulated_clock.time_ns, 3 + FRAME_LATENCY_MAX_TRACKED_FRAMES) == 0);
+
+    return true;
+}
+
+static bool test_begin_frame_sleeps_on_clock(void) {
+    fixture_init(true);
+    fixture_record_two_frames();
+    fixture_record_frame(3);
+
+    frame_latency_controller_begin_frame(&controller, 4);
+    TEST_ASSERT(controller.stats.last_wait_ns == TIME_MS_TO_NS(7));
+    TEST_ASSERT(simulated_clock.time_ns == TIME_MS_TO_NS(34));
+
+    // The CPU work measured for the frame starts after the wait
+    simulated_clock_advance(&simulated_clock, CPU_TIME_NS);
+    frame_latency_controller_submit_frame(&controller, 4);
+    TEST_ASSERT(controller.stats.cpu_time_ns == CPU_TIME_NS);
+
+    return true;
+}
+
+static bool test_disabled_wait_is_zero(void) {
+    fixture_init(false);
+    fixture_record_two_frames();
+    fixture_record_frame(3);
+
+    TEST_ASSERT(frame_latency_controller_get_wait_time(&controller, simulated_clock.time_ns, 4) == 0);
+    frame_latency_controller_begin_frame(&controller, 4);
+    TEST_ASSERT(controller.stats.last_wait_ns == 0);
+    TEST_ASSERT(simulated_clock.time_ns == TIME_MS_TO_NS(27));
+
+    return true;
+}
+
+int main(int argc, char* args[]) {
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_completed_frames_update_stats);
+    failed_count += TEST_RUN(test_frames_completed_together_share_gpu_time);
+    failed_count += TEST_RUN(test_wait_time_targets_gpu_drain);
+    failed_count += TEST_RUN(test_begin_frame_sleeps_on_clock);
+    failed_count += TEST_RUN(test_disabled_wait_is_zero);
+
+    return failed_count > 0;
+}
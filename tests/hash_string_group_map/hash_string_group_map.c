@@ -0,0 +1,102 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../../src/lib/core/collections/hash_string_group_map.h"
+#include "../../src/lib/core/collections/hash_string_group_match.h"
+#include "../test.h"
+
+#define GROUP_COUNT 4096
+#define KEY_COUNT 2048
+#define OPERATION_COUNT 50000
+
+typedef struct GroupMapFixture HASH_STRING_GROUP_MAP(uint32_t) GroupMapFixture;
+
+static inline uint32_t test_random(uint32_t* seed) {
+    *seed = *seed * 1664525U + 1013904223U;
+    return *seed >> 8;
+}
+
+// Control bytes as the map writes them, free slots are rarer than tags
+static void fill_group(uint8_t* ctrl, uint32_t* seed) {
+    for (size_t i = 0; i < HASH_STRING_GROUP_SIZE; ++i) {
+        uint32_t roll = test_random(seed) % 8;
+        if (roll == 0) {
+            ctrl[i] = HASH_STRING_GROUP_CTRL_EMPTY;
+        } else if (roll == 1) {
+            ctrl[i] = HASH_STRING_GROUP_CTRL_DELETED;
+        } else {
+            ctrl[i] = (uint8_t)(test_random(seed) % 8);
+        }
+    }
+}
+
+// Collects the slots of a mask of the target's stride into one bit per slot
+static HashStringGroupMask get_slot_bits(HashStringGroupMask mask) {
+    HashStringGroupMask bits = 0;
+    for (; mask != 0; mask = hash_string_group_mask_next(mask)) {
+        bits |= (HashStringGroupMask)1 << hash_string_group_mask_first(mask);
+    }
+    return bits;
+}
+
+// Holds on every target, with SSE2 or NEON it compares the vector matches against the scalar ones
+static bool test_group_match_equals_scalar(void) {
+    uint8_t ctrl[HASH_STRING_GROUP_SIZE];
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < GROUP_COUNT; ++i) {
+        fill_group(ctrl, &seed);
+        TEST_ASSERT(get_slot_bits(hash_string_group_match_free(ctrl)) == hash_string_group_match_free_scalar(ctrl));
+        TEST_ASSERT(get_slot_bits(hash_string_group_match(ctrl, HASH_STRING_GROUP_CTRL_EMPTY)) ==
+                    hash_string_group_match_scalar(ctrl, HASH_STRING_GROUP_CTRL_EMPTY));
+        for (uint8_t tag = 0; tag < 8; ++tag) {
+            TEST_ASSERT(get_slot_bits(hash_string_group_match(ctrl, tag)) == hash_string_group_match_scalar(ctrl, tag));
+        }
+    }
+
+    return true;
+}
+
+// Random adds and deletes checked against a plain array, deletes leave both empty slots and tombstones behind
+static bool test_map_agrees_with_reference(void) {
+    static char keys[KEY_COUNT][HASH_KEY_MAX_SIZE];
+    static uint32_t reference[KEY_COUNT];
+    for (uint32_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(keys[i], HASH_KEY_MAX_SIZE, "group/key_%u", i);
+        reference[i] = 0;
+    }
+
+    GroupMapFixture map;
+    hash_string_group_map_init(&map);
+    size_t size = 0;
+    uint32_t seed = 1;
+    for (uint32_t i = 1; i <= OPERATION_COUNT; ++i) {
+        uint32_t key = test_random(&seed) % KEY_COUNT;
+        if (test_random(&seed) % 3 == 0) {
+            TEST_ASSERT(hash_string_group_map_delete(&map, keys[key]) == (reference[key] != 0));
+            size -= reference[key] != 0 ? 1 : 0;
+            reference[key] = 0;
+        } else {
+            TEST_ASSERT(hash_string_group_map_add(&map, keys[key], i));
+            size += reference[key] == 0 ? 1 : 0;
+            reference[key] = i;
+        }
+
+        uint32_t probe = test_random(&seed) % KEY_COUNT;
+        uint32_t value = 0;
+        bool is_found = hash_string_group_map_get(&map, keys[probe], &value);
+        TEST_ASSERT(is_found == (reference[probe] != 0) && (!is_found || value == reference[probe]));
+        TEST_ASSERT(hash_string_group_map_get_size(&map) == size);
+    }
+
+    hash_string_group_map_destroy(&map);
+    return true;
+}
+
+int main(int argc, char* args[]) {
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_group_match_equals_scalar);
+    failed_count += TEST_RUN(test_map_agrees_with_reference);
+
+    return failed_count > 0;
+}
@@ -0,0 +1,233 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../../src/lib/core/collections/hash_string_map.h"
+#include "../test.h"
+
+#define KEY_COUNT 1024
+
+typedef struct TestMap HASH_STRING_MAP(uint32_t) TestMap;
+
+static char keys[KEY_COUNT][HASH_KEY_MAX_SIZE];
+// Value stored for every key, 0 for keys not in the map
+static uint32_t expected[KEY_COUNT];
+
+static void fixture_init(TestMap* map) {
+    for (uint32_t i = 0; i < KEY_COUNT; ++i) {
+        snprintf(keys[i], HASH_KEY_MAX_SIZE, "map/key_%u", i);
+        expected[i] = 0;
+    }
+    hash_string_map_init(map);
+}
+
+static bool fixture_add(TestMap* map, uint32_t key) {
+    expected[key] = key + 1;
+    return hash_string_map_add(map, keys[key], key + 1);
+}
+
+static bool fixture_delete(TestMap* map, uint32_t key) {
+    expected[key] = 0;
+    return hash_string_map_delete(map, keys[key]);
+}
+
+static bool fixture_is_migrating(const TestMap* map) { return map->table.old_slots.cap != 0; }
+
+// Every key is found with its value or missing, and the tombstone count matches the deleted slots of the table
+static bool fixture_check(const TestMap* map) {
+    size_t size = 0;
+    for (uint32_t i = 0; i < KEY_COUNT; ++i) {
+        uint32_t value = 0;
+        bool is_found = hash_string_map_get(map, keys[i], &value);
+        TEST_ASSERT(is_found == (expected[i] != 0) && value == expected[i]);
+        size += is_found ? 1 : 0;
+    }
+    TEST_ASSERT(hash_string_map_get_size(map) == size);
+
+    size_t tombstones = 0;
+    for (size_t i = 0; i < map->table.slots.cap; ++i) {
+        tombstones += map->table.slots.hashes[i] == HASH_STRING_MAP_SLOT_DELETED ? 1 : 0;
+    }
+    TEST_ASSERT(map->table.tombstones == tombstones);
+
+    return true;
+}
+
+// Adds keys until an insert starts a migration to a grown table
+static bool fixture_add_until_migrating(TestMap* map, uint32_t* next_key) {
+    while (!fixture_is_migrating(map)) {
+        TEST_ASSERT(*next_key < KEY_COUNT && fixture_add(map, (*next_key)++));
+    }
+    return true;
+}
+
+// Deletes land in both tables while entries move over, moved entries may reuse slots of deleted ones
+static bool test_grow_with_finds_and_deletes(void) {
+    TestMap map;
+    fixture_init(&map);
+
+    uint32_t grow_count = 0;
+    uint32_t migrating_delete_count = 0;
+    size_t capacity = 0;
+    for (uint32_t i = 0; i < KEY_COUNT; ++i) {
+        TEST_ASSERT(fixture_add(&map, i));
+        if (hash_string_map_get_capacity(&map) != capacity) {
+            capacity = hash_string_map_get_capacity(&map);
+            grow_count += 1;
+        }
+        if (i % 3 == 2) {
+            migrating_delete_count += fixture_is_migrating(&map) ? 1 : 0;
+            TEST_ASSERT(fixture_delete(&map, i - 1 - i % 7 % 2));
+            TEST_ASSERT(!fixture_delete(&map, i - 1 - i % 7 % 2));
+        }
+        TEST_ASSERT(fixture_check(&map));
+    }
+    TEST_ASSERT(grow_count >= 5 && migrating_delete_count > 0);
+
+    hash_string_map_destroy(&map);
+    return true;
+}
+
+// Slots past slots.cap refer to the old table, the range walk covers both tables in chunks
+static bool test_iterate_while_migrating(void) {
+    TestMap map;
+    fixture_init(&map);
+    uint32_t next_key = 0;
+    TEST_ASSERT(fixture_add_until_migrating(&map, &next_key));
+
+    bool has_old_slot = false;
+    for (uint32_t i = 0; i < next_key; ++i) {
+        ssize_t slot = hash_string_map_table_find(&map.table, keys[i]);
+        TEST_ASSERT(slot != -1);
+        has_old_slot = has_old_slot || (size_t)slot >= map.table.slots.cap;
+        const uint32_t* value = hash_string_map_table_value(&map.table, sizeof(uint32_t), (size_t)slot);
+        TEST_ASSERT(*value == i + 1);
+    }
+    TEST_ASSERT(has_old_slot);
+
+    uint32_t seen[KEY_COUNT] = {0};
+    char chunk_keys[5][HASH_KEY_MAX_SIZE];
+    uint32_t chunk_values[5];
+    size_t walked = 0;
+    for (size_t start = 0; start < hash_string_map_get_size(&map); start += 5) {
+        size_t key_count = hash_string_map_keys_range(&map, chunk_keys, start, 5);
+        size_t value_count = hash_string_map_values_range(&map, chunk_values, start, 5);
+        TEST_ASSERT(key_count == value_count && key_count > 0);
+        for (size_t i = 0; i < key_count; ++i) {
+            uint32_t key;
+            TEST_ASSERT(sscanf(chunk_keys[i], "map/key_%u", &key) == 1 && key < next_key);
+            TEST_ASSERT(chunk_values[i] == key + 1);
+            seen[key] += 1;
+        }
+        walked += key_count;
+    }
+    TEST_ASSERT(fixture_is_migrating(&map));
+    TEST_ASSERT(walked == next_key);
+    for (uint32_t i = 0; i < next_key; ++i) {
+        TEST_ASSERT(seen[i] == 1);
+    }
+
+    hash_string_map_destroy(&map);
+    return true;
+}
+
+// Deletes do not migrate, the old table is freed by the delete of its last entry
+static bool test_delete_frees_old_slots(void) {
+    TestMap map;
+    fixture_init(&map);
+    uint32_t next_key = 0;
+    TEST_ASSERT(fixture_add_until_migrating(&map, &next_key));
+
+    uint32_t old_count = 0;
+    for (uint32_t i = 0; i < next_key; ++i) {
+        ssize_t slot = hash_string_map_table_find(&map.table, keys[i]);
+        if ((size_t)slot < map.table.slots.cap) {
+            continue;
+        }
+        old_count += 1;
+        TEST_ASSERT(fixture_is_migrating(&map));
+        TEST_ASSERT(fixture_delete(&map, i));
+    }
+    TEST_ASSERT(old_count > 0);
+    TEST_ASSERT(!fixture_is_migrating(&map) && map.table.old_size == 0 && map.table.migrate_index == 0);
+    TEST_ASSERT(fixture_check(&map));
+
+    TEST_ASSERT(fixture_add(&map, next_key));
+    TEST_ASSERT(fixture_check(&map));
+
+    hash_string_map_destroy(&map);
+    return true;
+}
+
+// Few live entries and many tombstones rebuild a table of the same capacity instead of growing
+static bool test_tombstones_rebuild_same_capacity(void) {
+    TestMap map;
+    fixture_init(&map);
+    for (uint32_t i = 0; i < 4; ++i) {
+        TEST_ASSERT(fixture_add(&map, i));
+    }
+    const size_t capacity = hash_string_map_get_capacity(&map);
+    TEST_ASSERT(capacity == HASH_STRING_MAP_MIN_CAPACITY);
+
+    bool has_rebuilt = false;
+    for (uint32_t i = 4; i < 200; ++i) {
+        TEST_ASSERT(fixture_delete(&map, i - 4));
+        TEST_ASSERT(fixture_add(&map, i));
+        has_rebuilt = has_rebuilt || fixture_is_migrating(&map);
+        TEST_ASSERT(hash_string_map_get_capacity(&map) == capacity);
+        TEST_ASSERT(map.table.tombstones < capacity);
+        TEST_ASSERT(fixture_check(&map));
+    }
+    TEST_ASSERT(has_rebuilt);
+
+    hash_string_map_destroy(&map);
+    return true;
+}
+
+static bool test_reserve_and_clear_values(void) {
+    TestMap map;
+    fixture_init(&map);
+
+    // Reserved room takes the entries without growing
+    TEST_ASSERT(hash_string_map_reserve(&map, 100));
+    const size_t capacity = hash_string_map_get_capacity(&map);
+    for (uint32_t i = 0; i < 100; ++i) {
+        TEST_ASSERT(fixture_add(&map, i));
+    }
+    TEST_ASSERT(hash_string_map_get_capacity(&map) == capacity && !fixture_is_migrating(&map));
+
+    // Reserving during a migration moves every entry right away
+    uint32_t next_key = 100;
+    TEST_ASSERT(fixture_add_until_migrating(&map, &next_key));
+    const size_t grown_capacity = hash_string_map_get_capacity(&map);
+    TEST_ASSERT(hash_string_map_reserve(&map, next_key * 2));
+    TEST_ASSERT(!fixture_is_migrating(&map) && hash_string_map_get_capacity(&map) > grown_capacity);
+    TEST_ASSERT(fixture_check(&map));
+
+    // Clearing during a migration drops both tables' entries and keeps the capacity
+    TEST_ASSERT(fixture_add_until_migrating(&map, &next_key));
+    const size_t migrating_capacity = hash_string_map_get_capacity(&map);
+    hash_string_map_clear_values(&map);
+    for (uint32_t i = 0; i < KEY_COUNT; ++i) {
+        expected[i] = 0;
+    }
+    TEST_ASSERT(!fixture_is_migrating(&map) && hash_string_map_get_capacity(&map) == migrating_capacity);
+    TEST_ASSERT(fixture_check(&map));
+
+    TEST_ASSERT(fixture_add(&map, 7));
+    TEST_ASSERT(fixture_check(&map));
+
+    hash_string_map_destroy(&map);
+    return true;
+}
+
+int main(int argc, char* args[]) {
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_grow_with_finds_and_deletes);
+    failed_count += TEST_RUN(test_iterate_while_migrating);
+    failed_count += TEST_RUN(test_delete_frees_old_slots);
+    failed_count += TEST_RUN(test_tombstones_rebuild_same_capacity);
+    failed_count += TEST_RUN(test_reserve_and_clear_values);
+
+    return failed_count > 0;
+}
@@ -0,0 +1,237 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../src/lib/core/jobs/job_deque.h"
+#include "../../src/lib/core/jobs/job_system.h"
+#include "../../src/lib/core/memory/memory.h"
+#include "../../src/lib/core/threads/thread.h"
+#include "../../src/lib/core/time/clock.h"
+#include "../../src/lib/core/utils/macro.h"
+#include "../test.h"
+
+#define WORKER_COUNT 4
+#define PARALLEL_FOR_COUNT 100003
+#define PARALLEL_FOR_BATCH_SIZE 1000
+#define PARENT_JOB_COUNT 8
+#define CHILD_JOB_COUNT 64
+// More jobs than the pool and the deque of a worker hold
+#define OVERFLOW_JOB_COUNT (JOB_DEQUE_CAPACITY * 2)
+#define SLEEP_TIMEOUT_MS 5000
+#define INIT_DESTROY_ROUNDS 4
+
+typedef struct ParallelForFixture {
+    _Atomic(uint32_t) visits[PARALLEL_FOR_COUNT];
+    _Atomic(uint64_t) sum;
+} ParallelForFixture;
+
+typedef struct ParentJob {
+    JobSystem* system;
+    _Atomic(uint64_t) child_sum;
+    uint64_t sum_after_wait;
+    bool is_valid;
+} ParentJob;
+
+typedef struct OverflowFixture {
+    _Atomic(bool) is_gate_open;
+    _Atomic(uint32_t) run_count;
+    _Atomic(uint32_t) inline_count;
+    JobSystem* system;
+} OverflowFixture;
+
+static ParallelForFixture* parallel_for_fixture;
+
+static bool init_system(JobSystem* system, uint32_t worker_count) {
+    JobSystemConfig config = job_system_config_default();
+    config.worker_count = worker_count;
+    TEST_ASSERT(job_system_init(system, &config));
+    TEST_ASSERT(system->worker_count == worker_count && job_system_get_worker_index(system) == 0);
+    return true;
+}
+
+// Waits until every worker but the calling one is asleep on the wake semaphore
+static bool wait_for_sleeping_workers(JobSystem* system) {
+    const Clock clock = clock_get_system();
+    const uint64_t start_ns = clock_now(&clock);
+    while (atomic_load(&system->sleeping_count) != system->worker_count - 1) {
+        TEST_ASSERT(clock_now(&clock) - start_ns < TIME_MS_TO_NS(SLEEP_TIMEOUT_MS));
+        clock_sleep(&clock, TIME_MS_TO_NS(1));
+    }
+    return true;
+}
+
+static void sum_range(void* data, size_t start, size_t end) {
+    ParallelForFixture* fixture = data;
+    uint64_t sum = 0;
+    for (size_t i = start; i < end; ++i) {
+        atomic_fetch_add(&fixture->visits[i], 1);
+        sum += i;
+    }
+    atomic_fetch_add(&fixture->sum, sum);
+}
+
+static void add_child_value(void* data) {
+    ParentJob* parent = data;
+    atomic_fetch_add(&parent->child_sum, 1);
+}
+
+// Fans out children from a worker and waits for them there, the wait runs queued jobs instead of blocking the worker
+static void run_parent_job(void* data) {
+    ParentJob* parent = data;
+    JobDecl jobs[CHILD_JOB_COUNT];
+    for (uint32_t i = 0; i < CHILD_JOB_COUNT; ++i) {
+        jobs[i] = (JobDecl){.function = add_child_value, .data = parent};
+    }
+
+    JobCounter counter;
+    job_counter_clear(&counter);
+    parent->is_valid = job_system_get_worker_index(parent->system) >= 0 &&
+                       job_system_run(parent->system, jobs, CHILD_JOB_COUNT, &counter);
+    job_system_wait(parent->system, &counter);
+    parent->sum_after_wait = atomic_load(&parent->child_sum);
+}
+
+// Jobs taken by the other workers hold them until the gate opens, jobs run by worker 0 before the gate opens can only
+// have run inline in job_system_run
+static void run_gated_job(void* data) {
+    OverflowFixture* fixture = data;
+    if (job_system_get_worker_index(fixture->system) == 0 && !atomic_load(&fixture->is_gate_open)) {
+        atomic_fetch_add(&fixture->inline_count, 1);
+    } else {
+        while (!atomic_load(&fixture->is_gate_open)) {
+            thread_pause();
+        }
+    }
+    atomic_fetch_add(&fixture->run_count, 1);
+}
+
+static bool test_parallel_for_sums(void) {
+    JobSystem system;
+    TEST_ASSERT(init_system(&system, WORKER_COUNT));
+
+    for (size_t batch_size = 1; batch_size <= PARALLEL_FOR_BATCH_SIZE; batch_size *= 10) {
+        ParallelForFixture* fixture = parallel_for_fixture;
+        for (size_t i = 0; i < PARALLEL_FOR_COUNT; ++i) {
+            atomic_init(&fixture->visits[i], 0);
+        }
+        atomic_init(&fixture->sum, 0);
+
+        TEST_ASSERT(job_system_parallel_for(&system, PARALLEL_FOR_COUNT, batch_size, sum_range, fixture));
+        TEST_ASSERT(atomic_load(&fixture->sum) == (uint64_t)PARALLEL_FOR_COUNT * (PARALLEL_FOR_COUNT - 1) / 2);
+        for (size_t i = 0; i < PARALLEL_FOR_COUNT; ++i) {
+            TEST_ASSERT(atomic_load(&fixture->visits[i]) == 1);
+        }
+    }
+    TEST_ASSERT(job_system_parallel_for(&system, 0, PARALLEL_FOR_BATCH_SIZE, sum_range, parallel_for_fixture));
+    TEST_ASSERT(!job_system_parallel_for(&system, (size_t)UINT32_MAX + 1, 1, sum_range, parallel_for_fixture));
+
+    job_system_destroy(&system);
+    return true;
+}
+
+static bool test_nested_counters(void) {
+    JobSystem system;
+    TEST_ASSERT(init_system(&system, WORKER_COUNT));
+
+    ParentJob parents[PARENT_JOB_COUNT];
+    JobDecl jobs[PARENT_JOB_COUNT];
+    for (uint32_t i = 0; i < PARENT_JOB_COUNT; ++i) {
+        parents[i] = (ParentJob){.system = &system};
+        atomic_init(&parents[i].child_sum, 0);
+        jobs[i] = (JobDecl){.function = run_parent_job, .data = &parents[i]};
+    }
+
+    JobCounter counter;
+    job_counter_clear(&counter);
+    TEST_ASSERT(job_system_run(&system, jobs, PARENT_JOB_COUNT, &counter));
+    job_system_wait(&system, &counter);
+    TEST_ASSERT(job_counter_is_done(&counter));
+    for (uint32_t i = 0; i < PARENT_JOB_COUNT; ++i) {
+        TEST_ASSERT(parents[i].is_valid);
+        TEST_ASSERT(parents[i].sum_after_wait == CHILD_JOB_COUNT);
+    }
+
+    job_system_destroy(&system);
+    return true;
+}
+
+static bool test_overflow_runs_inline(void) {
+    JobSystem system;
+    TEST_ASSERT(init_system(&system, WORKER_COUNT));
+
+    static JobDecl jobs[OVERFLOW_JOB_COUNT];
+    OverflowFixture fixture = {.system = &system};
+    atomic_init(&fixture.is_gate_open, false);
+    atomic_init(&fixture.run_count, 0);
+    atomic_init(&fixture.inline_count, 0);
+    for (uint32_t i = 0; i < OVERFLOW_JOB_COUNT; ++i) {
+        jobs[i] = (JobDecl){.function = run_gated_job, .data = &fixture};
+    }
+
+    JobCounter counter;
+    job_counter_clear(&counter);
+    TEST_ASSERT(!job_system_run(&system, jobs, (size_t)UINT32_MAX + 1, &counter));
+    TEST_ASSERT(job_counter_is_done(&counter));
+
+    // The other workers hold at most one job each, every job past the pool and them runs inline
+    TEST_ASSERT(job_system_run(&system, jobs, OVERFLOW_JOB_COUNT, &counter));
+    const uint32_t inline_count = atomic_load(&fixture.inline_count);
+    TEST_ASSERT(inline_count >= OVERFLOW_JOB_COUNT - JOB_DEQUE_CAPACITY - (WORKER_COUNT - 1));
+    TEST_ASSERT(atomic_load(&fixture.run_count) >= inline_count);
+
+    atomic_store(&fixture.is_gate_open, true);
+    job_system_wait(&system, &counter);
+    TEST_ASSERT(atomic_load(&fixture.run_count) == OVERFLOW_JOB_COUNT);
+
+    job_system_destroy(&system);
+    return true;
+}
+
+// Destroy has to wake workers asleep on the semaphore, jobs queued while they sleep have to wake them as well
+static bool test_init_destroy_with_sleeping_workers(void) {
+    for (uint32_t round = 0; round < INIT_DESTROY_ROUNDS; ++round) {
+        JobSystem system;
+        TEST_ASSERT(init_system(&system, WORKER_COUNT));
+        TEST_ASSERT(wait_for_sleeping_workers(&system));
+
+        if (round % 2 == 1) {
+            OverflowFixture fixture = {.system = &system};
+            atomic_init(&fixture.is_gate_open, true);
+            atomic_init(&fixture.run_count, 0);
+            atomic_init(&fixture.inline_count, 0);
+            JobDecl jobs[WORKER_COUNT * 4];
+            for (uint32_t i = 0; i < WORKER_COUNT * 4; ++i) {
+                jobs[i] = (JobDecl){.function = run_gated_job, .data = &fixture};
+            }
+
+            JobCounter counter;
+            job_counter_clear(&counter);
+            TEST_ASSERT(job_system_run(&system, jobs, WORKER_COUNT * 4, &counter));
+            job_system_wait(&system, &counter);
+            TEST_ASSERT(atomic_load(&fixture.run_count) == WORKER_COUNT * 4);
+            TEST_ASSERT(wait_for_sleeping_workers(&system));
+        }
+
+        job_system_destroy(&system);
+        TEST_ASSERT(!job_system_is_init(&system) && job_system_get_worker_index(&system) == -1);
+    }
+
+    return true;
+}
+
+int main(int argc, char* args[]) {
+    parallel_for_fixture = mem_alloc(sizeof(ParallelForFixture));
+    if (parallel_for_fixture == NULL) {
+        return 1;
+    }
+
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_parallel_for_sums);
+    failed_count += TEST_RUN(test_nested_counters);
+    failed_count += TEST_RUN(test_overflow_runs_inline);
+    failed_count += TEST_RUN(test_init_destroy_with_sleeping_workers);
+
+    mem_free(parallel_for_fixture);
+
+    return failed_count > 0;
+}
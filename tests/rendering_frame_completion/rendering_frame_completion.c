@@ -0,0 +1,222 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../src/lib/core/memory/memory.h"
+#include "../../src/lib/core/time/clock.h"
+#include "../../src/lib/core/utils/macro.h"
+#include "../../src/lib/vulkan/core/functions.h"
+#include "../../src/lib/vulkan/core/memory/allocator.h"
+#include "../../src/lib/vulkan/core/memory/backend/fake_memory_backend.h"
+#include "../../src/lib/vulkan/core/rendering/rendering_context.h"
+#include "../test.h"
+
+#define FRAMES_IN_FLIGHT 3
+
+// Fences of the frame slots are numbered from 1, the device functions the rendering context polls are replaced
+static bool fence_signaled[FRAMES_IN_FLIGHT];
+static uint32_t fence_wait_count;
+static uint64_t timeline_value;
+
+static VkResult VKAPI_CALL fake_get_fence_status(VkDevice device, VkFence fence) {
+    return fence_signaled[(uintptr_t)fence - 1] ? VK_SUCCESS : VK_NOT_READY;
+}
+
+static VkResult VKAPI_CALL fake_wait_for_fences(
+    VkDevice device, uint32_t fence_count, const VkFence* fences, VkBool32 wait_all, uint64_t timeout) {
+    for (uint32_t i = 0; i < fence_count; ++i) {
+        fence_signaled[(uintptr_t)fences[i] - 1] = true;
+    }
+    fence_wait_count += 1;
+    return VK_SUCCESS;
+}
+
+static VkResult VKAPI_CALL fake_get_semaphore_counter_value(VkDevice device, VkSemaphore semaphore, uint64_t* value) {
+    *value = timeline_value;
+    return VK_SUCCESS;
+}
+
+static VkResult VKAPI_CALL fake_wait_semaphores(VkDevice device, const VkSemaphoreWaitInfo* info, uint64_t timeout) {
+    timeline_value = MAX(timeline_value, info->pValues[0]);
+    return VK_SUCCESS;
+}
+
+static Context context;
+static CommandContext command_context;
+static RenderingContext rendering_context;
+static SimulatedClock simulated_clock;
+
+static void fixture_init(bool timeline_enabled) {
+    vkGetFenceStatus = fake_get_fence_status;
+    vkWaitForFences = fake_wait_for_fences;
+    vkGetSemaphoreCounterValue = fake_get_semaphore_counter_value;
+    vkWaitSemaphores = fake_wait_semaphores;
+    for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        fence_signaled[i] = false;
+    }
+    fence_wait_count = 0;
+    timeline_value = 0;
+
+    context.device.handle = (VkDevice)(uintptr_t)1;
+    command_context.context = &context;
+
+    rendering_context_clear(&rendering_context);
+    rendering_context.command_context = &command_context;
+    rendering_context.config.frames_in_flight = FRAMES_IN_FLIGHT;
+    rendering_context.config.render_timeout_ms = 1000;
+    if (timeline_enabled) {
+        rendering_context.frame_timeline = (VkSemaphore)(uintptr_t)1;
+    }
+    for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+        rendering_context.frame_resources[i].render_fence = (VkFence)(uintptr_t)(i + 1);
+    }
+
+    simulated_clock.time_ns = 0;
+    FrameLatencyConfig latency_config = {0};
+    Clock clock = clock_get_simulated(&simulated_clock);
+    frame_latency_controller_init(&rendering_context.latency_controller, &latency_config, &clock);
+}
+
+// Submits the next frame into its slot, the slot fence is reset like the real submit does
+static uint64_t submit_frame(void) {
+    uint64_t frame_number = rendering_context.frame_number++;
+    uint32_t slot = (uint32_t)((frame_number - 1) % FRAMES_IN_FLIGHT);
+    rendering_context.frame_resources[slot].frame_number = frame_number;
+    fence_signaled[slot] = false;
+    return frame_number;
+}
+
+static void signal_frame(uint64_t frame_number) { fence_signaled[(frame_number - 1) % FRAMES_IN_FLIGHT] = true; }
+
+static bool test_polling_completes_signaled_frames(void) {
+    fixture_init(false);
+    for (uint32_t i = 0; i < 3; ++i) {
+        submit_frame();
+    }
+
+    TEST_ASSERT(rendering_context_update_completed_frame_number(&rendering_context) == 0);
+
+    signal_frame(1);
+    signal_frame(2);
+    TEST_ASSERT(rendering_context_update_completed_frame_number(&rendering_context) == 2);
+    TEST_ASSERT(rendering_context.latency_controller.completed_frame_number == 2);
+
+    return true;
+}
+
+static bool test_completed_frame_number_never_decreases(void) {
+    fixture_init(false);
+    for (uint32_t i = 0; i < 3; ++i) {
+        submit_frame();
+    }
+
+    // Fences signal in submission order, a later fence covers every frame before it
+    signal_frame(3);
+    TEST_ASSERT(rendering_context_update_completed_frame_number(&rendering_context) == 3);
+    signal_frame(1);
+    TEST_ASSERT(rendering_context_update_completed_frame_number(&rendering_context) == 3);
+
+    // Reusing the slots of completed frames keeps the completed frame number
+    submit_frame();
+    submit_frame();
+    TEST_ASSERT(rendering_context_update_completed_frame_number(&rendering_context) == 3);
+    signal_frame(4);
+    TEST_ASSERT(rendering_context_update_completed_frame_number(&rendering_context) == 4);
+
+    return true;
+}
+
+static bool test_wait_for_frame_uses_earliest_covering_frame(void) {
+    fixture_init(false);
+    for (uint32_t i = 0; i < 5; ++i) {
+        submit_frame();
+    }
+
+    // Frame 2's slot has been reused by frame 5, frame 3 is the earliest frame that covers it
+    TEST_ASSERT(rendering_context_wait_for_frame(&rendering_context, 2) == RENDERING_CONTEXT_SUCCESS);
+    TEST_ASSERT(fence_wait_count == 1);
+    TEST_ASSERT(rendering_context.completed_frame_number == 3);
+
+    TEST_ASSERT(rendering_context_wait_for_frame(&rendering_context, 1) == RENDERING_CONTEXT_SUCCESS);
+    TEST_ASSERT(fence_wait_count == 1);
+    TEST_ASSERT(rendering_context_wait_for_frame(&rendering_context, 6) == RENDERING_CONTEXT_FRAME_NOT_SUBMITTED);
+
+    return true;
+}
+
+static bool test_timeline_value_completes_frames(void) {
+    fixture_init(true);
+    for (uint32_t i = 0; i < 5; ++i) {
+        submit_frame();
+    }
+
+    timeline_value = 4;
+    TEST_ASSERT(rendering_context_update_completed_frame_number(&rendering_context) == 4);
+    TEST_ASSERT(rendering_context_wait_for_frame(&rendering_context, 5) == RENDERING_CONTEXT_SUCCESS);
+    TEST_ASSERT(rendering_context.completed_frame_number == 5);
+    TEST_ASSERT(fence_wait_count == 0);
+
+    return true;
+}
+
+static bool test_garbage_released_once_frame_completes(void) {
+    fixture_init(false);
+
+    FakeMemoryBackend* fake = mem_alloc(sizeof(FakeMemoryBackend));
+    TEST_ASSERT(fake != NULL);
+    fake_memory_backend_clear(fake);
+    FakeMemoryBackendInfo fake_info = fake_memory_backend_info_get_default();
+    TEST_ASSERT(fake_memory_backend_init(fake, &fake_info) == MEMORY_CONTEXT_SUCCESS);
+
+    VulkanMemoryAllocator allocator;
+    VulkanMemoryAllocatorInfo allocator_info = vulkan_memory_allocator_info_get_default();
+    allocator_info.device = &fake->device;
+    allocator_info.backend = &fake->backend;
+    allocator_info.device_local_block_size_MB = 1;
+    allocator_info.dedicated_allocation_threshold_MB = 1;
+    TEST_ASSERT(vulkan_memory_allocator_init(&allocator, &allocator_info) == MEMORY_CONTEXT_SUCCESS);
+
+    VulkanMemoryAllocatorRequest request = {
+        .size = 4096,
+        .align = 256,
+        .memory_type_bits = 1,
+        .usage = VULKAN_MEMORY_USAGE_GPU_ONLY,
+        .allocation_type = VULKAN_ALLOCATION_TYPE_BUFFER,
+        .strategy = VULKAN_MEMORY_STRATEGY_DEFAULT,
+    };
+    VulkanAllocation allocation;
+    TEST_ASSERT(vulkan_memory_allocator_allocate(&allocator, &request, &allocation) == MEMORY_CONTEXT_SUCCESS);
+
+    // Freed while frame 2 is recorded, frame 1 completing is not enough
+    submit_frame();
+    vulkan_memory_allocator_begin_frame(&allocator, 1, rendering_context.frame_number);
+    vulkan_memory_allocator_free(&allocator, allocation);
+    uint64_t frame_number = submit_frame();
+
+    signal_frame(1);
+    vulkan_memory_allocator_empty_garbage(
+        &allocator, rendering_context_update_completed_frame_number(&rendering_context));
+    TEST_ASSERT(fake->allocation_count == 1);
+
+    signal_frame(frame_number);
+    vulkan_memory_allocator_empty_garbage(
+        &allocator, rendering_context_update_completed_frame_number(&rendering_context));
+    // The emptied block is released together with the allocation
+    TEST_ASSERT(fake->allocation_count == 0);
+
+    vulkan_memory_allocator_destroy(&allocator);
+    fake_memory_backend_destroy(fake);
+    mem_free(fake);
+
+    return true;
+}
+
+int main(int argc, char* args[]) {
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_polling_completes_signaled_frames);
+    failed_count += TEST_RUN(test_completed_frame_number_never_decreases);
+    failed_count += TEST_RUN(test_wait_for_frame_uses_earliest_covering_frame);
+    failed_count += TEST_RUN(test_timeline_value_completes_frames);
+    failed_count += TEST_RUN(test_garbage_released_once_frame_completes);
+
+    return failed_count > 0;
+}
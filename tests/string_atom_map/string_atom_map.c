@@ -0,0 +1,83 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../src/lib/core/string/string_atom_map.h"
+#include "../test.h"
+
+#define GROW_ATOM_COUNT 1000
+
+static bool test_set_get_and_replace(void) {
+    StringAtomMap map;
+    string_atom_map_clear(&map);
+
+    uint32_t value;
+    TEST_ASSERT(!string_atom_map_get(&map, 1, &value));
+    TEST_ASSERT(!string_atom_map_set(&map, STRING_ATOM_NONE, 1));
+    TEST_ASSERT(string_atom_map_set(&map, 7, 70));
+    TEST_ASSERT(string_atom_map_set(&map, 7, 71));
+    TEST_ASSERT(map.size == 1 && map.cap == STRING_ATOM_MAP_MIN_CAPACITY);
+    TEST_ASSERT(string_atom_map_get(&map, 7, &value) && value == 71);
+    TEST_ASSERT(!string_atom_map_get(&map, 8, &value));
+
+    string_atom_map_destroy(&map);
+    return true;
+}
+
+// Large atoms only take a slot each, the capacity follows the entry count
+static bool test_grow_keeps_entries(void) {
+    StringAtomMap map;
+    string_atom_map_clear(&map);
+
+    for (uint32_t i = 1; i <= GROW_ATOM_COUNT; ++i) {
+        TEST_ASSERT(string_atom_map_set(&map, i * 1021, i));
+    }
+    TEST_ASSERT(map.size == GROW_ATOM_COUNT && map.cap == 2048);
+    for (uint32_t i = 1; i <= GROW_ATOM_COUNT; ++i) {
+        uint32_t value;
+        TEST_ASSERT(string_atom_map_get(&map, i * 1021, &value) && value == i);
+    }
+    TEST_ASSERT(string_atom_map_set(&map, STRING_ATOM_MAX_COUNT, 1) && map.cap == 2048);
+
+    string_atom_map_destroy(&map);
+    return true;
+}
+
+// Atoms 16 apart share their home slot in a table of 16, the chain has to stay reachable after every delete
+static bool test_delete_shifts_collisions_back(void) {
+    StringAtomMap map;
+    string_atom_map_clear(&map);
+
+    for (uint32_t i = 0; i < 6; ++i) {
+        TEST_ASSERT(string_atom_map_set(&map, 3 + i * 16, i));
+    }
+    TEST_ASSERT(string_atom_map_set(&map, 4, 100));
+    TEST_ASSERT(map.cap == STRING_ATOM_MAP_MIN_CAPACITY);
+
+    TEST_ASSERT(string_atom_map_delete(&map, 3 + 16));
+    TEST_ASSERT(!string_atom_map_delete(&map, 3 + 16));
+    TEST_ASSERT(string_atom_map_delete(&map, 3));
+    TEST_ASSERT(map.size == 5);
+
+    uint32_t value;
+    for (uint32_t i = 2; i < 6; ++i) {
+        TEST_ASSERT(string_atom_map_get(&map, 3 + i * 16, &value) && value == i);
+    }
+    TEST_ASSERT(string_atom_map_get(&map, 4, &value) && value == 100);
+    TEST_ASSERT(!string_atom_map_get(&map, 3, &value));
+
+    string_atom_map_clear_values(&map);
+    TEST_ASSERT(map.size == 0 && map.cap == STRING_ATOM_MAP_MIN_CAPACITY);
+    TEST_ASSERT(!string_atom_map_get(&map, 4, &value));
+
+    string_atom_map_destroy(&map);
+    return true;
+}
+
+int main(int argc, char* args[]) {
+    int failed_count = 0;
+    failed_count += TEST_RUN(test_set_get_and_replace);
+    failed_count += TEST_RUN(test_grow_keeps_entries);
+    failed_count += TEST_RUN(test_delete_shifts_collisions_back);
+
+    return failed_count > 0;
+}
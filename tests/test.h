@@ -0,0 +1,19 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Tests are functions returning bool, a failed assertion prints the condition and returns false
+#define TEST_ASSERT(condition)                                                                                         \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #condition);                          \
+            return false;                                                                                              \
+        }                                                                                                              \
+    } while (0)
+
+// Evaluates to the number of failed tests, zero or one
+#define TEST_RUN(test) ((test)() ? (printf("[ OK ] %s\n", #test), 0) : (printf("[FAIL] %s\n", #test), 1))
+
+#endif
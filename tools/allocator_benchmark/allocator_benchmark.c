@@ -0,0 +1,1034 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../src/lib/core/memory/memory.h"
+
+// Heap calls of the vector growth functions, vector.h is included ahead of every other header so its inline functions
+// call the counting wrappers below
+static uint64_t allocator_benchmark_heap_call_count;
+
+static void* allocator_benchmark_counting_alloc(size_t size) {
+    allocator_benchmark_heap_call_count += 1;
+    return mem_alloc(size);
+}
+
+static void* allocator_benchmark_counting_realloc(void* mem, size_t size) {
+    allocator_benchmark_heap_call_count += 1;
+    return mem_realloc(mem, size);
+}
+
+#define mem_alloc allocator_benchmark_counting_alloc
+#define mem_realloc allocator_benchmark_counting_realloc
+#include "../../src/lib/core/collections/vector.h"
+#undef mem_alloc
+#undef mem_realloc
+
+#include "../../src/lib/core/collections/hash_string_map.h"
+#include "../../src/lib/core/string/string.h"
+#include "../../src/lib/core/string/string_atom.h"
+#include "../../src/lib/core/threads/thread.h"
+#include "../../src/lib/core/utils/macro.h"
+#include "../../src/lib/vulkan/core/command/command_context.h"
+#include "../../src/lib/vulkan/core/memory/allocator.h"
+#include "../../src/lib/vulkan/core/memory/backend/fake_memory_backend.h"
+#include "../../src/lib/vulkan/core/memory/memory_allocation_cache/memory_allocation_cache.h"
+#include "../../src/lib/vulkan/core/shader/pipeline_repository.h"
+
+#define ALLOCATOR_BENCHMARK_DEFAULT_ITERATIONS 1000000
+// Allocations kept alive by the block benchmark, one of them is replaced on every iteration
+#define ALLOCATOR_BENCHMARK_LIVE_ALLOCATIONS 4096
+#define ALLOCATOR_BENCHMARK_RECORD_COUNT 8192
+#define ALLOCATOR_BENCHMARK_NAME_COUNT 1024
+// The baselines scan every record or chunk per operation, their runs are capped to keep the tool quick
+#define ALLOCATOR_BENCHMARK_FIRST_FIT_MAX_ITERATIONS 100000
+#define ALLOCATOR_BENCHMARK_LINEAR_CACHE_MAX_ITERATIONS 2000
+#define ALLOCATOR_BENCHMARK_LINEAR_CACHE_NAME_SIZE 128
+#define ALLOCATOR_BENCHMARK_LINEAR_CACHE_FREE_NAME "_AVAIL"
+// Live allocations of the mixed block benchmarks, the first fit scan is linear in them
+#define ALLOCATOR_BENCHMARK_MIXED_LIVE_ALLOCATIONS 1024
+#define ALLOCATOR_BENCHMARK_MIXED_BLOCK_SIZE MB_TO_BYTES(128ULL)
+// Live allocations of every thread of the threaded block benchmarks, the threads empty the garbage once per frame of
+// this many iterations
+#define ALLOCATOR_BENCHMARK_THREAD_LIVE_ALLOCATIONS 256
+#define ALLOCATOR_BENCHMARK_THREAD_FRAME_ITERATIONS 64
+// Registered command pools and pipelines of the lookup benchmarks
+#define ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT 16
+#define ALLOCATOR_BENCHMARK_PIPELINE_COUNT 64
+#define ALLOCATOR_BENCHMARK_LOOKUP_NAME_SIZE 32
+#define ALLOCATOR_BENCHMARK_COMMAND_POOL_FREE_NAME "_AVAIL"
+// Every iteration of the vector benchmarks simulates a frame that fills a fresh vector with this many pushes, fits
+// into the inline storage of the small vector
+#define ALLOCATOR_BENCHMARK_VECTOR_PUSHES 12
+
+typedef struct AllocatorBenchmarkResult {
+    uint64_t op_count;
+    uint64_t elapsed_ns;
+    // Set by the benchmarks that simulate frames, heap calls are counted over all of them
+    uint64_t frame_count;
+    uint64_t heap_call_count;
+} AllocatorBenchmarkResult;
+
+typedef bool (*AllocatorBenchmarkFunction)(uint64_t iterations, AllocatorBenchmarkResult* result);
+
+typedef struct AllocatorBenchmark {
+    const char* name;
+    AllocatorBenchmarkFunction run;
+} AllocatorBenchmark;
+
+typedef struct AllocatorBenchmarkThread {
+    Thread thread;
+    VulkanMemoryAllocator* allocator;
+    uint64_t iterations;
+    uint32_t seed;
+    bool is_valid;
+} AllocatorBenchmarkThread;
+
+// Chunk of the first fit block the TLSF free lists replaced, every split allocates a node
+typedef struct AllocatorBenchmarkFirstFitChunk AllocatorBenchmarkFirstFitChunk;
+
+struct AllocatorBenchmarkFirstFitChunk {
+    uint32_t id;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    VulkanAllocationType type;
+    AllocatorBenchmarkFirstFitChunk* prev;
+    AllocatorBenchmarkFirstFitChunk* next;
+};
+
+typedef struct AllocatorBenchmarkFirstFitBlock {
+    AllocatorBenchmarkFirstFitChunk* head;
+    uint32_t next_id;
+    VkDeviceSize size;
+    VkDeviceSize allocated;
+} AllocatorBenchmarkFirstFitBlock;
+
+// Record of the cache before records were indexed by hash, looked up by comparing the names of all records
+typedef struct AllocatorBenchmarkLinearCacheRecord {
+    char name[ALLOCATOR_BENCHMARK_LINEAR_CACHE_NAME_SIZE];
+    uint32_t page_index;
+    MemoryAllocationCacheRecordType type;
+    VulkanAllocation allocation;
+    VulkanBufferObject buffer_object;
+} AllocatorBenchmarkLinearCacheRecord;
+
+// Slot of the command pool cache before pools were named by atoms, looked up by comparing the names of all slots
+typedef struct AllocatorBenchmarkNamedCommandPool {
+    char name[COMMAND_POOL_NAME_SIZE];
+    VkCommandBuffer buffer;
+} AllocatorBenchmarkNamedCommandPool;
+
+// Pipelines were keyed by their names before the repository indexed them by atom
+typedef struct AllocatorBenchmarkPipelineMap HASH_STRING_MAP(PipelineRecord) AllocatorBenchmarkPipelineMap;
+
+typedef struct AllocatorBenchmarkVector VECTOR(uint32_t) AllocatorBenchmarkVector;
+typedef struct AllocatorBenchmarkSmallVector SMALL_VECTOR(uint32_t, 16) AllocatorBenchmarkSmallVector;
+
+// Results are folded into the sink so the measured work cannot be optimized away
+static volatile uint64_t allocator_benchmark_sink;
+
+static uint64_t allocator_benchmark_get_ns(uint64_t start_counter) {
+    uint64_t elapsed = SDL_GetPerformanceCounter() - start_counter;
+    return (uint64_t)((double)elapsed * 1e9 / (double)SDL_GetPerformanceFrequency());
+}
+
+static inline uint32_t allocator_benchmark_random(uint32_t* seed) {
+    *seed = *seed * 1664525U + 1013904223U;
+    return *seed >> 8;
+}
+
+static bool allocator_benchmark_init_allocator(
+    FakeMemoryBackend* fake, VulkanMemoryAllocator* allocator, bool concurrent) {
+    fake_memory_backend_clear(fake);
+    vulkan_memory_allocator_clear(allocator);
+
+    FakeMemoryBackendInfo fake_info = fake_memory_backend_info_get_default();
+    VulkanMemoryAllocatorInfo allocator_info = vulkan_memory_allocator_info_get_default();
+    allocator_info.device = &fake->device;
+    allocator_info.backend = &fake->backend;
+    allocator_info.concurrent = concurrent;
+
+    if (fake_memory_backend_init(fake, &fake_info) != MEMORY_CONTEXT_SUCCESS) {
+        return false;
+    }
+    if (vulkan_memory_allocator_init(allocator, &allocator_info) != MEMORY_CONTEXT_SUCCESS) {
+        fake_memory_backend_destroy(fake);
+        return false;
+    }
+    return true;
+}
+
+// Random sizes between 256 B and 64 KB keep the free lists of the block busy, the TLSF search and the coalescing are
+// on the hot path of every iteration
+static bool allocator_benchmark_run_block(uint64_t iterations, bool concurrent, AllocatorBenchmarkResult* result) {
+    FakeMemoryBackend* fake = mem_alloc(sizeof(FakeMemoryBackend));
+    VulkanMemoryAllocator* allocator = mem_alloc(sizeof(VulkanMemoryAllocator));
+    VulkanAllocation* allocations = mem_alloc(sizeof(VulkanAllocation) * ALLOCATOR_BENCHMARK_LIVE_ALLOCATIONS);
+    bool status = fake != NULL && allocator != NULL && allocations != NULL &&
+                  allocator_benchmark_init_allocator(fake, allocator, concurrent);
+    if (!status) {
+        mem_free(fake);
+        mem_free(allocator);
+        mem_free(allocations);
+        return false;
+    }
+
+    VulkanMemoryAllocatorRequest request = {
+        .align = 256,
+        .memory_type_bits = 1,
+        .usage = VULKAN_MEMORY_USAGE_GPU_ONLY,
+        .allocation_type = VULKAN_ALLOCATION_TYPE_BUFFER,
+        .strategy = VULKAN_MEMORY_STRATEGY_DEFAULT,
+    };
+    uint32_t seed = 1;
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_LIVE_ALLOCATIONS && status; ++i) {
+        request.size = 256 + allocator_benchmark_random(&seed) % KB_TO_BYTES(64);
+        status = vulkan_memory_allocator_allocate(allocator, &request, &allocations[i]) == MEMORY_CONTEXT_SUCCESS;
+    }
+
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        uint32_t index = allocator_benchmark_random(&seed) % ALLOCATOR_BENCHMARK_LIVE_ALLOCATIONS;
+        VulkanAllocation* allocation = &allocations[index];
+        vulkan_memory_allocator_free_immediately(allocator, allocation);
+        request.size = 256 + allocator_benchmark_random(&seed) % KB_TO_BYTES(64);
+        status = vulkan_memory_allocator_allocate(allocator, &request, allocation) == MEMORY_CONTEXT_SUCCESS;
+        allocator_benchmark_sink += allocation->offset;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations * 2;
+
+    vulkan_memory_allocator_destroy(allocator);
+    fake_memory_backend_destroy(fake);
+    mem_free(fake);
+    mem_free(allocator);
+    mem_free(allocations);
+
+    return status;
+}
+
+static bool allocator_benchmark_run_block_alloc_free(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    return allocator_benchmark_run_block(iterations, false, result);
+}
+
+static bool allocator_benchmark_run_block_alloc_free_locked(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    return allocator_benchmark_run_block(iterations, true, result);
+}
+
+// Frees are deferred like the frees of loader threads, the completed ranges come back through the thread cache of the
+// freeing thread whichever thread empties the garbage
+static int allocator_benchmark_thread_run(void* data) {
+    AllocatorBenchmarkThread* worker = data;
+    VulkanAllocation allocations[ALLOCATOR_BENCHMARK_THREAD_LIVE_ALLOCATIONS];
+    VulkanMemoryAllocatorRequest request = {
+        .align = 256,
+        .memory_type_bits = 1,
+        .usage = VULKAN_MEMORY_USAGE_GPU_ONLY,
+        .allocation_type = VULKAN_ALLOCATION_TYPE_BUFFER,
+        .strategy = VULKAN_MEMORY_STRATEGY_DEFAULT,
+    };
+
+    bool status = true;
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_THREAD_LIVE_ALLOCATIONS && status; ++i) {
+        request.size = 256U << (allocator_benchmark_random(&worker->seed) % 8);
+        status = vulkan_memory_allocator_allocate(worker->allocator, &request, &allocations[i]) ==
+                 MEMORY_CONTEXT_SUCCESS;
+    }
+    for (uint64_t i = 0; i < worker->iterations && status; ++i) {
+        uint32_t index = allocator_benchmark_random(&worker->seed) % ALLOCATOR_BENCHMARK_THREAD_LIVE_ALLOCATIONS;
+        status = vulkan_memory_allocator_free(worker->allocator, allocations[index]);
+        request.size = 256U << (allocator_benchmark_random(&worker->seed) % 8);
+        status = status && vulkan_memory_allocator_allocate(worker->allocator, &request, &allocations[index]) ==
+                               MEMORY_CONTEXT_SUCCESS;
+        if (i % ALLOCATOR_BENCHMARK_THREAD_FRAME_ITERATIONS == 0) {
+            vulkan_memory_allocator_empty_garbage(worker->allocator, UINT64_MAX);
+        }
+    }
+
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_THREAD_LIVE_ALLOCATIONS && status; ++i) {
+        vulkan_memory_allocator_free_immediately(worker->allocator, &allocations[i]);
+    }
+    vulkan_memory_allocator_release_thread_cache(worker->allocator);
+    worker->is_valid = status;
+
+    return 0;
+}
+
+// The iterations are split between the threads, ns/op is the wall time over the ops of every thread so it drops with
+// the thread count as long as the threads do not contend
+static bool allocator_benchmark_run_block_threads(
+    uint64_t iterations, uint32_t thread_count, AllocatorBenchmarkResult* result) {
+    FakeMemoryBackend* fake = mem_alloc(sizeof(FakeMemoryBackend));
+    VulkanMemoryAllocator* allocator = mem_alloc(sizeof(VulkanMemoryAllocator));
+    AllocatorBenchmarkThread* workers = mem_alloc(sizeof(AllocatorBenchmarkThread) * thread_count);
+    bool status = fake != NULL && allocator != NULL && workers != NULL &&
+                  allocator_benchmark_init_allocator(fake, allocator, true);
+    if (!status) {
+        mem_free(fake);
+        mem_free(allocator);
+        mem_free(workers);
+        return false;
+    }
+
+    uint32_t started_count = 0;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint32_t i = 0; i < thread_count && status; ++i) {
+        workers[i] = (AllocatorBenchmarkThread){
+            .allocator = allocator,
+            .iterations = iterations / thread_count,
+            .seed = i + 1,
+            .is_valid = false,
+        };
+        thread_clear(&workers[i].thread);
+        status = thread_init(&workers[i].thread, "allocator_benchmark", allocator_benchmark_thread_run, &workers[i]);
+        started_count += status ? 1 : 0;
+    }
+    for (uint32_t i = 0; i < started_count; ++i) {
+        thread_join(&workers[i].thread);
+        status = status && workers[i].is_valid;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations / thread_count * thread_count * 2;
+
+    vulkan_memory_allocator_destroy(allocator);
+    fake_memory_backend_destroy(fake);
+    mem_free(fake);
+    mem_free(allocator);
+    mem_free(workers);
+
+    return status;
+}
+
+static bool allocator_benchmark_run_block_threads_1(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    return allocator_benchmark_run_block_threads(iterations, 1, result);
+}
+
+static bool allocator_benchmark_run_block_threads_2(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    return allocator_benchmark_run_block_threads(iterations, 2, result);
+}
+
+static bool allocator_benchmark_run_block_threads_4(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    return allocator_benchmark_run_block_threads(iterations, 4, result);
+}
+
+static bool allocator_benchmark_run_block_threads_8(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    return allocator_benchmark_run_block_threads(iterations, 8, result);
+}
+
+// Buffers, linear and optimal images with alignments from 16 B to 64 KB, neighbours of different kinds on one
+// granularity page push the search into the granularity retry and the exact class fallback
+static void allocator_benchmark_get_mixed_info(uint32_t* seed, VulkanAllocationInfo* info) {
+    static const VulkanAllocationType types[] = {
+        VULKAN_ALLOCATION_TYPE_BUFFER, VULKAN_ALLOCATION_TYPE_IMAGE_LINEAR, VULKAN_ALLOCATION_TYPE_IMAGE_OPTIMAL};
+    static const uint32_t aligns[] = {16, 256, 1024, 4096, KB_TO_BYTES(64)};
+    uint32_t value = allocator_benchmark_random(seed);
+    info->size = 256 + value % KB_TO_BYTES(64);
+    info->allocation_type = types[(value >> 16) % 3];
+    info->align = aligns[(value >> 18) % 5];
+}
+
+static bool allocator_benchmark_is_on_same_page(
+    VkDeviceSize ra_offset, VkDeviceSize ra_size, VkDeviceSize rb_offset, VkDeviceSize page_size) {
+    if (ra_offset + ra_size > rb_offset || ra_size == 0) {
+        return false;
+    }
+    return ((ra_offset + ra_size - 1) & ~(page_size - 1)) == (rb_offset & ~(page_size - 1));
+}
+
+// Only covers the buffers, linear and optimal images the benchmark requests
+static bool allocator_benchmark_has_granularity_conflict(VulkanAllocationType type1, VulkanAllocationType type2) {
+    if (type1 == VULKAN_ALLOCATION_TYPE_FREE || type2 == VULKAN_ALLOCATION_TYPE_FREE) {
+        return false;
+    }
+    return (type1 == VULKAN_ALLOCATION_TYPE_IMAGE_OPTIMAL) != (type2 == VULKAN_ALLOCATION_TYPE_IMAGE_OPTIMAL);
+}
+
+static bool allocator_benchmark_first_fit_init(AllocatorBenchmarkFirstFitBlock* block, VkDeviceSize size) {
+    block->head = mem_alloc(sizeof(AllocatorBenchmarkFirstFitChunk));
+    if (block->head == NULL) {
+        return false;
+    }
+    *block->head = (AllocatorBenchmarkFirstFitChunk){.size = size, .type = VULKAN_ALLOCATION_TYPE_FREE};
+    block->next_id = 1;
+    block->size = size;
+    block->allocated = 0;
+    return true;
+}
+
+static void allocator_benchmark_first_fit_destroy(AllocatorBenchmarkFirstFitBlock* block) {
+    while (block->head != NULL) {
+        AllocatorBenchmarkFirstFitChunk* next = block->head->next;
+        mem_free(block->head);
+        block->head = next;
+    }
+}
+
+// Walks the chunk list from the head and takes the first free chunk that fits, the alignment padding is kept in the
+// allocated chunk
+static uint32_t allocator_benchmark_first_fit_allocate(
+    AllocatorBenchmarkFirstFitBlock* block, const VulkanAllocationInfo* info, VkDeviceSize* out_offset) {
+    AllocatorBenchmarkFirstFitChunk* prev = NULL;
+    for (AllocatorBenchmarkFirstFitChunk* chunk = block->head; chunk != NULL; prev = chunk, chunk = chunk->next) {
+        if (chunk->type != VULKAN_ALLOCATION_TYPE_FREE || chunk->size < info->size) {
+            continue;
+        }
+
+        VkDeviceSize offset = ALIGN(chunk->offset, (VkDeviceSize)info->align);
+        if (prev != NULL && allocator_benchmark_is_on_same_page(prev->offset, prev->size, offset, info->granularity) &&
+            allocator_benchmark_has_granularity_conflict(prev->type, info->allocation_type)) {
+            offset = ALIGN(offset, info->granularity);
+        }
+        VkDeviceSize aligned_size = offset - chunk->offset + info->size;
+        if (chunk->size < aligned_size) {
+            continue;
+        }
+        if (chunk->next != NULL &&
+            allocator_benchmark_is_on_same_page(offset, info->size, chunk->next->offset, info->granularity) &&
+            allocator_benchmark_has_granularity_conflict(info->allocation_type, chunk->next->type)) {
+            continue;
+        }
+
+        if (chunk->size > aligned_size) {
+            AllocatorBenchmarkFirstFitChunk* remainder = mem_alloc(sizeof(AllocatorBenchmarkFirstFitChunk));
+            if (remainder == NULL) {
+                return 0;
+            }
+            *remainder = (AllocatorBenchmarkFirstFitChunk){
+                .offset = chunk->offset + aligned_size,
+                .size = chunk->size - aligned_size,
+                .type = VULKAN_ALLOCATION_TYPE_FREE,
+                .prev = chunk,
+                .next = chunk->next,
+            };
+            if (chunk->next != NULL) {
+                chunk->next->prev = remainder;
+            }
+            chunk->next = remainder;
+        }
+
+        chunk->id = block->next_id++;
+        chunk->size = aligned_size;
+        chunk->type = info->allocation_type;
+        block->allocated += aligned_size;
+        *out_offset = offset;
+        return chunk->id;
+    }
+
+    return 0;
+}
+
+// Chunks are found by id with a walk from the head
+static void allocator_benchmark_first_fit_free(AllocatorBenchmarkFirstFitBlock* block, uint32_t id) {
+    AllocatorBenchmarkFirstFitChunk* chunk = block->head;
+    while (chunk != NULL && (chunk->id != id || chunk->type == VULKAN_ALLOCATION_TYPE_FREE)) {
+        chunk = chunk->next;
+    }
+    if (chunk == NULL) {
+        return;
+    }
+
+    block->allocated -= chunk->size;
+    chunk->type = VULKAN_ALLOCATION_TYPE_FREE;
+    if (chunk->prev != NULL && chunk->prev->type == VULKAN_ALLOCATION_TYPE_FREE) {
+        AllocatorBenchmarkFirstFitChunk* prev = chunk->prev;
+        prev->size += chunk->size;
+        prev->next = chunk->next;
+        if (chunk->next != NULL) {
+            chunk->next->prev = prev;
+        }
+        mem_free(chunk);
+        chunk = prev;
+    }
+    if (chunk->next != NULL && chunk->next->type == VULKAN_ALLOCATION_TYPE_FREE) {
+        AllocatorBenchmarkFirstFitChunk* next = chunk->next;
+        chunk->size += next->size;
+        chunk->next = next->next;
+        if (next->next != NULL) {
+            next->next->prev = chunk;
+        }
+        mem_free(next);
+    }
+}
+
+static bool allocator_benchmark_run_block_mixed_tlsf(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    FakeMemoryBackend* fake = mem_alloc(sizeof(FakeMemoryBackend));
+    VulkanMemoryBlock* block = mem_alloc(sizeof(VulkanMemoryBlock));
+    VulkanAllocation* allocations = mem_alloc(sizeof(VulkanAllocation) * ALLOCATOR_BENCHMARK_MIXED_LIVE_ALLOCATIONS);
+    FakeMemoryBackendInfo fake_info = fake_memory_backend_info_get_default();
+    bool status = fake != NULL && block != NULL && allocations != NULL;
+    if (status) {
+        fake_memory_backend_clear(fake);
+        status = fake_memory_backend_init(fake, &fake_info) == MEMORY_CONTEXT_SUCCESS;
+    }
+    if (!status) {
+        mem_free(fake);
+        mem_free(block);
+        mem_free(allocations);
+        return false;
+    }
+
+    VulkanMemoryBlockInfo block_info = {
+        .device = &fake->device,
+        .backend = &fake->backend,
+        .memory_type_index = 0,
+        .size = ALLOCATOR_BENCHMARK_MIXED_BLOCK_SIZE,
+        .usage = VULKAN_MEMORY_USAGE_GPU_ONLY,
+    };
+    status = vulkan_memory_block_init(block, &block_info) == MEMORY_CONTEXT_SUCCESS;
+
+    VulkanAllocationInfo info = {.granularity = fake_info.buffer_image_granularity};
+    uint32_t seed = 1;
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_MIXED_LIVE_ALLOCATIONS && status; ++i) {
+        allocator_benchmark_get_mixed_info(&seed, &info);
+        status = vulkan_memory_block_allocate(block, &info, &allocations[i]) == MEMORY_CONTEXT_SUCCESS;
+    }
+
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        VulkanAllocation* allocation =
+            &allocations[allocator_benchmark_random(&seed) % ALLOCATOR_BENCHMARK_MIXED_LIVE_ALLOCATIONS];
+        vulkan_memory_block_free_allocation(block, allocation);
+        allocator_benchmark_get_mixed_info(&seed, &info);
+        status = vulkan_memory_block_allocate(block, &info, allocation) == MEMORY_CONTEXT_SUCCESS;
+        allocator_benchmark_sink += allocation->offset;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations * 2;
+
+    vulkan_memory_block_destroy(block);
+    fake_memory_backend_destroy(fake);
+    mem_free(fake);
+    mem_free(block);
+    mem_free(allocations);
+
+    return status;
+}
+
+// Same requests as the TLSF run, the baseline the free lists are measured against
+static bool allocator_benchmark_run_block_mixed_first_fit(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    AllocatorBenchmarkFirstFitBlock block;
+    uint32_t* ids = mem_alloc(sizeof(uint32_t) * ALLOCATOR_BENCHMARK_MIXED_LIVE_ALLOCATIONS);
+    if (ids == NULL || !allocator_benchmark_first_fit_init(&block, ALLOCATOR_BENCHMARK_MIXED_BLOCK_SIZE)) {
+        mem_free(ids);
+        return false;
+    }
+
+    iterations = MIN(iterations, ALLOCATOR_BENCHMARK_FIRST_FIT_MAX_ITERATIONS);
+    FakeMemoryBackendInfo fake_info = fake_memory_backend_info_get_default();
+    VulkanAllocationInfo info = {.granularity = fake_info.buffer_image_granularity};
+    VkDeviceSize offset = 0;
+    bool status = true;
+    uint32_t seed = 1;
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_MIXED_LIVE_ALLOCATIONS && status; ++i) {
+        allocator_benchmark_get_mixed_info(&seed, &info);
+        ids[i] = allocator_benchmark_first_fit_allocate(&block, &info, &offset);
+        status = ids[i] != 0;
+    }
+
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        uint32_t* id = &ids[allocator_benchmark_random(&seed) % ALLOCATOR_BENCHMARK_MIXED_LIVE_ALLOCATIONS];
+        allocator_benchmark_first_fit_free(&block, *id);
+        allocator_benchmark_get_mixed_info(&seed, &info);
+        *id = allocator_benchmark_first_fit_allocate(&block, &info, &offset);
+        status = *id != 0;
+        allocator_benchmark_sink += offset;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations * 2;
+
+    allocator_benchmark_first_fit_destroy(&block);
+    mem_free(ids);
+
+    return status;
+}
+
+// Every name owns several pages like the paged buffers of the memory context
+static bool allocator_benchmark_fill_cache(
+    MemoryAllocationCache* cache, StringAtom* names, MemoryAllocationCacheHandle* handles) {
+    if (!memory_allocation_cache_init(cache, ALLOCATOR_BENCHMARK_RECORD_COUNT)) {
+        return false;
+    }
+
+    VulkanBufferObject buffer;
+    vulkan_buffer_object_clear(&buffer);
+    VulkanAllocation allocation;
+    vulkan_allocation_clear(&allocation);
+
+    for (uint32_t i = 0; i < ALLOCATOR_BENCHMARK_NAME_COUNT; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "benchmark_buffer_%u", i);
+        names[i] = string_atom_intern(name);
+    }
+    for (uint32_t i = 0; i < ALLOCATOR_BENCHMARK_RECORD_COUNT - 1; ++i) {
+        handles[i] = memory_allocation_cache_add_buffer_record(
+            cache, names[i % ALLOCATOR_BENCHMARK_NAME_COUNT], &buffer, &allocation);
+        if (handles[i] == MEMORY_ALLOCATION_CACHE_INVALID_HANDLE) {
+            memory_allocation_cache_destroy(cache);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool allocator_benchmark_run_cache_lookup(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    MemoryAllocationCache cache;
+    memory_allocation_cache_clear(&cache);
+    StringAtom* names = mem_alloc(sizeof(StringAtom) * ALLOCATOR_BENCHMARK_NAME_COUNT);
+    MemoryAllocationCacheHandle* handles =
+        mem_alloc(sizeof(MemoryAllocationCacheHandle) * ALLOCATOR_BENCHMARK_RECORD_COUNT);
+    bool status = names != NULL && handles != NULL && allocator_benchmark_fill_cache(&cache, names, handles);
+    if (!status) {
+        mem_free(names);
+        mem_free(handles);
+        return false;
+    }
+
+    uint32_t page_count = (ALLOCATOR_BENCHMARK_RECORD_COUNT - 1) / ALLOCATOR_BENCHMARK_NAME_COUNT;
+    uint32_t seed = 1;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        uint32_t value = allocator_benchmark_random(&seed);
+        const MemoryAllocationCacheRecord* record = memory_allocation_cache_get_buffer(
+            &cache, names[value % ALLOCATOR_BENCHMARK_NAME_COUNT], (value >> 10) % page_count);
+        status = record != NULL;
+        allocator_benchmark_sink += (uintptr_t)record;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations;
+
+    memory_allocation_cache_destroy(&cache);
+    mem_free(names);
+    mem_free(handles);
+
+    return status;
+}
+
+// Removing a page renumbers the pages after it, so the churn also covers the page bookkeeping of the index
+static bool allocator_benchmark_run_cache_add_remove(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    MemoryAllocationCache cache;
+    memory_allocation_cache_clear(&cache);
+    StringAtom* names = mem_alloc(sizeof(StringAtom) * ALLOCATOR_BENCHMARK_NAME_COUNT);
+    MemoryAllocationCacheHandle* handles =
+        mem_alloc(sizeof(MemoryAllocationCacheHandle) * ALLOCATOR_BENCHMARK_RECORD_COUNT);
+    bool status = names != NULL && handles != NULL && allocator_benchmark_fill_cache(&cache, names, handles);
+    if (!status) {
+        mem_free(names);
+        mem_free(handles);
+        return false;
+    }
+
+    VulkanBufferObject buffer;
+    vulkan_buffer_object_clear(&buffer);
+    VulkanAllocation allocation;
+    vulkan_allocation_clear(&allocation);
+    MemoryAllocationCacheRecord removed;
+
+    uint32_t seed = 1;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        uint32_t slot = allocator_benchmark_random(&seed) % (ALLOCATOR_BENCHMARK_RECORD_COUNT - 1);
+        status = memory_allocation_cache_remove_handle(&cache, handles[slot], &removed);
+        handles[slot] = memory_allocation_cache_add_buffer_record(&cache, removed.name, &buffer, &allocation);
+        status = status && handles[slot] != MEMORY_ALLOCATION_CACHE_INVALID_HANDLE;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations * 2;
+
+    memory_allocation_cache_destroy(&cache);
+    mem_free(names);
+    mem_free(handles);
+
+    return status;
+}
+
+static bool allocator_benchmark_linear_cache_is_match(const AllocatorBenchmarkLinearCacheRecord* record,
+    const char* name, MemoryAllocationCacheRecordType type, uint32_t page_index) {
+    return string_equals(record->name, name) && record->type == type && record->page_index == page_index;
+}
+
+static const AllocatorBenchmarkLinearCacheRecord* allocator_benchmark_linear_cache_get(
+    const AllocatorBenchmarkLinearCacheRecord* records, const char* name, uint32_t page_index) {
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_RECORD_COUNT; ++i) {
+        if (allocator_benchmark_linear_cache_is_match(
+                &records[i], name, MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD, page_index)) {
+            return &records[i];
+        }
+    }
+    return NULL;
+}
+
+// Takes the first free slot, the page index is the number of records already holding the name
+static bool allocator_benchmark_linear_cache_add(AllocatorBenchmarkLinearCacheRecord* records, const char* name) {
+    AllocatorBenchmarkLinearCacheRecord* free_record = NULL;
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_RECORD_COUNT && free_record == NULL; ++i) {
+        if (string_equals(records[i].name, ALLOCATOR_BENCHMARK_LINEAR_CACHE_FREE_NAME)) {
+            free_record = &records[i];
+        }
+    }
+    if (free_record == NULL) {
+        return false;
+    }
+
+    uint32_t page_count = 0;
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_RECORD_COUNT; ++i) {
+        if (string_equals(records[i].name, name) && records[i].type == MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD) {
+            ++page_count;
+        }
+    }
+    string_copy(name, free_record->name, ALLOCATOR_BENCHMARK_LINEAR_CACHE_NAME_SIZE);
+    free_record->type = MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD;
+    free_record->page_index = page_count;
+    return true;
+}
+
+// Frees the matching record and renumbers the later pages of the name
+static bool allocator_benchmark_linear_cache_remove(
+    AllocatorBenchmarkLinearCacheRecord* records, const char* name, uint32_t page_index) {
+    bool found = false;
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_RECORD_COUNT; ++i) {
+        if (allocator_benchmark_linear_cache_is_match(
+                &records[i], name, MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD, page_index)) {
+            string_copy(ALLOCATOR_BENCHMARK_LINEAR_CACHE_FREE_NAME, records[i].name,
+                ALLOCATOR_BENCHMARK_LINEAR_CACHE_NAME_SIZE);
+            records[i].type = MEMORY_ALLOCACTION_CACHE_UKNOWN_RECORD;
+            found = true;
+        }
+    }
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_RECORD_COUNT && found; ++i) {
+        if (string_equals(records[i].name, name) && records[i].type == MEMORY_ALLOCACTION_CACHE_BUFFER_RECORD &&
+            records[i].page_index > page_index) {
+            records[i].page_index -= 1;
+        }
+    }
+    return found;
+}
+
+static AllocatorBenchmarkLinearCacheRecord* allocator_benchmark_fill_linear_cache(char (*names)[32]) {
+    AllocatorBenchmarkLinearCacheRecord* records =
+        mem_alloc(sizeof(AllocatorBenchmarkLinearCacheRecord) * ALLOCATOR_BENCHMARK_RECORD_COUNT);
+    if (records == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < ALLOCATOR_BENCHMARK_RECORD_COUNT; ++i) {
+        string_copy(ALLOCATOR_BENCHMARK_LINEAR_CACHE_FREE_NAME, records[i].name,
+            ALLOCATOR_BENCHMARK_LINEAR_CACHE_NAME_SIZE);
+        records[i].page_index = 0;
+        records[i].type = MEMORY_ALLOCACTION_CACHE_UKNOWN_RECORD;
+        vulkan_allocation_clear(&records[i].allocation);
+        vulkan_buffer_object_clear(&records[i].buffer_object);
+    }
+    for (uint32_t i = 0; i < ALLOCATOR_BENCHMARK_NAME_COUNT; ++i) {
+        snprintf(names[i], sizeof(names[i]), "benchmark_buffer_%u", i);
+    }
+    for (uint32_t i = 0; i < ALLOCATOR_BENCHMARK_RECORD_COUNT - 1; ++i) {
+        if (!allocator_benchmark_linear_cache_add(records, names[i % ALLOCATOR_BENCHMARK_NAME_COUNT])) {
+            mem_free(records);
+            return NULL;
+        }
+    }
+    return records;
+}
+
+// Same lookups as cache_lookup on the records scan the cache did before the hash index
+static bool allocator_benchmark_run_cache_lookup_linear(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    char(*names)[32] = mem_alloc(sizeof(*names) * ALLOCATOR_BENCHMARK_NAME_COUNT);
+    AllocatorBenchmarkLinearCacheRecord* records = names != NULL ? allocator_benchmark_fill_linear_cache(names) : NULL;
+    if (records == NULL) {
+        mem_free(names);
+        return false;
+    }
+
+    iterations = MIN(iterations, ALLOCATOR_BENCHMARK_LINEAR_CACHE_MAX_ITERATIONS);
+    uint32_t page_count = (ALLOCATOR_BENCHMARK_RECORD_COUNT - 1) / ALLOCATOR_BENCHMARK_NAME_COUNT;
+    bool status = true;
+    uint32_t seed = 1;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        uint32_t value = allocator_benchmark_random(&seed);
+        const AllocatorBenchmarkLinearCacheRecord* record = allocator_benchmark_linear_cache_get(
+            records, names[value % ALLOCATOR_BENCHMARK_NAME_COUNT], (value >> 10) % page_count);
+        status = record != NULL;
+        allocator_benchmark_sink += (uintptr_t)record;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations;
+
+    mem_free(records);
+    mem_free(names);
+
+    return status;
+}
+
+static bool allocator_benchmark_run_cache_add_remove_linear(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    char(*names)[32] = mem_alloc(sizeof(*names) * ALLOCATOR_BENCHMARK_NAME_COUNT);
+    AllocatorBenchmarkLinearCacheRecord* records = names != NULL ? allocator_benchmark_fill_linear_cache(names) : NULL;
+    if (records == NULL) {
+        mem_free(names);
+        return false;
+    }
+
+    iterations = MIN(iterations, ALLOCATOR_BENCHMARK_LINEAR_CACHE_MAX_ITERATIONS);
+    bool status = true;
+    uint32_t seed = 1;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        const char* name = names[allocator_benchmark_random(&seed) % ALLOCATOR_BENCHMARK_NAME_COUNT];
+        status = allocator_benchmark_linear_cache_remove(records, name, 0) &&
+                 allocator_benchmark_linear_cache_add(records, name);
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations * 2;
+
+    mem_free(records);
+    mem_free(names);
+
+    return status;
+}
+
+static void allocator_benchmark_get_lookup_names(
+    char (*names)[ALLOCATOR_BENCHMARK_LOOKUP_NAME_SIZE], StringAtom* atoms, uint32_t count, const char* prefix) {
+    for (uint32_t i = 0; i < count; ++i) {
+        snprintf(names[i], ALLOCATOR_BENCHMARK_LOOKUP_NAME_SIZE, "%s_%u", prefix, i);
+        atoms[i] = string_atom_intern(names[i]);
+    }
+}
+
+static bool allocator_benchmark_run_command_buffer_lookup_name(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    char names[ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT][ALLOCATOR_BENCHMARK_LOOKUP_NAME_SIZE];
+    StringAtom atoms[ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT];
+    allocator_benchmark_get_lookup_names(names, atoms, ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT, "command_pool");
+
+    AllocatorBenchmarkNamedCommandPool* pools =
+        mem_alloc(sizeof(AllocatorBenchmarkNamedCommandPool) * COMMAND_POOL_CACHE_MAX_POOLS);
+    if (pools == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < COMMAND_POOL_CACHE_MAX_POOLS; ++i) {
+        const char* name =
+            i < ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT ? names[i] : ALLOCATOR_BENCHMARK_COMMAND_POOL_FREE_NAME;
+        string_copy(name, pools[i].name, COMMAND_POOL_NAME_SIZE);
+        pools[i].buffer = (VkCommandBuffer)(uintptr_t)(i + 1);
+    }
+
+    uint32_t seed = 1;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        const char* name = names[allocator_benchmark_random(&seed) % ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT];
+        for (uint32_t j = 0; j < COMMAND_POOL_CACHE_MAX_POOLS; ++j) {
+            if (string_equals(pools[j].name, name)) {
+                allocator_benchmark_sink += (uintptr_t)pools[j].buffer;
+                break;
+            }
+        }
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations;
+
+    mem_free(pools);
+
+    return true;
+}
+
+// Pools get a fake buffer each and no device objects, the context only has to be set for the lookup
+static bool allocator_benchmark_run_command_buffer_lookup_atom(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    char names[ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT][ALLOCATOR_BENCHMARK_LOOKUP_NAME_SIZE];
+    StringAtom atoms[ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT];
+    allocator_benchmark_get_lookup_names(names, atoms, ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT, "command_pool");
+
+    Context* context = mem_alloc(sizeof(Context));
+    CommandContext* command_context = mem_alloc(sizeof(CommandContext));
+    bool status = context != NULL && command_context != NULL;
+    if (status) {
+        command_context_init(command_context, context);
+    }
+    for (uint32_t i = 0; i < ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT && status; ++i) {
+        CommandPool pool;
+        command_pool_clear(&pool);
+        pool.name = atoms[i];
+        VkCommandBuffer buffer = (VkCommandBuffer)(uintptr_t)(i + 1);
+        status = vector_push(&pool.primary_buffers.handles, buffer) &&
+                 command_pool_cache_add(&command_context->command_pool_cache, &pool);
+    }
+
+    uint32_t seed = 1;
+    const CommandBufferInfo info = {.buffer_index = 0, .secondary = false};
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        StringAtom atom = atoms[allocator_benchmark_random(&seed) % ALLOCATOR_BENCHMARK_COMMAND_POOL_COUNT];
+        VkCommandBuffer buffer = command_context_get_command_buffer(command_context, atom, &info);
+        status = buffer != VK_NULL_HANDLE;
+        allocator_benchmark_sink += (uintptr_t)buffer;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations;
+
+    // The pools own no device objects, only their buffer lists are freed
+    for (uint32_t i = 0; command_context != NULL && i < COMMAND_POOL_CACHE_MAX_POOLS; ++i) {
+        vector_clear(&command_context->command_pool_cache.items[i].primary_buffers.handles);
+    }
+    mem_free(context);
+    mem_free(command_context);
+
+    return status;
+}
+
+static bool allocator_benchmark_run_pipeline_lookup_name(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    char names[ALLOCATOR_BENCHMARK_PIPELINE_COUNT][ALLOCATOR_BENCHMARK_LOOKUP_NAME_SIZE];
+    StringAtom atoms[ALLOCATOR_BENCHMARK_PIPELINE_COUNT];
+    allocator_benchmark_get_lookup_names(names, atoms, ALLOCATOR_BENCHMARK_PIPELINE_COUNT, "pipeline");
+
+    AllocatorBenchmarkPipelineMap map;
+    hash_string_map_init(&map);
+    bool status = true;
+    for (uint32_t i = 0; i < ALLOCATOR_BENCHMARK_PIPELINE_COUNT && status; ++i) {
+        PipelineRecord record = {.name = atoms[i], .type = PIPELINE_TYPE_GRAPHICS};
+        status = hash_string_map_add(&map, names[i], record);
+    }
+
+    uint32_t seed = 1;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        const char* name = names[allocator_benchmark_random(&seed) % ALLOCATOR_BENCHMARK_PIPELINE_COUNT];
+        const PipelineRecord* record = hash_string_map_get_reference(&map, name);
+        status = record != NULL && record->type == PIPELINE_TYPE_GRAPHICS;
+        allocator_benchmark_sink += (uintptr_t)&record->graphics_pipeline;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations;
+
+    hash_string_map_destroy(&map);
+
+    return status;
+}
+
+// The pipelines have no device objects, destroying the repository skips them
+static bool allocator_benchmark_run_pipeline_lookup_atom(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    char names[ALLOCATOR_BENCHMARK_PIPELINE_COUNT][ALLOCATOR_BENCHMARK_LOOKUP_NAME_SIZE];
+    StringAtom atoms[ALLOCATOR_BENCHMARK_PIPELINE_COUNT];
+    allocator_benchmark_get_lookup_names(names, atoms, ALLOCATOR_BENCHMARK_PIPELINE_COUNT, "pipeline");
+
+    PipelineRepository repository;
+    pipeline_repository_clear(&repository);
+    PipelineRepositoryConfig config = {.reserved_size = ALLOCATOR_BENCHMARK_PIPELINE_COUNT};
+    bool status = pipeline_repository_init(&repository, &config);
+    GraphicsPipeline pipeline = {0};
+    for (uint32_t i = 0; i < ALLOCATOR_BENCHMARK_PIPELINE_COUNT && status; ++i) {
+        status = pipeline_repository_add_graphics_pipeline(&repository, names[i], &pipeline);
+    }
+
+    uint32_t seed = 1;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        StringAtom atom = atoms[allocator_benchmark_random(&seed) % ALLOCATOR_BENCHMARK_PIPELINE_COUNT];
+        const GraphicsPipeline* found = pipeline_repository_get_graphics_pipeline(&repository, atom);
+        status = found != NULL;
+        allocator_benchmark_sink += (uintptr_t)found;
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations;
+
+    pipeline_repository_destroy(&repository);
+
+    return status;
+}
+
+static bool allocator_benchmark_run_vector_push(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    bool status = true;
+    allocator_benchmark_heap_call_count = 0;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        AllocatorBenchmarkVector values;
+        vector_init(&values);
+        for (uint32_t j = 0; j < ALLOCATOR_BENCHMARK_VECTOR_PUSHES && status; ++j) {
+            status = vector_push(&values, j);
+        }
+        allocator_benchmark_sink += values.data[values.size - 1];
+        vector_clear(&values);
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations * ALLOCATOR_BENCHMARK_VECTOR_PUSHES;
+    result->frame_count = iterations;
+    result->heap_call_count = allocator_benchmark_heap_call_count;
+
+    return status;
+}
+
+static bool allocator_benchmark_run_small_vector_push(uint64_t iterations, AllocatorBenchmarkResult* result) {
+    bool status = true;
+    allocator_benchmark_heap_call_count = 0;
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < iterations && status; ++i) {
+        AllocatorBenchmarkSmallVector values;
+        small_vector_init(&values);
+        for (uint32_t j = 0; j < ALLOCATOR_BENCHMARK_VECTOR_PUSHES && status; ++j) {
+            status = small_vector_push(&values, j);
+        }
+        allocator_benchmark_sink += values.data[values.size - 1];
+        small_vector_destroy(&values);
+    }
+    result->elapsed_ns = allocator_benchmark_get_ns(start_counter);
+    result->op_count = iterations * ALLOCATOR_BENCHMARK_VECTOR_PUSHES;
+    result->frame_count = iterations;
+    result->heap_call_count = allocator_benchmark_heap_call_count;
+
+    return status;
+}
+
+static const AllocatorBenchmark allocator_benchmarks[] = {
+    {.name = "block_alloc_free", .run = allocator_benchmark_run_block_alloc_free},
+    {.name = "block_alloc_free_locked", .run = allocator_benchmark_run_block_alloc_free_locked},
+    {.name = "block_threads_1", .run = allocator_benchmark_run_block_threads_1},
+    {.name = "block_threads_2", .run = allocator_benchmark_run_block_threads_2},
+    {.name = "block_threads_4", .run = allocator_benchmark_run_block_threads_4},
+    {.name = "block_threads_8", .run = allocator_benchmark_run_block_threads_8},
+    {.name = "block_mixed_tlsf", .run = allocator_benchmark_run_block_mixed_tlsf},
+    {.name = "block_mixed_first_fit", .run = allocator_benchmark_run_block_mixed_first_fit},
+    {.name = "cache_lookup", .run = allocator_benchmark_run_cache_lookup},
+    {.name = "cache_add_remove", .run = allocator_benchmark_run_cache_add_remove},
+    {.name = "cache_lookup_linear", .run = allocator_benchmark_run_cache_lookup_linear},
+    {.name = "cache_add_remove_linear", .run = allocator_benchmark_run_cache_add_remove_linear},
+    {.name = "command_buffer_lookup_name", .run = allocator_benchmark_run_command_buffer_lookup_name},
+    {.name = "command_buffer_lookup_atom", .run = allocator_benchmark_run_command_buffer_lookup_atom},
+    {.name = "pipeline_lookup_name", .run = allocator_benchmark_run_pipeline_lookup_name},
+    {.name = "pipeline_lookup_atom", .run = allocator_benchmark_run_pipeline_lookup_atom},
+    {.name = "vector_push", .run = allocator_benchmark_run_vector_push},
+    {.name = "small_vector_push", .run = allocator_benchmark_run_small_vector_push},
+};
+
+int main(int argc, char* args[]) {
+    uint64_t iterations = ALLOCATOR_BENCHMARK_DEFAULT_ITERATIONS;
+    if (argc > 2 || (argc == 2 && (iterations = strtoull(args[1], NULL, 10)) == 0)) {
+        fprintf(stderr, "Usage: %s [iterations]\n", args[0]);
+        return 1;
+    }
+    if (!string_atom_table_init()) {
+        fprintf(stderr, "Unable to init the string atom table\n");
+        return 1;
+    }
+
+    printf("%-28s %12s %10s %12s\n", "benchmark", "ops", "ns/op", "allocs/frame");
+    int error_code = 0;
+    for (size_t i = 0; i < sizeof(allocator_benchmarks) / sizeof(AllocatorBenchmark); ++i) {
+        AllocatorBenchmarkResult result = {0};
+        if (!allocator_benchmarks[i].run(iterations, &result)) {
+            fprintf(stderr, "Benchmark %s failed\n", allocator_benchmarks[i].name);
+            error_code = 1;
+            continue;
+        }
+
+        double ns_per_op = result.op_count > 0 ? (double)result.elapsed_ns / (double)result.op_count : 0.0;
+        printf("%-28s %12llu %10.1f", allocator_benchmarks[i].name, (unsigned long long)result.op_count, ns_per_op);
+        if (result.frame_count > 0) {
+            printf(" %12.2f\n", (double)result.heap_call_count / (double)result.frame_count);
+        } else {
+            printf(" %12s\n", "-");
+        }
+    }
+
+    string_atom_table_destroy();
+
+    return error_code;
+}
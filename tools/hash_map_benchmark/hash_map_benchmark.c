@@ -0,0 +1,176 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../src/lib/core/collections/hash_string_group_map.h"
+#include "../../src/lib/core/collections/hash_string_map.h"
+#include "../../src/lib/core/memory/memory.h"
+
+#define HASH_MAP_BENCHMARK_DEFAULT_LOOKUPS 1000000
+#define HASH_MAP_BENCHMARK_KEY_FORMAT "benchmark/key_%u"
+
+typedef struct HashMapBenchmarkResult {
+    // ns/op of each operation
+    double insert;
+    double hit;
+    double miss;
+    // Deletes a key and adds it back, keeps the map full of tombstones
+    double churn;
+} HashMapBenchmarkResult;
+
+typedef struct HashMapBenchmarkMap HASH_STRING_MAP(uint32_t) HashMapBenchmarkMap;
+typedef struct HashMapBenchmarkGroupMap HASH_STRING_GROUP_MAP(uint32_t) HashMapBenchmarkGroupMap;
+
+typedef bool (*HashMapBenchmarkFunction)(
+    char (*keys)[HASH_KEY_MAX_SIZE], uint32_t key_count, uint64_t lookups, HashMapBenchmarkResult* result);
+
+typedef struct HashMapBenchmark {
+    const char* name;
+    HashMapBenchmarkFunction run;
+} HashMapBenchmark;
+
+static const uint32_t hash_map_benchmark_sizes[] = {100, 10000, 1000000};
+
+// Results are folded into the sink so the measured work cannot be optimized away
+static volatile uint64_t hash_map_benchmark_sink;
+
+static uint64_t hash_map_benchmark_get_ns(uint64_t start_counter) {
+    uint64_t elapsed = SDL_GetPerformanceCounter() - start_counter;
+    return (uint64_t)((double)elapsed * 1e9 / (double)SDL_GetPerformanceFrequency());
+}
+
+static inline uint32_t hash_map_benchmark_random(uint32_t* seed) {
+    *seed = *seed * 1664525U + 1013904223U;
+    return *seed >> 8;
+}
+
+static double hash_map_benchmark_ns_per_op(uint64_t start_counter, uint64_t op_count) {
+    return (double)hash_map_benchmark_get_ns(start_counter) / (double)op_count;
+}
+
+// The first key_count keys are inserted, the second half of the buffer holds keys that are never added
+static bool hash_map_benchmark_run_map(
+    char (*keys)[HASH_KEY_MAX_SIZE], uint32_t key_count, uint64_t lookups, HashMapBenchmarkResult* result) {
+    HashMapBenchmarkMap map;
+    hash_string_map_init(&map);
+    bool status = true;
+
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint32_t i = 0; i < key_count && status; ++i) {
+        status = hash_string_map_add(&map, keys[i], i);
+    }
+    result->insert = hash_map_benchmark_ns_per_op(start_counter, key_count);
+
+    uint32_t seed = 1;
+    start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < lookups && status; ++i) {
+        uint32_t value = 0;
+        status = hash_string_map_get(&map, keys[hash_map_benchmark_random(&seed) % key_count], &value);
+        hash_map_benchmark_sink += value;
+    }
+    result->hit = hash_map_benchmark_ns_per_op(start_counter, lookups);
+
+    start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < lookups && status; ++i) {
+        status = !hash_string_map_has(&map, keys[key_count + hash_map_benchmark_random(&seed) % key_count]);
+    }
+    result->miss = hash_map_benchmark_ns_per_op(start_counter, lookups);
+
+    start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < lookups && status; ++i) {
+        uint32_t index = hash_map_benchmark_random(&seed) % key_count;
+        status = hash_string_map_delete(&map, keys[index]) && hash_string_map_add(&map, keys[index], index);
+    }
+    result->churn = hash_map_benchmark_ns_per_op(start_counter, lookups * 2);
+
+    hash_string_map_destroy(&map);
+
+    return status;
+}
+
+static bool hash_map_benchmark_run_group_map(
+    char (*keys)[HASH_KEY_MAX_SIZE], uint32_t key_count, uint64_t lookups, HashMapBenchmarkResult* result) {
+    HashMapBenchmarkGroupMap map;
+    hash_string_group_map_init(&map);
+    bool status = true;
+
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint32_t i = 0; i < key_count && status; ++i) {
+        status = hash_string_group_map_add(&map, keys[i], i);
+    }
+    result->insert = hash_map_benchmark_ns_per_op(start_counter, key_count);
+
+    uint32_t seed = 1;
+    start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < lookups && status; ++i) {
+        uint32_t value = 0;
+        status = hash_string_group_map_get(&map, keys[hash_map_benchmark_random(&seed) % key_count], &value);
+        hash_map_benchmark_sink += value;
+    }
+    result->hit = hash_map_benchmark_ns_per_op(start_counter, lookups);
+
+    start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < lookups && status; ++i) {
+        status = !hash_string_group_map_has(&map, keys[key_count + hash_map_benchmark_random(&seed) % key_count]);
+    }
+    result->miss = hash_map_benchmark_ns_per_op(start_counter, lookups);
+
+    start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < lookups && status; ++i) {
+        uint32_t index = hash_map_benchmark_random(&seed) % key_count;
+        status =
+            hash_string_group_map_delete(&map, keys[index]) && hash_string_group_map_add(&map, keys[index], index);
+    }
+    result->churn = hash_map_benchmark_ns_per_op(start_counter, lookups * 2);
+
+    hash_string_group_map_destroy(&map);
+
+    return status;
+}
+
+static const HashMapBenchmark hash_map_benchmarks[] = {
+    {.name = "hash_string_map", .run = hash_map_benchmark_run_map},
+    {.name = "hash_string_group_map", .run = hash_map_benchmark_run_group_map},
+};
+
+int main(int argc, char* args[]) {
+    uint64_t lookups = HASH_MAP_BENCHMARK_DEFAULT_LOOKUPS;
+    if (argc > 2 || (argc == 2 && (lookups = strtoull(args[1], NULL, 10)) == 0)) {
+        fprintf(stderr, "Usage: %s [lookups]\n", args[0]);
+        return 1;
+    }
+
+    size_t size_count = sizeof(hash_map_benchmark_sizes) / sizeof(uint32_t);
+    uint32_t max_key_count = hash_map_benchmark_sizes[size_count - 1];
+    char(*keys)[HASH_KEY_MAX_SIZE] = mem_alloc(sizeof(*keys) * max_key_count * 2);
+    if (keys == NULL) {
+        fprintf(stderr, "Unable to allocate the keys\n");
+        return 1;
+    }
+
+    printf("%-24s %8s %10s %10s %10s %10s\n", "map", "size", "insert", "hit", "miss", "churn");
+    int error_code = 0;
+    for (size_t i = 0; i < size_count; ++i) {
+        // Interleaved so the missing keys share their prefixes with the present ones
+        uint32_t key_count = hash_map_benchmark_sizes[i];
+        for (uint32_t j = 0; j < key_count * 2; ++j) {
+            snprintf(keys[j % 2 == 0 ? j / 2 : key_count + j / 2], HASH_KEY_MAX_SIZE, HASH_MAP_BENCHMARK_KEY_FORMAT, j);
+        }
+
+        for (size_t j = 0; j < sizeof(hash_map_benchmarks) / sizeof(HashMapBenchmark); ++j) {
+            HashMapBenchmarkResult result = {0};
+            if (!hash_map_benchmarks[j].run(keys, key_count, lookups, &result)) {
+                fprintf(stderr, "Benchmark %s failed for size %u\n", hash_map_benchmarks[j].name, key_count);
+                error_code = 1;
+                continue;
+            }
+            printf("%-24s %8u %10.1f %10.1f %10.1f %10.1f\n", hash_map_benchmarks[j].name, key_count, result.insert,
+                result.hit, result.miss, result.churn);
+        }
+    }
+
+    mem_free(keys);
+
+    return error_code;
+}
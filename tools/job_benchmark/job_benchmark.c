@@ -0,0 +1,153 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../src/lib/core/jobs/job_system.h"
+
+#define JOB_BENCHMARK_DEFAULT_JOBS 1000000
+// Jobs queued at once by the throughput benchmark, stays below the job pool of a worker
+#define JOB_BENCHMARK_BATCH_SIZE 256
+// Every root job of a fan-out round starts this many leaf jobs and waits for them
+#define JOB_BENCHMARK_FAN_OUT 16
+
+typedef struct JobBenchmarkResult {
+    uint64_t job_count;
+    uint64_t elapsed_ns;
+} JobBenchmarkResult;
+
+typedef bool (*JobBenchmarkFunction)(JobSystem* system, uint64_t job_count, JobBenchmarkResult* result);
+
+typedef struct JobBenchmark {
+    const char* name;
+    JobBenchmarkFunction run;
+} JobBenchmark;
+
+// 0 uses one worker per CPU
+static const uint32_t job_benchmark_worker_counts[] = {1, 2, 4, 0};
+
+static uint64_t job_benchmark_get_ns(uint64_t start_counter) {
+    uint64_t elapsed = SDL_GetPerformanceCounter() - start_counter;
+    return (uint64_t)((double)elapsed * 1e9 / (double)SDL_GetPerformanceFrequency());
+}
+
+static void job_benchmark_empty_job(void* data) {}
+
+static void job_benchmark_root_job(void* data) {
+    JobSystem* system = data;
+    JobDecl jobs[JOB_BENCHMARK_FAN_OUT];
+    for (size_t i = 0; i < JOB_BENCHMARK_FAN_OUT; ++i) {
+        jobs[i] = (JobDecl){.function = job_benchmark_empty_job, .data = NULL};
+    }
+
+    JobCounter counter;
+    job_counter_clear(&counter);
+    if (job_system_run(system, jobs, JOB_BENCHMARK_FAN_OUT, &counter)) {
+        job_system_wait(system, &counter);
+    }
+}
+
+static bool job_benchmark_run_empty_jobs(JobSystem* system, uint64_t job_count, JobBenchmarkResult* result) {
+    JobDecl jobs[JOB_BENCHMARK_BATCH_SIZE];
+    for (size_t i = 0; i < JOB_BENCHMARK_BATCH_SIZE; ++i) {
+        jobs[i] = (JobDecl){.function = job_benchmark_empty_job, .data = NULL};
+    }
+
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < job_count; i += JOB_BENCHMARK_BATCH_SIZE) {
+        JobCounter counter;
+        job_counter_clear(&counter);
+        if (!job_system_run(system, jobs, JOB_BENCHMARK_BATCH_SIZE, &counter)) {
+            return false;
+        }
+        job_system_wait(system, &counter);
+        result->job_count += JOB_BENCHMARK_BATCH_SIZE;
+    }
+    result->elapsed_ns = job_benchmark_get_ns(start_counter);
+
+    return true;
+}
+
+// Every round is FAN_OUT root jobs with FAN_OUT leaves each, the leaves of a root may run on any worker
+static bool job_benchmark_run_fan_out(JobSystem* system, uint64_t job_count, JobBenchmarkResult* result) {
+    JobDecl jobs[JOB_BENCHMARK_FAN_OUT];
+    for (size_t i = 0; i < JOB_BENCHMARK_FAN_OUT; ++i) {
+        jobs[i] = (JobDecl){.function = job_benchmark_root_job, .data = system};
+    }
+
+    const uint64_t round_job_count = JOB_BENCHMARK_FAN_OUT * (JOB_BENCHMARK_FAN_OUT + 1);
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < job_count; i += round_job_count) {
+        JobCounter counter;
+        job_counter_clear(&counter);
+        if (!job_system_run(system, jobs, JOB_BENCHMARK_FAN_OUT, &counter)) {
+            return false;
+        }
+        job_system_wait(system, &counter);
+        result->job_count += round_job_count;
+    }
+    result->elapsed_ns = job_benchmark_get_ns(start_counter);
+
+    return true;
+}
+
+static void job_benchmark_range_job(void* data, size_t start, size_t end) {}
+
+// One batch per job, measures the overhead parallel_for adds to the empty jobs
+static bool job_benchmark_run_parallel_for(JobSystem* system, uint64_t job_count, JobBenchmarkResult* result) {
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t i = 0; i < job_count; i += JOB_BENCHMARK_BATCH_SIZE) {
+        if (!job_system_parallel_for(system, JOB_BENCHMARK_BATCH_SIZE, 1, job_benchmark_range_job, NULL)) {
+            return false;
+        }
+        result->job_count += JOB_BENCHMARK_BATCH_SIZE;
+    }
+    result->elapsed_ns = job_benchmark_get_ns(start_counter);
+
+    return true;
+}
+
+static const JobBenchmark job_benchmarks[] = {
+    {.name = "empty_jobs", .run = job_benchmark_run_empty_jobs},
+    {.name = "fan_out_fan_in", .run = job_benchmark_run_fan_out},
+    {.name = "parallel_for", .run = job_benchmark_run_parallel_for},
+};
+
+int main(int argc, char* args[]) {
+    uint64_t job_count = JOB_BENCHMARK_DEFAULT_JOBS;
+    if (argc > 2 || (argc == 2 && (job_count = strtoull(args[1], NULL, 10)) == 0)) {
+        fprintf(stderr, "Usage: %s [jobs]\n", args[0]);
+        return 1;
+    }
+
+    printf("%-24s %8s %12s %10s\n", "benchmark", "workers", "jobs", "ns/job");
+    int error_code = 0;
+    for (size_t i = 0; i < sizeof(job_benchmark_worker_counts) / sizeof(uint32_t); ++i) {
+        JobSystemConfig config = job_system_config_default();
+        config.worker_count = job_benchmark_worker_counts[i];
+
+        JobSystem system;
+        if (!job_system_init(&system, &config)) {
+            fprintf(stderr, "Unable to init the job system with %u workers\n", config.worker_count);
+            error_code = 1;
+            continue;
+        }
+
+        for (size_t j = 0; j < sizeof(job_benchmarks) / sizeof(JobBenchmark); ++j) {
+            JobBenchmarkResult result = {0};
+            if (!job_benchmarks[j].run(&system, job_count, &result)) {
+                fprintf(stderr, "Benchmark %s failed with %u workers\n", job_benchmarks[j].name, system.worker_count);
+                error_code = 1;
+                continue;
+            }
+
+            double ns_per_job = result.job_count > 0 ? (double)result.elapsed_ns / (double)result.job_count : 0.0;
+            printf("%-24s %8u %12llu %10.1f\n", job_benchmarks[j].name, system.worker_count,
+                (unsigned long long)result.job_count, ns_per_job);
+        }
+
+        job_system_destroy(&system);
+    }
+
+    return error_code;
+}
@@ -0,0 +1,299 @@
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/lib/core/fs/file.h"
+#include "../../src/lib/core/memory/memory.h"
+#include "../../src/lib/core/utils/macro.h"
+#include "../../src/lib/vulkan/core/memory/allocator.h"
+#include "../../src/lib/vulkan/core/memory/backend/fake_memory_backend.h"
+#include "../../src/lib/vulkan/core/memory/trace/memory_trace.h"
+
+// Stats are sampled on every frame and at least every this many ops
+#define MEMORY_REPLAY_SAMPLE_INTERVAL 1024
+#define MEMORY_REPLAY_MAX_CONFIGS 32
+// Keeps the strategy recorded in the trace
+#define MEMORY_REPLAY_TRACE_STRATEGY VULKAN_MEMORY_STRATEGIES_TOTAL
+
+typedef struct MemoryReplayConfig {
+    VkDeviceSize device_local_block_size_MB;
+    VkDeviceSize host_visible_block_size_MB;
+    VkDeviceSize dedicated_allocation_threshold_MB;
+    // Replaces the strategy of every request, transient strategies fail the requests that outgrow their blocks
+    VulkanMemoryStrategy strategy;
+    // Replays through the locks and the thread cache of a concurrent allocator
+    bool concurrent;
+} MemoryReplayConfig;
+
+typedef struct MemoryReplayResult {
+    uint64_t op_count;
+    uint64_t failed_count;
+    uint64_t elapsed_ns;
+
+    VkDeviceSize peak_bytes;
+    uint32_t peak_block_count;
+    // Share of the free bytes outside the largest free range, averaged over the samples and at its worst
+    double average_fragmentation;
+    double max_fragmentation;
+    uint64_t sample_count;
+} MemoryReplayResult;
+
+// Indexed by the strategy, the last name stands for MEMORY_REPLAY_TRACE_STRATEGY
+static const char* memory_replay_strategy_names[] = {"default", "linear", "ring", "trace"};
+
+static const MemoryReplayConfig memory_replay_default_configs[] = {
+    {.device_local_block_size_MB = 32, .host_visible_block_size_MB = 32, .dedicated_allocation_threshold_MB = 16,
+        .strategy = MEMORY_REPLAY_TRACE_STRATEGY},
+    {.device_local_block_size_MB = 64, .host_visible_block_size_MB = 64, .dedicated_allocation_threshold_MB = 32,
+        .strategy = MEMORY_REPLAY_TRACE_STRATEGY},
+    {.device_local_block_size_MB = 128, .host_visible_block_size_MB = 64, .dedicated_allocation_threshold_MB = 64,
+        .strategy = MEMORY_REPLAY_TRACE_STRATEGY},
+    {.device_local_block_size_MB = 256, .host_visible_block_size_MB = 256, .dedicated_allocation_threshold_MB = 64,
+        .strategy = MEMORY_REPLAY_TRACE_STRATEGY},
+    {.device_local_block_size_MB = 256, .host_visible_block_size_MB = 256, .dedicated_allocation_threshold_MB = 64,
+        .strategy = MEMORY_REPLAY_TRACE_STRATEGY, .concurrent = true},
+};
+
+static bool memory_replay_parse_strategy(const char* str, size_t length, VulkanMemoryStrategy* strategy) {
+    for (uint32_t i = 0; i <= MEMORY_REPLAY_TRACE_STRATEGY; ++i) {
+        if (strlen(memory_replay_strategy_names[i]) == length &&
+            strncmp(str, memory_replay_strategy_names[i], length) == 0) {
+            *strategy = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// device_local_MB:host_visible_MB:dedicated_threshold_MB[:strategy][:concurrent]
+static bool memory_replay_parse_config(const char* str, MemoryReplayConfig* config) {
+    unsigned long long device_local = 0, host_visible = 0, dedicated = 0;
+    int offset = 0;
+    if (sscanf(str, "%llu:%llu:%llu%n", &device_local, &host_visible, &dedicated, &offset) != 3 ||
+        device_local == 0 || host_visible == 0) {
+        return false;
+    }
+
+    config->device_local_block_size_MB = device_local;
+    config->host_visible_block_size_MB = host_visible;
+    config->dedicated_allocation_threshold_MB = dedicated;
+    config->strategy = MEMORY_REPLAY_TRACE_STRATEGY;
+    config->concurrent = false;
+
+    const char* option = str + offset;
+    while (*option == ':') {
+        option += 1;
+        size_t length = strcspn(option, ":");
+        if (length == strlen("concurrent") && strncmp(option, "concurrent", length) == 0) {
+            config->concurrent = true;
+        } else if (!memory_replay_parse_strategy(option, length, &config->strategy)) {
+            return false;
+        }
+        option += length;
+    }
+
+    return *option == '\0';
+}
+
+static uint64_t memory_replay_get_ns(uint64_t start_counter) {
+    uint64_t elapsed = SDL_GetPerformanceCounter() - start_counter;
+    return (uint64_t)((double)elapsed * 1e9 / (double)SDL_GetPerformanceFrequency());
+}
+
+static void memory_replay_sample(const VulkanMemoryAllocator* allocator, MemoryReplayResult* result) {
+    VulkanMemoryStats stats;
+    vulkan_memory_allocator_get_stats(allocator, &stats);
+
+    double fragmentation = 0.0;
+    if (stats.total.free_bytes > 0) {
+        fragmentation = 1.0 - (double)stats.total.largest_free_range / (double)stats.total.free_bytes;
+    }
+
+    result->peak_block_count = MAX(result->peak_block_count, stats.total.block_count);
+    result->max_fragmentation = MAX(result->max_fragmentation, fragmentation);
+    result->average_fragmentation += fragmentation;
+    result->sample_count += 1;
+}
+
+static uint32_t memory_replay_get_max_allocation_id(const byte* data, size_t size) {
+    VulkanMemoryTraceReader reader;
+    VulkanMemoryTraceEvent event;
+    uint32_t max_allocation_id = 0;
+
+    vulkan_memory_trace_reader_init(&reader, data, size);
+    while (vulkan_memory_trace_reader_next(&reader, &event)) {
+        max_allocation_id = MAX(max_allocation_id, event.allocation_id);
+    }
+
+    return reader.is_valid ? max_allocation_id : UINT32_MAX;
+}
+
+static void memory_replay_event(VulkanMemoryAllocator* allocator, const MemoryReplayConfig* config,
+    const VulkanMemoryTraceEvent* event, VulkanAllocation* allocations, MemoryReplayResult* result) {
+    VulkanAllocation* allocation = &allocations[event->allocation_id];
+
+    switch (event->op) {
+        case VULKAN_MEMORY_TRACE_OP_ALLOCATE: {
+            VulkanMemoryAllocatorRequest req = {
+                .size = event->request.size,
+                .align = event->request.align,
+                .memory_type_bits = event->request.memory_type_bits,
+                .usage = event->request.usage,
+                .allocation_type = event->request.allocation_type,
+                .strategy =
+                    config->strategy == MEMORY_REPLAY_TRACE_STRATEGY ? event->request.strategy : config->strategy,
+                .prefers_dedicated_allocation = event->request.prefers_dedicated_allocation,
+                .requires_dedicated_allocation = event->request.requires_dedicated_allocation,
+                .buffer = VK_NULL_HANDLE,
+            };
+            if (vulkan_memory_allocator_allocate(allocator, &req, allocation) != MEMORY_CONTEXT_SUCCESS) {
+                result->failed_count += 1;
+            }
+            break;
+        }
+        case VULKAN_MEMORY_TRACE_OP_FREE:
+            vulkan_memory_allocator_free(allocator, *allocation);
+            vulkan_allocation_clear(allocation);
+            break;
+        case VULKAN_MEMORY_TRACE_OP_FREE_IMMEDIATELY:
+            vulkan_memory_allocator_free_immediately(allocator, allocation);
+            break;
+        case VULKAN_MEMORY_TRACE_OP_BEGIN_FRAME:
+            vulkan_memory_allocator_begin_frame(allocator, event->frame_index, event->frame_number);
+            break;
+        case VULKAN_MEMORY_TRACE_OP_EMPTY_GARBAGE:
+            vulkan_memory_allocator_empty_garbage(allocator, event->frame_number);
+            break;
+        default:
+            break;
+    }
+}
+
+static bool memory_replay_run(const byte* data, size_t size, uint32_t max_allocation_id,
+    const MemoryReplayConfig* config, MemoryReplayResult* result) {
+    *result = (MemoryReplayResult){0};
+
+    FakeMemoryBackend* fake = mem_alloc(sizeof(FakeMemoryBackend));
+    VulkanAllocation* allocations = mem_alloc(sizeof(VulkanAllocation) * ((size_t)max_allocation_id + 1));
+    if (fake == NULL || allocations == NULL) {
+        mem_free(fake);
+        mem_free(allocations);
+        return false;
+    }
+    for (size_t i = 0; i <= max_allocation_id; ++i) {
+        vulkan_allocation_clear(&allocations[i]);
+    }
+
+    FakeMemoryBackendInfo fake_info = fake_memory_backend_info_get_default();
+    VulkanMemoryAllocatorInfo allocator_info = vulkan_memory_allocator_info_get_default();
+    allocator_info.device = &fake->device;
+    allocator_info.backend = &fake->backend;
+    allocator_info.device_local_block_size_MB = config->device_local_block_size_MB;
+    allocator_info.host_visible_block_size_MB = config->host_visible_block_size_MB;
+    allocator_info.dedicated_allocation_threshold_MB = config->dedicated_allocation_threshold_MB;
+    allocator_info.concurrent = config->concurrent;
+
+    VulkanMemoryAllocator allocator;
+    bool status = fake_memory_backend_init(fake, &fake_info) == MEMORY_CONTEXT_SUCCESS &&
+                  vulkan_memory_allocator_init(&allocator, &allocator_info) == MEMORY_CONTEXT_SUCCESS;
+
+    VulkanMemoryTraceReader reader;
+    VulkanMemoryTraceEvent event;
+    vulkan_memory_trace_reader_init(&reader, data, size);
+
+    // Sampling is left out of the measured time
+    uint64_t start_counter = SDL_GetPerformanceCounter();
+    while (status && vulkan_memory_trace_reader_next(&reader, &event)) {
+        memory_replay_event(&allocator, config, &event, allocations, result);
+        result->op_count += 1;
+
+        if (event.op == VULKAN_MEMORY_TRACE_OP_BEGIN_FRAME || result->op_count % MEMORY_REPLAY_SAMPLE_INTERVAL == 0) {
+            result->elapsed_ns += memory_replay_get_ns(start_counter);
+            memory_replay_sample(&allocator, result);
+            start_counter = SDL_GetPerformanceCounter();
+        }
+    }
+    result->elapsed_ns += memory_replay_get_ns(start_counter);
+
+    if (status) {
+        memory_replay_sample(&allocator, result);
+        result->average_fragmentation /= (double)result->sample_count;
+        result->peak_bytes = fake->peak_usage;
+        vulkan_memory_allocator_destroy(&allocator);
+    }
+    fake_memory_backend_destroy(fake);
+    mem_free(fake);
+    mem_free(allocations);
+
+    return status;
+}
+
+int main(int argc, char* args[]) {
+    if (argc < 2 || argc - 2 > MEMORY_REPLAY_MAX_CONFIGS) {
+        fprintf(stderr,
+            "Usage: %s <trace> [device_local_MB:host_visible_MB:dedicated_threshold_MB[:strategy][:concurrent]]...\n"
+            "Strategies: trace, default, linear, ring\n",
+            args[0]);
+        return 1;
+    }
+
+    MemoryReplayConfig configs[MEMORY_REPLAY_MAX_CONFIGS];
+    size_t config_count = argc - 2;
+    for (size_t i = 0; i < config_count; ++i) {
+        if (!memory_replay_parse_config(args[i + 2], &configs[i])) {
+            fprintf(stderr, "Invalid config: %s\n", args[i + 2]);
+            return 1;
+        }
+    }
+    if (config_count == 0) {
+        config_count = sizeof(memory_replay_default_configs) / sizeof(MemoryReplayConfig);
+        for (size_t i = 0; i < config_count; ++i) {
+            configs[i] = memory_replay_default_configs[i];
+        }
+    }
+
+    ssize_t size = file_get_byte_size(args[1]);
+    byte* data = size > 0 ? mem_alloc(size) : NULL;
+    if (data == NULL || file_read_binary(args[1], (char*)data) != size) {
+        fprintf(stderr, "Unable to load the trace: %s\n", args[1]);
+        mem_free(data);
+        return 1;
+    }
+
+    VulkanMemoryTraceReader reader;
+    uint32_t max_allocation_id = memory_replay_get_max_allocation_id(data, size);
+    if (!vulkan_memory_trace_reader_init(&reader, data, size) || max_allocation_id == UINT32_MAX) {
+        fprintf(stderr, "Invalid trace: %s\n", args[1]);
+        mem_free(data);
+        return 1;
+    }
+
+    printf("%-28s %10s %8s %10s %14s %8s %10s %10s\n", "config", "ops", "failed", "ns/op", "peak_bytes", "blocks",
+        "avg_frag", "max_frag");
+    int error_code = 0;
+    for (size_t i = 0; i < config_count; ++i) {
+        char name[64];
+        snprintf(name, sizeof(name), "%llu:%llu:%llu:%s%s", (unsigned long long)configs[i].device_local_block_size_MB,
+            (unsigned long long)configs[i].host_visible_block_size_MB,
+            (unsigned long long)configs[i].dedicated_allocation_threshold_MB,
+            memory_replay_strategy_names[configs[i].strategy], configs[i].concurrent ? ":concurrent" : "");
+
+        MemoryReplayResult result;
+        if (!memory_replay_run(data, size, max_allocation_id, &configs[i], &result)) {
+            fprintf(stderr, "Replay failed for config %s\n", name);
+            error_code = 1;
+            continue;
+        }
+
+        double ns_per_op = result.op_count > 0 ? (double)result.elapsed_ns / (double)result.op_count : 0.0;
+        printf("%-28s %10llu %8llu %10.1f %14llu %8u %10.3f %10.3f\n", name, (unsigned long long)result.op_count,
+            (unsigned long long)result.failed_count, ns_per_op, (unsigned long long)result.peak_bytes,
+            result.peak_block_count, result.average_fragmentation, result.max_fragmentation);
+    }
+
+    mem_free(data);
+
+    return error_code;
+}